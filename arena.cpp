@@ -0,0 +1,197 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+//NOTE(Torin) Arenas hand out memory from large blocks that are never returned
+//to the system. Resetting an arena keeps its blocks around so once an arena
+//has reached its high water mark it no longer calls malloc at all.
+
+struct MemoryArenaBlock {
+  MemoryArenaBlock *next;
+  size_t size;
+  size_t used;
+};
+
+struct MemoryArena {
+  const char *name;
+  MemoryArenaBlock *firstBlock;
+  MemoryArenaBlock *currentBlock;
+  size_t minimumBlockSize;
+
+  size_t bytesUsed;
+  size_t bytesReserved;
+  size_t highWaterMark;
+  uint32_t blockCount;
+  uint64_t allocationCount;
+  uint64_t resetCount;
+};
+
+//NOTE(Torin) Fixed size blocks carved out of an arena with a free list so
+//objects that come and go (watch expressions) can be recycled
+struct MemoryPool {
+  MemoryArena *arena;
+  size_t blockSize;
+  void *freeList;
+  uint32_t blocksInUse;
+  uint32_t blocksReserved;
+};
+
+struct MemoryStats {
+  uint64_t backingAllocationCount;
+  uint64_t backingAllocationCountAtFrameBegin;
+  uint64_t backingAllocationsLastFrame;
+};
+
+static MemoryStats _memoryStats;
+
+#define MEMORY_ARENA_DEFAULT_BLOCK_SIZE (1024 * 1024)
+#define MEMORY_ARENA_ALIGNMENT 16
+
+static inline
+size_t AlignSize(size_t size, size_t alignment) {
+  size_t result = (size + (alignment - 1)) & ~(alignment - 1);
+  return result;
+}
+
+static inline
+void InitMemoryArena(MemoryArena *arena, const char *name, size_t minimumBlockSize) {
+  memset(arena, 0, sizeof(MemoryArena));
+  arena->name = name;
+  arena->minimumBlockSize = minimumBlockSize;
+}
+
+static MemoryArenaBlock *
+AllocateMemoryArenaBlock(MemoryArena *arena, size_t requiredSize)
+{
+  size_t blockSize = arena->minimumBlockSize;
+  if (blockSize < requiredSize) blockSize = requiredSize;
+  size_t headerSize = AlignSize(sizeof(MemoryArenaBlock), MEMORY_ARENA_ALIGNMENT);
+  MemoryArenaBlock *block = (MemoryArenaBlock *)malloc(headerSize + blockSize);
+  assert(block != NULL);
+  block->next = NULL;
+  block->size = blockSize;
+  block->used = 0;
+
+  arena->blockCount++;
+  arena->bytesReserved += blockSize;
+  _memoryStats.backingAllocationCount++;
+  return block;
+}
+
+static inline
+uint8_t *GetMemoryArenaBlockBase(MemoryArenaBlock *block) {
+  uint8_t *result = (uint8_t *)block + AlignSize(sizeof(MemoryArenaBlock), MEMORY_ARENA_ALIGNMENT);
+  return result;
+}
+
+static void *
+PushSize(MemoryArena *arena, size_t size)
+{
+  size = AlignSize(size, MEMORY_ARENA_ALIGNMENT);
+  MemoryArenaBlock *block = arena->currentBlock;
+  while (block == NULL || block->used + size > block->size) {
+    if (block == NULL) {
+      if (arena->firstBlock == NULL)
+        arena->firstBlock = AllocateMemoryArenaBlock(arena, size);
+      block = arena->firstBlock;
+    } else if (block->next != NULL) {
+      block = block->next;
+    } else {
+      block->next = AllocateMemoryArenaBlock(arena, size);
+      block = block->next;
+    }
+  }
+
+  arena->currentBlock = block;
+  void *result = GetMemoryArenaBlockBase(block) + block->used;
+  block->used += size;
+  arena->bytesUsed += size;
+  arena->allocationCount++;
+  if (arena->bytesUsed > arena->highWaterMark)
+    arena->highWaterMark = arena->bytesUsed;
+  return result;
+}
+
+static inline
+void *PushSizeZero(MemoryArena *arena, size_t size) {
+  void *result = PushSize(arena, size);
+  memset(result, 0, size);
+  return result;
+}
+
+#define PushStruct(arena, type) (type *)PushSizeZero(arena, sizeof(type))
+#define PushArray(arena, type, count) (type *)PushSizeZero(arena, sizeof(type) * (count))
+
+static inline
+const char *PushCString(MemoryArena *arena, const char *str) {
+  if (str == NULL) return NULL;
+  size_t length = strlen(str);
+  char *result = (char *)PushSize(arena, length + 1);
+  memcpy(result, str, length);
+  result[length] = 0;
+  return result;
+}
+
+static void
+ResetMemoryArena(MemoryArena *arena)
+{
+  for (MemoryArenaBlock *block = arena->firstBlock; block != NULL; block = block->next)
+    block->used = 0;
+  arena->currentBlock = arena->firstBlock;
+  arena->bytesUsed = 0;
+  arena->resetCount++;
+}
+
+static void
+FreeMemoryArena(MemoryArena *arena)
+{
+  MemoryArenaBlock *block = arena->firstBlock;
+  while (block != NULL) {
+    MemoryArenaBlock *next = block->next;
+    free(block);
+    block = next;
+  }
+  InitMemoryArena(arena, arena->name, arena->minimumBlockSize);
+}
+
+static inline
+void InitMemoryPool(MemoryPool *pool, MemoryArena *arena, size_t blockSize) {
+  memset(pool, 0, sizeof(MemoryPool));
+  pool->arena = arena;
+  pool->blockSize = AlignSize(blockSize < sizeof(void *) ? sizeof(void *) : blockSize,
+    MEMORY_ARENA_ALIGNMENT);
+}
+
+static void *
+PoolAllocate(MemoryPool *pool)
+{
+  void *result = pool->freeList;
+  if (result != NULL) {
+    pool->freeList = *(void **)result;
+  } else {
+    result = PushSize(pool->arena, pool->blockSize);
+    pool->blocksReserved++;
+  }
+  memset(result, 0, pool->blockSize);
+  pool->blocksInUse++;
+  return result;
+}
+
+static void
+PoolFree(MemoryPool *pool, void *ptr)
+{
+  if (ptr == NULL) return;
+  assert(pool->blocksInUse > 0);
+  *(void **)ptr = pool->freeList;
+  pool->freeList = ptr;
+  pool->blocksInUse--;
+}
+
+static inline
+void BeginMemoryFrame() {
+  MemoryStats& stats = _memoryStats;
+  stats.backingAllocationsLastFrame =
+    stats.backingAllocationCount - stats.backingAllocationCountAtFrameBegin;
+  stats.backingAllocationCountAtFrameBegin = stats.backingAllocationCount;
+}
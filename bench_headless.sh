@@ -0,0 +1,33 @@
+#!/bin/sh
+#Runs 10k step commands through the headless interface and reports throughput.
+#Expects the debugger to have been built to ./a.out with build.sh, run it
+#with: sh bench_headless.sh [step count]
+STEP_COUNT=${1:-10000}
+WORK_DIR=$(mktemp -d)
+
+cat > $WORK_DIR/loop.c <<'LOOP'
+#include <stdio.h>
+int main() {
+  volatile long sum = 0;
+  for (long i = 0; i < 100000000; i++) {
+    sum += i;
+  }
+  printf("%ld\n", sum);
+  return 0;
+}
+LOOP
+clang -O0 -g $WORK_DIR/loop.c -o $WORK_DIR/loop || exit 1
+
+echo "break main" > $WORK_DIR/steps.txt
+echo "run" >> $WORK_DIR/steps.txt
+i=0
+while [ $i -lt $STEP_COUNT ]; do
+  echo "next"
+  i=$((i + 1))
+done >> $WORK_DIR/steps.txt
+echo "quit" >> $WORK_DIR/steps.txt
+
+./a.out -x$WORK_DIR/steps.txt $WORK_DIR/loop 2>/dev/null > $WORK_DIR/results.txt
+grep -c '"command":"next","ok":true' $WORK_DIR/results.txt | sed 's/^/successful steps: /'
+grep '"event":"summary"' $WORK_DIR/results.txt
+rm -rf $WORK_DIR
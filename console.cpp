@@ -0,0 +1,239 @@
+//NOTE(Torin) Console output lives in a fixed size ring of bytes alongside a
+//ring of line records so the inferior can print forever and only the newest
+//output is kept. Lines are addressed by an absolute line number that only
+//ever grows; a line number is valid while it is in [firstLine, endLine).
+//Each entry type also keeps a ring of the line numbers of its own lines so a
+//filtered view can jump straight to any row instead of scanning for matches.
+
+#define CONSOLE_DEFAULT_BYTE_CAPACITY (16 * 1024 * 1024)
+#define CONSOLE_MIN_BYTE_CAPACITY (64 * 1024)
+#define CONSOLE_BYTES_PER_LINE 16
+#define CONSOLE_MAX_LINE_LENGTH 4096
+
+enum ConsoleEntryType {
+  ConsoleEntryType_APPLICATION,
+  ConsoleEntryType_DEBUGGER,
+  ConsoleEntryType_Count,
+};
+
+#define CONSOLE_FILTER_ALL ((1 << ConsoleEntryType_Count) - 1)
+
+struct ConsoleLine {
+  uint64_t offset;
+  uint32_t length;
+  uint32_t type;
+};
+
+struct ConsoleTypeIndex {
+  uint64_t *lineNumbers;
+  uint64_t first;
+  uint64_t end;
+};
+
+struct Console {
+  char *bytes;
+  uint64_t byteMask;
+  uint64_t writeOffset;
+
+  ConsoleLine *lines;
+  uint64_t lineMask;
+  uint64_t firstLine;
+  uint64_t endLine;
+  bool isLastLineOpen;
+
+  ConsoleTypeIndex typeIndices[ConsoleEntryType_Count];
+  uint32_t filterMask;
+  uint64_t scrollOffset;
+
+  uint64_t linesDropped;
+  float drawMicroseconds;
+};
+
+static inline
+uint64_t RoundUpToPowerOfTwo(uint64_t value) {
+  uint64_t result = 1;
+  while (result < value) result <<= 1;
+  return result;
+}
+
+static void
+InitConsole(Console *console, size_t byteCapacity, MemoryArena *arena)
+{
+  memset(console, 0, sizeof(Console));
+  if (byteCapacity < CONSOLE_MIN_BYTE_CAPACITY)
+    byteCapacity = CONSOLE_MIN_BYTE_CAPACITY;
+  uint64_t byteCount = RoundUpToPowerOfTwo(byteCapacity);
+  uint64_t lineCount = byteCount / CONSOLE_BYTES_PER_LINE;
+  console->bytes = (char *)PushSize(arena, byteCount);
+  console->byteMask = byteCount - 1;
+  console->lines = (ConsoleLine *)PushSize(arena, sizeof(ConsoleLine) * lineCount);
+  console->lineMask = lineCount - 1;
+  for (uint32_t i = 0; i < ConsoleEntryType_Count; i++) {
+    console->typeIndices[i].lineNumbers =
+      (uint64_t *)PushSize(arena, sizeof(uint64_t) * lineCount);
+  }
+  console->filterMask = CONSOLE_FILTER_ALL;
+}
+
+static inline
+void DropOldestConsoleLine(Console *console) {
+  assert(console->firstLine < console->endLine);
+  const ConsoleLine& line = console->lines[console->firstLine & console->lineMask];
+  //NOTE(Torin) Lines are dropped in order so the oldest line of its type is this one
+  ConsoleTypeIndex& index = console->typeIndices[line.type];
+  assert(index.lineNumbers[index.first & console->lineMask] == console->firstLine);
+  index.first++;
+  console->firstLine++;
+  console->linesDropped++;
+  if (console->firstLine == console->endLine)
+    console->isLastLineOpen = false;
+}
+
+static inline
+bool IsConsoleTypeVisible(const Console *console, uint32_t type) {
+  bool result = (console->filterMask & (1 << type)) != 0;
+  return result;
+}
+
+static ConsoleLine *
+PushConsoleLine(Console *console, uint32_t type)
+{
+  if (console->endLine - console->firstLine > console->lineMask)
+    DropOldestConsoleLine(console);
+
+  uint64_t lineNumber = console->endLine++;
+  ConsoleLine *line = &console->lines[lineNumber & console->lineMask];
+  line->offset = console->writeOffset;
+  line->length = 0;
+  line->type = type;
+
+  ConsoleTypeIndex& index = console->typeIndices[type];
+  index.lineNumbers[index.end++ & console->lineMask] = lineNumber;
+
+  //NOTE(Torin) Keep the rows on screen still while scrolled back
+  if (console->scrollOffset > 0 && IsConsoleTypeVisible(console, type))
+    console->scrollOffset++;
+  console->isLastLineOpen = true;
+  return line;
+}
+
+static void
+WriteConsoleBytes(Console *console, const char *text, size_t length)
+{
+  uint64_t capacity = console->byteMask + 1;
+  assert(length <= capacity);
+  size_t begin = (size_t)(console->writeOffset & console->byteMask);
+  size_t firstLength = length;
+  if (firstLength > capacity - begin) firstLength = capacity - begin;
+  memcpy(console->bytes + begin, text, firstLength);
+  memcpy(console->bytes, text + firstLength, length - firstLength);
+  console->writeOffset += length;
+
+  //NOTE(Torin) Any line that starts in the bytes just overwritten is gone
+  while (console->firstLine < console->endLine) {
+    const ConsoleLine& oldest = console->lines[console->firstLine & console->lineMask];
+    if (oldest.offset + capacity >= console->writeOffset) break;
+    DropOldestConsoleLine(console);
+  }
+}
+
+//NOTE(Torin) Text does not have to end in a newline, output that arrives in
+//pieces keeps extending the last line until its newline shows up. Lines
+//longer than CONSOLE_MAX_LINE_LENGTH are wrapped so a line can never be
+//overwritten while it is still being written.
+static void
+AppendConsoleText(Console *console, uint32_t type, const char *text, size_t length)
+{
+  if (console->bytes == NULL) return;
+  while (length > 0) {
+    ConsoleLine *line = NULL;
+    if (console->isLastLineOpen) {
+      line = &console->lines[(console->endLine - 1) & console->lineMask];
+      if (line->type != type || line->length >= CONSOLE_MAX_LINE_LENGTH)
+        line = NULL;
+    }
+    if (line == NULL) line = PushConsoleLine(console, type);
+
+    const char *newline = (const char *)memchr(text, '\n', length);
+    size_t chunkLength = newline ? (size_t)(newline - text) : length;
+    size_t consumedLength = newline ? chunkLength + 1 : chunkLength;
+    if (chunkLength > CONSOLE_MAX_LINE_LENGTH - line->length) {
+      chunkLength = CONSOLE_MAX_LINE_LENGTH - line->length;
+      consumedLength = chunkLength;
+      newline = NULL;
+    }
+
+    size_t writeLength = chunkLength;
+    if (newline && writeLength > 0 && text[writeLength - 1] == '\r') writeLength--;
+    WriteConsoleBytes(console, text, writeLength);
+    line->length += (uint32_t)writeLength;
+    if (newline) console->isLastLineOpen = false;
+    text += consumedLength;
+    length -= consumedLength;
+  }
+}
+
+//NOTE(Torin) There are only two entry types so a filter is either everything,
+//a single type, or nothing and every case is a direct index
+static uint64_t
+GetConsoleRowCount(const Console *console)
+{
+  if (console->filterMask == CONSOLE_FILTER_ALL)
+    return console->endLine - console->firstLine;
+  for (uint32_t i = 0; i < ConsoleEntryType_Count; i++) {
+    if (console->filterMask == (1U << i))
+      return console->typeIndices[i].end - console->typeIndices[i].first;
+  }
+  return 0;
+}
+
+static const ConsoleLine *
+GetConsoleRow(const Console *console, uint64_t rowIndex)
+{
+  uint64_t lineNumber = console->firstLine + rowIndex;
+  if (console->filterMask != CONSOLE_FILTER_ALL) {
+    for (uint32_t i = 0; i < ConsoleEntryType_Count; i++) {
+      if (console->filterMask != (1U << i)) continue;
+      const ConsoleTypeIndex& index = console->typeIndices[i];
+      lineNumber = index.lineNumbers[(index.first + rowIndex) & console->lineMask];
+    }
+  }
+  assert(lineNumber >= console->firstLine && lineNumber < console->endLine);
+  const ConsoleLine *result = &console->lines[lineNumber & console->lineMask];
+  return result;
+}
+
+//NOTE(Torin) Copies the start of a line out of the ring, control characters
+//become spaces since the glyph atlas only has printable ascii
+static size_t
+CopyConsoleLine(const Console *console, const ConsoleLine *line, char *dest, size_t destSize)
+{
+  size_t length = line->length < destSize ? line->length : destSize;
+  for (size_t i = 0; i < length; i++) {
+    char c = console->bytes[(line->offset + i) & console->byteMask];
+    dest[i] = ((uint8_t)c < ' ') ? ' ' : c;
+  }
+  return length;
+}
+
+static inline
+void ScrollConsole(Console *console, int32_t rowDelta, uint32_t visibleRowCount) {
+  uint64_t rowCount = GetConsoleRowCount(console);
+  uint64_t maxOffset = rowCount > visibleRowCount ? rowCount - visibleRowCount : 0;
+  int64_t offset = (int64_t)console->scrollOffset - rowDelta;
+  if (offset < 0) offset = 0;
+  if ((uint64_t)offset > maxOffset) offset = (int64_t)maxOffset;
+  console->scrollOffset = (uint64_t)offset;
+}
+
+static inline
+void CycleConsoleFilter(Console *console) {
+  if (console->filterMask == CONSOLE_FILTER_ALL) {
+    console->filterMask = 1 << ConsoleEntryType_APPLICATION;
+  } else if (console->filterMask == (1 << ConsoleEntryType_APPLICATION)) {
+    console->filterMask = 1 << ConsoleEntryType_DEBUGGER;
+  } else {
+    console->filterMask = CONSOLE_FILTER_ALL;
+  }
+  console->scrollOffset = 0;
+}
@@ -9,14 +9,19 @@ struct TextDrawState {
 };
 
 
-//TODO(Torin) Make a new TextBuffer struct to seperated out the 
-//line information from the rest of the guicontext
+static inline
+uint32_t GetActiveSourceLineCount(GUIContext *context) {
+  uint32_t result = 0;
+  if (context->activeSource != NULL)
+    result = context->activeSource->buffer.lineCount;
+  return result;
+}
 
 static inline
 uint32_t GetRequiredLineNumberRectWidth(GUIContext *context) {
   uint32_t currentNumber = 1;
   uint32_t digitCount = 0;
-  while ((currentNumber - 1) < context->line_count) {
+  while ((currentNumber - 1) < GetActiveSourceLineCount(context)) {
     currentNumber *= 10;
     digitCount += 1;
   }
@@ -55,33 +60,53 @@ void gui_highlight_line(GUIContext* context, uint32_t lineNumber, RGBA8 color) {
     line_height
   };
 
+  FlushTextBatch(&context->textBatch);
   SDL_SetRenderDrawColor(context->renderer, color.r, color.g, color.b, color.a);
   SDL_RenderFillRect(context->renderer, &highlight_rect);
 }
 
 
 
+//NOTE(Torin) Returns NULL if the atlas for the font could not be built. A
+//font that failed is not retried every frame, callers skip text drawn in it
+static const GlyphAtlas *
+GetGlyphAtlas(GUIContext *ctx, TTF_Font *font)
+{
+  for (uint32_t i = 0; i < ctx->glyphAtlasCount; i++) {
+    if (ctx->glyphAtlases[i].font == font)
+      return &ctx->glyphAtlases[i];
+  }
+  if (font == NULL || font == ctx->failedGlyphAtlasFont) return NULL;
+
+  assert(ctx->glyphAtlasCount < ARRAYCOUNT(ctx->glyphAtlases));
+  GlyphAtlas *atlas = &ctx->glyphAtlases[ctx->glyphAtlasCount];
+  if (!InitGlyphAtlas(atlas, ctx->renderer, font)) {
+    log_error("failed to build a glyph atlas, text in this font will not be drawn");
+    ctx->failedGlyphAtlasFont = font;
+    return NULL;
+  }
+  ctx->glyphAtlasCount++;
+  return atlas;
+}
+
+static inline
+int DrawTextRun(GUIContext *ctx, TTF_Font *font, const char *text, size_t length, 
+int x, int y, const RGBA8& color)
+{
+  const GlyphAtlas *atlas = GetGlyphAtlas(ctx, font);
+  if (atlas == NULL) return 0;
+  int result = PushTextToBatch(&ctx->textBatch, atlas, text, length, x, y, color);
+  return result;
+}
+
 void DrawCStrText(GUIContext *ctx, const char *text, const Panel& panel, 
 const PanelStyle& style, const RGBA8& color, TextDrawState *state) 
 {
   assert(text != NULL);
-  SDL_Color textColor = RGBA8ToSDLColor(color); 
-  SDL_Color backgroundColor = RGBA8ToSDLColor(style.color_background);
-
-  SDL_Surface *textSurface = TTF_RenderText_Blended(style.font, text, textColor);
-  SDL_Texture *textTexture = SDL_CreateTextureFromSurface(ctx->renderer, textSurface);
-
-  SDL_Rect textRect = {
+  int width = DrawTextRun(ctx, style.font, text, strlen(text),
     (int)(panel.x + style.pad_left + state->currentXOffset),
-    (int)(panel.y + style.pad_top + state->currentYOffset),
-    textSurface->w,
-    textSurface->h,
-  };
-
-  SDL_RenderCopy(ctx->renderer, textTexture, NULL, &textRect);
-  SDL_DestroyTexture(textTexture);
-  SDL_FreeSurface(textSurface);
-  state->currentXOffset += textSurface->w;
+    (int)(panel.y + style.pad_top + state->currentYOffset), color);
+  state->currentXOffset += width;
 }
 
 inline void 
@@ -122,6 +147,8 @@ void gui_draw_panel(GUIContext* context, Panel *panel, const PanelStyle& style)
   };
 #endif
 
+  //NOTE(Torin) Text queued so far belongs underneath this panel
+  FlushTextBatch(&context->textBatch);
 
   SDL_SetRenderDrawColor(context->renderer,
    style.color_border.r,
@@ -162,30 +189,58 @@ void gui_draw_panel(GUIContext* context, Panel *panel, const PanelStyle& style)
 }
 
 static void 
-DrawExpression(GUIContext *ctx, Expression* expr, 
+DrawExpression(GUIContext *ctx, const Expression* expr, const ExpressionList *list,
 const Panel& panel, const PanelStyle& panelStyle, 
-const SyntaxStyle& syntaxStyle, TextDrawState *drawState)
+const SyntaxStyle& syntaxStyle, TextDrawState *drawState, uint32_t *rowIndex)
 {
-  for (uint32_t i = 0; i < expr->depth; i++) {
-    DrawCStrText(ctx, "  ", panel, panelStyle, syntaxStyle.identColor, drawState);
+  uint32_t windowEnd = list->topRow + list->visibleRowCount;
+  if (*rowIndex >= windowEnd) return;
+  uint32_t rowCount = GetExpressionRowCount(expr, list);
+  if (rowCount == 0) return;
+  if (*rowIndex + rowCount <= list->topRow) {
+    *rowIndex += rowCount;
+    return;
   }
 
-  DrawCStrText(ctx, expr->type, panel, panelStyle, syntaxStyle.typeColor, drawState);
-  DrawCStrText(ctx," ", panel, panelStyle, syntaxStyle.identColor, drawState);
-  DrawCStrText(ctx, expr->name, panel, panelStyle, syntaxStyle.identColor, drawState);
+  if (*rowIndex >= list->topRow) {
+    for (uint32_t i = 0; i < expr->depth; i++) {
+      DrawCStrText(ctx, "  ", panel, panelStyle, syntaxStyle.identColor, drawState);
+    }
 
-  if (expr->childCount > 0) {
+    DrawCStrText(ctx, expr->type, panel, panelStyle, syntaxStyle.typeColor, drawState);
+    DrawCStrText(ctx," ", panel, panelStyle, syntaxStyle.identColor, drawState);
+    DrawCStrText(ctx, expr->name, panel, panelStyle, syntaxStyle.identColor, drawState);
+    if (expr->childCount == 0) {
+      const RGBA8& valueColor = HasExpressionValueChanged(expr, list) ?
+        syntaxStyle.changedValueColor : syntaxStyle.valueColor;
+      DrawCStrText(ctx, " ", panel, panelStyle, syntaxStyle.identColor, drawState);
+      DrawCStrText(ctx, expr->value, panel, panelStyle, valueColor, drawState);
+    }
     NextRow(drawState, panelStyle);
-    if (expr->isExpanded) {
-      for (uint32_t i = 0; i < expr->childCount; i++) {
-        Expression* child = &expr->children[i];
-        DrawExpression(ctx, child, panel, panelStyle, syntaxStyle, drawState);
+  }
+  *rowIndex += 1;
+
+  if (expr->isExpanded) {
+    for (uint32_t i = 0; i < expr->materializedChildCount; i++) {
+      const Expression* child = &expr->children[i];
+      DrawExpression(ctx, child, list, panel, panelStyle, syntaxStyle, drawState, rowIndex);
+    }
+
+    if (IsExpressionPaged(expr)) {
+      if (*rowIndex >= list->topRow && *rowIndex < windowEnd) {
+        for (uint32_t i = 0; i <= expr->depth; i++) {
+          DrawCStrText(ctx, "  ", panel, panelStyle, syntaxStyle.identColor, drawState);
+        }
+        uint32_t firstIndex = expr->pageIndex * EXPRESSION_PAGE_SIZE;
+        char pageText[128];
+        snprintf(pageText, sizeof(pageText), "[%u-%u of %u] page %u/%u",
+          firstIndex, firstIndex + expr->materializedChildCount - 1, expr->childCount,
+          expr->pageIndex + 1, GetExpressionPageCount(expr));
+        DrawCStrText(ctx, pageText, panel, panelStyle, syntaxStyle.valueColor, drawState);
+        NextRow(drawState, panelStyle);
       }
+      *rowIndex += 1;
     }
-  } else {
-    DrawCStrText(ctx, " ", panel, panelStyle, syntaxStyle.identColor, drawState);
-    DrawCStrText(ctx, expr->value, panel, panelStyle, syntaxStyle.valueColor, drawState);
-    NextRow(drawState, panelStyle);
   }
 }
 
@@ -194,10 +249,108 @@ void DrawExpressionList(GUIContext* ctx, ExpressionList *list, const Panel& pane
 const PanelStyle& panelStyle, const SyntaxStyle& syntaxStyle)
 {
   TextDrawState drawState = {};
+  uint32_t rowIndex = 0;
   for (uint32_t i = 0; i < list->count; i++) {
     Expression *expr = list->expressions[i];
-    DrawExpression(ctx, expr, panel, panelStyle, syntaxStyle, &drawState);
+    DrawExpression(ctx, expr, list, panel, panelStyle, syntaxStyle, &drawState, &rowIndex);
   }
 }
 
+static inline
+void AppendDebugOverlayArenaLine(char *dest, size_t destSize, const MemoryArena& arena) {
+  snprintf(dest, destSize, "%-8s %8zu KB used %8zu KB reserved %3u blocks %8zu KB peak %10lu allocs",
+    arena.name, arena.bytesUsed / 1024, arena.bytesReserved / 1024, arena.blockCount,
+    arena.highWaterMark / 1024, (unsigned long)arena.allocationCount);
+}
 
+//NOTE(Torin) Toggled with F1, used to verify that the arenas have reached
+//a steady state and nothing is calling malloc every frame
+static void
+DrawDebugOverlay(GUIContext *context)
+{
+  const MemoryArena* arenas[5];
+  uint32_t arenaCount = 0;
+  arenas[arenaCount++] = &context->sessionArena;
+  if (context->activeSource != NULL)
+    arenas[arenaCount++] = &context->activeSource->arena;
+  arenas[arenaCount++] = &context->stopArena;
+  arenas[arenaCount++] = &context->hoverArena;
+  arenas[arenaCount++] = &context->frameArena;
+
+  static const uint32_t LINE_CAPACITY = 160;
+  static const uint32_t MAX_LINE_COUNT = 16;
+  char *lines = PushArray(&context->frameArena, char, LINE_CAPACITY * MAX_LINE_COUNT);
+  uint32_t lineCount = 0;
+
+  snprintf(&lines[LINE_CAPACITY * lineCount++], LINE_CAPACITY, 
+    "frame: %.2f ms cpu, %u glyph quads in %u batches",
+    context->frameMilliseconds, context->textBatch.quadsLastFrame, 
+    context->textBatch.flushesLastFrame);
+  snprintf(&lines[LINE_CAPACITY * lineCount++], LINE_CAPACITY, 
+    "damage: %u panels redrawn, %lu frames presented, %lu idle frames skipped",
+    context->panelsRedrawnLastFrame, (unsigned long)context->framesPresented,
+    (unsigned long)context->framesSkipped);
+  const SourceCache& cache = context->sourceCache;
+  uint64_t lookupCount = cache.hitCount + cache.missCount;
+  snprintf(&lines[LINE_CAPACITY * lineCount++], LINE_CAPACITY, 
+    "source cache: %u/%u files, %.1f%% hits (%lu hits, %lu misses, %lu reloads, %lu evictions)",
+    cache.fileCount, SOURCE_CACHE_CAPACITY, 
+    lookupCount ? (100.0 * cache.hitCount / lookupCount) : 0.0,
+    (unsigned long)cache.hitCount, (unsigned long)cache.missCount,
+    (unsigned long)cache.reloadCount, (unsigned long)cache.evictionCount);
+  if (context->activeSource != NULL) {
+    const SourceFile& source = *context->activeSource;
+    snprintf(&lines[LINE_CAPACITY * lineCount++], LINE_CAPACITY, 
+      "source: %u lines, %lu bytes %s, indexed in %.2f ms",
+      source.buffer.lineCount, source.buffer.size,
+      source.buffer.isMapped ? "mapped" : "read", 
+      source.buffer.indexMilliseconds);
+    const SyntaxCache& syntax = source.syntaxCache;
+    snprintf(&lines[LINE_CAPACITY * lineCount++], LINE_CAPACITY, 
+      "syntax: %u/%u line states known, %lu lines lexed at %.0f lines/sec",
+      syntax.knownStateCount, syntax.lineCount, (unsigned long)syntax.linesLexed,
+      syntax.secondsLexing > 0.0 ? syntax.linesLexed / syntax.secondsLexing : 0.0);
+    snprintf(&lines[LINE_CAPACITY * lineCount++], LINE_CAPACITY, 
+      "hover hit-test: %.2f us, %u/%u line advances cached",
+      context->hoverMicroseconds, source.lineAdvanceCache.linesBuilt,
+      source.lineAdvanceCache.lineCount);
+  }
+  const Console& console = GetConsole();
+  snprintf(&lines[LINE_CAPACITY * lineCount++], LINE_CAPACITY, 
+    "console: %lu lines (%lu dropped), %.1f/%.1f MB ring, drawn in %.1f us",
+    (unsigned long)(console.endLine - console.firstLine), (unsigned long)console.linesDropped,
+    (console.writeOffset < console.byteMask + 1 ? console.writeOffset : console.byteMask + 1) / 
+      (1024.0 * 1024.0), (console.byteMask + 1) / (1024.0 * 1024.0), console.drawMicroseconds);
+  snprintf(&lines[LINE_CAPACITY * lineCount++], LINE_CAPACITY, 
+    "process output: %.2f MB/s, %.1f MB total",
+    context->processOutputMegabytesPerSecond, context->processOutputBytes / (1024.0 * 1024.0));
+  snprintf(&lines[LINE_CAPACITY * lineCount++], LINE_CAPACITY, 
+    "arena block mallocs last frame: %lu (total %lu)",
+    (unsigned long)_memoryStats.backingAllocationsLastFrame,
+    (unsigned long)_memoryStats.backingAllocationCount);
+  for (uint32_t i = 0; i < arenaCount; i++) {
+    AppendDebugOverlayArenaLine(&lines[LINE_CAPACITY * lineCount++], LINE_CAPACITY, *arenas[i]);
+  }
+
+  const ExpressionList& list = context->expressionList;
+  snprintf(&lines[LINE_CAPACITY * lineCount++], LINE_CAPACITY, 
+    "watch pages: %u in use, %u reserved; roots: %u in use, %u reserved",
+    list.pagePool.blocksInUse, list.pagePool.blocksReserved,
+    list.rootPool.blocksInUse, list.rootPool.blocksReserved);
+
+  const PanelStyle& style = context->mouseOverPanelStyle;
+  uint32_t lineHeight = context->line_spacing + context->font_size;
+  Panel panel = {};
+  panel.w = context->screen_width / 2;
+  panel.h = (lineCount * lineHeight) + style.pad_top + style.pad_bottom + (style.border_size * 2);
+  panel.x = context->screen_width - panel.w;
+  panel.y = 0;
+  gui_draw_panel(context, &panel, style);
+
+  TextDrawState drawState = {};
+  for (uint32_t i = 0; i < lineCount; i++) {
+    DrawCStrText(context, &lines[LINE_CAPACITY * i], panel, style, &drawState);
+    drawState.currentYOffset += lineHeight;
+    drawState.currentXOffset = 0;
+  }
+}
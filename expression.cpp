@@ -1,122 +1,465 @@
-static void 
-UpdateRootExpression(Expression* expr, DebugContext* debug, bool forceUpdate = false) 
-{
-  lldb::SBExpressionOptions options; 
-  options.SetFetchDynamicValue(lldb::eNoDynamicValues);
-  options.SetUnwindOnError(true);
-  assert(expr->depth == 0 && expr->name != NULL);
-  const char *expressionString = expr->name;
+struct ExpressionRow {
+  Expression *expr;
+  uint32_t rootIndex;
+  bool isPageControl;
+};
 
-  static void 
-  (*UpdateSubWatchExpression)(Expression* expr, lldb::SBValue& value) = 
-  [](Expression* expr, lldb::SBValue& value)
-  {
-    expr->name = value.GetName();
+struct ExpressionRowWindow {
+  uint32_t begin;
+  uint32_t end;
+  bool isUnbounded;
+};
+
+static inline
+bool IsRowRangeInWindow(uint32_t rowIndex, uint32_t rowCount, const ExpressionRowWindow& window) {
+  if (window.isUnbounded) return true;
+  bool result = rowIndex < window.end && rowIndex + rowCount > window.begin;
+  return result;
+}
 
-    if (value.GetType().IsArrayType()) {
-      lldb::SBType arrayType = value.GetType().GetArrayElementType();
-      if (strcmp(arrayType.GetName(), "const char *") == 0 ||
-            strcmp(arrayType.GetName(), "char *") == 0 ) {
-        value.SetFormat(lldb::eFormatCharArray);
-      }
+static uint32_t
+GetExpressionEffectiveChildCount(lldb::SBValue value) {
+  uint32_t result = 0;
+  if (value.GetType().IsArrayType()) {
+    lldb::SBType arrayType = value.GetType().GetArrayElementType();
+    if (strcmp(arrayType.GetName(), "const char *") == 0 ||
+          strcmp(arrayType.GetName(), "char *") == 0 ) {
+      return result;
     }
+  }
 
-    expr->type = value.GetTypeName();
-    expr->value = value.GetValue();
-
-    if (expr->name == NULL)
-      expr->name = "INVALID NAME";
-    if (expr->type == NULL)
-      expr->type = "INVALID TYPE";
-    if (expr->value == NULL)
-      expr->value = "INVALID VALUE";
-
-    for (uint32_t i = 0; i < expr->childCount; i++) {
-      Expression *childExpr = &expr->children[i];
-      lldb::SBValue childValue = value.GetChildAtIndex(i);
-      UpdateSubWatchExpression(childExpr, childValue);
-      childValue.Clear();
+  result = value.GetNumChildren();
+  return result;
+}
+
+static inline
+bool IsExpressionPaged(const Expression *expr) {
+  bool result = expr->childCount > EXPRESSION_PAGE_SIZE;
+  return result;
+}
+
+static inline
+uint32_t GetExpressionPageCount(const Expression *expr) {
+  uint32_t result = (expr->childCount + EXPRESSION_PAGE_SIZE - 1) / EXPRESSION_PAGE_SIZE;
+  return result;
+}
+
+//NOTE(Torin) Only allocates the nodes for the current page, the values
+//themselves are fetched by UpdateWatchExpressions once the rows become visible
+static void
+MaterializeExpressionChildren(Expression *expr, ExpressionList *list)
+{
+  assert(expr->children == NULL);
+  uint32_t firstChildIndex = expr->pageIndex * EXPRESSION_PAGE_SIZE;
+  assert(firstChildIndex < expr->childCount);
+  uint32_t count = min(expr->childCount - firstChildIndex, EXPRESSION_PAGE_SIZE);
+
+  expr->children = (Expression *)PoolAllocate(&list->pagePool);
+  expr->materializedChildCount = count;
+  for (uint32_t i = 0; i < count; i++) {
+    Expression *child = &expr->children[i];
+    child->depth = expr->depth + 1;
+    child->indexInParent = firstChildIndex + i;
+  }
+}
+
+static void
+ReleaseExpressionChildren(Expression *expr, ExpressionList *list)
+{
+  for (uint32_t i = 0; i < expr->materializedChildCount; i++) {
+    Expression *child = &expr->children[i];
+    ReleaseExpressionChildren(child, list);
+    PoolFree(&list->valuePool, child->valueStorage);
+  }
+  PoolFree(&list->pagePool, expr->children);
+  expr->children = NULL;
+  expr->materializedChildCount = 0;
+}
+
+static inline
+bool IsExpressionRowShown(const Expression *expr, const ExpressionList *list) {
+  if (!list->showChangedOnly || expr->depth == 0) return true;
+  bool result = expr->subtreeChangedStopID == list->currentStopID;
+  return result;
+}
+
+static inline
+bool HasExpressionValueChanged(const Expression *expr, const ExpressionList *list) {
+  bool result = expr->changedStopID == list->currentStopID;
+  return result;
+}
+
+static uint32_t
+GetExpressionRowCount(const Expression *expr, const ExpressionList *list)
+{
+  if (!IsExpressionRowShown(expr, list)) return 0;
+  uint32_t result = 1;
+  if (expr->isExpanded && expr->childCount > 0) {
+    for (uint32_t i = 0; i < expr->materializedChildCount; i++)
+      result += GetExpressionRowCount(&expr->children[i], list);
+    if (IsExpressionPaged(expr))
+      result += 1;
+  }
+  return result;
+}
+
+static inline
+uint32_t GetExpressionListRowCount(const ExpressionList *list) {
+  uint32_t result = 0;
+  for (uint32_t i = 0; i < list->count; i++)
+    result += GetExpressionRowCount(list->expressions[i], list);
+  return result;
+}
+
+static void
+SetExpressionExpanded(Expression *expr, bool isExpanded, ExpressionList *list)
+{
+  expr->isExpanded = isExpanded;
+  if (isExpanded && expr->children == NULL && expr->childCount > 0) {
+    MaterializeExpressionChildren(expr, list);
+  }
+}
+
+static void
+SetExpressionPage(Expression *expr, uint32_t pageIndex, ExpressionList *list)
+{
+  uint32_t pageCount = GetExpressionPageCount(expr);
+  if (pageCount == 0 || pageIndex >= pageCount) return;
+  ReleaseExpressionChildren(expr, list);
+  expr->pageIndex = pageIndex;
+  MaterializeExpressionChildren(expr, list);
+}
+
+//NOTE(Torin) Children from a synthetic provider (std::vector, std::string)
+//usually live on the heap, outside the bytes of the value itself
+static bool
+HasProviderChildren(lldb::SBValue& value)
+{
+  if (value.IsSynthetic()) return true;
+  lldb::SBValue syntheticValue = value.GetSyntheticValue();
+  bool result = syntheticValue.IsValid() && syntheticValue.IsSynthetic();
+  return result;
+}
+
+//NOTE(Torin) FNV-1a over the raw bytes of the value and its type name.  Aggregates
+//up to EXPRESSION_HASH_BYTE_LIMIT hash their whole object so an unchanged struct
+//also vouches for its members, bigger ones only hash their value string
+static uint64_t
+HashExpressionValue(lldb::SBValue& value)
+{
+  uint64_t result = 0xCBF29CE484222325;
+  auto HashBytes = [&result](const uint8_t *bytes, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      result ^= bytes[i];
+      result *= 0x100000001B3;
     }
   };
 
+  const char *typeName = value.GetTypeName();
+  if (typeName != NULL)
+    HashBytes((const uint8_t *)typeName, strlen(typeName));
+
+  size_t byteCount = value.GetByteSize();
+  lldb::SBData data;
+  if (byteCount > 0 && byteCount <= EXPRESSION_HASH_BYTE_LIMIT) {
+    data = value.GetData();
+    byteCount = data.GetByteSize();
+  } else {
+    byteCount = 0;
+  }
+  if (byteCount == 0) {
+    const char *valueString = value.GetValue();
+    if (valueString != NULL)
+      HashBytes((const uint8_t *)valueString, strlen(valueString));
+    return result;
+  }
+
+  uint8_t chunk[4096];
+  lldb::SBError error;
+  for (size_t offset = 0; offset < byteCount; offset += sizeof(chunk)) {
+    size_t bytesRead = data.ReadRawData(error, offset, chunk, 
+      min(byteCount - offset, sizeof(chunk)));
+    if (error.Fail()) break;
+    HashBytes(chunk, bytesRead);
+  }
+  return result;
+}
 
-  lldb::SBValue value = debug->target.EvaluateExpression(expr->name, options);
-  UpdateSubWatchExpression(expr, value);
-  expr->name = expressionString;
+static void
+UpdateExpressionChildCount(Expression *expr, lldb::SBValue& value, ExpressionList *list)
+{
+  uint32_t childCount = GetExpressionEffectiveChildCount(value);
+  if (childCount != expr->childCount) {
+    ReleaseExpressionChildren(expr, list);
+    expr->childCount = childCount;
+    if (expr->pageIndex >= GetExpressionPageCount(expr))
+      expr->pageIndex = 0;
+    SetExpressionExpanded(expr, expr->isExpanded, list);
+  }
 }
 
-static uint32_t 
-GetExpressionEffectiveChildCount(lldb::SBValue value) {
-  uint32_t result = 0;
+//NOTE(Torin) LLDB reuses the storage behind GetValue() once the process runs
+//again so the string is copied, long values are cut off with "..."
+static void
+SetExpressionValueString(Expression *expr, const char *valueString, ExpressionList *list)
+{
+  if (valueString == NULL) {
+    expr->value = "INVALID VALUE";
+    return;
+  }
+  if (expr->valueStorage == NULL)
+    expr->valueStorage = (char *)PoolAllocate(&list->valuePool);
+
+  size_t length = strlen(valueString);
+  if (length < EXPRESSION_VALUE_CAPACITY) {
+    memcpy(expr->valueStorage, valueString, length + 1);
+  } else {
+    size_t keptLength = EXPRESSION_VALUE_CAPACITY - 4;
+    memcpy(expr->valueStorage, valueString, keptLength);
+    memcpy(expr->valueStorage + keptLength, "...", 4);
+  }
+  expr->value = expr->valueStorage;
+}
+
+//NOTE(Torin) Returns true when the value is identical to the one seen at the
+//previous stop in which case the strings from the last fetch are kept
+static bool
+UpdateExpressionFromValue(Expression *expr, lldb::SBValue& value, ExpressionList *list)
+{
+  uint32_t stopID = list->currentStopID;
+  uint64_t valueHash = HashExpressionValue(value);
+  bool wasFetchedBefore = expr->lastUpdateStopID != 0;
+  expr->lastUpdateStopID = stopID;
+  expr->hasUnhashedChildren = HasProviderChildren(value) ||
+    value.GetByteSize() > EXPRESSION_HASH_BYTE_LIMIT;
+  if (wasFetchedBefore && expr->valueHash == valueHash) {
+    //NOTE(Torin) A provider can report a new size with the same hashed bytes
+    if (expr->hasUnhashedChildren)
+      UpdateExpressionChildCount(expr, value, list);
+    return true;
+  }
+  expr->valueHash = valueHash;
+
   if (value.GetType().IsArrayType()) {
     lldb::SBType arrayType = value.GetType().GetArrayElementType();
     if (strcmp(arrayType.GetName(), "const char *") == 0 ||
           strcmp(arrayType.GetName(), "char *") == 0 ) {
-      return result;
+      value.SetFormat(lldb::eFormatCharArray);
     }
-    return result;
   }
 
-  result = value.GetNumChildren();
+  //NOTE(Torin) The root keeps the string the user typed as its name
+  if (expr->depth > 0)
+    expr->name = value.GetName();
+  expr->type = value.GetTypeName();
+  SetExpressionValueString(expr, value.GetValue(), list);
+  expr->isPointer = value.GetType().IsPointerType() || value.GetType().IsReferenceType();
+
+  if (expr->name == NULL)
+    expr->name = "INVALID NAME";
+  if (expr->type == NULL)
+    expr->type = "INVALID TYPE";
+
+  UpdateExpressionChildCount(expr, value, list);
+
+  if (wasFetchedBefore) {
+    expr->changedStopID = stopID;
+    expr->subtreeChangedStopID = stopID;
+  }
+  return false;
+}
+
+//NOTE(Torin) True if every expanded descendant lives inside the hashed bytes of
+//expr itself, pointers and synthetic children are somewhere else in memory
+static bool
+IsExpressionSubtreeEmbedded(const Expression *expr)
+{
+  if (!expr->isExpanded) return true;
+  if (expr->isPointer || expr->hasUnhashedChildren) return false;
+  for (uint32_t i = 0; i < expr->materializedChildCount; i++) {
+    if (!IsExpressionSubtreeEmbedded(&expr->children[i]))
+      return false;
+  }
+  return true;
+}
+
+static void
+MarkExpressionSubtreeUnchanged(Expression *expr, uint32_t stopID, uint32_t *skippedCount)
+{
+  for (uint32_t i = 0; i < expr->materializedChildCount; i++) {
+    Expression *child = &expr->children[i];
+    if (child->lastUpdateStopID != 0) {
+      child->lastUpdateStopID = stopID;
+      *skippedCount += 1;
+    }
+    MarkExpressionSubtreeUnchanged(child, stopID, skippedCount);
+  }
+}
+
+//NOTE(Torin) Walks the rows of an expression in draw order and only descends
+//into children that intersect the row window
+static bool
+IsExpressionWindowStale(const Expression *expr, uint32_t rowIndex, 
+const ExpressionRowWindow& window, const ExpressionList *list)
+{
+  if (expr->lastUpdateStopID != list->currentStopID) return true;
+  if (!expr->isExpanded) return false;
+
+  uint32_t childRow = rowIndex + 1;
+  for (uint32_t i = 0; i < expr->materializedChildCount; i++) {
+    const Expression *child = &expr->children[i];
+    uint32_t childRowCount = GetExpressionRowCount(child, list);
+    if (IsRowRangeInWindow(childRow, childRowCount, window)) {
+      if (IsExpressionWindowStale(child, childRow, window, list))
+        return true;
+    }
+    childRow += childRowCount;
+  }
+  return false;
+}
+
+static void
+UpdateExpressionRows(Expression *expr, lldb::SBValue& value, uint32_t rowIndex,
+const ExpressionRowWindow& window, ExpressionList *list)
+{
+  if (expr->lastUpdateStopID != list->currentStopID) {
+    list->refreshFetchedCount++;
+    if (UpdateExpressionFromValue(expr, value, list) &&
+        IsExpressionSubtreeEmbedded(expr)) {
+      MarkExpressionSubtreeUnchanged(expr, list->currentStopID, &list->refreshSkippedCount);
+    }
+  }
+  if (!expr->isExpanded) return;
+
+  uint32_t childRow = rowIndex + 1;
+  for (uint32_t i = 0; i < expr->materializedChildCount; i++) {
+    Expression *child = &expr->children[i];
+    uint32_t childRowCount = GetExpressionRowCount(child, list);
+    if (IsRowRangeInWindow(childRow, childRowCount, window) &&
+        IsExpressionWindowStale(child, childRow, window, list)) {
+      lldb::SBValue childValue = value.GetChildAtIndex(child->indexInParent);
+      UpdateExpressionRows(child, childValue, childRow, window, list);
+    }
+    if (child->subtreeChangedStopID == list->currentStopID)
+      expr->subtreeChangedStopID = list->currentStopID;
+    childRow += childRowCount;
+  }
+}
+
+static lldb::SBValue
+EvaluateRootExpression(Expression *expr, DebugContext *debug)
+{
+  assert(expr->depth == 0 && expr->name != NULL);
+  lldb::SBExpressionOptions options;
+  options.SetFetchDynamicValue(lldb::eNoDynamicValues);
+  options.SetUnwindOnError(true);
+  lldb::SBValue result = debug->target.EvaluateExpression(expr->name, options);
   return result;
 }
 
-static void GetExpressionRecursiveEffectiveChildCount(
-uint32_t *result, lldb::SBValue& value) 
+//NOTE(Torin) Called every frame, only talks to the debugger when a row
+//inside the visible window has not been fetched since the last stop.
+//The changed only filter needs to know about every materialized row
+static void
+UpdateWatchExpressions(ExpressionList *list, DebugContext *debug)
+{
+  ExpressionRowWindow window = {};
+  window.begin = list->topRow;
+  window.end = list->topRow + list->visibleRowCount;
+  window.isUnbounded = list->showChangedOnly;
+
+  uint32_t rowIndex = 0;
+  for (uint32_t i = 0; i < list->count; i++) {
+    Expression *expr = list->expressions[i];
+    uint32_t rowCount = GetExpressionRowCount(expr, list);
+    if (IsRowRangeInWindow(rowIndex, rowCount, window) &&
+        IsExpressionWindowStale(expr, rowIndex, window, list)) {
+      lldb::SBValue value = EvaluateRootExpression(expr, debug);
+      UpdateExpressionRows(expr, value, rowIndex, window, list);
+    }
+    rowIndex += GetExpressionRowCount(expr, list);
+  }
+
+  if (list->reportedStopID != list->currentStopID) {
+    list->reportedStopID = list->currentStopID;
+    log_debug("watch-refresh: fetched %u values, skipped %u unchanged",
+      list->refreshFetchedCount, list->refreshSkippedCount);
+    list->refreshFetchedCount = 0;
+    list->refreshSkippedCount = 0;
+  }
+}
+
+static bool
+GetExpressionRowAtIndex(Expression *expr, const ExpressionList *list,
+uint32_t *currentRow, uint32_t requestedRow, ExpressionRow *row)
+{
+  uint32_t rowCount = GetExpressionRowCount(expr, list);
+  if (*currentRow + rowCount <= requestedRow) {
+    *currentRow += rowCount;
+    return false;
+  }
+
+  if (*currentRow == requestedRow) {
+    row->expr = expr;
+    row->isPageControl = false;
+    return true;
+  }
+
+  *currentRow += 1;
+  for (uint32_t i = 0; i < expr->materializedChildCount; i++) {
+    if (GetExpressionRowAtIndex(&expr->children[i], list, currentRow, requestedRow, row))
+      return true;
+  }
+
+  assert(IsExpressionPaged(expr) && *currentRow == requestedRow);
+  row->expr = expr;
+  row->isPageControl = true;
+  return true;
+}
+
+static bool
+GetExpressionRowAtIndex(ExpressionList *list, uint32_t requestedRow, ExpressionRow *row)
 {
-  for (uint32_t i = 0; i < value.GetNumChildren(); i++) {
-    *result += GetExpressionEffectiveChildCount(value.GetChildAtIndex(i));
+  uint32_t currentRow = 0;
+  for (uint32_t i = 0; i < list->count; i++) {
+    if (GetExpressionRowAtIndex(list->expressions[i], list, &currentRow, requestedRow, row)) {
+      row->rootIndex = i;
+      return true;
+    }
   }
+  return false;
 }
 
 static void
-RecursivelyInitChildExpressions(Expression *expr, lldb::SBValue value, 
-uint32_t currentIndex, uint32_t depth, Expression* rootExpression) 
-{
-  expr->childCount = GetExpressionEffectiveChildCount(value);
-  expr->depth = depth;
-  expr->isExpanded = true;
-  
-  uint32_t childFillIndex = currentIndex + 1;
-  uint32_t subChildrenHandled = 0;
-  for (uint32_t i = 0; i < expr->childCount; i++) {
-    lldb::SBValue childValue = value.GetChildAtIndex(i); 
-    Expression& childExpr = expr->children[i];
-    childFillIndex = childFillIndex + expr->childCount;
-    subChildrenHandled += childValue.GetNumChildren();
-    childExpr.children = rootExpression + childFillIndex;
-    RecursivelyInitChildExpressions(&childExpr, childValue, 
-      currentIndex + 1, depth + 1, rootExpression);
-  }
-}
-
-static void 
-CreateWatchExpression(ExpressionList *exprList, 
-DebugContext* debug, const char *exprString) 
+ScrollExpressionList(ExpressionList *list, int32_t rowsToScroll)
+{
+  int32_t rowCount = (int32_t)GetExpressionListRowCount(list);
+  int32_t topRow = (int32_t)list->topRow + rowsToScroll;
+  if (topRow > rowCount - 1) topRow = rowCount - 1;
+  if (topRow < 0) topRow = 0;
+  list->topRow = (uint32_t)topRow;
+}
+
+static void
+CreateWatchExpression(ExpressionList *exprList,
+DebugContext* debug, const char *exprString)
 {
   assert(exprString != NULL && strlen(exprString) > 0);
   assert(exprList->count + 1 < ARRAYCOUNT(exprList->expressions));
 
-  lldb::SBValue rootValue = debug->target.EvaluateExpression(exprString);
-  uint32_t totalChildCount = rootValue.GetNumChildren();
-  GetExpressionRecursiveEffectiveChildCount(&totalChildCount, rootValue);
-
-  size_t totalExpressionMemorySize = (totalChildCount + 1) * sizeof(Expression);
   size_t expressionStringLength = strlen(exprString);
-  size_t requiredExpressionStringSize = expressionStringLength + 1;
-  
-  Expression *rootExpression = (Expression *)
-    malloc(totalExpressionMemorySize + requiredExpressionStringSize);
-  memset(rootExpression, 0, totalExpressionMemorySize + requiredExpressionStringSize);
-  char *rootExpressionString = (char *)(rootExpression + (totalChildCount + 1));
+  assert(expressionStringLength < EXPRESSION_NAME_CAPACITY);
+
+  Expression *rootExpression = (Expression *)PoolAllocate(&exprList->rootPool);
+  char *rootExpressionString = (char *)(rootExpression + 1);
   memcpy(rootExpressionString, exprString, expressionStringLength);
- 
-  rootExpression->children = rootExpression + 1;
-  RecursivelyInitChildExpressions(rootExpression, rootValue, 0, 0, rootExpression);
   rootExpression->name = rootExpressionString;
-  UpdateRootExpression(rootExpression, debug, true);
 
-  assert(exprList->count + 1 < ARRAYCOUNT(exprList->expressions));
+  lldb::SBValue rootValue = EvaluateRootExpression(rootExpression, debug);
+  UpdateExpressionFromValue(rootExpression, rootValue, exprList);
+  SetExpressionExpanded(rootExpression, true, exprList);
+  rootExpression->subtreeChangedStopID = exprList->currentStopID;
+
   exprList->expressions[exprList->count] = rootExpression;
   exprList->count++;
   log_debug("watch-expression added: %s", exprString);
@@ -127,23 +470,12 @@ DestroyWatchExpression(uint32_t expressionIndex, ExpressionList *expressionList)
 {
   assert(expressionList->count > expressionIndex);
   Expression *expressionToFree = expressionList->expressions[expressionIndex];
-  free(expressionToFree);
+  ReleaseExpressionChildren(expressionToFree, expressionList);
+  PoolFree(&expressionList->valuePool, expressionToFree->valueStorage);
+  PoolFree(&expressionList->rootPool, expressionToFree);
   for (uint32_t i = expressionIndex; i < expressionList->count - 1; i++)
     expressionList->expressions[i] = expressionList->expressions[i + 1];
   expressionList->expressions[expressionList->count - 1] = nullptr;
   expressionList->count--;
+  ScrollExpressionList(expressionList, 0);
 }
-
-static inline
-uint32_t GetTotalExpressionCount(const Expression* expr) 
-{
-  uint32_t result = 1;
-  for (uint32_t i = 0; i < expr->childCount; i++) {
-    Expression *child = &expr->children[i];
-    result += GetTotalExpressionCount(child);
-  }
-  return result;
-}
-
-
-
@@ -0,0 +1,349 @@
+//NOTE(Torin) Fuzzy finder over every function, type, global and source file
+//in the target. A query matches a name when its characters appear in order
+//(case insensitive). Every entry stores a 64 bit mask of the characters in its
+//name so most entries are rejected with a single AND before any scoring, and
+//while the user keeps typing only the previous query's matches are rescanned
+//since a longer query can only ever match a subset of them. Scans are spread
+//across frames with a time budget.
+
+enum SymbolKind : uint8_t {
+  SymbolKind_Function,
+  SymbolKind_Type,
+  SymbolKind_Global,
+  SymbolKind_File,
+  SymbolKind_Count,
+};
+
+static const char *SYMBOL_KIND_NAMES[] = {
+  "fn",
+  "type",
+  "global",
+  "file",
+};
+
+struct SymbolEntry {
+  const char *name;
+  const char *lowerName;
+  uint32_t nameLength;
+  uint32_t moduleIndex;
+  uint32_t symbolIndex;
+  uint8_t kind;
+};
+
+struct SymbolSearchResult {
+  uint32_t entryIndex;
+  int32_t score;
+};
+
+#define SYMBOL_SEARCH_QUERY_CAPACITY 128
+#define SYMBOL_SEARCH_RESULT_CAPACITY 16
+#define SYMBOL_SEARCH_FRAME_BUDGET_MS 4.0f
+
+struct SymbolSearch {
+  SymbolEntry *entries;
+  //NOTE(Torin) Kept apart from the entries so the rejection pass only
+  //touches 8 bytes per entry
+  uint64_t *charMasks;
+  uint32_t entryCount;
+  uint32_t entryCapacity;
+
+  //NOTE(Torin) Indices of the entries that matched lastQuery
+  uint32_t *candidates;
+  uint32_t *nextCandidates;
+  uint32_t candidateCount;
+  bool hasCandidates;
+
+  char query[SYMBOL_SEARCH_QUERY_CAPACITY];
+  uint32_t queryLength;
+  char lastQuery[SYMBOL_SEARCH_QUERY_CAPACITY];
+  uint32_t lastQueryLength;
+
+  SymbolSearchResult results[SYMBOL_SEARCH_RESULT_CAPACITY];
+  uint32_t resultCount;
+  uint32_t matchCount;
+  uint32_t selectedResult;
+
+  bool isScanning;
+  bool isNarrowing;
+  uint32_t scanCount;
+  uint32_t scannedCount;
+  float queryMilliseconds;
+
+  bool isVisible;
+};
+
+static inline
+char ToLowerAscii(char c) {
+  char result = (c >= 'A' && c <= 'Z') ? (char)(c + ('a' - 'A')) : c;
+  return result;
+}
+
+static inline
+uint64_t GetSymbolCharBit(char c) {
+  uint8_t value = (uint8_t)ToLowerAscii(c);
+  uint64_t result = 0;
+  if (value >= 'a' && value <= 'z') result = (uint64_t)1 << (value - 'a');
+  else if (value >= '0' && value <= '9') result = (uint64_t)1 << (26 + (value - '0'));
+  else if (value == '_') result = (uint64_t)1 << 36;
+  else if (value == '/' || value == '.') result = (uint64_t)1 << 37;
+  else if (value == ':') result = (uint64_t)1 << 38;
+  else result = (uint64_t)1 << (39 + (value % 25));
+  return result;
+}
+
+static inline
+uint64_t GetSymbolCharMask(const char *text, uint32_t length) {
+  uint64_t result = 0;
+  for (uint32_t i = 0; i < length; i++)
+    result |= GetSymbolCharBit(text[i]);
+  return result;
+}
+
+static inline
+void InitSymbolSearch(SymbolSearch *search, uint32_t entryCapacity, MemoryArena *arena) {
+  memset(search, 0, sizeof(SymbolSearch));
+  search->entryCapacity = entryCapacity;
+  search->entries = PushArray(arena, SymbolEntry, entryCapacity);
+  search->charMasks = PushArray(arena, uint64_t, entryCapacity);
+  search->candidates = PushArray(arena, uint32_t, entryCapacity);
+  search->nextCandidates = PushArray(arena, uint32_t, entryCapacity);
+}
+
+//NOTE(Torin) The name is copied into the arena
+static inline
+void AddSymbolEntry(SymbolSearch *search, const char *name, uint8_t kind, 
+uint32_t moduleIndex, uint32_t symbolIndex, MemoryArena *arena) {
+  assert(search->entryCount < search->entryCapacity);
+  search->charMasks[search->entryCount] = GetSymbolCharMask(name, strlen(name));
+  SymbolEntry& entry = search->entries[search->entryCount++];
+  entry.name = PushCString(arena, name);
+  entry.nameLength = strlen(name);
+  char *lowerName = (char *)PushSize(arena, entry.nameLength + 1);
+  for (uint32_t i = 0; i <= entry.nameLength; i++)
+    lowerName[i] = ToLowerAscii(name[i]);
+  entry.lowerName = lowerName;
+  entry.moduleIndex = moduleIndex;
+  entry.symbolIndex = symbolIndex;
+  entry.kind = kind;
+}
+
+//NOTE(Torin) Types and source files show up in every compile unit that uses
+//them, the set holds entryIndex + 1 so zero is an empty slot
+struct SymbolNameSet {
+  uint32_t *slots;
+  uint32_t slotMask;
+};
+
+static inline
+void InitSymbolNameSet(SymbolNameSet *set, uint32_t capacity, MemoryArena *arena) {
+  uint32_t slotCount = 64;
+  while (slotCount < capacity * 2) slotCount *= 2;
+  set->slots = PushArray(arena, uint32_t, slotCount);
+  set->slotMask = slotCount - 1;
+}
+
+static bool
+AddUniqueSymbolEntry(SymbolSearch *search, SymbolNameSet *set, const char *name, 
+uint8_t kind, uint32_t moduleIndex, uint32_t symbolIndex, MemoryArena *arena)
+{
+  uint32_t hash = 2166136261u ^ kind;
+  for (const char *c = name; *c != 0; c++) {
+    hash ^= (uint8_t)*c;
+    hash *= 16777619u;
+  }
+
+  uint32_t slot = hash & set->slotMask;
+  while (set->slots[slot] != 0) {
+    const SymbolEntry& entry = search->entries[set->slots[slot] - 1];
+    if (entry.kind == kind && strcmp(entry.name, name) == 0)
+      return false;
+    slot = (slot + 1) & set->slotMask;
+  }
+
+  AddSymbolEntry(search, name, kind, moduleIndex, symbolIndex, arena);
+  set->slots[slot] = search->entryCount;
+  return true;
+}
+
+static inline
+bool IsSymbolWordBoundary(const char *name, uint32_t index) {
+  if (index == 0) return true;
+  char previous = name[index - 1];
+  char current = name[index];
+  bool result = previous == '_' || previous == ':' || previous == '/' ||
+    previous == '.' || previous == ' ' || 
+    ((previous >= 'a' && previous <= 'z') && (current >= 'A' && current <= 'Z'));
+  return result;
+}
+
+//NOTE(Torin) Returns INT32_MIN when the query is not a subsequence of the name.
+//The first match is found greedily, then walked back from its end to find
+//the tightest window so "gui" prefers "gui_draw" over "GetUnusedIndex".
+//lowerQuery is the query in lower case, query keeps the case that was typed
+static int32_t
+ScoreSymbolMatch(const SymbolEntry& entry, const char *query, const char *lowerQuery, 
+uint32_t queryLength)
+{
+  if (queryLength == 0) return 0;
+  const char *name = entry.name;
+  const char *lowerName = entry.lowerName;
+  uint32_t nameLength = entry.nameLength;
+
+  uint32_t queryIndex = 0;
+  uint32_t matchEnd = 0;
+  for (uint32_t i = 0; i < nameLength; i++) {
+    if (lowerName[i] == lowerQuery[queryIndex]) {
+      if (++queryIndex == queryLength) {
+        matchEnd = i + 1;
+        break;
+      }
+    }
+  }
+  if (queryIndex < queryLength) return INT32_MIN;
+
+  uint32_t matchBegin = matchEnd;
+  queryIndex = queryLength;
+  while (queryIndex > 0) {
+    matchBegin--;
+    if (lowerName[matchBegin] == lowerQuery[queryIndex - 1])
+      queryIndex--;
+  }
+
+  int32_t score = 0;
+  int32_t consecutive = 0;
+  queryIndex = 0;
+  for (uint32_t i = matchBegin; i < matchEnd; i++) {
+    if (lowerName[i] == lowerQuery[queryIndex]) {
+      score += 16;
+      if (IsSymbolWordBoundary(name, i)) score += 10;
+      if (name[i] == query[queryIndex]) score += 1;
+      consecutive++;
+      score += (consecutive - 1) * 6;
+      queryIndex++;
+    } else {
+      consecutive = 0;
+      score -= 1;
+    }
+  }
+
+  if (matchBegin == 0) score += 12;
+  score -= (int32_t)(nameLength / 8);
+  return score;
+}
+
+static inline
+void InsertSymbolSearchResult(SymbolSearch *search, uint32_t entryIndex, int32_t score) {
+  uint32_t index = search->resultCount;
+  if (index == SYMBOL_SEARCH_RESULT_CAPACITY) {
+    if (score <= search->results[index - 1].score) return;
+    index--;
+  } else {
+    search->resultCount++;
+  }
+  while (index > 0 && search->results[index - 1].score < score) {
+    search->results[index] = search->results[index - 1];
+    index--;
+  }
+  search->results[index] = SymbolSearchResult { entryIndex, score };
+}
+
+static inline
+double GetSymbolSearchMilliseconds() {
+  timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  double result = (double)time.tv_sec * 1000.0 + ((double)time.tv_nsec / 1000000.0);
+  return result;
+}
+
+//NOTE(Torin) Starts scanning for the current query. When it extends the last
+//query that finished only that query's matches are scanned, a scan that was
+//still running when the query changed is thrown away
+static void
+BeginSymbolSearch(SymbolSearch *search)
+{
+  bool canNarrow = search->hasCandidates && search->queryLength >= search->lastQueryLength &&
+    memcmp(search->query, search->lastQuery, search->lastQueryLength) == 0;
+  search->isNarrowing = canNarrow;
+  search->scanCount = canNarrow ? search->candidateCount : search->entryCount;
+  search->scannedCount = 0;
+  search->matchCount = 0;
+  search->resultCount = 0;
+  search->selectedResult = 0;
+  search->isScanning = true;
+  search->queryMilliseconds = 0.0f;
+}
+
+//NOTE(Torin) Scans for at most budgetMilliseconds so typing never stalls a
+//frame, results fill in over the next frames when there is more to scan
+static void
+StepSymbolSearch(SymbolSearch *search, float budgetMilliseconds)
+{
+  if (search->isScanning == false) return;
+  double beginMilliseconds = GetSymbolSearchMilliseconds();
+
+  const char *query = search->query;
+  uint32_t queryLength = search->queryLength;
+  uint64_t queryMask = GetSymbolCharMask(query, queryLength);
+  char lowerQuery[SYMBOL_SEARCH_QUERY_CAPACITY];
+  for (uint32_t i = 0; i < queryLength; i++)
+    lowerQuery[i] = ToLowerAscii(query[i]);
+
+  static const uint32_t ENTRIES_PER_CLOCK_CHECK = 4096;
+  uint32_t index = search->scannedCount;
+  uint32_t matchCount = search->matchCount;
+  while (index < search->scanCount) {
+    uint32_t chunkEnd = index + ENTRIES_PER_CLOCK_CHECK;
+    if (chunkEnd > search->scanCount) chunkEnd = search->scanCount;
+    for (; index < chunkEnd; index++) {
+      uint32_t entryIndex = search->isNarrowing ? search->candidates[index] : index;
+      if ((search->charMasks[entryIndex] & queryMask) != queryMask) continue;
+      const SymbolEntry& entry = search->entries[entryIndex];
+      int32_t score = ScoreSymbolMatch(entry, query, lowerQuery, queryLength);
+      if (score == INT32_MIN) continue;
+      search->nextCandidates[matchCount++] = entryIndex;
+      InsertSymbolSearchResult(search, entryIndex, score);
+    }
+    if (GetSymbolSearchMilliseconds() - beginMilliseconds > budgetMilliseconds) break;
+  }
+  search->scannedCount = index;
+  search->matchCount = matchCount;
+
+  if (index == search->scanCount) {
+    uint32_t *swap = search->candidates;
+    search->candidates = search->nextCandidates;
+    search->nextCandidates = swap;
+    search->candidateCount = matchCount;
+    search->hasCandidates = true;
+    memcpy(search->lastQuery, query, queryLength);
+    search->lastQueryLength = queryLength;
+    search->isScanning = false;
+  }
+  search->queryMilliseconds += (float)(GetSymbolSearchMilliseconds() - beginMilliseconds);
+}
+
+static inline
+void SetSymbolSearchVisible(SymbolSearch *search, bool isVisible) {
+  search->isVisible = isVisible;
+  search->queryLength = 0;
+  search->query[0] = 0;
+  search->hasCandidates = false;
+  search->isScanning = false;
+  if (isVisible) BeginSymbolSearch(search);
+}
+
+static inline
+void AppendSymbolSearchQuery(SymbolSearch *search, const char *text) {
+  size_t length = strlen(text);
+  if (search->queryLength + length + 1 > SYMBOL_SEARCH_QUERY_CAPACITY) return;
+  memcpy(search->query + search->queryLength, text, length);
+  search->queryLength += length;
+  search->query[search->queryLength] = 0;
+  BeginSymbolSearch(search);
+}
+
+static inline
+void PopSymbolSearchQuery(SymbolSearch *search) {
+  if (search->queryLength == 0) return;
+  search->query[--search->queryLength] = 0;
+  BeginSymbolSearch(search);
+}
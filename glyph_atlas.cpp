@@ -0,0 +1,288 @@
+//NOTE(Torin) Every printable ascii glyph of a font is rendered once into a
+//single texture, text is then drawn as a batch of quads sampling from it
+//instead of creating a surface and texture per string per frame
+
+#define GLYPH_ATLAS_FIRST_CHAR 32
+#define GLYPH_ATLAS_LAST_CHAR 126
+#define GLYPH_ATLAS_GLYPH_COUNT (GLYPH_ATLAS_LAST_CHAR - GLYPH_ATLAS_FIRST_CHAR + 1)
+#define GLYPH_ATLAS_WIDTH 512
+#define GLYPH_ATLAS_PADDING 1
+
+#define TEXT_BATCH_QUAD_CAPACITY 16384
+
+struct GlyphAtlas {
+  TTF_Font *font;
+  SDL_Texture *texture;
+  int width;
+  int height;
+  int lineHeight;
+  SDL_Rect glyphRects[GLYPH_ATLAS_GLYPH_COUNT];
+};
+
+struct TextQuad {
+  SDL_Rect source;
+  SDL_Rect dest;
+  RGBA8 color;
+};
+
+struct TextBatch {
+  SDL_Renderer *renderer;
+  const GlyphAtlas *atlas;
+  TextQuad *quads;
+  uint32_t quadCount;
+  uint32_t quadCapacity;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+  SDL_Vertex *vertices;
+  int *indices;
+#endif
+
+  uint32_t quadsThisFrame;
+  uint32_t flushesThisFrame;
+  uint32_t quadsLastFrame;
+  uint32_t flushesLastFrame;
+};
+
+static inline
+uint32_t GetGlyphIndex(char c) {
+  uint8_t value = (uint8_t)c;
+  if (value < GLYPH_ATLAS_FIRST_CHAR || value > GLYPH_ATLAS_LAST_CHAR)
+    value = '?';
+  uint32_t result = value - GLYPH_ATLAS_FIRST_CHAR;
+  return result;
+}
+
+static bool
+InitGlyphAtlas(GlyphAtlas *atlas, SDL_Renderer *renderer, TTF_Font *font)
+{
+  memset(atlas, 0, sizeof(GlyphAtlas));
+  atlas->font = font;
+  atlas->lineHeight = TTF_FontHeight(font);
+
+  //NOTE(Torin) Glyphs are rendered white so the batch can tint them
+  SDL_Color white = { 255, 255, 255, 255 };
+  SDL_Surface *glyphSurfaces[GLYPH_ATLAS_GLYPH_COUNT];
+  int penX = 0, penY = 0, rowHeight = 0;
+  for (uint32_t i = 0; i < GLYPH_ATLAS_GLYPH_COUNT; i++) {
+    char text[2] = { (char)(GLYPH_ATLAS_FIRST_CHAR + i), 0 };
+    SDL_Surface *surface = TTF_RenderText_Blended(font, text, white);
+    if (surface == NULL) {
+      log_error("failed to render glyph '%c' for the atlas: %s", text[0], TTF_GetError());
+      for (uint32_t j = 0; j < i; j++) SDL_FreeSurface(glyphSurfaces[j]);
+      return false;
+    }
+    glyphSurfaces[i] = surface;
+    int w = surface->w;
+    int h = surface->h;
+    if (penX + w > GLYPH_ATLAS_WIDTH) {
+      penX = 0;
+      penY += rowHeight + GLYPH_ATLAS_PADDING;
+      rowHeight = 0;
+    }
+    atlas->glyphRects[i] = SDL_Rect { penX, penY, w, h };
+    penX += w + GLYPH_ATLAS_PADDING;
+    if (h > rowHeight) rowHeight = h;
+  }
+
+  atlas->width = GLYPH_ATLAS_WIDTH;
+  atlas->height = penY + rowHeight;
+  SDL_Surface *atlasSurface = SDL_CreateRGBSurfaceWithFormat(0,
+    atlas->width, atlas->height, 32, SDL_PIXELFORMAT_RGBA32);
+  if (atlasSurface == NULL) {
+    log_error("failed to create glyph atlas surface: %s", SDL_GetError());
+    for (uint32_t i = 0; i < GLYPH_ATLAS_GLYPH_COUNT; i++) SDL_FreeSurface(glyphSurfaces[i]);
+    return false;
+  }
+  SDL_FillRect(atlasSurface, NULL, 0);
+
+  for (uint32_t i = 0; i < GLYPH_ATLAS_GLYPH_COUNT; i++) {
+    SDL_Surface *surface = glyphSurfaces[i];
+    SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+    SDL_Rect dest = atlas->glyphRects[i];
+    SDL_BlitSurface(surface, NULL, atlasSurface, &dest);
+    SDL_FreeSurface(surface);
+  }
+
+  atlas->texture = SDL_CreateTextureFromSurface(renderer, atlasSurface);
+  SDL_FreeSurface(atlasSurface);
+  if (atlas->texture == NULL) {
+    log_error("failed to create glyph atlas texture: %s", SDL_GetError());
+    return false;
+  }
+  SDL_SetTextureBlendMode(atlas->texture, SDL_BLENDMODE_BLEND);
+  return true;
+}
+
+static inline
+int MeasureTextWidth(const GlyphAtlas *atlas, const char *text, size_t length) {
+  int result = 0;
+  for (size_t i = 0; i < length; i++)
+    result += atlas->glyphRects[GetGlyphIndex(text[i])].w;
+  return result;
+}
+
+static void
+InitTextBatch(TextBatch *batch, SDL_Renderer *renderer, MemoryArena *arena)
+{
+  memset(batch, 0, sizeof(TextBatch));
+  batch->renderer = renderer;
+  batch->quadCapacity = TEXT_BATCH_QUAD_CAPACITY;
+  batch->quads = PushArray(arena, TextQuad, batch->quadCapacity);
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+  batch->vertices = PushArray(arena, SDL_Vertex, batch->quadCapacity * 4);
+  batch->indices = PushArray(arena, int, batch->quadCapacity * 6);
+  for (uint32_t i = 0; i < batch->quadCapacity; i++) {
+    int *index = &batch->indices[i * 6];
+    int base = (int)(i * 4);
+    index[0] = base + 0; index[1] = base + 1; index[2] = base + 2;
+    index[3] = base + 2; index[4] = base + 3; index[5] = base + 0;
+  }
+#endif
+}
+
+static void
+FlushTextBatch(TextBatch *batch)
+{
+  if (batch->quadCount == 0) return;
+  const GlyphAtlas *atlas = batch->atlas;
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+  float inverseWidth = 1.0f / (float)atlas->width;
+  float inverseHeight = 1.0f / (float)atlas->height;
+  for (uint32_t i = 0; i < batch->quadCount; i++) {
+    const TextQuad& quad = batch->quads[i];
+    SDL_Color color = { quad.color.r, quad.color.g, quad.color.b, quad.color.a };
+    float x0 = (float)quad.dest.x, y0 = (float)quad.dest.y;
+    float x1 = x0 + quad.dest.w, y1 = y0 + quad.dest.h;
+    float u0 = quad.source.x * inverseWidth, v0 = quad.source.y * inverseHeight;
+    float u1 = (quad.source.x + quad.source.w) * inverseWidth;
+    float v1 = (quad.source.y + quad.source.h) * inverseHeight;
+    SDL_Vertex *vertex = &batch->vertices[i * 4];
+    vertex[0] = SDL_Vertex { { x0, y0 }, color, { u0, v0 } };
+    vertex[1] = SDL_Vertex { { x1, y0 }, color, { u1, v0 } };
+    vertex[2] = SDL_Vertex { { x1, y1 }, color, { u1, v1 } };
+    vertex[3] = SDL_Vertex { { x0, y1 }, color, { u0, v1 } };
+  }
+  SDL_RenderGeometry(batch->renderer, atlas->texture, batch->vertices,
+    batch->quadCount * 4, batch->indices, batch->quadCount * 6);
+#else
+  //NOTE(Torin) Older SDL has no geometry api but still only ever binds the one
+  //atlas texture and batches the copies internally
+  RGBA8 currentColor = batch->quads[0].color;
+  SDL_SetTextureColorMod(atlas->texture, currentColor.r, currentColor.g, currentColor.b);
+  SDL_SetTextureAlphaMod(atlas->texture, currentColor.a);
+  for (uint32_t i = 0; i < batch->quadCount; i++) {
+    const TextQuad& quad = batch->quads[i];
+    if (memcmp(&quad.color, &currentColor, sizeof(RGBA8)) != 0) {
+      currentColor = quad.color;
+      SDL_SetTextureColorMod(atlas->texture, currentColor.r, currentColor.g, currentColor.b);
+      SDL_SetTextureAlphaMod(atlas->texture, currentColor.a);
+    }
+    SDL_RenderCopy(batch->renderer, atlas->texture, &quad.source, &quad.dest);
+  }
+#endif
+
+  batch->quadsThisFrame += batch->quadCount;
+  batch->flushesThisFrame++;
+  batch->quadCount = 0;
+}
+
+//NOTE(Torin) Returns the width of the text that was pushed
+static int
+PushTextToBatch(TextBatch *batch, const GlyphAtlas *atlas, const char *text,
+size_t length, int x, int y, RGBA8 color)
+{
+  if (batch->atlas != atlas) {
+    FlushTextBatch(batch);
+    batch->atlas = atlas;
+  }
+
+  int penX = x;
+  for (size_t i = 0; i < length; i++) {
+    const SDL_Rect& source = atlas->glyphRects[GetGlyphIndex(text[i])];
+    if (text[i] != ' ' && source.w > 0) {
+      if (batch->quadCount == batch->quadCapacity)
+        FlushTextBatch(batch);
+      TextQuad& quad = batch->quads[batch->quadCount++];
+      quad.source = source;
+      quad.dest = SDL_Rect { penX, y, source.w, source.h };
+      quad.color = color;
+    }
+    penX += source.w;
+  }
+  return penX - x;
+}
+
+static inline
+void EndTextBatchFrame(TextBatch *batch) {
+  FlushTextBatch(batch);
+  batch->quadsLastFrame = batch->quadsThisFrame;
+  batch->flushesLastFrame = batch->flushesThisFrame;
+  batch->quadsThisFrame = 0;
+  batch->flushesThisFrame = 0;
+}
+
+//NOTE(Torin) Prefix sums of glyph advances for each source line so hit
+//testing the text under the mouse is a binary search instead of measuring
+//every token with the font. Lines are built lazily the first time they are
+//hovered and live in the source arena so changing files throws them away.
+struct LineAdvanceCache {
+  const GlyphAtlas *atlas;
+  int32_t **lineAdvances;
+  uint32_t lineCount;
+  uint32_t linesBuilt;
+};
+
+static inline
+void InitLineAdvanceCache(LineAdvanceCache *cache, uint32_t lineCount, MemoryArena *arena) {
+  cache->atlas = NULL;
+  cache->lineCount = lineCount;
+  cache->linesBuilt = 0;
+  cache->lineAdvances = PushArray(arena, int32_t *, lineCount);
+}
+
+//NOTE(Torin) Returns lineLength + 1 entries where entry i is the x offset of
+//the ith character. Tabs advance by two spaces to match copy_line_to_buffer
+static const int32_t *
+GetLineAdvances(LineAdvanceCache *cache, const GlyphAtlas *atlas, uint32_t lineIndex,
+const char *lineData, uint32_t lineLength, MemoryArena *arena)
+{
+  assert(lineIndex < cache->lineCount);
+  if (cache->atlas != atlas) {
+    //NOTE(Torin) The font changed, the old prefix sums stay in the arena
+    //until the next file change but are never looked at again
+    memset(cache->lineAdvances, 0, sizeof(int32_t *) * cache->lineCount);
+    cache->atlas = atlas;
+    cache->linesBuilt = 0;
+  }
+
+  int32_t *advances = cache->lineAdvances[lineIndex];
+  if (advances != NULL) return advances;
+
+  advances = PushArray(arena, int32_t, lineLength + 1);
+  int32_t spaceWidth = atlas->glyphRects[GetGlyphIndex(' ')].w;
+  int32_t x = 0;
+  for (uint32_t i = 0; i < lineLength; i++) {
+    advances[i] = x;
+    if (lineData[i] == '\t') x += spaceWidth * 2;
+    else x += atlas->glyphRects[GetGlyphIndex(lineData[i])].w;
+  }
+  advances[lineLength] = x;
+
+  cache->lineAdvances[lineIndex] = advances;
+  cache->linesBuilt++;
+  return advances;
+}
+
+//NOTE(Torin) Index of the character covering x or lineLength if x is past
+//the end of the line
+static inline
+uint32_t FindCharIndexAtOffset(const int32_t *advances, uint32_t lineLength, int32_t x) {
+  if (x < 0) return 0;
+  uint32_t low = 0, high = lineLength;
+  while (low < high) {
+    uint32_t mid = low + ((high - low + 1) / 2);
+    if (advances[mid] <= x) low = mid;
+    else high = mid - 1;
+  }
+  return low;
+}
@@ -0,0 +1,352 @@
+//NOTE(Torin) Headless mode drives the same lldb backend as the gui without
+//initializing SDL or TTF. Commands are read one per line from a script file
+//or stdin and every command produces exactly one JSON object on its own line
+//on stdout. Anything else that would have been printed (logging, lldb's own
+//output) is moved to stderr so stdout stays machine readable.
+//
+//  break <file>:<line> | break <symbol>
+//  run (again once the process has exited)
+//  step | next | finish | continue
+//  print <identifier>
+//  backtrace
+//  quit
+//
+//Empty lines and lines starting with # are ignored.
+
+#define HEADLESS_LINE_CAPACITY 4096
+#define HEADLESS_BACKTRACE_LIMIT 64
+
+struct HeadlessContext {
+  DebugContext debug;
+  MemoryArena arena;
+  FILE *results;
+  const char *executableArguments;
+  uint64_t commandCount;
+  uint64_t errorCount;
+  uint64_t executionCount;
+  double executionSeconds;
+};
+
+static void
+WriteJSONStringN(FILE *file, const char *text, size_t length)
+{
+  fputc('"', file);
+  for (size_t i = 0; i < length; i++) {
+    char c = text[i];
+    switch (c) {
+      case '"':  fputs("\\\"", file); break;
+      case '\\': fputs("\\\\", file); break;
+      case '\n': fputs("\\n", file); break;
+      case '\r': fputs("\\r", file); break;
+      case '\t': fputs("\\t", file); break;
+      default: {
+        if ((uint8_t)c < ' ') fprintf(file, "\\u%04x", (uint8_t)c);
+        else fputc(c, file);
+      } break;
+    }
+  }
+  fputc('"', file);
+}
+
+static inline
+void WriteJSONString(FILE *file, const char *text) {
+  WriteJSONStringN(file, text, strlen(text));
+}
+
+static void
+WriteHeadlessError(HeadlessContext *context, const char *command, const char *message)
+{
+  context->errorCount++;
+  fprintf(context->results, "{\"command\":");
+  WriteJSONString(context->results, command);
+  fprintf(context->results, ",\"ok\":false,\"error\":");
+  WriteJSONString(context->results, message);
+  fprintf(context->results, "}\n");
+}
+
+static void
+WriteHeadlessFrame(FILE *file, lldb::SBFrame frame)
+{
+  const char *function = frame.GetFunctionName();
+  fprintf(file, "{\"pc\":%lu,\"function\":", (unsigned long)frame.GetPC());
+  WriteJSONString(file, function ? function : "");
+  lldb::SBLineEntry lineEntry = frame.GetLineEntry();
+  if (lineEntry.IsValid()) {
+    char path[PATH_MAX];
+    if (lineEntry.GetFileSpec().GetPath(path, sizeof(path)) >= sizeof(path)) path[0] = 0;
+    fprintf(file, ",\"file\":");
+    WriteJSONString(file, path);
+    fprintf(file, ",\"line\":%u", lineEntry.GetLine());
+  }
+  fprintf(file, "}");
+}
+
+static const char *
+GetHeadlessStopReasonName(lldb::StopReason reason)
+{
+  switch (reason) {
+    case lldb::eStopReasonBreakpoint: return "breakpoint";
+    case lldb::eStopReasonPlanComplete: return "step";
+    case lldb::eStopReasonTrace: return "trace";
+    case lldb::eStopReasonWatchpoint: return "watchpoint";
+    case lldb::eStopReasonSignal: return "signal";
+    case lldb::eStopReasonException: return "exception";
+    default: return "other";
+  }
+}
+
+//NOTE(Torin) Every execution command reports where the process ended up
+static void
+WriteHeadlessProcessState(HeadlessContext *context, const char *command)
+{
+  FILE *file = context->results;
+  lldb::SBProcess& process = context->debug.process;
+  lldb::StateType state = process.GetState();
+  fprintf(file, "{\"command\":");
+  WriteJSONString(file, command);
+  fprintf(file, ",\"ok\":true");
+  if (state == lldb::eStateStopped) {
+    lldb::SBThread thread = process.GetSelectedThread();
+    fprintf(file, ",\"state\":\"stopped\",\"reason\":\"%s\",\"frame\":",
+      GetHeadlessStopReasonName(thread.GetStopReason()));
+    WriteHeadlessFrame(file, thread.GetSelectedFrame());
+  } else if (state == lldb::eStateExited) {
+    fprintf(file, ",\"state\":\"exited\",\"status\":%d", process.GetExitStatus());
+  } else if (state == lldb::eStateCrashed) {
+    fprintf(file, ",\"state\":\"crashed\"");
+  } else {
+    fprintf(file, ",\"state\":\"other\"");
+  }
+  fprintf(file, "}\n");
+}
+
+static void
+DrainHeadlessProcessOutput(HeadlessContext *context)
+{
+  char buffer[64 * 1024];
+  for (;;) {
+    size_t bytesRead = lldb_read_process_output(&context->debug, buffer, sizeof(buffer));
+    if (bytesRead == 0) break;
+    fprintf(context->results, "{\"event\":\"output\",\"text\":");
+    WriteJSONStringN(context->results, buffer, bytesRead);
+    fprintf(context->results, "}\n");
+  }
+}
+
+static bool
+IsHeadlessProcessStopped(HeadlessContext *context)
+{
+  bool result = context->debug.process.IsValid() &&
+    context->debug.process.GetState() == lldb::eStateStopped;
+  return result;
+}
+
+//NOTE(Torin) An inferior that has exited or been detached can be run again
+static bool
+IsHeadlessProcessLive(HeadlessContext *context)
+{
+  if (!context->debug.process.IsValid()) return false;
+  lldb::StateType state = context->debug.process.GetState();
+  bool result = state != lldb::eStateInvalid && state != lldb::eStateUnloaded &&
+    state != lldb::eStateExited && state != lldb::eStateDetached;
+  return result;
+}
+
+static inline
+double GetHeadlessSeconds() {
+  timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  double result = time.tv_sec + (time.tv_nsec / 1000000000.0);
+  return result;
+}
+
+static void
+ExecuteHeadlessBreak(HeadlessContext *context, const char *argument)
+{
+  lldb::SBBreakpoint breakpoint;
+  const char *colon = strrchr(argument, ':');
+  if (colon != NULL && colon != argument && isdigit(colon[1])) {
+    char filename[PATH_MAX];
+    size_t filenameLength = colon - argument;
+    if (filenameLength >= sizeof(filename)) {
+      WriteHeadlessError(context, "break", "filename is too long");
+      return;
+    }
+    memcpy(filename, argument, filenameLength);
+    filename[filenameLength] = 0;
+    breakpoint = context->debug.target.BreakpointCreateByLocation(filename,
+      (uint32_t)strtoul(colon + 1, NULL, 10));
+  } else {
+    breakpoint = context->debug.target.BreakpointCreateByName(argument);
+  }
+
+  if (!breakpoint.IsValid()) {
+    WriteHeadlessError(context, "break", "could not create breakpoint");
+    return;
+  }
+  fprintf(context->results, "{\"command\":\"break\",\"ok\":true,\"id\":%d,\"locations\":%lu}\n",
+    (int)breakpoint.GetID(), (unsigned long)breakpoint.GetNumLocations());
+}
+
+static void
+ExecuteHeadlessPrint(HeadlessContext *context, const char *argument)
+{
+  ResetMemoryArena(&context->arena);
+  PrintInfo info = lldb_print_identifier(&context->debug, argument, &context->arena);
+  if (info.value_count == 0) {
+    WriteHeadlessError(context, "print", "no value found");
+    return;
+  }
+
+  FILE *file = context->results;
+  fprintf(file, "{\"command\":\"print\",\"ok\":true,\"values\":[");
+  for (uint32_t i = 0; i < info.value_count; i++) {
+    const PrintValue& value = info.values[i];
+    if (i > 0) fputc(',', file);
+    fprintf(file, "{\"name\":");
+    WriteJSONString(file, value.name_string);
+    fprintf(file, ",\"type\":");
+    WriteJSONString(file, value.type_string);
+    fprintf(file, ",\"value\":");
+    WriteJSONString(file, value.value_string);
+    fputc('}', file);
+  }
+  fprintf(file, "]}\n");
+}
+
+static void
+ExecuteHeadlessBacktrace(HeadlessContext *context)
+{
+  FILE *file = context->results;
+  lldb::SBThread thread = context->debug.process.GetSelectedThread();
+  uint32_t frameCount = thread.GetNumFrames();
+  if (frameCount > HEADLESS_BACKTRACE_LIMIT) frameCount = HEADLESS_BACKTRACE_LIMIT;
+  fprintf(file, "{\"command\":\"backtrace\",\"ok\":true,\"frames\":[");
+  for (uint32_t i = 0; i < frameCount; i++) {
+    if (i > 0) fputc(',', file);
+    WriteHeadlessFrame(file, thread.GetFrameAtIndex(i));
+  }
+  fprintf(file, "]}\n");
+}
+
+//NOTE(Torin) Returns false when the session should end
+static bool
+ExecuteHeadlessCommand(HeadlessContext *context, char *line)
+{
+  char *command = line;
+  while (isspace(*command)) command++;
+  char *end = command + strlen(command);
+  while (end > command && isspace(end[-1])) *--end = 0;
+  if (*command == 0 || *command == '#') return true;
+
+  char *argument = command;
+  while (*argument != 0 && !isspace(*argument)) argument++;
+  if (*argument != 0) {
+    *argument++ = 0;
+    while (isspace(*argument)) argument++;
+  }
+
+  context->commandCount++;
+  if (!strcmp(command, "quit")) {
+    fprintf(context->results, "{\"command\":\"quit\",\"ok\":true}\n");
+    return false;
+  } else if (!strcmp(command, "break")) {
+    if (*argument == 0) WriteHeadlessError(context, command, "expected <file>:<line> or <symbol>");
+    else ExecuteHeadlessBreak(context, argument);
+  } else if (!strcmp(command, "run")) {
+    if (IsHeadlessProcessLive(context)) {
+      WriteHeadlessError(context, command, "process is already running");
+    } else {
+      //NOTE(Torin) SBLaunchInfo takes a NULL terminated argument list
+      const char *argv[] = { context->executableArguments, NULL };
+      lldb_run_executable(&context->debug, argv);
+      WriteHeadlessProcessState(context, command);
+    }
+  } else if (!strcmp(command, "step") || !strcmp(command, "next") ||
+      !strcmp(command, "finish") || !strcmp(command, "continue")) {
+    if (!IsHeadlessProcessStopped(context)) {
+      WriteHeadlessError(context, command, "process is not stopped");
+    } else {
+      double beginSeconds = GetHeadlessSeconds();
+      if (command[0] == 's') lldb_step_into(&context->debug);
+      else if (command[0] == 'n') lldb_step_over(&context->debug);
+      else if (command[0] == 'f') lldb_step_out(&context->debug);
+      else lldb_continue_execution(&context->debug);
+      context->executionSeconds += GetHeadlessSeconds() - beginSeconds;
+      context->executionCount++;
+      WriteHeadlessProcessState(context, command);
+    }
+  } else if (!strcmp(command, "print")) {
+    if (!IsHeadlessProcessStopped(context)) WriteHeadlessError(context, command, "process is not stopped");
+    else if (*argument == 0) WriteHeadlessError(context, command, "expected an identifier");
+    else ExecuteHeadlessPrint(context, argument);
+  } else if (!strcmp(command, "backtrace")) {
+    if (!IsHeadlessProcessStopped(context)) WriteHeadlessError(context, command, "process is not stopped");
+    else ExecuteHeadlessBacktrace(context);
+  } else {
+    WriteHeadlessError(context, command, "unknown command");
+  }
+
+  DrainHeadlessProcessOutput(context);
+  return true;
+}
+
+static int
+RunHeadless(const char *executablePath, const char *executableArguments,
+const char *scriptPath, const char **breakpoints, uint32_t breakpointCount)
+{
+  FILE *input = stdin;
+  if (scriptPath != NULL) {
+    input = fopen(scriptPath, "r");
+    if (input == NULL) {
+      fprintf(stderr, "could not open script %s: %s\n", scriptPath, strerror(errno));
+      return 1;
+    }
+  }
+
+  HeadlessContext *context = (HeadlessContext *)calloc(1, sizeof(HeadlessContext));
+  //NOTE(Torin) Results keep the real stdout, everything else printf'd goes to stderr
+  fflush(stdout);
+  int resultsFD = dup(STDOUT_FILENO);
+  dup2(STDERR_FILENO, STDOUT_FILENO);
+  context->results = fdopen(resultsFD, "w");
+  context->executableArguments = executableArguments;
+  InitMemoryArena(&context->arena, "headless", MEMORY_ARENA_DEFAULT_BLOCK_SIZE);
+
+  double beginSeconds = GetHeadlessSeconds();
+  lldb_initialize(&context->debug, executablePath);
+  if (!context->debug.target.IsValid()) {
+    WriteHeadlessError(context, "load", "could not create target");
+    fclose(context->results);
+    return 1;
+  }
+
+  char line[HEADLESS_LINE_CAPACITY];
+  for (uint32_t i = 0; i < breakpointCount; i++) {
+    snprintf(line, sizeof(line), "break %s", breakpoints[i]);
+    ExecuteHeadlessCommand(context, line);
+  }
+  while (fgets(line, sizeof(line), input) != NULL) {
+    if (!ExecuteHeadlessCommand(context, line)) break;
+    //NOTE(Torin) Flushed per command so a driving process can wait on each result
+    fflush(context->results);
+  }
+
+  //NOTE(Torin) Execution commands are timed on their own so step throughput
+  //is not skewed by loading the target
+  double seconds = GetHeadlessSeconds() - beginSeconds;
+  fprintf(context->results, "{\"event\":\"summary\",\"commands\":%lu,\"errors\":%lu,"
+    "\"seconds\":%.3f,\"execution_commands\":%lu,\"execution_seconds\":%.3f,"
+    "\"execution_commands_per_second\":%.1f}\n",
+    (unsigned long)context->commandCount, (unsigned long)context->errorCount, seconds,
+    (unsigned long)context->executionCount, context->executionSeconds,
+    context->executionSeconds > 0.0 ? context->executionCount / context->executionSeconds : 0.0);
+  fclose(context->results);
+
+  if (input != stdin) fclose(input);
+  lldb_terminate(&context->debug);
+  FreeMemoryArena(&context->arena);
+  int result = context->errorCount ? 1 : 0;
+  free(context);
+  return result;
+}
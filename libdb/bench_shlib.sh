@@ -0,0 +1,41 @@
+#!/bin/bash
+#NOTE(Torin) Builds a program linked against LIBRARY_COUNT shared libraries
+#that dlopens one more, then runs it natively and under test_shlib
+set -e
+LIBRARY_COUNT=${LIBRARY_COUNT:-200}
+CC=${CC:-clang}
+LIBDB_DIR=$(cd "$(dirname "$0")" && pwd)
+BENCH_DIR=$(mktemp -d)
+trap 'rm -rf "$BENCH_DIR"' EXIT
+cd "$BENCH_DIR"
+
+echo "int main(void) {" > main_calls.inc
+for i in $(seq 0 $((LIBRARY_COUNT - 1))); do
+  echo "int shlib_function_$i(int x) { return x + $i; }" > shlib_$i.c
+  $CC -shared -fPIC -O1 shlib_$i.c -o libshlib_$i.so
+  echo "int shlib_function_$i(int);" >> declarations.inc
+  echo "  total += shlib_function_$i(total);" >> calls.inc
+  LIBS="$LIBS -lshlib_$i"
+done
+echo "int shlib_dlopen_function(int x) { return x * 2; }" > shlib_dlopen.c
+$CC -shared -fPIC -O1 shlib_dlopen.c -o libshlib_dlopen.so
+
+cat > program.c <<PROGRAM
+#include <dlfcn.h>
+#include <stdio.h>
+$(cat declarations.inc)
+int main(void) {
+  int total = 0;
+$(cat calls.inc)
+  void *library = dlopen("$BENCH_DIR/libshlib_dlopen.so", RTLD_NOW);
+  int (*function)(int) = (int (*)(int))dlsym(library, "shlib_dlopen_function");
+  printf("%d\n", function(total));
+  return 0;
+}
+PROGRAM
+$CC -O1 program.c -o program -L. $LIBS -Wl,-rpath,"$BENCH_DIR" -ldl
+
+$CC -g -O0 "$LIBDB_DIR/test_shlib.c" -o test_shlib
+time ./program > /dev/null
+./test_shlib ./program > /dev/null
+./test_shlib ./program shlib_function_$((LIBRARY_COUNT - 1)) shlib_dlopen_function > /dev/null
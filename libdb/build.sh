@@ -1 +1,3 @@
-clang -g -O0 test_libdb.c
\ No newline at end of file
+clang -g -O0 test_libdb.c
+clang -g -O0 test_core.c -o test_core
+clang -O2 test_leb128.c -o test_leb128
@@ -22,6 +22,7 @@
 #define ELF_SECTION_TYPE_SYMBOL_TABLE 2
 #define ELF_SECTION_TYPE_STRING_TABLE 3
 #define ELF_SECTION_TYPE_UNINIALIZED_SPACE 8
+#define ELF_SECTION_TYPE_DYNAMIC_SYMBOL_TABLE 11
 
 #define ELF_SECTION_FLAG_WRITE 1
 #define ELF_SECTION_FLAG_STATIC_MEMORY 2
@@ -36,6 +37,7 @@
 #define ELF_SYMBOL_TYPE_FUNCTION 2
 #define ELF_SYMBOL_TYPE_SECTION 3
 #define ELF_SYMBOL_TYPE_FILE 4
+#define ELF_SYMBOL_TYPE_GNU_IFUNC 10
 
 typedef struct {
   uint32_t magicNumber;
@@ -86,6 +88,112 @@ typedef struct {
   uint64_t size;
 } ELFSymbol;
 
+#define ELF_PROGRAM_TYPE_LOAD 1
+#define ELF_PROGRAM_TYPE_DYNAMIC 2
+#define ELF_PROGRAM_TYPE_NOTE 4
+#define ELF_PROGRAM_TYPE_PHDR 6
+
+typedef struct {
+  uint32_t type;
+  uint32_t flags;
+  uint64_t fileOffset;
+  uint64_t virtualAddress;
+  uint64_t physicalAddress;
+  uint64_t fileSize;
+  uint64_t memorySize;
+  uint64_t alignment;
+} ELFProgramHeader;
+
+//NOTE(Torin) Notes are a header followed by the name and then the descriptor,
+//each padded to 4 bytes
+typedef struct {
+  uint32_t nameSize;
+  uint32_t descriptorSize;
+  uint32_t type;
+} ELFNoteHeader;
+
+#define ELF_NOTE_TYPE_PRSTATUS 1
+#define ELF_NOTE_TYPE_FPREGSET 2
+#define ELF_NOTE_TYPE_PRPSINFO 3
+#define ELF_NOTE_TYPE_AUXV 6
+#define ELF_NOTE_TYPE_FILE 0x46494c45
+
+#define ELF_CORE_REGISTER_COUNT 27
+#define ELF_CORE_FPREGSET_SIZE 512
+
+//NOTE(Torin) The x86_64 linux elf_prstatus, registers are in user_regs_struct order
+typedef struct {
+  int32_t signalNumber;
+  int32_t signalCode;
+  int32_t signalErrno;
+  int16_t currentSignal;
+  uint16_t padding;
+  uint64_t pendingSignals;
+  uint64_t heldSignals;
+  int32_t pid;
+  int32_t parentPid;
+  int32_t processGroup;
+  int32_t sessionID;
+  uint64_t userTime[2];
+  uint64_t systemTime[2];
+  uint64_t childUserTime[2];
+  uint64_t childSystemTime[2];
+  uint64_t registers[ELF_CORE_REGISTER_COUNT];
+  int32_t fpRegistersValid;
+} ELFCorePRStatus;
+
+//NOTE(Torin) NT_FILE is this header, count entries and then count null
+//terminated paths. Offsets are in units of pageSize
+typedef struct {
+  uint64_t count;
+  uint64_t pageSize;
+} ELFCoreFileNoteHeader;
+
+typedef struct {
+  uint64_t start;
+  uint64_t end;
+  uint64_t fileOffset;
+} ELFCoreFileNoteEntry;
+
+#define ELF_AUXV_TYPE_NULL 0
+#define ELF_AUXV_TYPE_PHDR 3
+#define ELF_AUXV_TYPE_PHNUM 5
+#define ELF_AUXV_TYPE_BASE 7
+#define ELF_AUXV_TYPE_ENTRY 9
+
+#define ELF_DYNAMIC_TAG_NULL 0
+#define ELF_DYNAMIC_TAG_DEBUG 21
+
+typedef struct {
+  int64_t tag;
+  uint64_t value;
+} ELFDynamicEntry;
+
+//NOTE(Torin) The dynamic loader's r_debug, DT_DEBUG points at it once the
+//loader has run. The loader calls breakpointAddress every time the list of
+//loaded objects changes and sets state first
+#define ELF_DEBUG_STATE_CONSISTENT 0
+#define ELF_DEBUG_STATE_ADD 1
+#define ELF_DEBUG_STATE_DELETE 2
+
+typedef struct {
+  int32_t version;
+  uint32_t padding;
+  uint64_t linkMapAddress;
+  uint64_t breakpointAddress;
+  int32_t state;
+  uint32_t padding1;
+  uint64_t loaderBase;
+} ELFDebugRendezvous;
+
+typedef struct {
+  uint64_t baseAddress;
+  uint64_t nameAddress;
+  uint64_t dynamicAddress;
+  uint64_t next;
+  uint64_t previous;
+} ELFLinkMap;
+
 typedef enum {
   ELF_SECTION_TEXT,
   ELF_SECTION_BSS,
@@ -21,8 +21,24 @@ typedef enum {
 typedef enum {
   libdb_Stop_Reason_NONE,
   libdb_Stop_Reason_BREAKPOINT_HIT,
+  libdb_Stop_Reason_SIGNAL,
 } libdb_Stop_Reason;
 
+typedef struct libdb_Core libdb_Core;
+
+//NOTE(Torin) A shared object the dynamic loader has mapped into the program,
+//its symbols are only read the first time something needs them
+typedef struct {
+  char *path;
+  uint64_t base_address;
+  uint64_t link_map_address;
+  uint64_t image_size;
+  libdb_Symbol_Table symbol_table;
+  int32_t are_symbols_loaded;
+  int32_t did_symbol_load_fail;
+  int32_t is_mapped;
+} libdb_Shared_Library;
+
 typedef struct {
   libdb_Symbol_Table symbol_table;
   int32_t pid;
@@ -31,16 +47,47 @@ typedef struct {
   libdb_Stop_Reason stop_reason;
   uint64_t rip;
   int64_t breakpoint_id;
+
+  //NOTE(Torin) Read end of the pipe the inferior's stdout and stderr are
+  //attached to, nonblocking, -1 when there is none
+  int32_t output_fd;
+
+  //NOTE(Torin) Set when the program is a core dump rather than a live
+  //process, registers and memory then come from the core
+  libdb_Core *core;
+  uint32_t thread_index;
+  int32_t signal_number;
+
+  //NOTE(Torin) Found by following DT_DEBUG once the loader has run, zero
+  //for static executables and before the program reaches its entry point
+  uint64_t debug_rendezvous_address;
+  libdb_Shared_Library *shared_libraries;
+  uint32_t shared_library_count;
+  uint32_t shared_library_capacity;
 } libdb_Program;
 
 int32_t libdb_program_open(const char *executable_path, libdb_Program *program);
 int32_t libdb_program_update_state(libdb_Program *program);
 
+int32_t libdb_program_open_core(const char *executable_path, const char *core_path, libdb_Program *program);
+void libdb_program_close_core(libdb_Program *program);
+
+uint32_t libdb_get_thread_count(libdb_Program *program);
+void libdb_select_thread(libdb_Program *program, uint32_t thread_index);
+uint64_t libdb_get_register(libdb_Program *program, uint32_t register_index);
+uint64_t libdb_read_memory(libdb_Program *program, uint64_t address, void *buffer, uint64_t size);
+
+const libdb_Symbol_Table *libdb_shared_library_get_symbols(libdb_Program *program, uint32_t library_index);
+uint64_t libdb_find_function_address(libdb_Program *program, const char *function_name);
+const char *libdb_find_function_name(libdb_Program *program, uint64_t address, uint64_t *offset);
+
 int libdb_execution_continue(libdb_Program *program);
 void libdb_exectuion_step_over(libdb_Program *program);
 void libdb_execution_step_into(libdb_Program *program);
 void libdb_exeuction_step_out(libdb_Program *program);
 
+int64_t libdb_program_read_output(libdb_Program *program, char *buffer, uint64_t buffer_size);
+
 int64_t libdb_breakpoint_create_at_symbol(const char *symbol_name, libdb_Program *program);
 int64_t libdb_breakpoint_create_at_location(const char *filename, int64_t line_number, libdb_Program *program);
 void libdb_breakpoint_destroy(int64_t breakpoint_id);
@@ -51,7 +98,12 @@ void libdb_breakpoint_destroy(int64_t breakpoint_id);
 #undef LIBDB_IMPLEMENTATION
 
 #include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
 #include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/ptrace.h>
 #include <sys/wait.h>
@@ -60,6 +112,10 @@ void libdb_breakpoint_destroy(int64_t breakpoint_id);
 #include <stdio.h>
 #include <string.h>
 
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
 #define R15	0
 #define R14	1
 #define R13	2
@@ -115,23 +171,92 @@ void libdb_breakpoint_destroy(int64_t breakpoint_id);
 #define libdb_free(ptr) free(ptr)
 #endif//libdb_free
 
-#define LIBDB_BREAKPOINT_CAPACITY 16
+#define LIBDB_BREAKPOINT_CAPACITY 64
+#define LIBDB_OUTPUT_PIPE_SIZE (1024 * 1024)
+#define LIBDB_SYMBOL_NAME_CAPACITY 128
+
+//NOTE(Torin) A pending breakpoint names a function no loaded object has yet
+//and is planted when a library providing it shows up. Entry and loader
+//breakpoints are libdb's own, they drive shared library tracking and are
+//never reported as stops
+typedef enum {
+  libdb_Breakpoint_Kind_USER,
+  libdb_Breakpoint_Kind_PENDING,
+  libdb_Breakpoint_Kind_ENTRY,
+  libdb_Breakpoint_Kind_LOADER,
+} libdb_Breakpoint_Kind;
 
 typedef struct {
   uint64_t instruction_address;
   uint64_t replaced_memory;
+  libdb_Breakpoint_Kind kind;
+  char symbol_name[LIBDB_SYMBOL_NAME_CAPACITY];
 } libdb_Breakpoint;
 
 typedef struct {
   uint64_t breakpoint_addresses[LIBDB_BREAKPOINT_CAPACITY];
 } libdb_Internal;
 
-static libdb_Breakpoint _breakpoints[16];
+static libdb_Breakpoint _breakpoints[LIBDB_BREAKPOINT_CAPACITY];
 static uint32_t _breakpoint_count = 0;
 
+static void libdb_shared_library_handle_breakpoint(libdb_Program *program, libdb_Breakpoint *breakpoint);
+static uint64_t libdb_shared_library_find_function(libdb_Program *program, const char *function_name);
+static void libdb_shared_library_begin_tracking(libdb_Program *program);
+static void libdb_shared_library_free(libdb_Shared_Library *library);
+
 #define ELF64_IMPLEMENTATION
 #include "elf64.h"
 
+//NOTE(Torin) A core dump is mapped whole and never copied, the PT_LOAD
+//segments, register sets and file table all point straight into the
+//mapping so opening a core costs the same no matter how big it is. Pages
+//the kernel did not dump (read only file mappings) are read from the
+//files listed in NT_FILE, mapped the first time they are needed.
+
+typedef struct {
+  int32_t pid;
+  int32_t signal_number;
+  const uint64_t *registers;
+  const uint8_t *fp_registers;
+} libdb_Core_Thread;
+
+typedef struct {
+  uint64_t virtual_address;
+  uint64_t memory_size;
+  uint64_t file_size;
+  //NOTE(Torin) The p_filesz bytes the kernel wrote, file_size is less when
+  //the core was cut short
+  uint64_t dumped_size;
+  const uint8_t *data;
+} libdb_Core_Segment;
+
+typedef struct {
+  uint64_t start;
+  uint64_t end;
+  uint64_t file_offset;
+  const char *path;
+  const uint8_t *data;
+  uint64_t data_size;
+  int32_t map_failed;
+} libdb_Core_File;
+
+struct libdb_Core {
+  const uint8_t *data;
+  uint64_t size;
+  uint64_t page_size;
+
+  libdb_Core_Thread *threads;
+  uint32_t thread_count;
+  libdb_Core_Segment *segments;
+  uint32_t segment_count;
+  libdb_Core_File *files;
+  uint32_t file_count;
+
+  const uint64_t *auxv;
+  uint64_t auxv_count;
+};
+
 static const char* libdb_SIGNAL_NAME_LIST[] = {
   "NULL SIGNAL",
   "SIGHUP",
@@ -167,19 +292,37 @@ static const char* libdb_SIGNAL_NAME_LIST[] = {
   "SIGSYS",
 };
 
+uint64_t libdb_get_register(libdb_Program *program, uint32_t register_index) {
+  libdb_assert(register_index < ELF_CORE_REGISTER_COUNT);
+  if (program->core != NULL) {
+    return program->core->threads[program->thread_index].registers[register_index];
+  }
+  uint64_t result = ptrace(PTRACE_PEEKUSER, program->pid, register_index * 8, 0);
+  return result;
+}
+
 uint64_t libdb_get_rip(libdb_Program *program) {
-  uint64_t result = ptrace(PTRACE_PEEKUSER, program->pid, RIP * 8, 0);
+  uint64_t result = libdb_get_register(program, RIP);
   return result;
 }
 
 uint64_t libdb_get_instruction(libdb_Program *program, uint64_t address) {
-  uint64_t result = ptrace(PTRACE_PEEKTEXT, program->pid, address);
+  uint64_t result = 0;
+  if (program->core != NULL) {
+    libdb_read_memory(program, address, &result, sizeof(result));
+    return result;
+  }
+  result = ptrace(PTRACE_PEEKTEXT, program->pid, address);
   return result;
 
 }
 
 int libdb_execution_continue(libdb_Program *program) {
   libdb_assert(program->state != libdb_Program_State_RUNNING);
+  if (program->core != NULL) {
+    libdb_log_error("a core dump cannot be continued");
+    return 0;
+  }
 
   if (program->breakpoint_id != -1) {
     libdb_Breakpoint *bp = &_breakpoints[program->breakpoint_id];
@@ -251,38 +394,59 @@ void libdb_exeuction_step_out(libdb_Program *program) {
 
 }
 
+static void
+libdb_breakpoint_insert(libdb_Program *program, libdb_Breakpoint *breakpoint, uint64_t address) {
+  breakpoint->instruction_address = address;
+  breakpoint->replaced_memory = ptrace(PTRACE_PEEKTEXT, program->pid, address, NULL);
+  uint64_t new_data = (0xFFFFFFFFFFFFFF00 & breakpoint->replaced_memory) | 0xCC;
+  ptrace(PTRACE_POKETEXT, program->pid, address, new_data);
+}
+
+static libdb_Breakpoint *
+libdb_breakpoint_allocate(libdb_Breakpoint_Kind kind, const char *symbol_name) {
+  if (_breakpoint_count == LIBDB_BREAKPOINT_CAPACITY) {
+    libdb_log_error("breakpoint_create: all %d breakpoints are in use", LIBDB_BREAKPOINT_CAPACITY);
+    return NULL;
+  }
+  libdb_Breakpoint *breakpoint = &_breakpoints[_breakpoint_count++];
+  breakpoint->instruction_address = 0;
+  breakpoint->replaced_memory = 0;
+  breakpoint->kind = kind;
+  breakpoint->symbol_name[0] = 0;
+  if (symbol_name != NULL) {
+    strncpy(breakpoint->symbol_name, symbol_name, LIBDB_SYMBOL_NAME_CAPACITY - 1);
+    breakpoint->symbol_name[LIBDB_SYMBOL_NAME_CAPACITY - 1] = 0;
+  }
+  return breakpoint;
+}
+
 int64_t libdb_breakpoint_create_at_symbol(const char *symbolName, libdb_Program *program)
 {
   //TODO(Torin) Make sure the process is stoped here
   //for testing purposes this is ignored for now because breakpoints
   //are only created while the process is stopped
   libdb_assert(program->state = libdb_Program_State_STOPPED);
+  if (program->core != NULL) {
+    libdb_log_error("breakpoints cannot be set in a core dump");
+    return -1;
+  }
 
-  libdb_Symbol_Table *symTable = &program->symbol_table;
-  const char *currentFunctionName = symTable->functionNames;
-  for (uint32_t i = 0; i < symTable->functionCount; i++) {
-
-    if (strcmp(currentFunctionName, symbolName) == 0) {
-      libdb_Breakpoint *breakpoint = &_breakpoints[_breakpoint_count];
-      breakpoint->instruction_address = symTable->functionAddresses[i];
-
-      breakpoint->replaced_memory = ptrace(PTRACE_PEEKTEXT, program->pid,
-       breakpoint->instruction_address, NULL);
-      ptrace(PTRACE_POKETEXT, program->pid, breakpoint->instruction_address, 0xCC);
-
-      libdb_log_info("breakpoint-create: function %s 0x%lX",
-          symbolName, breakpoint->instruction_address);
-      int64_t breakpointID = _breakpoint_count;
-      _breakpoint_count++;
-      return breakpointID;
-    }
+  uint64_t address = libdb_find_function_address(program, symbolName);
+  libdb_Breakpoint *breakpoint = libdb_breakpoint_allocate(
+    address ? libdb_Breakpoint_Kind_USER : libdb_Breakpoint_Kind_PENDING, symbolName);
+  if (breakpoint == NULL) return -1;
+  int64_t breakpointID = breakpoint - _breakpoints;
 
-    currentFunctionName += strlen(currentFunctionName) + 1;
+  if (address == 0) {
+    libdb_log_info("breakpoint-create: function %s is not loaded yet, "
+        "the breakpoint is pending", symbolName);
+    return breakpointID;
   }
 
-  libdb_log_error("breakpoint_create: failed to create breakpoint "
-      "could not resolve symbol %s", symbolName);
-  return 0;
+  libdb_breakpoint_insert(program, breakpoint, address);
+  libdb_log_info("breakpoint-create: function %s 0x%lX",
+      symbolName, breakpoint->instruction_address);
+  return breakpointID;
 }
 
 int libdb_program_update_state(libdb_Program *program) {
@@ -330,6 +494,14 @@ int libdb_program_update_state(libdb_Program *program) {
             if (program->breakpoint_id == -1) {
               assert(0);
             }
+
+            libdb_Breakpoint *breakpoint = &_breakpoints[program->breakpoint_id];
+            if (breakpoint->kind == libdb_Breakpoint_Kind_ENTRY ||
+                breakpoint->kind == libdb_Breakpoint_Kind_LOADER) {
+              libdb_shared_library_handle_breakpoint(program, breakpoint);
+              libdb_execution_continue(program);
+              return 0;
+            }
           }
         } else {
           libdb_log_debug("UNHANLDED STOP SIGNAL");
@@ -341,17 +513,79 @@ int libdb_program_update_state(libdb_Program *program) {
   return 0;
 }
 
-size_t leb128_decode_uint64(uint8_t *input, uint64_t *result) {
+//NOTE(Torin) Buffers leb128 values are decoded from must have this many
+//readable bytes past their end so a value can be read with one 8 byte load
+#define LIBDB_LEB128_PADDING 8
+
+//NOTE(Torin) One byte at a time, used for values longer than 8 bytes and as
+//the reference the fast path is tested against. Stops after 10 bytes, a
+//uint64 never needs more
+static size_t
+leb128_decode_uint64_bytewise(const uint8_t *input, uint64_t *result) {
+  uint64_t value = 0;
   size_t bytes_consumed = 0;
-  *result = 0;
   while (1) {
-    *result |= ((input[bytes_consumed]  & 0x7F) << (7 * bytes_consumed));
+    uint8_t byte = input[bytes_consumed];
+    if (bytes_consumed < 10)
+      value |= (uint64_t)(byte & 0x7F) << (7 * bytes_consumed);
     bytes_consumed++;
-    if (!(input[bytes_consumed] & 0x80)) break;
+    if (!(byte & 0x80) || bytes_consumed == 10) break;
   }
+  *result = value;
   return bytes_consumed;
 }
 
+static inline
+uint64_t leb128_pack_bytes(uint64_t bytes) {
+#ifdef __BMI2__
+  return _pext_u64(bytes, 0x7F7F7F7F7F7F7F7FULL);
+#else
+  //NOTE(Torin) Squeezes the 7 bit groups together, pairs then quads then all 8
+  bytes &= 0x7F7F7F7F7F7F7F7FULL;
+  bytes = (bytes & 0x007F007F007F007FULL) | ((bytes >> 1) & 0x3F803F803F803F80ULL);
+  bytes = (bytes & 0x00003FFF00003FFFULL) | ((bytes >> 2) & 0x0FFFC0000FFFC000ULL);
+  bytes = (bytes & 0x000000000FFFFFFFULL) | ((bytes >> 4) & 0x00FFFFFFF0000000ULL);
+  return bytes;
+#endif
+}
+
+//NOTE(Torin) Values of one or two bytes, most of them in DWARF, are decoded
+//from a 16 bit load without branching on the length. Longer values come from
+//one 8 byte load: the first byte without its continuation bit set ends the
+//value and the 7 bit groups before it are packed together
+size_t leb128_decode_uint64(uint8_t *input, uint64_t *result) {
+  uint16_t pair = 0;
+  memcpy(&pair, input, sizeof(pair));
+  if ((pair & 0x8080) != 0x8080) {
+    uint64_t is_two_bytes = (pair >> 7) & 1;
+    uint64_t bytes = pair & (0x007F | (is_two_bytes * 0x7F00));
+    *result = (bytes & 0x7F) | ((bytes >> 1) & 0x3F80);
+    return 1 + is_two_bytes;
+  }
+
+  uint64_t bytes = 0;
+  memcpy(&bytes, input, sizeof(bytes));
+  uint64_t end_bits = ~bytes & 0x8080808080808080ULL;
+  if (end_bits == 0) return leb128_decode_uint64_bytewise(input, result);
+  size_t length = (__builtin_ctzll(end_bits) + 1) / 8;
+  bytes &= ~0ULL >> (64 - (8 * length));
+  *result = leb128_pack_bytes(bytes);
+  return length;
+}
+
+size_t leb128_decode_int64(uint8_t *input, int64_t *result) {
+  uint64_t value = 0;
+  size_t length = leb128_decode_uint64(input, &value);
+  uint32_t bit_count = 7 * (uint32_t)length;
+  if (bit_count < 64) {
+    uint32_t unused_bits = 64 - bit_count;
+    *result = (int64_t)(value << unused_bits) >> unused_bits;
+  } else {
+    *result = (int64_t)value;
+  }
+  return length;
+}
+
 
 int strings_match(const char *a, const char *b) {
   size_t index = 0;
@@ -406,7 +640,96 @@ uint64_t dw_get_form_size(uint64_t form) {
 }
 
 
-int libdb_program_open(const char* path, libdb_Program *program) {
+//NOTE(Torin) Never blocks, returns the number of bytes read which is 0 when
+//the inferior has not written anything since the last call
+int64_t libdb_program_read_output(libdb_Program *program, char *buffer, uint64_t buffer_size) {
+  if (program->output_fd == -1) return 0;
+  ssize_t result = read(program->output_fd, buffer, buffer_size);
+  if (result == -1) {
+    if (errno != EAGAIN && errno != EINTR) {
+      libdb_log_error("failed to read program output: %s", strerror(errno));
+    }
+    return 0;
+  }
+  return result;
+}
+
+//NOTE(Torin) STT_GNU_IFUNC symbols are functions too, their address is the
+//resolver the loader calls to pick an implementation
+static int
+libdb_symbol_is_function(const ELFSymbol *symbol) {
+  if (symbol->sectionTableIndex == 0) return 0;
+  return symbol->type == ELF_SYMBOL_TYPE_FUNCTION || symbol->type == ELF_SYMBOL_TYPE_GNU_IFUNC;
+}
+
+//NOTE(Torin) Function and file symbols are copied out of an ELF symbol
+//table, load_bias is added to every address so shared libraries end up
+//with the addresses they actually run at
+static void
+libdb_symbol_table_build(libdb_Symbol_Table *symTable, const ELFSymbol *symbolTableData,
+  uint32_t symbolTableEntryCount, const char *symbolStringTableData, uint64_t load_bias)
+{
+  uint64_t functionSymbolCount = 0;
+  uint64_t functionStringMemoryRequirement = 0;
+  uint64_t fileSymbolCount = 0;
+  uint64_t fileStringMemoryRequirement = 0;
+
+  for (uint32_t i = 1; i < symbolTableEntryCount; i++) {
+    const ELFSymbol *symbol = &symbolTableData[i];
+    const char *symbolName = symbol->nameOffset + symbolStringTableData;
+    if (libdb_symbol_is_function(symbol)) {
+      functionSymbolCount++;
+      functionStringMemoryRequirement += strlen(symbolName) + 1;
+    } else if (symbol->type == ELF_SYMBOL_TYPE_FILE) {
+      fileSymbolCount++;
+      fileStringMemoryRequirement += strlen(symbolName) + 1;
+    }
+  }
+
+  size_t requiredSymbolTableMemory  = (functionSymbolCount * sizeof(uint64_t)) +
+    functionStringMemoryRequirement + fileStringMemoryRequirement;
+  uint8_t *symbolTableMemory = (uint8_t *)libdb_malloc(requiredSymbolTableMemory);
+
+  //NOTE(Torin) Addresses go first so they stay aligned
+  symTable->functionAddresses = (uintptr_t *)symbolTableMemory;
+  symTable->functionNames = (const char *)(symTable->functionAddresses + functionSymbolCount);
+  symTable->fileNames = symTable->functionNames + functionStringMemoryRequirement;
+  symTable->functionCount = functionSymbolCount;
+  symTable->fileCount = fileSymbolCount;
+
+  uint32_t currentFunctionIndex = 0;
+  uint32_t currentFileIndex = 0;
+  char *functionNameWrite = (char *)symTable->functionNames;
+  char *fileNameWrite = (char *)symTable->fileNames;
+  for (uint32_t i = 1; i < symbolTableEntryCount; i++) {
+    const ELFSymbol *symbol = &symbolTableData[i];
+    const char *symbolName = symbol->nameOffset + symbolStringTableData;
+    uintptr_t symbolAddress = symbol->symbolValue + load_bias;
+
+    if (libdb_symbol_is_function(symbol)) {
+      size_t symbolNameLength = strlen(symbolName);
+      memcpy(functionNameWrite, symbolName, symbolNameLength);
+      functionNameWrite[symbolNameLength] = 0;
+      functionNameWrite += symbolNameLength + 1;
+      symTable->functionAddresses[currentFunctionIndex] = symbolAddress;
+      currentFunctionIndex++;
+    } else if(symbol->type == ELF_SYMBOL_TYPE_FILE) {
+      size_t symbolNameLength = strlen(symbolName);
+      memcpy(fileNameWrite, symbolName, symbolNameLength);
+      fileNameWrite[symbolNameLength] = 0;
+      fileNameWrite += symbolNameLength + 1;
+      currentFileIndex++;
+    }
+  }
+
+  assert(currentFunctionIndex == symTable->functionCount);
+  assert(currentFileIndex == symTable->fileCount);
+}
+
+//NOTE(Torin) Reads the symbol table and debug info of the executable,
+//returns 0 on failure
+static int
+libdb_program_load_executable(const char* path, libdb_Program *program) {
   FILE *file_handle = fopen(path, "rb");
   if(file_handle == NULL){
     libdb_log_error("Could not find exectuable file %s when attempting to open program", path);
@@ -416,8 +739,9 @@ int libdb_program_open(const char* path, libdb_Program *program) {
   fseek(file_handle, 0, SEEK_END);
   size_t file_size = ftell(file_handle);
   fseek(file_handle, 0, SEEK_SET);
-  uint8_t *fileData = (uint8_t *)libdb_malloc(file_size);
+  uint8_t *fileData = (uint8_t *)libdb_malloc(file_size + LIBDB_LEB128_PADDING);
   fread(fileData, 1, file_size, file_handle);
+  memset(fileData + file_size, 0, LIBDB_LEB128_PADDING);
   fclose(file_handle);
 
   ELF64Header* header = (ELF64Header*)fileData;
@@ -473,10 +797,21 @@ int libdb_program_open(const char* path, libdb_Program *program) {
   }
 
 
-  if(debug_info_section == 0){ libdb_log_error("could not find .debug_info section header"); return 0; }
-  if(debug_abbrev_section == 0){ libdb_log_error("could not find .debug_abbrev section header"); return 0; }
-  if(debug_str_section == 0) { libdb_log_error("could not find .debug_str section header"); return 0; }
-  if(debug_line_section == 0) { libdb_log_error("could not find .debug_line section header"); return 0; }
+  assert(symbolTableHeader != NULL);
+  assert(stringTableHeader != NULL);
+  assert(symbolTableEntryCount > 1);
+  ELFSymbol *symbolTableData =
+    (ELFSymbol*)(symbolTableHeader->fileOffsetOfSectionData + fileData);
+
+  libdb_symbol_table_build(&program->symbol_table, symbolTableData,
+    symbolTableEntryCount, symbolStringTableData, 0);
+
+  //NOTE(Torin) Without debug info the program can still be run and broken
+  //into by function name
+  if(debug_info_section == 0){ libdb_log_error("could not find .debug_info section header"); return 1; }
+  if(debug_abbrev_section == 0){ libdb_log_error("could not find .debug_abbrev section header"); return 1; }
+  if(debug_str_section == 0) { libdb_log_error("could not find .debug_str section header"); return 1; }
+  if(debug_line_section == 0) { libdb_log_error("could not find .debug_line section header"); return 1; }
 
 
   typedef struct {
@@ -746,12 +1081,11 @@ int libdb_program_open(const char* path, libdb_Program *program) {
         }break;
 
         case DW_LNS_advance_line:{
-          uint64_t increment = 0;
+          int64_t increment = 0;
           current_instruction_offset++;
-          current_instruction_offset += leb128_decode_uint64(statement_program + current_instruction_offset, &increment);
+          current_instruction_offset += leb128_decode_int64(statement_program + current_instruction_offset, &increment);
           line += increment;
-          libdb_log_debug("Advance line by %lu to %lu", increment, line);
-          current_instruction_offset++;
+          libdb_log_debug("Advance line by %ld to %lu", increment, line);
         }break;
 
         case DW_LNS_set_file:{
@@ -908,74 +1242,41 @@ int libdb_program_open(const char* path, libdb_Program *program) {
 
   }
 
-  assert(symbolTableHeader != NULL);
-  assert(stringTableHeader != NULL);
-  assert(symbolTableEntryCount > 1);
-  ELFSymbol *symbolTableData =
-    (ELFSymbol*)(symbolTableHeader->fileOffsetOfSectionData + fileData);
-
-  uint64_t functionSymbolCount = 0;
-  uint64_t functionStringMemoryRequirement = 0;
-  uint64_t fileSymbolCount = 0;
-  uint64_t fileStringMemoryRequirement = 0;
-
-  for (uint32_t i = 1; i < symbolTableEntryCount; i++) {
-    ELFSymbol *symbol = &symbolTableData[i];
-    const char *symbolName = symbol->nameOffset + symbolStringTableData;
-    uintptr_t symbolAddress = symbol->symbolValue;
-    if (symbol->type == ELF_SYMBOL_TYPE_FUNCTION) {
-      functionSymbolCount++;
-      functionStringMemoryRequirement += strlen(symbolName) + 1;
-    } else if (symbol->type == ELF_SYMBOL_TYPE_FILE) {
-      fileSymbolCount++;
-      fileStringMemoryRequirement += strlen(symbolName) + 1;
-    }
-  }
-
-  size_t requiredSymbolTableMemory  = (functionSymbolCount * sizeof(uint64_t)) +
-    functionStringMemoryRequirement + fileStringMemoryRequirement;
-  uint8_t *symbolTableMemory = (uint8_t *)libdb_malloc(requiredSymbolTableMemory);
 
-  libdb_Symbol_Table *symTable = &program->symbol_table;
-  symTable->functionNames = (const char *)symbolTableMemory;
-  symTable->functionAddresses = (uintptr_t *)(symbolTableMemory +
-      functionStringMemoryRequirement);
-  symTable->fileNames = (const char *)symTable->functionAddresses + functionSymbolCount;
-  symTable->functionCount = functionSymbolCount;
-  symTable->fileCount = fileSymbolCount;
-
-  uint32_t currentFunctionIndex = 0;
-  uint32_t currentFileIndex = 0;
-  char *functionNameWrite = (char *)symTable->functionNames;
-  char *fileNameWrite = (char *)symTable->fileNames;
-  for (uint32_t i = 1; i < symbolTableEntryCount; i++) {
-    ELFSymbol *symbol = &symbolTableData[i];
-    const char *symbolName = symbol->nameOffset + symbolStringTableData;
-    uintptr_t symbolAddress = symbol->symbolValue;
-
-    if (symbol->type == ELF_SYMBOL_TYPE_FUNCTION) {
-      size_t symbolNameLength = strlen(symbolName);
-      memcpy(functionNameWrite, symbolName, symbolNameLength);
-      functionNameWrite[symbolNameLength] = 0;
-      functionNameWrite += symbolNameLength + 1;
-      symTable->functionAddresses[currentFunctionIndex] = symbolAddress;
-      currentFunctionIndex++;
-    } else if(symbol->type == ELF_SYMBOL_TYPE_FILE) {
-      size_t symbolNameLength = strlen(symbolName);
-      memcpy(fileNameWrite, symbolName, symbolNameLength);
-      fileNameWrite[symbolNameLength] = 0;
-      fileNameWrite += symbolNameLength + 1;
-      currentFileIndex++;
-    }
-  }
+  return 1;
+}
 
-  assert(currentFunctionIndex == symTable->functionCount);
-  assert(currentFileIndex == symTable->fileCount);
+int libdb_program_open(const char* path, libdb_Program *program) {
+  if (!libdb_program_load_executable(path, program)) return 0;
 
   program->state = libdb_Program_State_STOPPED;
   program->stop_reason = libdb_Stop_Reason_NONE;
   program->breakpoint_id = -1;
   program->rip = 0;
+  program->core = NULL;
+  program->thread_index = 0;
+  program->signal_number = 0;
+  program->debug_rendezvous_address = 0;
+  program->shared_libraries = NULL;
+  program->shared_library_count = 0;
+  program->shared_library_capacity = 0;
+
+  //NOTE(Torin) A pipe rather than a pty so the inferior can write as fast
+  //as it likes; the default 64k pipe is grown so a frontend that only drains
+  //it once a frame does not throttle a chatty program
+  int output_pipe[2];
+  program->output_fd = -1;
+  if (pipe(output_pipe) == -1) {
+    libdb_log_error("failed to create output pipe: %s", strerror(errno));
+    output_pipe[0] = output_pipe[1] = -1;
+  } else {
+    fcntl(output_pipe[0], F_SETFD, FD_CLOEXEC);
+    fcntl(output_pipe[1], F_SETFD, FD_CLOEXEC);
+    fcntl(output_pipe[0], F_SETFL, O_NONBLOCK);
+#ifdef F_SETPIPE_SZ
+    fcntl(output_pipe[0], F_SETPIPE_SZ, LIBDB_OUTPUT_PIPE_SIZE);
+#endif
+  }
 
   pid_t pid = fork();
   program->pid = pid;
@@ -983,10 +1284,14 @@ int libdb_program_open(const char* path, libdb_Program *program) {
   if (pid == -1) {
     return 1;
   } else if (pid == 0) {
-    char* const args[] = { NULL };
+    char* const args[] = { (char *)path, NULL };
     char* const envp[] = { NULL };
+    if (output_pipe[1] != -1) {
+      dup2(output_pipe[1], STDOUT_FILENO);
+      dup2(output_pipe[1], STDERR_FILENO);
+    }
     ptrace(PTRACE_TRACEME, NULL, NULL);
-    execve("test", args, envp);
+    execve(path, args, envp);
     libdb_log_error("the child process failed to execute\n");
     return 1;
   } else {
@@ -1001,10 +1306,731 @@ int libdb_program_open(const char* path, libdb_Program *program) {
     }
   }
 
+  if (output_pipe[1] != -1) {
+    close(output_pipe[1]);
+    program->output_fd = output_pipe[0];
+  }
+
   libdb_log_debug("childpid is %d", pid);
 
+  libdb_shared_library_begin_tracking(program);
+  return 0;
+}
+
+#define libdb_align4(value) (((value) + 3) & ~(uint64_t)3)
+
+static int
+libdb_core_segment_compare(const void *a, const void *b) {
+  const libdb_Core_Segment *segment_a = (const libdb_Core_Segment *)a;
+  const libdb_Core_Segment *segment_b = (const libdb_Core_Segment *)b;
+  if (segment_a->virtual_address < segment_b->virtual_address) return -1;
+  if (segment_a->virtual_address > segment_b->virtual_address) return 1;
+  return 0;
+}
+
+static void
+libdb_core_parse_file_note(libdb_Core *core, const uint8_t *descriptor, uint64_t size) {
+  if (size < sizeof(ELFCoreFileNoteHeader)) return;
+  const ELFCoreFileNoteHeader *header = (const ELFCoreFileNoteHeader *)descriptor;
+  uint64_t entries_size = header->count * sizeof(ELFCoreFileNoteEntry);
+  if (header->count > size || entries_size > size - sizeof(ELFCoreFileNoteHeader)) return;
+
+  const ELFCoreFileNoteEntry *entries = (const ELFCoreFileNoteEntry *)(header + 1);
+  const char *path = (const char *)(entries + header->count);
+  const char *end = (const char *)descriptor + size;
+  core->files = (libdb_Core_File *)libdb_malloc(sizeof(libdb_Core_File) * header->count);
+  core->page_size = header->pageSize;
+  for (uint64_t i = 0; i < header->count && path < end; i++) {
+    size_t path_length = strnlen(path, end - path);
+    if (path + path_length == end) break;
+    libdb_Core_File *file = &core->files[core->file_count++];
+    file->start = entries[i].start;
+    file->end = entries[i].end;
+    file->file_offset = entries[i].fileOffset * header->pageSize;
+    file->path = path;
+    file->data = NULL;
+    file->data_size = 0;
+    file->map_failed = 0;
+    path += path_length + 1;
+  }
+}
+
+//NOTE(Torin) Walks every note in every PT_NOTE segment, the first pass only
+//counts threads so the second can fill a single allocation
+static void
+libdb_core_parse_notes(libdb_Core *core, const ELFProgramHeader *program_headers, uint32_t count) {
+  for (uint32_t pass = 0; pass < 2; pass++) {
+    if (pass == 1) {
+      core->threads = (libdb_Core_Thread *)libdb_malloc(sizeof(libdb_Core_Thread) * core->thread_count);
+      core->thread_count = 0;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+      const ELFProgramHeader *program_header = &program_headers[i];
+      if (program_header->type != ELF_PROGRAM_TYPE_NOTE) continue;
+      if (program_header->fileOffset > core->size ||
+          program_header->fileSize > core->size - program_header->fileOffset) continue;
+
+      const uint8_t *current = core->data + program_header->fileOffset;
+      const uint8_t *end = current + program_header->fileSize;
+      while ((uint64_t)(end - current) >= sizeof(ELFNoteHeader)) {
+        const ELFNoteHeader *note = (const ELFNoteHeader *)current;
+        uint64_t name_size = libdb_align4((uint64_t)note->nameSize);
+        uint64_t descriptor_size = libdb_align4((uint64_t)note->descriptorSize);
+        uint64_t remaining = (end - current) - sizeof(ELFNoteHeader);
+        if (name_size > remaining || descriptor_size > remaining - name_size) break;
+        const uint8_t *descriptor = current + sizeof(ELFNoteHeader) + name_size;
+        current = descriptor + descriptor_size;
+
+        if (note->type == ELF_NOTE_TYPE_PRSTATUS) {
+          if (note->descriptorSize < sizeof(ELFCorePRStatus)) continue;
+          if (pass == 0) { core->thread_count++; continue; }
+          const ELFCorePRStatus *status = (const ELFCorePRStatus *)descriptor;
+          libdb_Core_Thread *thread = &core->threads[core->thread_count++];
+          thread->pid = status->pid;
+          thread->signal_number = status->currentSignal;
+          thread->registers = status->registers;
+          thread->fp_registers = NULL;
+        } else if (note->type == ELF_NOTE_TYPE_FPREGSET) {
+          //NOTE(Torin) The fp registers of a thread follow its prstatus
+          if (pass == 0 || core->thread_count == 0) continue;
+          if (note->descriptorSize < ELF_CORE_FPREGSET_SIZE) continue;
+          core->threads[core->thread_count - 1].fp_registers = descriptor;
+        } else if (note->type == ELF_NOTE_TYPE_FILE) {
+          if (pass == 0 && core->files == NULL)
+            libdb_core_parse_file_note(core, descriptor, note->descriptorSize);
+        } else if (note->type == ELF_NOTE_TYPE_AUXV) {
+          if (pass == 0 && core->auxv == NULL) {
+            core->auxv = (const uint64_t *)descriptor;
+            core->auxv_count = note->descriptorSize / (2 * sizeof(uint64_t));
+          }
+        }
+      }
+    }
+  }
+}
+
+int32_t libdb_program_open_core(const char *executable_path, const char *core_path, libdb_Program *program) {
+  int fd = open(core_path, O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    libdb_log_error("could not open core file %s: %s", core_path, strerror(errno));
+    return 0;
+  }
+  struct stat core_stat;
+  if (fstat(fd, &core_stat) != 0 || (uint64_t)core_stat.st_size < sizeof(ELF64Header)) {
+    libdb_log_error("core file %s is too small to be an ELF file", core_path);
+    close(fd);
+    return 0;
+  }
+  uint64_t core_size = (uint64_t)core_stat.st_size;
+  void *mapping = mmap(NULL, core_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    libdb_log_error("could not map core file %s: %s", core_path, strerror(errno));
+    return 0;
+  }
+
+  const uint8_t *core_data = (const uint8_t *)mapping;
+  const ELF64Header *header = (const ELF64Header *)core_data;
+  uint64_t program_headers_size = (uint64_t)header->programHeaderEntryCount * sizeof(ELFProgramHeader);
+  if (header->magicNumber != ELF64_MAGIC_NUMBER ||
+      header->objectFileType != ELF_OBJ_TYPE_CORE ||
+      header->programHeaderEntrySize != sizeof(ELFProgramHeader) ||
+      header->programHeaderOffset > core_size ||
+      program_headers_size > core_size - header->programHeaderOffset) {
+    libdb_log_error("%s is not a valid ELF core file", core_path);
+    munmap(mapping, core_size);
+    return 0;
+  }
+
+  libdb_Core *core = (libdb_Core *)libdb_malloc(sizeof(libdb_Core));
+  memset(core, 0, sizeof(libdb_Core));
+  core->data = core_data;
+  core->size = core_size;
+
+  const ELFProgramHeader *program_headers =
+    (const ELFProgramHeader *)(core_data + header->programHeaderOffset);
+  uint32_t program_header_count = header->programHeaderEntryCount;
+  libdb_core_parse_notes(core, program_headers, program_header_count);
+  if (core->thread_count == 0) {
+    libdb_log_error("core file %s does not contain any threads", core_path);
+    libdb_free(core->threads);
+    libdb_free(core->files);
+    libdb_free(core);
+    munmap(mapping, core_size);
+    return 0;
+  }
+
+  core->segments = (libdb_Core_Segment *)libdb_malloc(sizeof(libdb_Core_Segment) * program_header_count);
+  for (uint32_t i = 0; i < program_header_count; i++) {
+    const ELFProgramHeader *program_header = &program_headers[i];
+    if (program_header->type != ELF_PROGRAM_TYPE_LOAD) continue;
+    if (program_header->memorySize == 0) continue;
+    libdb_Core_Segment *segment = &core->segments[core->segment_count++];
+    segment->virtual_address = program_header->virtualAddress;
+    segment->memory_size = program_header->memorySize;
+    segment->dumped_size = program_header->fileSize;
+    if (segment->dumped_size > segment->memory_size) segment->dumped_size = segment->memory_size;
+    //NOTE(Torin) A truncated core keeps whatever part of the segment made it
+    segment->file_size = 0;
+    segment->data = NULL;
+    if (program_header->fileOffset < core_size) {
+      uint64_t available = core_size - program_header->fileOffset;
+      segment->file_size = segment->dumped_size < available ? segment->dumped_size : available;
+      segment->data = core_data + program_header->fileOffset;
+    }
+  }
+  qsort(core->segments, core->segment_count, sizeof(libdb_Core_Segment), libdb_core_segment_compare);
+
+  //NOTE(Torin) Cleared first since libdb_program_close_core frees the
+  //shared library list when the executable cannot be loaded
+  program->debug_rendezvous_address = 0;
+  program->shared_libraries = NULL;
+  program->shared_library_count = 0;
+  program->shared_library_capacity = 0;
+  if (!libdb_program_load_executable(executable_path, program)) {
+    program->core = core;
+    libdb_program_close_core(program);
+    return 0;
+  }
+
+  program->core = core;
+  program->pid = core->threads[0].pid;
+  program->thread_index = 0;
+  program->signal_number = core->threads[0].signal_number;
+  program->state = libdb_Program_State_STOPPED;
+  program->stop_reason = libdb_Stop_Reason_SIGNAL;
+  program->breakpoint_id = -1;
+  program->output_fd = -1;
+  program->rip = core->threads[0].registers[RIP];
+  libdb_shared_library_begin_tracking(program);
+  return 1;
+}
+
+void libdb_program_close_core(libdb_Program *program) {
+  libdb_Core *core = program->core;
+  if (core == NULL) return;
+  for (uint32_t i = 0; i < program->shared_library_count; i++)
+    libdb_shared_library_free(&program->shared_libraries[i]);
+  libdb_free(program->shared_libraries);
+  program->shared_libraries = NULL;
+  program->shared_library_count = 0;
+  for (uint32_t i = 0; i < core->file_count; i++) {
+    if (core->files[i].data != NULL)
+      munmap((void *)core->files[i].data, core->files[i].data_size);
+  }
+  munmap((void *)core->data, core->size);
+  libdb_free(core->threads);
+  libdb_free(core->segments);
+  libdb_free(core->files);
+  libdb_free(core);
+  program->core = NULL;
+}
+
+uint32_t libdb_get_thread_count(libdb_Program *program) {
+  if (program->core == NULL) return 1;
+  return program->core->thread_count;
+}
+
+void libdb_select_thread(libdb_Program *program, uint32_t thread_index) {
+  if (program->core == NULL) return;
+  libdb_assert(thread_index < program->core->thread_count);
+  const libdb_Core_Thread *thread = &program->core->threads[thread_index];
+  program->thread_index = thread_index;
+  program->signal_number = thread->signal_number;
+  program->rip = thread->registers[RIP];
+}
+
+//NOTE(Torin) Returns the dumped segment holding address, NULL if no segment does
+static const libdb_Core_Segment *
+libdb_core_find_segment(const libdb_Core *core, uint64_t address) {
+  uint32_t low = 0, high = core->segment_count;
+  while (low < high) {
+    uint32_t middle = low + (high - low) / 2;
+    const libdb_Core_Segment *segment = &core->segments[middle];
+    if (address < segment->virtual_address) high = middle;
+    else if (address - segment->virtual_address >= segment->memory_size) low = middle + 1;
+    else return segment;
+  }
+  return NULL;
+}
+
+static uint64_t
+libdb_core_read_file_mapping(libdb_Core *core, uint64_t address, uint8_t *buffer, uint64_t size) {
+  for (uint32_t i = 0; i < core->file_count; i++) {
+    libdb_Core_File *file = &core->files[i];
+    if (address < file->start || address >= file->end) continue;
+    if (file->data == NULL && !file->map_failed) {
+      int fd = open(file->path, O_RDONLY | O_CLOEXEC);
+      struct stat file_stat;
+      if (fd != -1 && fstat(fd, &file_stat) == 0 && (uint64_t)file_stat.st_size > file->file_offset) {
+        uint64_t data_size = (uint64_t)file_stat.st_size - file->file_offset;
+        if (data_size > file->end - file->start) data_size = file->end - file->start;
+        //NOTE(Torin) NT_FILE offsets are page aligned so they can be mapped directly
+        void *mapping = mmap(NULL, data_size, PROT_READ, MAP_PRIVATE, fd, file->file_offset);
+        if (mapping != MAP_FAILED) {
+          file->data = (const uint8_t *)mapping;
+          file->data_size = data_size;
+        }
+      }
+      if (fd != -1) close(fd);
+      if (file->data == NULL) file->map_failed = 1;
+    }
+    if (file->data == NULL) return 0;
+    uint64_t offset = address - file->start;
+    if (offset >= file->data_size) return 0;
+    uint64_t count = file->data_size - offset < size ? file->data_size - offset : size;
+    memcpy(buffer, file->data + offset, count);
+    return count;
+  }
+  return 0;
+}
+
+//NOTE(Torin) Returns the number of bytes read, reads stop at the first
+//address that has no backing in the core or the process
+uint64_t libdb_read_memory(libdb_Program *program, uint64_t address, void *buffer, uint64_t size) {
+  uint8_t *write = (uint8_t *)buffer;
+  uint64_t bytes_read = 0;
+
+  if (program->core == NULL) {
+    while (bytes_read < size) {
+      uint64_t word_address = (address + bytes_read) & ~(uint64_t)7;
+      uint64_t word_offset = (address + bytes_read) - word_address;
+      errno = 0;
+      uint64_t word = ptrace(PTRACE_PEEKDATA, program->pid, word_address, NULL);
+      if (errno != 0) break;
+      uint64_t count = 8 - word_offset;
+      if (count > size - bytes_read) count = size - bytes_read;
+      memcpy(write + bytes_read, (uint8_t *)&word + word_offset, count);
+      bytes_read += count;
+    }
+    return bytes_read;
+  }
+
+  libdb_Core *core = program->core;
+  while (bytes_read < size) {
+    uint64_t current = address + bytes_read;
+    uint64_t remaining = size - bytes_read;
+    const libdb_Core_Segment *segment = libdb_core_find_segment(core, current);
+    if (segment == NULL) break;
+
+    uint64_t offset = current - segment->virtual_address;
+    uint64_t count = segment->memory_size - offset;
+    if (count > remaining) count = remaining;
+    if (offset < segment->file_size) {
+      if (count > segment->file_size - offset) count = segment->file_size - offset;
+      memcpy(write + bytes_read, segment->data + offset, count);
+    } else if (offset < segment->dumped_size) {
+      //NOTE(Torin) The core was cut off before these bytes, they are not zero
+      break;
+    } else {
+      //NOTE(Torin) Past the dumped bytes the page either came from a file
+      //the kernel did not bother dumping or is zero fill
+      uint64_t file_count = libdb_core_read_file_mapping(core, current, write + bytes_read, count);
+      if (file_count > 0) count = file_count;
+      else memset(write + bytes_read, 0, count);
+    }
+    bytes_read += count;
+  }
+  return bytes_read;
+}
+
+//NOTE(Torin) Shared libraries are found the way the dynamic loader
+//advertises them: DT_DEBUG in the executable's dynamic section points at
+//r_debug, which holds the head of the link_map list and the address of a
+//function the loader calls whenever the list changes. A live program gets
+//an internal breakpoint at its entry point, by which time the loader has
+//mapped everything it was linked against, and from there on one at the
+//loader's function to catch dlopen and dlclose. Symbols of a library are
+//only read when a lookup needs them.
+
+#define LIBDB_LINK_MAP_LIMIT 65536
+
+static uint64_t
+libdb_read_auxv(libdb_Program *program, uint64_t type) {
+  if (program->core != NULL) {
+    const uint64_t *auxv = program->core->auxv;
+    for (uint64_t i = 0; auxv != NULL && i < program->core->auxv_count; i++) {
+      if (auxv[i*2] == type) return auxv[i*2 + 1];
+    }
+    return 0;
+  }
+
+  char auxv_path[64];
+  snprintf(auxv_path, sizeof(auxv_path), "/proc/%d/auxv", program->pid);
+  int fd = open(auxv_path, O_RDONLY | O_CLOEXEC);
+  if (fd == -1) return 0;
+  uint64_t result = 0;
+  uint64_t entry[2];
+  while (read(fd, entry, sizeof(entry)) == sizeof(entry)) {
+    if (entry[0] == ELF_AUXV_TYPE_NULL) break;
+    if (entry[0] == type) { result = entry[1]; break; }
+  }
+  close(fd);
+  return result;
+}
+
+//NOTE(Torin) Reads the program headers out of the running image so this
+//works for position independent executables, returns the load bias and
+//where the dynamic section ended up
+static uint64_t
+libdb_get_executable_load_bias(libdb_Program *program, uint64_t *dynamic_address) {
+  *dynamic_address = 0;
+  uint64_t phdr_address = libdb_read_auxv(program, ELF_AUXV_TYPE_PHDR);
+  uint64_t phdr_count = libdb_read_auxv(program, ELF_AUXV_TYPE_PHNUM);
+  if (phdr_address == 0 || phdr_count == 0 || phdr_count > 0xFFFF) return 0;
+
+  uint64_t load_bias = 0;
+  for (uint64_t i = 0; i < phdr_count; i++) {
+    ELFProgramHeader program_header;
+    uint64_t address = phdr_address + i * sizeof(ELFProgramHeader);
+    if (libdb_read_memory(program, address, &program_header, sizeof(program_header)) != sizeof(program_header))
+      return 0;
+    if (program_header.type == ELF_PROGRAM_TYPE_PHDR)
+      load_bias = phdr_address - program_header.virtualAddress;
+    else if (program_header.type == ELF_PROGRAM_TYPE_DYNAMIC)
+      *dynamic_address = program_header.virtualAddress;
+  }
+  if (*dynamic_address != 0) *dynamic_address += load_bias;
+  return load_bias;
+}
+
+static uint64_t
+libdb_find_debug_rendezvous(libdb_Program *program) {
+  uint64_t dynamic_address = 0;
+  libdb_get_executable_load_bias(program, &dynamic_address);
+  if (dynamic_address == 0) return 0;
+
+  for (uint32_t i = 0; i < LIBDB_LINK_MAP_LIMIT; i++) {
+    ELFDynamicEntry entry;
+    uint64_t address = dynamic_address + i * sizeof(ELFDynamicEntry);
+    if (libdb_read_memory(program, address, &entry, sizeof(entry)) != sizeof(entry)) break;
+    if (entry.tag == ELF_DYNAMIC_TAG_NULL) break;
+    if (entry.tag == ELF_DYNAMIC_TAG_DEBUG) return entry.value;
+  }
   return 0;
 }
 
+static int
+libdb_shared_library_load_symbols(libdb_Shared_Library *library) {
+  if (library->are_symbols_loaded) return 1;
+  if (library->did_symbol_load_fail) return 0;
+  library->did_symbol_load_fail = 1;
+
+  int fd = open(library->path, O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    libdb_log_debug("shared-library: could not open %s", library->path);
+    return 0;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || (uint64_t)file_stat.st_size < sizeof(ELF64Header)) {
+    close(fd);
+    return 0;
+  }
+  uint64_t file_size = (uint64_t)file_stat.st_size;
+  void *mapping = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) return 0;
+
+  const uint8_t *file_data = (const uint8_t *)mapping;
+  const ELF64Header *header = (const ELF64Header *)file_data;
+  uint64_t section_headers_size = (uint64_t)header->sectionHeaderEntryCount * sizeof(ELFSectionHeader);
+  uint64_t program_headers_size = (uint64_t)header->programHeaderEntryCount * sizeof(ELFProgramHeader);
+  if (header->magicNumber != ELF64_MAGIC_NUMBER ||
+      header->sectionHeaderOffset > file_size ||
+      section_headers_size > file_size - header->sectionHeaderOffset ||
+      header->programHeaderOffset > file_size ||
+      program_headers_size > file_size - header->programHeaderOffset) {
+    libdb_log_error("shared library \"%s\" is not a valid ELF binary", library->path);
+    munmap(mapping, file_size);
+    return 0;
+  }
+
+  const ELFProgramHeader *program_headers =
+    (const ELFProgramHeader *)(file_data + header->programHeaderOffset);
+  for (uint32_t i = 0; i < header->programHeaderEntryCount; i++) {
+    if (program_headers[i].type != ELF_PROGRAM_TYPE_LOAD) continue;
+    uint64_t end = program_headers[i].virtualAddress + program_headers[i].memorySize;
+    if (end > library->image_size) library->image_size = end;
+  }
+
+  //NOTE(Torin) System libraries are usually stripped, the dynamic symbol
+  //table is still there and has every exported function
+  const ELFSectionHeader *sections = (const ELFSectionHeader *)(file_data + header->sectionHeaderOffset);
+  const ELFSectionHeader *symbol_section = NULL;
+  for (uint32_t i = 0; i < header->sectionHeaderEntryCount; i++) {
+    if (sections[i].sectionType == ELF_SECTION_TYPE_SYMBOL_TABLE) {
+      symbol_section = &sections[i];
+      break;
+    } else if (sections[i].sectionType == ELF_SECTION_TYPE_DYNAMIC_SYMBOL_TABLE) {
+      symbol_section = &sections[i];
+    }
+  }
+
+  int result = 0;
+  if (symbol_section != NULL && symbol_section->sectionLink < header->sectionHeaderEntryCount) {
+    const ELFSectionHeader *string_section = &sections[symbol_section->sectionLink];
+    if (symbol_section->fileOffsetOfSectionData + symbol_section->sectionSize <= file_size &&
+        string_section->fileOffsetOfSectionData + string_section->sectionSize <= file_size &&
+        string_section->sectionSize > 0 &&
+        file_data[string_section->fileOffsetOfSectionData + string_section->sectionSize - 1] == 0) {
+      libdb_symbol_table_build(&library->symbol_table,
+        (const ELFSymbol *)(file_data + symbol_section->fileOffsetOfSectionData),
+        (uint32_t)(symbol_section->sectionSize / sizeof(ELFSymbol)),
+        (const char *)(file_data + string_section->fileOffsetOfSectionData),
+        library->base_address);
+      result = 1;
+    }
+  }
+
+  munmap(mapping, file_size);
+  if (result) {
+    library->are_symbols_loaded = 1;
+    library->did_symbol_load_fail = 0;
+    libdb_log_debug("shared-library: loaded %lu functions from %s",
+      library->symbol_table.functionCount, library->path);
+  }
+  return result;
+}
+
+static uint64_t
+libdb_symbol_table_find(const libdb_Symbol_Table *symbol_table, const char *function_name) {
+  const char *current_name = symbol_table->functionNames;
+  for (uint64_t i = 0; i < symbol_table->functionCount; i++) {
+    if (strcmp(current_name, function_name) == 0)
+      return symbol_table->functionAddresses[i];
+    current_name += strlen(current_name) + 1;
+  }
+  return 0;
+}
+
+static uint64_t
+libdb_shared_library_find_function(libdb_Program *program, const char *function_name) {
+  for (uint32_t i = 0; i < program->shared_library_count; i++) {
+    libdb_Shared_Library *library = &program->shared_libraries[i];
+    if (!libdb_shared_library_load_symbols(library)) continue;
+    uint64_t address = libdb_symbol_table_find(&library->symbol_table, function_name);
+    if (address != 0) return address;
+  }
+  return 0;
+}
+
+static void
+libdb_shared_library_free(libdb_Shared_Library *library) {
+  if (library->are_symbols_loaded)
+    libdb_free((void *)library->symbol_table.functionAddresses);
+  libdb_free(library->path);
+}
+
+static int
+libdb_read_string(libdb_Program *program, uint64_t address, char *buffer, uint64_t buffer_size) {
+  uint64_t length = 0;
+  while (length < buffer_size) {
+    uint64_t chunk_size = buffer_size - length < 64 ? buffer_size - length : 64;
+    uint64_t bytes_read = libdb_read_memory(program, address + length, buffer + length, chunk_size);
+    const char *terminator = (const char *)memchr(buffer + length, 0, bytes_read);
+    if (terminator != NULL) return 1;
+    if (bytes_read < chunk_size) break;
+    length += bytes_read;
+  }
+  buffer[0] = 0;
+  return 0;
+}
+
+static void
+libdb_shared_library_resolve_pending(libdb_Program *program) {
+  if (program->core != NULL) return;
+  for (uint32_t i = 0; i < _breakpoint_count; i++) {
+    libdb_Breakpoint *breakpoint = &_breakpoints[i];
+    if (breakpoint->kind != libdb_Breakpoint_Kind_PENDING) continue;
+    uint64_t address = libdb_shared_library_find_function(program, breakpoint->symbol_name);
+    if (address == 0) continue;
+    libdb_breakpoint_insert(program, breakpoint, address);
+    breakpoint->kind = libdb_Breakpoint_Kind_USER;
+    libdb_log_info("breakpoint-create: pending function %s resolved to 0x%lX",
+      breakpoint->symbol_name, address);
+  }
+}
+
+//NOTE(Torin) Brings the library list in line with the loader's link_map.
+//Libraries that went away are dropped and breakpoints placed in them by
+//name go back to pending so they come back if the library is reloaded
+static void
+libdb_shared_library_sync(libdb_Program *program) {
+  ELFDebugRendezvous rendezvous;
+  if (libdb_read_memory(program, program->debug_rendezvous_address,
+        &rendezvous, sizeof(rendezvous)) != sizeof(rendezvous)) return;
+  if (rendezvous.state != ELF_DEBUG_STATE_CONSISTENT) return;
+
+  for (uint32_t i = 0; i < program->shared_library_count; i++)
+    program->shared_libraries[i].is_mapped = 0;
+
+  static char path[PATH_MAX];
+  uint64_t link_map_address = rendezvous.linkMapAddress;
+  for (uint32_t count = 0; link_map_address != 0 && count < LIBDB_LINK_MAP_LIMIT; count++) {
+    ELFLinkMap link_map;
+    if (libdb_read_memory(program, link_map_address, &link_map, sizeof(link_map)) != sizeof(link_map)) break;
+    uint64_t current_address = link_map_address;
+    link_map_address = link_map.next;
+
+    libdb_Shared_Library *library = NULL;
+    for (uint32_t i = 0; i < program->shared_library_count; i++) {
+      libdb_Shared_Library *existing = &program->shared_libraries[i];
+      if (existing->link_map_address == current_address &&
+          existing->base_address == link_map.baseAddress) {
+        library = existing;
+        break;
+      }
+    }
+    if (library != NULL) {
+      library->is_mapped = 1;
+      continue;
+    }
+
+    //NOTE(Torin) The executable itself is the entry with an empty name
+    if (!libdb_read_string(program, link_map.nameAddress, path, sizeof(path))) continue;
+    if (path[0] == 0) continue;
+
+    if (program->shared_library_count == program->shared_library_capacity) {
+      uint32_t capacity = program->shared_library_capacity ? program->shared_library_capacity * 2 : 64;
+      libdb_Shared_Library *libraries = (libdb_Shared_Library *)libdb_malloc(sizeof(libdb_Shared_Library) * capacity);
+      if (program->shared_library_count > 0) {
+        memcpy(libraries, program->shared_libraries, sizeof(libdb_Shared_Library) * program->shared_library_count);
+      }
+      libdb_free(program->shared_libraries);
+      program->shared_libraries = libraries;
+      program->shared_library_capacity = capacity;
+    }
+
+    size_t path_length = strlen(path);
+    library = &program->shared_libraries[program->shared_library_count++];
+    memset(library, 0, sizeof(libdb_Shared_Library));
+    library->path = (char *)libdb_malloc(path_length + 1);
+    memcpy(library->path, path, path_length + 1);
+    library->base_address = link_map.baseAddress;
+    library->link_map_address = current_address;
+    library->is_mapped = 1;
+    libdb_log_debug("shared-library: %s at 0x%lX", library->path, library->base_address);
+  }
+
+  uint32_t write_index = 0;
+  for (uint32_t i = 0; i < program->shared_library_count; i++) {
+    libdb_Shared_Library *library = &program->shared_libraries[i];
+    if (library->is_mapped) {
+      program->shared_libraries[write_index++] = *library;
+      continue;
+    }
+
+    libdb_log_debug("shared-library: %s unloaded", library->path);
+    uint64_t end_address = library->base_address + library->image_size;
+    for (uint32_t j = 0; j < _breakpoint_count; j++) {
+      libdb_Breakpoint *breakpoint = &_breakpoints[j];
+      if (breakpoint->kind != libdb_Breakpoint_Kind_USER || breakpoint->symbol_name[0] == 0) continue;
+      if (breakpoint->instruction_address < library->base_address ||
+          breakpoint->instruction_address >= end_address) continue;
+      breakpoint->kind = libdb_Breakpoint_Kind_PENDING;
+      breakpoint->instruction_address = 0;
+    }
+    libdb_shared_library_free(library);
+  }
+  program->shared_library_count = write_index;
+
+  libdb_shared_library_resolve_pending(program);
+}
+
+static void
+libdb_shared_library_begin_tracking(libdb_Program *program) {
+  //NOTE(Torin) A position independent executable's symbols were read with
+  //link time addresses, move them to where the image was actually loaded
+  uint64_t dynamic_address = 0;
+  uint64_t load_bias = libdb_get_executable_load_bias(program, &dynamic_address);
+  if (load_bias != 0) {
+    for (uint64_t i = 0; i < program->symbol_table.functionCount; i++)
+      program->symbol_table.functionAddresses[i] += load_bias;
+  }
+
+  //NOTE(Torin) No interpreter means a static executable with nothing to track
+  if (libdb_read_auxv(program, ELF_AUXV_TYPE_BASE) == 0) return;
+
+  if (program->core != NULL) {
+    program->debug_rendezvous_address = libdb_find_debug_rendezvous(program);
+    if (program->debug_rendezvous_address != 0)
+      libdb_shared_library_sync(program);
+    return;
+  }
+
+  uint64_t entry_address = libdb_read_auxv(program, ELF_AUXV_TYPE_ENTRY);
+  if (entry_address == 0) return;
+  libdb_Breakpoint *breakpoint = libdb_breakpoint_allocate(libdb_Breakpoint_Kind_ENTRY, NULL);
+  if (breakpoint == NULL) return;
+  libdb_breakpoint_insert(program, breakpoint, entry_address);
+}
+
+static void
+libdb_shared_library_handle_breakpoint(libdb_Program *program, libdb_Breakpoint *breakpoint) {
+  if (breakpoint->kind == libdb_Breakpoint_Kind_ENTRY) {
+    if (program->debug_rendezvous_address != 0) return;
+    program->debug_rendezvous_address = libdb_find_debug_rendezvous(program);
+    if (program->debug_rendezvous_address == 0) {
+      libdb_log_error("shared-library: could not find the loader's r_debug");
+      return;
+    }
+    libdb_shared_library_sync(program);
+
+    ELFDebugRendezvous rendezvous;
+    if (libdb_read_memory(program, program->debug_rendezvous_address,
+          &rendezvous, sizeof(rendezvous)) != sizeof(rendezvous)) return;
+    if (rendezvous.breakpointAddress == 0) return;
+    libdb_Breakpoint *loader_breakpoint = libdb_breakpoint_allocate(libdb_Breakpoint_Kind_LOADER, NULL);
+    if (loader_breakpoint == NULL) return;
+    libdb_breakpoint_insert(program, loader_breakpoint, rendezvous.breakpointAddress);
+  } else if (breakpoint->kind == libdb_Breakpoint_Kind_LOADER) {
+    libdb_shared_library_sync(program);
+  }
+}
+
+const libdb_Symbol_Table *libdb_shared_library_get_symbols(libdb_Program *program, uint32_t library_index) {
+  libdb_assert(library_index < program->shared_library_count);
+  libdb_Shared_Library *library = &program->shared_libraries[library_index];
+  if (!libdb_shared_library_load_symbols(library)) return NULL;
+  return &library->symbol_table;
+}
+
+uint64_t libdb_find_function_address(libdb_Program *program, const char *function_name) {
+  uint64_t result = libdb_symbol_table_find(&program->symbol_table, function_name);
+  if (result == 0) result = libdb_shared_library_find_function(program, function_name);
+  return result;
+}
+
+//NOTE(Torin) Only the library the address falls in has its symbols read
+const char *libdb_find_function_name(libdb_Program *program, uint64_t address, uint64_t *offset) {
+  const libdb_Symbol_Table *symbol_table = &program->symbol_table;
+  libdb_Shared_Library *closest_library = NULL;
+  for (uint32_t i = 0; i < program->shared_library_count; i++) {
+    libdb_Shared_Library *library = &program->shared_libraries[i];
+    if (library->base_address > address) continue;
+    if (closest_library == NULL || library->base_address > closest_library->base_address)
+      closest_library = library;
+  }
+  if (closest_library != NULL && libdb_shared_library_load_symbols(closest_library) &&
+      address < closest_library->base_address + closest_library->image_size) {
+    symbol_table = &closest_library->symbol_table;
+  }
+
+  const char *result = NULL;
+  uint64_t result_address = 0;
+  const char *current_name = symbol_table->functionNames;
+  for (uint64_t i = 0; i < symbol_table->functionCount; i++) {
+    uint64_t function_address = symbol_table->functionAddresses[i];
+    if (function_address <= address && function_address >= result_address) {
+      result = current_name;
+      result_address = function_address;
+    }
+    current_name += strlen(current_name) + 1;
+  }
+  if (offset != NULL) *offset = address - result_address;
+  return result;
+}
+
 #endif//LIBDB_IMPLEMENTATION
 
@@ -0,0 +1,255 @@
+#define LIBDB_IMPLEMENTATION
+#include "libdb.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/ptrace.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+//NOTE(Torin) Runs ./test up to main, kills it with SIGABRT so the kernel
+//writes a core into the working directory, then opens that core and checks
+//it looks like the process did. The second half times opening a synthetic
+//sparse core with a large address space.
+
+#define SYNTHETIC_CORE_PATH "core_synthetic"
+#define SYNTHETIC_SEGMENT_COUNT 4096
+#define SYNTHETIC_SEGMENT_SIZE (8ULL * 1024 * 1024)
+#define SYNTHETIC_TOUCHED_SEGMENT_COUNT 64
+
+static double
+get_seconds() {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return (double)time.tv_sec + ((double)time.tv_nsec / 1000000000.0);
+}
+
+static uint64_t
+find_function_address(libdb_Program *program, const char *name) {
+  const char *function_name = program->symbol_table.functionNames;
+  for (uint32_t i = 0; i < program->symbol_table.functionCount; i++) {
+    if (strcmp(function_name, name) == 0)
+      return program->symbol_table.functionAddresses[i];
+    function_name += strlen(function_name) + 1;
+  }
+  return 0;
+}
+
+static int
+generate_core(uint64_t *main_address) {
+  struct rlimit limit = { RLIM_INFINITY, RLIM_INFINITY };
+  setrlimit(RLIMIT_CORE, &limit);
+  unlink("core");
+
+  libdb_Program program;
+  libdb_program_open("test", &program);
+  *main_address = find_function_address(&program, "main");
+  libdb_breakpoint_create_at_symbol("main", &program);
+  libdb_execution_continue(&program);
+  while (!libdb_program_update_state(&program)) {}
+  assert(program.stop_reason == libdb_Stop_Reason_BREAKPOINT_HIT);
+
+  ptrace(PTRACE_CONT, program.pid, NULL, SIGABRT);
+  int status = 0;
+  waitpid(program.pid, &status, __WALL);
+  if (!WIFSIGNALED(status) || !WCOREDUMP(status)) {
+    printf("test did not dump core, check ulimit -c and core_pattern\n");
+    return 0;
+  }
+  return 1;
+}
+
+static void
+test_process_core(uint64_t main_address) {
+  libdb_Program program;
+  double begin = get_seconds();
+  int result = libdb_program_open_core("test", "core", &program);
+  double elapsed = get_seconds() - begin;
+  assert(result == 1);
+  printf("opened %.1f MB core in %.3f ms\n", program.core->size / (1024.0 * 1024.0), elapsed * 1000.0);
+
+  assert(libdb_get_thread_count(&program) == 1);
+  assert(program.signal_number == SIGABRT);
+  assert(program.stop_reason == libdb_Stop_Reason_SIGNAL);
+  //NOTE(Torin) The process died just after executing the int 3 placed on main
+  uint64_t rip = libdb_get_rip(&program);
+  assert(rip == main_address + 1);
+
+  uint8_t instruction = 0;
+  assert(libdb_read_memory(&program, main_address, &instruction, 1) == 1);
+  assert(instruction == 0xCC);
+
+  uint64_t stack_value = 0;
+  uint64_t rsp = libdb_get_register(&program, RSP);
+  assert(libdb_read_memory(&program, rsp, &stack_value, sizeof(stack_value)) == sizeof(stack_value));
+  assert(libdb_read_memory(&program, 0, &stack_value, sizeof(stack_value)) == 0);
+  printf("rip 0x%lX rsp 0x%lX [rsp] 0x%lX\n", rip, rsp, stack_value);
+
+  libdb_program_close_core(&program);
+  assert(program.core == NULL);
+}
+
+//NOTE(Torin) Only the headers and one note are written, everything else is
+//a hole in a sparse file so a core of tens of gigabytes costs nothing on disk
+static int
+write_synthetic_core() {
+  FILE *file = fopen(SYNTHETIC_CORE_PATH, "wb");
+  if (file == NULL) return 0;
+
+  uint32_t program_header_count = SYNTHETIC_SEGMENT_COUNT + 1;
+  uint64_t note_offset = sizeof(ELF64Header) + program_header_count * sizeof(ELFProgramHeader);
+  uint64_t note_size = sizeof(ELFNoteHeader) + 8 + sizeof(ELFCorePRStatus);
+  uint64_t data_offset = (note_offset + note_size + 4095) & ~4095ULL;
+
+  ELF64Header header;
+  memset(&header, 0, sizeof(header));
+  header.magicNumber = ELF64_MAGIC_NUMBER;
+  header.bitType = 2;
+  header.dataEncoding = ELF_DATA_ENCODING_LITTLE_ENDIAN;
+  header.objectFileType = ELF_OBJ_TYPE_CORE;
+  header.programHeaderOffset = sizeof(ELF64Header);
+  header.elfHeaderSize = sizeof(ELF64Header);
+  header.programHeaderEntrySize = sizeof(ELFProgramHeader);
+  header.programHeaderEntryCount = (uint16_t)program_header_count;
+  fwrite(&header, sizeof(header), 1, file);
+
+  ELFProgramHeader note_header;
+  memset(&note_header, 0, sizeof(note_header));
+  note_header.type = ELF_PROGRAM_TYPE_NOTE;
+  note_header.fileOffset = note_offset;
+  note_header.fileSize = note_size;
+  fwrite(&note_header, sizeof(note_header), 1, file);
+
+  for (uint32_t i = 0; i < SYNTHETIC_SEGMENT_COUNT; i++) {
+    ELFProgramHeader load_header;
+    memset(&load_header, 0, sizeof(load_header));
+    load_header.type = ELF_PROGRAM_TYPE_LOAD;
+    load_header.fileOffset = data_offset + i * SYNTHETIC_SEGMENT_SIZE;
+    load_header.virtualAddress = 0x10000000ULL + i * 2 * SYNTHETIC_SEGMENT_SIZE;
+    load_header.fileSize = SYNTHETIC_SEGMENT_SIZE;
+    load_header.memorySize = SYNTHETIC_SEGMENT_SIZE;
+    fwrite(&load_header, sizeof(load_header), 1, file);
+  }
+
+  ELFNoteHeader note;
+  note.nameSize = 5;
+  note.descriptorSize = sizeof(ELFCorePRStatus);
+  note.type = ELF_NOTE_TYPE_PRSTATUS;
+  fwrite(&note, sizeof(note), 1, file);
+  fwrite("CORE\0\0\0", 8, 1, file);
+  ELFCorePRStatus status;
+  memset(&status, 0, sizeof(status));
+  status.currentSignal = SIGSEGV;
+  status.pid = 1234;
+  status.registers[RIP] = 0x10000000ULL;
+  fwrite(&status, sizeof(status), 1, file);
+
+  uint64_t total_size = data_offset + SYNTHETIC_SEGMENT_COUNT * SYNTHETIC_SEGMENT_SIZE;
+  int result = ftruncate(fileno(file), total_size) == 0;
+  fclose(file);
+  return result;
+}
+
+static void
+benchmark_large_core() {
+  if (!write_synthetic_core()) {
+    printf("could not write synthetic core, skipping benchmark\n");
+    return;
+  }
+
+  libdb_Program program;
+  double begin = get_seconds();
+  int result = libdb_program_open_core("test", SYNTHETIC_CORE_PATH, &program);
+  double elapsed = get_seconds() - begin;
+  assert(result == 1);
+  printf("opened %.1f GB sparse core (%u segments) in %.3f ms\n",
+    program.core->size / (1024.0 * 1024.0 * 1024.0), program.core->segment_count, elapsed * 1000.0);
+  assert(program.core->segment_count == SYNTHETIC_SEGMENT_COUNT);
+  assert(program.signal_number == SIGSEGV);
+
+  uint64_t value = 1;
+  uint64_t last_segment = 0x10000000ULL + (SYNTHETIC_SEGMENT_COUNT - 1) * 2 * SYNTHETIC_SEGMENT_SIZE;
+  assert(libdb_read_memory(&program, last_segment, &value, sizeof(value)) == sizeof(value));
+  assert(value == 0);
+  //NOTE(Torin) The gap between two segments is not mapped
+  assert(libdb_read_memory(&program, 0x10000000ULL + SYNTHETIC_SEGMENT_SIZE, &value, 1) == 0);
+
+  //NOTE(Torin) The first read of a page faults it in from the file, after
+  //that a read is only the segment lookup and a copy
+  begin = get_seconds();
+  for (uint32_t i = 0; i < SYNTHETIC_TOUCHED_SEGMENT_COUNT; i++) {
+    uint64_t address = 0x10000000ULL + i * 2 * SYNTHETIC_SEGMENT_SIZE;
+    libdb_read_memory(&program, address, &value, sizeof(value));
+  }
+  elapsed = get_seconds() - begin;
+  printf("%u cold reads in %.3f ms\n", SYNTHETIC_TOUCHED_SEGMENT_COUNT, elapsed * 1000.0);
+
+  begin = get_seconds();
+  for (uint32_t i = 0; i < 1000000; i++) {
+    uint64_t address = 0x10000000ULL + (i % SYNTHETIC_TOUCHED_SEGMENT_COUNT) * 2 * SYNTHETIC_SEGMENT_SIZE;
+    libdb_read_memory(&program, address, &value, sizeof(value));
+  }
+  elapsed = get_seconds() - begin;
+  printf("1000000 warm reads in %.3f ms\n", elapsed * 1000.0);
+
+  libdb_program_close_core(&program);
+  unlink(SYNTHETIC_CORE_PATH);
+}
+
+//NOTE(Torin) Cuts the synthetic core off half way through its last segment,
+//reads must stop there rather than return zeros
+static void
+test_truncated_core() {
+  if (!write_synthetic_core()) {
+    printf("could not write synthetic core, skipping truncated core test\n");
+    return;
+  }
+  struct stat core_stat;
+  assert(stat(SYNTHETIC_CORE_PATH, &core_stat) == 0);
+  assert(truncate(SYNTHETIC_CORE_PATH, core_stat.st_size - SYNTHETIC_SEGMENT_SIZE / 2) == 0);
+
+  libdb_Program program;
+  assert(libdb_program_open_core("test", SYNTHETIC_CORE_PATH, &program) == 1);
+  uint64_t last_segment = 0x10000000ULL + (SYNTHETIC_SEGMENT_COUNT - 1) * 2 * SYNTHETIC_SEGMENT_SIZE;
+  uint64_t cut = last_segment + SYNTHETIC_SEGMENT_SIZE / 2;
+  uint64_t value = 1;
+  assert(libdb_read_memory(&program, last_segment, &value, sizeof(value)) == sizeof(value));
+  assert(libdb_read_memory(&program, cut - 4, &value, sizeof(value)) == 4);
+  assert(libdb_read_memory(&program, cut, &value, sizeof(value)) == 0);
+  assert(libdb_read_memory(&program, last_segment + SYNTHETIC_SEGMENT_SIZE - 8, &value, sizeof(value)) == 0);
+  printf("truncated core reads stop at 0x%lX\n", cut);
+
+  libdb_program_close_core(&program);
+  unlink(SYNTHETIC_CORE_PATH);
+}
+
+//NOTE(Torin) A missing executable has to fail cleanly even when the
+//program was never initialized
+static void
+test_missing_executable() {
+  if (!write_synthetic_core()) {
+    printf("could not write synthetic core, skipping missing executable test\n");
+    return;
+  }
+  libdb_Program program;
+  memset(&program, 0xAB, sizeof(program));
+  assert(libdb_program_open_core("does_not_exist", SYNTHETIC_CORE_PATH, &program) == 0);
+  assert(program.core == NULL);
+  printf("missing executable rejected\n");
+  unlink(SYNTHETIC_CORE_PATH);
+}
+
+int main() {
+  uint64_t main_address = 0;
+  if (generate_core(&main_address)) {
+    test_process_core(main_address);
+  }
+  benchmark_large_core();
+  test_truncated_core();
+  test_missing_executable();
+  return 0;
+}
@@ -0,0 +1,187 @@
+#define LIBDB_IMPLEMENTATION
+#include "libdb.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <time.h>
+
+//NOTE(Torin) Checks the word at a time leb128 decoder against the byte at a
+//time one on encoded values of every length and on random bytes, then times
+//both on a buffer shaped like .debug_info and .debug_line where nearly every
+//value fits in one or two bytes, and on each length alone. Build it with and
+//without -mbmi2 to time both ways of packing the 7 bit groups.
+
+#define RANDOM_CASE_COUNT 2000000
+#define BENCHMARK_VALUE_COUNT 4000000
+#define BENCHMARK_REPEAT_COUNT 9
+
+static double
+get_seconds() {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return (double)time.tv_sec + ((double)time.tv_nsec / 1000000000.0);
+}
+
+static uint64_t random_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t
+next_random() {
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 7;
+  random_state ^= random_state << 17;
+  return random_state;
+}
+
+static size_t
+encode_uint64(uint64_t value, uint8_t *output) {
+  size_t length = 0;
+  do {
+    uint8_t byte = value & 0x7F;
+    value >>= 7;
+    if (value != 0) byte |= 0x80;
+    output[length++] = byte;
+  } while (value != 0);
+  return length;
+}
+
+static size_t
+encode_int64(int64_t value, uint8_t *output) {
+  size_t length = 0;
+  while (1) {
+    uint8_t byte = value & 0x7F;
+    value >>= 7;
+    int is_done = (value == 0 && !(byte & 0x40)) || (value == -1 && (byte & 0x40));
+    if (!is_done) byte |= 0x80;
+    output[length++] = byte;
+    if (is_done) return length;
+  }
+}
+
+static void
+check_value(uint64_t value) {
+  uint8_t buffer[16 + LIBDB_LEB128_PADDING];
+  memset(buffer, 0xFF, sizeof(buffer));
+  size_t length = encode_uint64(value, buffer);
+  uint64_t result = 0;
+  assert(leb128_decode_uint64(buffer, &result) == length);
+  assert(result == value);
+
+  memset(buffer, 0xFF, sizeof(buffer));
+  length = encode_int64((int64_t)value, buffer);
+  int64_t signed_result = 0;
+  assert(leb128_decode_int64(buffer, &signed_result) == length);
+  assert(signed_result == (int64_t)value);
+}
+
+static void
+test_encoded_values() {
+  for (uint32_t bit = 0; bit < 64; bit++) {
+    uint64_t power = 1ULL << bit;
+    check_value(power);
+    check_value(power - 1);
+    check_value(power + 1);
+    check_value(~power);
+    check_value(0 - power);
+  }
+  for (uint32_t i = 0; i < RANDOM_CASE_COUNT; i++) {
+    uint64_t value = next_random() >> (next_random() & 63);
+    check_value(value);
+  }
+}
+
+//NOTE(Torin) Random bytes with the continuation bit set more often than not so
+//every length, including runs longer than 10 bytes, comes up
+static void
+test_random_bytes() {
+  uint8_t buffer[16 + LIBDB_LEB128_PADDING];
+  for (uint32_t i = 0; i < RANDOM_CASE_COUNT; i++) {
+    uint64_t bits = next_random();
+    for (uint32_t j = 0; j < sizeof(buffer); j++) {
+      buffer[j] = (uint8_t)next_random();
+      if ((bits >> (j % 64)) & 1) buffer[j] |= 0x80;
+    }
+    uint64_t expected = 0, result = 0;
+    size_t expected_length = leb128_decode_uint64_bytewise(buffer, &expected);
+    assert(leb128_decode_uint64(buffer, &result) == expected_length);
+    assert(result == expected);
+  }
+}
+
+//NOTE(Torin) Value shapes the decoders are timed on: one like .debug_info and
+//.debug_line, then each length on its own so every path shows up separately
+enum {
+  BenchmarkShape_DWARF,
+  BenchmarkShape_1Byte,
+  BenchmarkShape_2Byte,
+  BenchmarkShape_5Byte,
+  BenchmarkShape_COUNT
+};
+
+static const char *BENCHMARK_SHAPE_NAMES[] = { "dwarf-like", "1 byte", "2 byte", "5 byte" };
+
+static uint64_t
+benchmark_value(int shape) {
+  uint64_t kind = next_random() % 100;
+  uint64_t value = next_random();
+  switch (shape) {
+    case BenchmarkShape_1Byte: return value & 0x7F;
+    case BenchmarkShape_2Byte: return 0x80 | (value & 0x3F7F);
+    case BenchmarkShape_5Byte: return 0x800000000ULL | (value & 0x7FFFFFFFFULL);
+  }
+  if (kind < 70) value &= 0x7F;
+  else if (kind < 90) value &= 0x3FFF;
+  else if (kind < 98) value &= 0xFFFFFFF;
+  else value &= 0xFFFFFFFFFFULL;
+  return value;
+}
+
+//NOTE(Torin) Best of several passes, the slower ones are the machine not the code
+static void
+benchmark_decoders() {
+  uint8_t *buffer = (uint8_t *)malloc(BENCHMARK_VALUE_COUNT * 10 + LIBDB_LEB128_PADDING);
+#ifdef __BMI2__
+  printf("ns per value, word decoder packing with pext:\n");
+#else
+  printf("ns per value, word decoder packing with shifts:\n");
+#endif
+  for (int shape = 0; shape < BenchmarkShape_COUNT; shape++) {
+    size_t size = 0;
+    for (uint32_t i = 0; i < BENCHMARK_VALUE_COUNT; i++)
+      size += encode_uint64(benchmark_value(shape), buffer + size);
+    memset(buffer + size, 0, LIBDB_LEB128_PADDING);
+
+    uint64_t bytewise_sum = 0, sum = 0;
+    double bytewise_elapsed = 1e9, elapsed = 1e9;
+    for (uint32_t repeat = 0; repeat < BENCHMARK_REPEAT_COUNT; repeat++) {
+      double begin = get_seconds();
+      for (size_t offset = 0; offset < size;) {
+        uint64_t value = 0;
+        offset += leb128_decode_uint64_bytewise(buffer + offset, &value);
+        bytewise_sum += value;
+      }
+      double end = get_seconds();
+      if (end - begin < bytewise_elapsed) bytewise_elapsed = end - begin;
+
+      begin = get_seconds();
+      for (size_t offset = 0; offset < size;) {
+        uint64_t value = 0;
+        offset += leb128_decode_uint64(buffer + offset, &value);
+        sum += value;
+      }
+      end = get_seconds();
+      if (end - begin < elapsed) elapsed = end - begin;
+    }
+    assert(sum == bytewise_sum);
+    printf("  %-10s bytewise %5.2f, word %5.2f\n", BENCHMARK_SHAPE_NAMES[shape],
+      bytewise_elapsed * 1e9 / BENCHMARK_VALUE_COUNT, elapsed * 1e9 / BENCHMARK_VALUE_COUNT);
+  }
+  free(buffer);
+}
+
+int main() {
+  test_encoded_values();
+  test_random_bytes();
+  benchmark_decoders();
+  printf("PASS leb128\n");
+  return 0;
+}
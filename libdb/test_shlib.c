@@ -0,0 +1,82 @@
+#define LIBDB_IMPLEMENTATION
+#include "libdb.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <time.h>
+
+//NOTE(Torin) Driven by bench_shlib.sh, which builds a program linked against
+//a few hundred shared libraries that also dlopens one more. With only the
+//program it times reaching main, when nothing needs library symbols none
+//should be read. It then looks up glibc's strlen, an STT_GNU_IFUNC. Given
+//the two functions it also checks that a breakpoint in a linked library and
+//a pending one in the dlopened library are hit.
+
+static double
+get_seconds() {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return (double)time.tv_sec + ((double)time.tv_nsec / 1000000000.0);
+}
+
+static void
+wait_for_breakpoint(libdb_Program *program, int64_t breakpoint_id) {
+  libdb_execution_continue(program);
+  while (!libdb_program_update_state(program)) {}
+  assert(program->state == libdb_Program_State_STOPPED);
+  assert(program->breakpoint_id == breakpoint_id);
+}
+
+int main(int argc, const char **argv) {
+  if (argc != 2 && argc != 4) {
+    printf("usage: test_shlib <program> [<linked function> <dlopened function>]\n");
+    return 1;
+  }
+
+  double begin = get_seconds();
+  libdb_Program program;
+  libdb_program_open(argv[1], &program);
+  int64_t main_breakpoint = libdb_breakpoint_create_at_symbol("main", &program);
+  int64_t linked_breakpoint = -1;
+  int64_t dlopen_breakpoint = -1;
+  if (argc == 4) {
+    linked_breakpoint = libdb_breakpoint_create_at_symbol(argv[2], &program);
+    dlopen_breakpoint = libdb_breakpoint_create_at_symbol(argv[3], &program);
+  }
+  assert(program.shared_library_count == 0);
+
+  wait_for_breakpoint(&program, main_breakpoint);
+  double main_seconds = get_seconds() - begin;
+  uint32_t library_count = program.shared_library_count;
+  uint32_t loaded_count = 0;
+  for (uint32_t i = 0; i < library_count; i++)
+    loaded_count += program.shared_libraries[i].are_symbols_loaded;
+  fprintf(stderr, "%u shared libraries, symbols read for %u of them at main\n",
+    library_count, loaded_count);
+  fprintf(stderr, "reached main in %.2f ms\n", main_seconds * 1000.0);
+
+  //NOTE(Torin) glibc's strlen is an STT_GNU_IFUNC, it has to be found like
+  //any other function
+  uint64_t strlen_address = libdb_find_function_address(&program, "strlen");
+  assert(strlen_address != 0);
+
+  if (argc == 4) {
+    wait_for_breakpoint(&program, linked_breakpoint);
+    uint64_t offset = 0;
+    const char *name = libdb_find_function_name(&program, program.rip, &offset);
+    assert(name != NULL && strcmp(name, argv[2]) == 0 && offset == 0);
+
+    wait_for_breakpoint(&program, dlopen_breakpoint);
+    double total_seconds = get_seconds() - begin;
+    assert(program.shared_library_count == library_count + 1);
+    name = libdb_find_function_name(&program, program.rip, &offset);
+    assert(name != NULL && strcmp(name, argv[3]) == 0);
+
+    fprintf(stderr, "dlopened library breakpoint in %.2f ms\n", total_seconds * 1000.0);
+  }
+
+  libdb_execution_continue(&program);
+  while (program.state != libdb_Program_State_EXITED)
+    libdb_program_update_state(&program);
+  return 0;
+}
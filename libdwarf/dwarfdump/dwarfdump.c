@@ -208,6 +208,11 @@ boolean found_error_message = FALSE;
 */
 int break_after_n_units = INT_MAX;
 
+/*  -j <num>: print the CUs of .debug_info and .debug_types
+    with this many worker processes. Output is the same as
+    with 1 (the default), see print_die.c. */
+int parallel_jobs = 1;
+
 boolean check_names = FALSE;
 boolean check_verbose_mode = TRUE; /* During '-k' mode, display errors */
 boolean check_frames = FALSE;
@@ -1462,6 +1467,7 @@ static const char *usage_text[] = {
 "\t\t\t  example: to stop after <num> compilation units",
 "\t\t-i\tprint info section",
 "\t\t-I\tprint sections .gdb_index, .debug_cu_index, .debug_tu_index",
+"\t\t-j <num>\tprint compilation units with <num> parallel jobs",
 /* FIXME -kw is check macros */
 "\t\t-k[abcdDeEfFgGilmMnrRsStu[f]x[e]y] check dwarf information",
 "\t\t   a\tdo all checks",
@@ -1533,6 +1539,7 @@ static const char *usage_text[] = {
 "\t\t-vv verbose: show even more information",
 "\t\t-V print version information",
 "\t\t-x abi=<abi>\tname abi in dwarfdump.conf",
+"\t\t-x alloc=<mode>\tlibdwarf allocation mode: tracked or slab",
 "\t\t-x name=<path>\tname dwarfdump.conf",
 "\t\t-x tied=<tiedpath>\tname an associated object file (Split DWARF)",
 "\t\t-w\tprint weakname section",
@@ -1619,9 +1626,8 @@ process_args(int argc, char *argv[])
         do_all();
     }
 
-    /* j unused */
     while ((c = dwgetopt(argc, argv,
-        "#:abc::CdDeE::fFgGhH:iIk:l::mMnNo::O:pPqQrRsS:t:u:UvVwW::x:yz")) != EOF) {
+        "#:abc::CdDeE::fFgGhH:iIj:k:l::mMnNo::O:pPqQrRsS:t:u:UvVwW::x:yz")) != EOF) {
 
         switch (c) {
         /* Internal debug level setting. */
@@ -1687,6 +1693,15 @@ process_args(int argc, char *argv[])
                         goto badopt;
                     }
                     break;
+                } else if (strncmp(dwoptarg, "alloc=", 6) == 0) {
+                    if (!strcmp(&dwoptarg[6],"tracked")) {
+                        dwarf_set_alloc_mode(DW_ALLOC_MODE_TRACKED);
+                    } else if (!strcmp(&dwoptarg[6],"slab")) {
+                        dwarf_set_alloc_mode(DW_ALLOC_MODE_SLAB);
+                    } else {
+                        goto badopt;
+                    }
+                    break;
                 } else {
                 badopt:
                     fprintf(stderr, "-x name=<path-to-conf> \n");
@@ -1696,6 +1711,8 @@ process_args(int argc, char *argv[])
                     fprintf(stderr, "-x tied=<tied-file-path> \n");
                     fprintf(stderr, " and  \n");
                     fprintf(stderr, "-x line5={std,s2l,orig,orig2l} \n");
+                    fprintf(stderr, " and  \n");
+                    fprintf(stderr, "-x alloc={tracked,slab} \n");
                     fprintf(stderr, "are legal, not -x %s\n", dwoptarg);
                     usage_error = TRUE;
                     break;
@@ -1745,6 +1762,18 @@ process_args(int argc, char *argv[])
                 }
             }
             break;
+        case 'j':
+            {
+                int jobs =  atoi(dwoptarg);
+                if (jobs < 1) {
+                    fprintf(stderr, "-j needs a count of jobs, not %s\n",
+                        dwoptarg);
+                    usage_error = TRUE;
+                    break;
+                }
+                parallel_jobs = jobs;
+            }
+            break;
         case 'F':
             eh_frame_flag = TRUE;
             suppress_check_dwarf();
@@ -267,6 +267,7 @@ extern boolean found_error_message;
 #define PRINTING_UNIQUE (!found_error_message)
 
 extern int break_after_n_units;
+extern int parallel_jobs;
 
 extern boolean check_names;          /* Check for invalid names */
 extern boolean check_verbose_mode;   /* During '-k' mode, display errors */
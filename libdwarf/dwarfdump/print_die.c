@@ -36,6 +36,10 @@
 #include "print_frames.h"       /* for get_string_from_locs() . */
 #include "macrocheck.h"
 #include "tag_common.h"
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>     /* for fork() and friends, -j */
 
 /*  Traverse a DIE and attributes to check self references */
 static boolean traverse_one_die(Dwarf_Debug dbg, Dwarf_Attribute attrib,
@@ -51,6 +55,9 @@ static void print_die_and_children_internal(Dwarf_Debug dbg,
     Dwarf_Bool is_info,
     char **srcfiles, Dwarf_Signed cnt);
 static int print_one_die_section(Dwarf_Debug dbg,Dwarf_Bool is_info);
+static int print_cus_of_die_section(Dwarf_Debug dbg,Dwarf_Bool is_info,
+    const char *section_name);
+static boolean parallel_claim_cu(unsigned cu_index);
 
 /* Is this a PU has been invalidated by the SN Systems linker? */
 #define IsInvalidCode(low,high) ((low == elf_max_address) || (low == 0 && high == 0))
@@ -311,33 +318,27 @@ print_as_info_or_cu()
 }
 
 
+static void
+report_die_section_error(FILE *out,Dwarf_Bool is_info)
+{
+    char * errmsg = dwarf_errmsg(err);
+    Dwarf_Unsigned myerr = dwarf_errno(err);
+
+    fprintf(out, "%s ERROR:  %s:  %s (%lu)\n",
+        program_name, is_info?"attempting to print .debug_info":
+        "attempting to print .debug_types",
+        errmsg, (unsigned long) myerr);
+    fprintf(out, "attempting to continue.\n");
+}
+
 /* process each compilation unit in .debug_info */
 void
 print_infos(Dwarf_Debug dbg,Dwarf_Bool is_info)
 {
     int nres = 0;
-    if (is_info) {
-        nres = print_one_die_section(dbg,TRUE);
-        if (nres == DW_DLV_ERROR) {
-            char * errmsg = dwarf_errmsg(err);
-            Dwarf_Unsigned myerr = dwarf_errno(err);
-
-            fprintf(stderr, "%s ERROR:  %s:  %s (%lu)\n",
-                program_name, "attempting to print .debug_info",
-                errmsg, (unsigned long) myerr);
-            fprintf(stderr, "attempting to continue.\n");
-        }
-        return;
-    }
-    nres = print_one_die_section(dbg,FALSE);
+    nres = print_one_die_section(dbg,is_info);
     if (nres == DW_DLV_ERROR) {
-        char * errmsg = dwarf_errmsg(err);
-        Dwarf_Unsigned myerr = dwarf_errno(err);
-
-        fprintf(stderr, "%s ERROR:  %s:  %s (%lu)\n",
-            program_name, "attempting to print .debug_types",
-            errmsg, (unsigned long) myerr);
-        fprintf(stderr, "attempting to continue.\n");
+        report_die_section_error(stderr,is_info);
     }
 }
 
@@ -528,23 +529,329 @@ print_cu_hdr_signature(Dwarf_Sig8 *signature,Dwarf_Unsigned typeoffset)
     }
 }
 
+/*  -j support.
+    dwarfdump keeps a great deal of its printing state in
+    globals and a Dwarf_Debug is not safe to share across threads,
+    so the workers are processes: each gets its own copy of
+    everything from fork().
+    Every worker walks all the CU headers but takes the next
+    unprinted CU from a counter in shared memory, prints it with
+    stdout pointed at a temporary file of its own and tells the
+    parent through a pipe where in that file the CU's output went.
+    The parent copies the finished CUs to the real stdout
+    in section order as they complete, so the output is
+    exactly what printing them one by one gives. */
+
+/*  Written whole to the pipe (well under PIPE_BUF) so the
+    workers' messages never interleave. */
+struct parallel_msg_s {
+    unsigned pm_cu;
+    int      pm_worker;
+    int      pm_kind;
+    off_t    pm_offset;
+    off_t    pm_length;
+};
+#define PARALLEL_CLAIMED   1
+#define PARALLEL_DONE      2
+/*  Done, and the section error report follows the output. */
+#define PARALLEL_DONE_ERR  3
+
+/*  The parent's view of one CU (loop iteration really,
+    the last one finds no CU). */
+struct parallel_cu_s {
+    int   pc_kind;
+    int   pc_worker;
+    off_t pc_offset;
+    off_t pc_length;
+};
+
+/*  In a worker: its number, else -1. */
+static int parallel_worker = -1;
+static unsigned *parallel_next_cu = 0;
+static int parallel_notify_fd = -1;
+/*  The CU a worker will print next, and the one it is
+    printing now (-1 if none). */
+static long parallel_target_cu = -1;
+static long parallel_current_cu = -1;
+static off_t parallel_current_offset = 0;
+
+/*  Checking, searching and macro printing accumulate
+    state across all the CUs and report it at the end,
+    none of which would make it back from a worker. */
+static boolean
+parallel_print_is_possible(void)
+{
+    return !do_check_dwarf && !check_self_references &&
+        !search_is_on && !macro_flag && !check_macros &&
+        !producer_children_flag;
+}
+
+static void
+parallel_send(int kind,off_t offset,off_t length)
+{
+    struct parallel_msg_s msg;
+
+    memset(&msg,0,sizeof(msg));
+    msg.pm_cu = parallel_current_cu;
+    msg.pm_worker = parallel_worker;
+    msg.pm_kind = kind;
+    msg.pm_offset = offset;
+    msg.pm_length = length;
+    if (write(parallel_notify_fd,&msg,sizeof(msg)) != sizeof(msg)) {
+        /*  The parent is gone, nobody will see the output. */
+        _exit(FAILED);
+    }
+}
+
+static void
+parallel_finish_cu(boolean report_error,Dwarf_Bool is_info)
+{
+    off_t length = 0;
+
+    if (parallel_current_cu < 0) {
+        return;
+    }
+    fflush(stdout);
+    length = lseek(STDOUT_FILENO,0,SEEK_CUR) - parallel_current_offset;
+    if (report_error) {
+        /*  The parent moves this to stderr when it reaches
+            the CU, so as when printing serially it does not
+            appear if something fatal happened earlier. */
+        report_die_section_error(stdout,is_info);
+        fflush(stdout);
+    }
+    parallel_send(report_error?PARALLEL_DONE_ERR:PARALLEL_DONE,
+        parallel_current_offset,length);
+    parallel_current_cu = -1;
+}
+
+/*  Called at the top of each CU loop iteration. In a worker,
+    returns TRUE if this worker is the one to print the CU. */
+static boolean
+parallel_claim_cu(unsigned cu_index)
+{
+    if (parallel_worker < 0) {
+        return TRUE;
+    }
+    if (parallel_target_cu < (long)cu_index) {
+        parallel_finish_cu(FALSE,FALSE);
+        parallel_target_cu = __sync_fetch_and_add(parallel_next_cu,1);
+    }
+    if (parallel_target_cu != (long)cu_index) {
+        return FALSE;
+    }
+    fflush(stdout);
+    parallel_current_cu = cu_index;
+    parallel_current_offset = lseek(STDOUT_FILENO,0,SEEK_CUR);
+    /*  So the parent can find what a fatal print_error()
+        left behind. */
+    parallel_send(PARALLEL_CLAIMED,parallel_current_offset,0);
+    return TRUE;
+}
+
+static void
+parallel_run_worker(Dwarf_Debug dbg,Dwarf_Bool is_info,
+    const char *section_name,int worker,int outfd)
+{
+    int nres = 0;
+
+    parallel_worker = worker;
+    if (dup2(outfd,STDOUT_FILENO) < 0) {
+        _exit(FAILED);
+    }
+    nres = print_cus_of_die_section(dbg,is_info,section_name);
+    /*  Only the worker that owned the failing iteration
+        reports an error, the rest just stop there too. */
+    parallel_finish_cu(nres == DW_DLV_ERROR,is_info);
+    fflush(stdout);
+    _exit(0);
+}
+
+/*  Copies length bytes (to the end if length is -1) from
+    offset in fd to out. */
+static void
+parallel_copy_output(int fd,off_t offset,off_t length,FILE *out)
+{
+    static char buf[64*1024];
+
+    while (length != 0) {
+        size_t want = sizeof(buf);
+        ssize_t got = 0;
+
+        if (length > 0 && (off_t)want > length) {
+            want = (size_t)length;
+        }
+        got = pread(fd,buf,want,offset);
+        if (got <= 0) {
+            break;
+        }
+        fwrite(buf,1,(size_t)got,out);
+        offset += got;
+        if (length > 0) {
+            length -= got;
+        }
+    }
+}
+
+static void
+parallel_emit_cu(FILE **outfiles,struct parallel_cu_s *cu)
+{
+    int fd = fileno(outfiles[cu->pc_worker]);
+
+    parallel_copy_output(fd,cu->pc_offset,cu->pc_length,stdout);
+    if (cu->pc_kind == PARALLEL_DONE_ERR) {
+        fflush(stdout);
+        parallel_copy_output(fd,cu->pc_offset+cu->pc_length,-1,stderr);
+    }
+}
+
+static int
+print_cus_in_parallel(Dwarf_Debug dbg,Dwarf_Bool is_info,
+    const char *section_name)
+{
+    struct parallel_cu_s *cus = 0;
+    unsigned cus_size = 0;
+    unsigned emitted = 0;
+    FILE **outfiles = 0;
+    pid_t *pids = 0;
+    int notify[2];
+    int started = 0;
+    int failed = FALSE;
+    Dwarf_Die first_die = 0;
+    Dwarf_Error first_err = 0;
+    int i = 0;
+
+    /*  Read the section in once for all the workers to share.
+        dwarf_offdie_b() leaves the CU iteration alone, any
+        error here is met and reported again by a worker. */
+    if (dwarf_offdie_b(dbg,0,is_info,&first_die,&first_err) ==
+        DW_DLV_OK) {
+        dwarf_dealloc(dbg,first_die,DW_DLA_DIE);
+    }
+
+    parallel_next_cu = mmap(0,sizeof(unsigned),PROT_READ|PROT_WRITE,
+        MAP_SHARED|MAP_ANONYMOUS,-1,0);
+    outfiles = (FILE **)calloc(parallel_jobs,sizeof(FILE *));
+    pids = (pid_t *)calloc(parallel_jobs,sizeof(pid_t));
+    if (parallel_next_cu == MAP_FAILED || !outfiles || !pids ||
+        pipe(notify) < 0) {
+        fprintf(stderr,"%s ERROR:  could not set up -j workers\n",
+            program_name);
+        exit(FAILED);
+    }
+    *parallel_next_cu = 0;
+    parallel_notify_fd = notify[1];
+
+    /*  So the workers do not inherit unwritten output. */
+    fflush(stdout);
+    for (i = 0; i < parallel_jobs; ++i) {
+        outfiles[i] = tmpfile();
+        if (!outfiles[i]) {
+            break;
+        }
+        pids[i] = fork();
+        if (pids[i] == 0) {
+            close(notify[0]);
+            parallel_run_worker(dbg,is_info,section_name,i,
+                fileno(outfiles[i]));
+        }
+        if (pids[i] < 0) {
+            fclose(outfiles[i]);
+            outfiles[i] = 0;
+            break;
+        }
+        ++started;
+    }
+    close(notify[1]);
+    parallel_notify_fd = -1;
+    if (!started) {
+        fprintf(stderr,"%s ERROR:  could not start -j workers\n",
+            program_name);
+        exit(FAILED);
+    }
+
+    /*  Emit CUs in order as they finish. read() returns 0
+        once every worker has exited. */
+    for (;;) {
+        struct parallel_msg_s msg;
+        struct parallel_cu_s *cu = 0;
+        ssize_t got = read(notify[0],&msg,sizeof(msg));
+
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got != sizeof(msg)) {
+            break;
+        }
+        if (msg.pm_cu >= cus_size) {
+            unsigned newsize = cus_size? cus_size*2: 1024;
+            while (newsize <= msg.pm_cu) {
+                newsize *= 2;
+            }
+            cus = (struct parallel_cu_s *)realloc(cus,
+                newsize*sizeof(struct parallel_cu_s));
+            if (!cus) {
+                fprintf(stderr,"%s ERROR:  out of memory in -j\n",
+                    program_name);
+                exit(FAILED);
+            }
+            memset(cus+cus_size,0,
+                (newsize-cus_size)*sizeof(struct parallel_cu_s));
+            cus_size = newsize;
+        }
+        cu = &cus[msg.pm_cu];
+        cu->pc_kind = msg.pm_kind;
+        cu->pc_worker = msg.pm_worker;
+        cu->pc_offset = msg.pm_offset;
+        cu->pc_length = msg.pm_length;
+        while (emitted < cus_size &&
+            cus[emitted].pc_kind >= PARALLEL_DONE) {
+            parallel_emit_cu(outfiles,&cus[emitted]);
+            ++emitted;
+        }
+    }
+    close(notify[0]);
+    for (i = 0; i < started; ++i) {
+        int status = 0;
+        if (waitpid(pids[i],&status,0) < 0 ||
+            !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            failed = TRUE;
+        }
+    }
+
+    /*  CUs never claimed were cut off by -H. A claimed CU that
+        never finished is one where a worker hit a fatal error,
+        its output ends with the message, as it would serially. */
+    for ( ; emitted < cus_size; ++emitted) {
+        struct parallel_cu_s *cu = &cus[emitted];
+        if (cu->pc_kind >= PARALLEL_DONE) {
+            parallel_emit_cu(outfiles,cu);
+        } else if (cu->pc_kind == PARALLEL_CLAIMED) {
+            parallel_copy_output(fileno(outfiles[cu->pc_worker]),
+                cu->pc_offset,-1,stdout);
+            failed = TRUE;
+            break;
+        }
+    }
+    fflush(stdout);
+    for (i = 0; i < started; ++i) {
+        fclose(outfiles[i]);
+    }
+    free(outfiles);
+    free(pids);
+    free(cus);
+    munmap(parallel_next_cu,sizeof(unsigned));
+    parallel_next_cu = 0;
+    if (failed) {
+        exit(FAILED);
+    }
+    dieprint_cu_offset = 0;
+    return DW_DLV_NO_ENTRY;
+}
+
 static int
 print_one_die_section(Dwarf_Debug dbg,Dwarf_Bool is_info)
 {
-    Dwarf_Unsigned cu_header_length = 0;
-    Dwarf_Unsigned abbrev_offset = 0;
-    Dwarf_Half version_stamp = 0;
-    Dwarf_Half address_size = 0;
-    Dwarf_Half extension_size = 0;
-    Dwarf_Half length_size = 0;
-    Dwarf_Sig8 signature;
-    Dwarf_Unsigned typeoffset = 0;
-    Dwarf_Unsigned next_cu_offset = 0;
-    unsigned loop_count = 0;
-    int nres = DW_DLV_OK;
-    int   cu_count = 0;
-    char * cu_short_name = NULL;
-    char * cu_long_name = NULL;
     const char * section_name = 0;
     int res = 0;
 
@@ -563,6 +870,30 @@ print_one_die_section(Dwarf_Debug dbg,Dwarf_Bool is_info)
     if (print_as_info_or_cu() && is_info && do_print_dwarf) {
         printf("\n%s\n",section_name);
     }
+    if (parallel_jobs > 1 && parallel_print_is_possible()) {
+        return print_cus_in_parallel(dbg,is_info,section_name);
+    }
+    return print_cus_of_die_section(dbg,is_info,section_name);
+}
+
+static int
+print_cus_of_die_section(Dwarf_Debug dbg,Dwarf_Bool is_info,
+    const char *section_name)
+{
+    Dwarf_Unsigned cu_header_length = 0;
+    Dwarf_Unsigned abbrev_offset = 0;
+    Dwarf_Half version_stamp = 0;
+    Dwarf_Half address_size = 0;
+    Dwarf_Half extension_size = 0;
+    Dwarf_Half length_size = 0;
+    Dwarf_Sig8 signature;
+    Dwarf_Unsigned typeoffset = 0;
+    Dwarf_Unsigned next_cu_offset = 0;
+    unsigned loop_count = 0;
+    int nres = DW_DLV_OK;
+    int   cu_count = 0;
+    char * cu_short_name = NULL;
+    char * cu_long_name = NULL;
 
     /* Loop until it fails.  */
     for (;;++loop_count) {
@@ -571,6 +902,9 @@ print_one_die_section(Dwarf_Debug dbg,Dwarf_Bool is_info)
         struct Dwarf_Debug_Fission_Per_CU_s fission_data;
         int fission_data_result = 0;
         Dwarf_Half cu_type = 0;
+        /*  Always TRUE unless this is a -j worker and another
+            worker prints this CU. */
+        boolean is_mine = parallel_claim_cu(loop_count);
 
         memset(&fission_data,0,sizeof(fission_data));
         nres = dwarf_next_cu_header_d(dbg,
@@ -585,7 +919,7 @@ print_one_die_section(Dwarf_Debug dbg,Dwarf_Bool is_info)
             dieprint_cu_offset = 0;
             return nres;
         }
-        if (loop_count == 0 &&!is_info &&
+        if (loop_count == 0 &&!is_info && is_mine &&
             /*  For .debug_types we don't print the section name
                 unless we really have it. */
             print_as_info_or_cu() && do_print_dwarf) {
@@ -596,10 +930,17 @@ print_one_die_section(Dwarf_Debug dbg,Dwarf_Bool is_info)
             return nres;
         }
         if (cu_count >=  break_after_n_units) {
-            printf("Break at %d\n",cu_count);
+            if (is_mine) {
+                printf("Break at %d\n",cu_count);
+            }
             dieprint_cu_offset = 0;
             break;
         }
+        if (!is_mine) {
+            ++cu_count;
+            dieprint_cu_offset = next_cu_offset;
+            continue;
+        }
         /*  Regardless of any options used, get basic
             information about the current CU: producer, name */
         sres = dwarf_siblingof_b(dbg, NULL,is_info, &cu_die, &err);
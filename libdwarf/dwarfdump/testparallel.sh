@@ -0,0 +1,30 @@
+#!/bin/sh
+#  Checks that dwarfdump -j gives byte for byte the
+#  output of printing one CU at a time.
+#  Usage: testparallel.sh <dwarfdump> <object> [jobs]
+
+dd=$1
+obj=$2
+jobs=${3-4}
+if [ $# -lt 2 ]
+then
+  echo "Usage: testparallel.sh <dwarfdump> <object> [jobs]"
+  exit 1
+fi
+fail=0
+serial=/tmp/dwpartest.$$.1
+parallel=/tmp/dwpartest.$$.$jobs
+for opts in "-i" "-il" "-iv" "-iG" "-iM" "-i -H 2" "-l"
+do
+  $dd $opts $obj >$serial 2>$serial.err
+  $dd $opts -j $jobs $obj >$parallel 2>$parallel.err
+  if cmp -s $serial $parallel && cmp -s $serial.err $parallel.err
+  then
+    echo "PASS dwarfdump $opts -j $jobs $obj"
+  else
+    echo "FAIL dwarfdump $opts -j $jobs $obj"
+    fail=1
+  fi
+done
+rm -f $serial $parallel $serial.err $parallel.err
+exit $fail
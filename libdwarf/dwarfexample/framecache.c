@@ -0,0 +1,335 @@
+/*
+  Copyright (c) 2026 The udb contributors.  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of the example nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY The udb contributors ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL The udb contributors BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+/*  framecache.c
+    This is an example of unwinding repeatedly at the same
+    pcs with a Dwarf_Frame_Cache.  It picks a set of pcs
+    spread over the fdes of .eh_frame (or .debug_frame if
+    there is no .eh_frame) and looks up the register rules
+    for each of them, first with dwarf_get_fde_at_pc() and
+    dwarf_get_fde_info_for_all_regs3() and then with
+    dwarf_frame_cache_get_regs3(), and prints the time
+    per lookup of each. Both print the same checksum.
+
+    Options:
+        --pcs=n         Look up n pcs, default 10000.
+        --iterations=n  Look up all the pcs n times,
+                        default 10.
+        --regs=n        Pass a Dwarf_Regtable3 of n columns,
+                        default all of them (see
+                        dwarf_set_frame_rule_table_size()).
+
+    To use, try
+        make
+        ./framecache framecache
+*/
+#include "config.h"
+
+#include <sys/types.h> /* For open() */
+#include <sys/stat.h>  /* For open() */
+#include <fcntl.h>     /* For open() */
+#include <stdlib.h>     /* For exit() */
+#include <unistd.h>     /* For close() */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "dwarf.h"
+#include "libdwarf.h"
+
+#define TRUE 1
+#define FALSE 0
+
+static int pc_count = 10000;
+static int iterations = 10;
+static int reg_count = 0;
+
+static Dwarf_Unsigned
+mix(Dwarf_Unsigned v)
+{
+    v ^= v >> 33;
+    v *= 0xff51afd7ed558ccdULL;
+    v ^= v >> 33;
+    return v;
+}
+
+static Dwarf_Unsigned
+sum_regtable(Dwarf_Regtable3 *tab3,Dwarf_Addr row_pc)
+{
+    Dwarf_Unsigned sum = mix(row_pc);
+    struct Dwarf_Regtable_Entry3_s *r = &tab3->rt3_cfa_rule;
+    int i = 0;
+
+    sum += mix(r->dw_regnum ^ (r->dw_offset_or_block_len << 16) ^
+        ((Dwarf_Unsigned)r->dw_value_type << 60));
+    for (i = 0; i < tab3->rt3_reg_table_size; ++i) {
+        r = tab3->rt3_rules + i;
+        sum += mix(i ^ (r->dw_regnum << 16) ^
+            (r->dw_offset_or_block_len << 32) ^
+            ((Dwarf_Unsigned)r->dw_value_type << 60) ^
+            ((Dwarf_Unsigned)r->dw_offset_relevant << 62));
+    }
+    return sum;
+}
+
+/*  Picks pcs all over the text covered by the fdes, the
+    same ones every run. */
+static Dwarf_Addr *
+make_pcs(Dwarf_Fde *fde_data,Dwarf_Signed fde_count)
+{
+    Dwarf_Addr *pcs = 0;
+    Dwarf_Unsigned seed = 12345;
+    int i = 0;
+
+    pcs = (Dwarf_Addr *)malloc(pc_count * sizeof(Dwarf_Addr));
+    if (!pcs) {
+        printf("Unable to malloc %d pcs\n",pc_count);
+        exit(1);
+    }
+    for (i = 0; i < pc_count; ++i) {
+        Dwarf_Addr lowpc = 0;
+        Dwarf_Unsigned func_length = 0;
+        Dwarf_Error error = 0;
+        int res = 0;
+
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        res = dwarf_get_fde_range(fde_data[(seed >> 33) % fde_count],
+            &lowpc,&func_length,0,0,0,0,0,&error);
+        if (res != DW_DLV_OK || !func_length) {
+            pcs[i] = 0;
+            continue;
+        }
+        pcs[i] = lowpc + (seed >> 13) % func_length;
+    }
+    return pcs;
+}
+
+/*  With checksum FALSE only the row pcs are summed, so
+    the time is that of the lookups. */
+static Dwarf_Unsigned
+lookup_uncached(Dwarf_Fde *fde_data,Dwarf_Addr *pcs,
+    Dwarf_Regtable3 *tab3,int checksum)
+{
+    Dwarf_Unsigned sum = 0;
+    int i = 0;
+
+    for (i = 0; i < pc_count; ++i) {
+        Dwarf_Fde fde = 0;
+        Dwarf_Addr row_pc = 0;
+        Dwarf_Error error = 0;
+        int res = 0;
+
+        res = dwarf_get_fde_at_pc(fde_data,pcs[i],&fde,0,0,&error);
+        if (res != DW_DLV_OK) {
+            continue;
+        }
+        res = dwarf_get_fde_info_for_all_regs3(fde,pcs[i],tab3,
+            &row_pc,&error);
+        if (res != DW_DLV_OK) {
+            continue;
+        }
+        sum += checksum? sum_regtable(tab3,row_pc) : row_pc;
+    }
+    return sum;
+}
+
+static Dwarf_Unsigned
+lookup_cached(Dwarf_Frame_Cache cache,Dwarf_Addr *pcs,
+    Dwarf_Regtable3 *tab3,int checksum)
+{
+    Dwarf_Unsigned sum = 0;
+    int i = 0;
+
+    for (i = 0; i < pc_count; ++i) {
+        Dwarf_Addr row_pc = 0;
+        Dwarf_Error error = 0;
+        int res = 0;
+
+        res = dwarf_frame_cache_get_regs3(cache,pcs[i],tab3,
+            &row_pc,0,0,&error);
+        if (res != DW_DLV_OK) {
+            continue;
+        }
+        sum += checksum? sum_regtable(tab3,row_pc) : row_pc;
+    }
+    return sum;
+}
+
+static double
+seconds_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int
+startswithextractnum(const char *arg,const char *lookfor, int *numout)
+{
+    const char *s = 0;
+    unsigned prefixlen = strlen(lookfor);
+    int v = 0;
+    if(strncmp(arg,lookfor,prefixlen)) {
+        return FALSE;
+    }
+    s = arg+prefixlen;
+    v = atoi(s);
+    *numout = v;
+    return TRUE;
+}
+
+int
+main(int argc, char **argv)
+{
+    Dwarf_Debug dbg = 0;
+    int fd = -1;
+    const char *filepath = 0;
+    int res = DW_DLV_ERROR;
+    Dwarf_Error error = 0;
+    Dwarf_Cie *cie_data = 0;
+    Dwarf_Signed cie_count = 0;
+    Dwarf_Fde *fde_data = 0;
+    Dwarf_Signed fde_count = 0;
+    Dwarf_Frame_Cache cache = 0;
+    Dwarf_Regtable3 tab3;
+    Dwarf_Addr *pcs = 0;
+    Dwarf_Unsigned uncached_sum = 0;
+    Dwarf_Unsigned cached_sum = 0;
+    double start = 0;
+    double uncached_time = 0;
+    double first_time = 0;
+    double cached_time = 0;
+    double lookups = 0;
+    int rulecount = 0;
+    int i = 0;
+
+    for(i = 1; i < (argc-1) ; ++i) {
+        if(startswithextractnum(argv[i],"--pcs=",&pc_count)) {
+            /* done */
+        } else if(startswithextractnum(argv[i],"--iterations=",
+            &iterations)) {
+            /* done */
+        } else if(startswithextractnum(argv[i],"--regs=",
+            &reg_count)) {
+            /* done */
+        } else {
+            printf("Unknown argument \"%s\" ignored\n",argv[i]);
+        }
+    }
+    if (argc < 2 || iterations < 1 || pc_count < 1 || reg_count < 0) {
+        printf("Usage: framecache [--pcs=n] [--iterations=n] "
+            "[--regs=n] objectfile\n");
+        exit(1);
+    }
+    filepath = argv[argc-1];
+    fd = open(filepath,O_RDONLY);
+    if(fd < 0) {
+        printf("Failure attempting to open \"%s\"\n",filepath);
+        exit(1);
+    }
+    res = dwarf_init(fd,DW_DLC_READ,0,0,&dbg,&error);
+    if(res != DW_DLV_OK) {
+        printf("Giving up, cannot do DWARF processing\n");
+        exit(1);
+    }
+    res = dwarf_get_fde_list_eh(dbg,&cie_data,&cie_count,
+        &fde_data,&fde_count,&error);
+    if (res != DW_DLV_OK) {
+        res = dwarf_get_fde_list(dbg,&cie_data,&cie_count,
+            &fde_data,&fde_count,&error);
+    }
+    if (res != DW_DLV_OK || !fde_count) {
+        printf("No frame information in \"%s\"\n",filepath);
+        exit(1);
+    }
+
+    /*  1 is arbitrary. We are winding up getting the
+        rule count here while leaving things unchanged. */
+    rulecount = dwarf_set_frame_rule_table_size(dbg,1);
+    dwarf_set_frame_rule_table_size(dbg,rulecount);
+    if (reg_count && reg_count < rulecount) {
+        rulecount = reg_count;
+    }
+    tab3.rt3_reg_table_size = rulecount;
+    tab3.rt3_rules = (struct Dwarf_Regtable_Entry3_s *) malloc(
+        sizeof(struct Dwarf_Regtable_Entry3_s)* rulecount);
+    if (!tab3.rt3_rules) {
+        printf("Unable to malloc for %d rules\n",rulecount);
+        exit(1);
+    }
+    pcs = make_pcs(fde_data,fde_count);
+
+    uncached_sum = lookup_uncached(fde_data,pcs,&tab3,TRUE);
+    start = seconds_now();
+    for (i = 0; i < iterations; ++i) {
+        lookup_uncached(fde_data,pcs,&tab3,FALSE);
+    }
+    uncached_time = seconds_now() - start;
+
+    res = dwarf_frame_cache_create(fde_data,&cache,&error);
+    if (res != DW_DLV_OK) {
+        printf("dwarf_frame_cache_create failed!\n");
+        exit(1);
+    }
+    /*  The first pass fills the cache, the rest only
+        look rows up. */
+    start = seconds_now();
+    lookup_cached(cache,pcs,&tab3,FALSE);
+    first_time = seconds_now() - start;
+    start = seconds_now();
+    for (i = 0; i < iterations; ++i) {
+        lookup_cached(cache,pcs,&tab3,FALSE);
+    }
+    cached_time = seconds_now() - start;
+    cached_sum = lookup_cached(cache,pcs,&tab3,TRUE);
+    dwarf_frame_cache_dealloc(cache);
+
+    lookups = (double)pc_count * iterations;
+    printf("%s: %" DW_PR_DSd " fdes, %d pcs, %d iterations, "
+        "%d register columns\n",
+        filepath,fde_count,pc_count,iterations,rulecount);
+    printf("uncached: %.1f ns/lookup, checksum 0x%" DW_PR_DUx "\n",
+        uncached_time * 1e9 / lookups,uncached_sum);
+    printf("cache fill: %.1f ns/lookup\n",
+        first_time * 1e9 / pc_count);
+    printf("cached: %.1f ns/lookup, checksum 0x%" DW_PR_DUx "\n",
+        cached_time * 1e9 / lookups,cached_sum);
+    if (uncached_sum != cached_sum) {
+        printf("FAIL: cached rows differ from uncached rows\n");
+        exit(1);
+    }
+
+    free(pcs);
+    free(tab3.rt3_rules);
+    dwarf_fde_cie_list_dealloc(dbg,cie_data,cie_count,
+        fde_data,fde_count);
+    res = dwarf_finish(dbg,&error);
+    if(res != DW_DLV_OK) {
+        printf("dwarf_finish failed!\n");
+    }
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,263 @@
+/*
+  Copyright (c) 2026 The udb contributors.  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of the example nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY The udb contributors ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL The udb contributors BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+/*  linereader.c
+    This is an example of reading line tables with
+    dwarf_srclines_stream(), which hands each row to a
+    callback instead of building a Dwarf_Line for it.
+    With --srclines-b the same rows are read with
+    dwarf_srclines_b() instead, so the two can be timed
+    against each other. Both print the same row count
+    and checksum.
+
+    Options:
+        --srclines-b    Read with dwarf_srclines_b().
+        --iterations=n  Read all the line tables n times,
+                        default 1.
+
+    To use, try
+        make
+        ./linereader linereader
+*/
+#include "config.h"
+
+#include <sys/types.h> /* For open() */
+#include <sys/stat.h>  /* For open() */
+#include <sys/time.h>     /* For getrusage() */
+#include <sys/resource.h> /* For getrusage() */
+#include <fcntl.h>     /* For open() */
+#include <stdlib.h>     /* For exit() */
+#include <unistd.h>     /* For close() */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "dwarf.h"
+#include "libdwarf.h"
+
+#define TRUE 1
+#define FALSE 0
+
+struct linesum {
+    Dwarf_Unsigned ls_rows;
+    Dwarf_Unsigned ls_sum;
+};
+
+static int use_srclines_b = FALSE;
+static int iterations = 1;
+
+static void
+add_row(struct linesum *ls,Dwarf_Addr addr,Dwarf_Unsigned lineno,
+    Dwarf_Unsigned fileno,Dwarf_Bool end_sequence)
+{
+    Dwarf_Unsigned v = addr ^ (lineno << 40) ^ (fileno << 56) ^
+        end_sequence;
+
+    v ^= v >> 33;
+    v *= 0xff51afd7ed558ccdULL;
+    v ^= v >> 33;
+    ls->ls_sum += v;
+    ls->ls_rows++;
+}
+
+static int
+stream_row(const Dwarf_Line_Row *row,void *user_data)
+{
+    add_row((struct linesum *)user_data,row->dlr_address,
+        row->dlr_line,row->dlr_file,row->dlr_end_sequence);
+    return DW_DLV_OK;
+}
+
+static int
+read_lines_stream(Dwarf_Die cu_die,struct linesum *ls,
+    Dwarf_Error *error)
+{
+    Dwarf_Unsigned version = 0;
+
+    return dwarf_srclines_stream(cu_die,stream_row,ls,
+        &version,0,error);
+}
+
+static int
+read_lines_b(Dwarf_Die cu_die,struct linesum *ls,Dwarf_Error *error)
+{
+    Dwarf_Unsigned version = 0;
+    Dwarf_Small table_count = 0;
+    Dwarf_Line_Context line_context = 0;
+    Dwarf_Line *lines = 0;
+    Dwarf_Signed linecount = 0;
+    Dwarf_Signed i = 0;
+    int res = 0;
+
+    res = dwarf_srclines_b(cu_die,&version,&table_count,
+        &line_context,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    res = dwarf_srclines_from_linecontext(line_context,
+        &lines,&linecount,error);
+    if (res != DW_DLV_OK) {
+        dwarf_srclines_dealloc_b(line_context);
+        return res;
+    }
+    for (i = 0; i < linecount; ++i) {
+        Dwarf_Addr addr = 0;
+        Dwarf_Unsigned lineno = 0;
+        Dwarf_Unsigned fileno = 0;
+        Dwarf_Bool end_sequence = 0;
+
+        dwarf_lineaddr(lines[i],&addr,error);
+        dwarf_lineno(lines[i],&lineno,error);
+        dwarf_line_srcfileno(lines[i],&fileno,error);
+        dwarf_lineendsequence(lines[i],&end_sequence,error);
+        add_row(ls,addr,lineno,fileno,end_sequence);
+    }
+    dwarf_srclines_dealloc_b(line_context);
+    return DW_DLV_OK;
+}
+
+static void
+read_all_lines(Dwarf_Debug dbg,struct linesum *ls)
+{
+    Dwarf_Unsigned next_cu_header = 0;
+    Dwarf_Error error = 0;
+
+    for (;;) {
+        Dwarf_Die cu_die = 0;
+        int res = 0;
+
+        res = dwarf_next_cu_header_d(dbg,TRUE,0,0,0,0,0,0,0,0,
+            &next_cu_header,0,&error);
+        if (res == DW_DLV_ERROR) {
+            printf("Error reading CU header: %s\n",dwarf_errmsg(error));
+            exit(1);
+        }
+        if (res == DW_DLV_NO_ENTRY) {
+            return;
+        }
+        res = dwarf_siblingof_b(dbg,0,TRUE,&cu_die,&error);
+        if (res != DW_DLV_OK) {
+            continue;
+        }
+        if (use_srclines_b) {
+            res = read_lines_b(cu_die,ls,&error);
+        } else {
+            res = read_lines_stream(cu_die,ls,&error);
+        }
+        if (res == DW_DLV_ERROR) {
+            printf("Error reading line table: %s\n",dwarf_errmsg(error));
+            dwarf_dealloc(dbg,error,DW_DLA_ERROR);
+        }
+        dwarf_dealloc(dbg,cu_die,DW_DLA_DIE);
+    }
+}
+
+static double
+seconds_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int
+startswithextractnum(const char *arg,const char *lookfor, int *numout)
+{
+    const char *s = 0;
+    unsigned prefixlen = strlen(lookfor);
+    int v = 0;
+    if(strncmp(arg,lookfor,prefixlen)) {
+        return FALSE;
+    }
+    s = arg+prefixlen;
+    v = atoi(s);
+    *numout = v;
+    return TRUE;
+}
+
+int
+main(int argc, char **argv)
+{
+    Dwarf_Debug dbg = 0;
+    int fd = -1;
+    const char *filepath = 0;
+    int res = DW_DLV_ERROR;
+    Dwarf_Error error = 0;
+    struct linesum ls;
+    struct rusage usage;
+    double start = 0;
+    double elapsed = 0;
+    int i = 0;
+
+    for(i = 1; i < (argc-1) ; ++i) {
+        if(strcmp(argv[i],"--srclines-b") == 0) {
+            use_srclines_b = TRUE;
+        } else if(startswithextractnum(argv[i],"--iterations=",
+            &iterations)) {
+            /* done */
+        } else {
+            printf("Unknown argument \"%s\" ignored\n",argv[i]);
+        }
+    }
+    if (argc < 2 || iterations < 1) {
+        printf("Usage: linereader [--srclines-b] [--iterations=n] "
+            "objectfile\n");
+        exit(1);
+    }
+    filepath = argv[argc-1];
+    fd = open(filepath,O_RDONLY);
+    if(fd < 0) {
+        printf("Failure attempting to open \"%s\"\n",filepath);
+        exit(1);
+    }
+    res = dwarf_init(fd,DW_DLC_READ,0,0,&dbg,&error);
+    if(res != DW_DLV_OK) {
+        printf("Giving up, cannot do DWARF processing\n");
+        exit(1);
+    }
+
+    memset(&ls,0,sizeof(ls));
+    start = seconds_now();
+    for (i = 0; i < iterations; ++i) {
+        /*  Once dwarf_next_cu_header_d() has returned
+            DW_DLV_NO_ENTRY it starts again at the first CU. */
+        read_all_lines(dbg,&ls);
+    }
+    elapsed = seconds_now() - start;
+    getrusage(RUSAGE_SELF,&usage);
+    printf("%s: %s, %" DW_PR_DUu " rows, checksum 0x%" DW_PR_DUx "\n",
+        filepath,use_srclines_b? "dwarf_srclines_b":"dwarf_srclines_stream",
+        ls.ls_rows,ls.ls_sum);
+    printf("%.3f seconds, %.1f million rows/second, max RSS %ld KB\n",
+        elapsed,ls.ls_rows / elapsed / 1e6,usage.ru_maxrss);
+
+    res = dwarf_finish(dbg,&error);
+    if(res != DW_DLV_OK) {
+        printf("dwarf_finish failed!\n");
+    }
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,973 @@
+/*
+  Copyright (c) 2026 The udb contributors.  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of the example nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY The udb contributors ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL The udb contributors BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+/*  loceval.c
+    This is an example of evaluating location expressions
+    with dwarf_loc_program_compile() and
+    dwarf_loc_program_eval().  It collects every
+    DW_AT_location and DW_AT_frame_base expression of
+    .debug_info, including each entry of the location
+    lists in .debug_loc, and evaluates all of them against
+    made up registers and memory in three ways:
+        decode each time: dwarf_loclist_from_expr_b() and
+            a simple interpreter over the Dwarf_Loc-s,
+            as a debugger not keeping anything would.
+        decode once: the same interpreter over Dwarf_Loc-s
+            decoded before timing.
+        compiled: dwarf_loc_program_eval() on programs
+            compiled before timing.
+    and prints the evaluations per second of each and the
+    time to compile.  The results of the interpreter and
+    of dwarf_loc_program_eval() are compared, and both are
+    checked on a few expressions with a 4 byte address size.
+
+    Options:
+        --iterations=n  Evaluate all the expressions n times,
+                        default 20.
+
+    To use, try
+        make
+        ./loceval loceval
+*/
+#include "config.h"
+
+#include <sys/types.h> /* For open() */
+#include <sys/stat.h>  /* For open() */
+#include <fcntl.h>     /* For open() */
+#include <stdlib.h>     /* For exit() */
+#include <unistd.h>     /* For close() */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "dwarf.h"
+#include "libdwarf.h"
+
+#define TRUE 1
+#define FALSE 0
+
+#define MAX_PIECES 16
+#define REF_STACK_SIZE 64
+
+struct expr_s {
+    Dwarf_Ptr      ex_bytes;
+    Dwarf_Unsigned ex_len;
+    Dwarf_Half     ex_address_size;
+    Dwarf_Half     ex_offset_size;
+    Dwarf_Half     ex_version;
+};
+
+static struct expr_s *exprs;
+static Dwarf_Unsigned expr_count;
+static Dwarf_Unsigned expr_space;
+static int iterations = 20;
+
+static void
+add_expr(Dwarf_Ptr bytes,Dwarf_Unsigned len,
+    Dwarf_Half address_size,Dwarf_Half offset_size,
+    Dwarf_Half version)
+{
+    struct expr_s *e = 0;
+
+    if (expr_count == expr_space) {
+        expr_space = expr_space? expr_space * 2 : 1024;
+        exprs = (struct expr_s *)realloc(exprs,
+            expr_space * sizeof(struct expr_s));
+        if (!exprs) {
+            printf("Unable to realloc for %" DW_PR_DUu
+                " expressions\n",expr_space);
+            exit(1);
+        }
+    }
+    e = exprs + expr_count++;
+    e->ex_bytes = bytes;
+    e->ex_len = len;
+    e->ex_address_size = address_size;
+    e->ex_offset_size = offset_size;
+    e->ex_version = version;
+}
+
+/*  Adds the expression, or each expression of the location
+    list, that attr has. */
+static void
+add_attr_exprs(Dwarf_Debug dbg,Dwarf_Attribute attr,
+    Dwarf_Half address_size,Dwarf_Half offset_size,
+    Dwarf_Half version)
+{
+    Dwarf_Half form = 0;
+    Dwarf_Unsigned offset = 0;
+    Dwarf_Error error = 0;
+    int res = 0;
+
+    res = dwarf_whatform(attr,&form,&error);
+    if (res != DW_DLV_OK) {
+        return;
+    }
+    if (form == DW_FORM_exprloc) {
+        Dwarf_Unsigned len = 0;
+        Dwarf_Ptr bytes = 0;
+
+        res = dwarf_formexprloc(attr,&len,&bytes,&error);
+        if (res == DW_DLV_OK) {
+            add_expr(bytes,len,address_size,offset_size,version);
+        }
+        return;
+    }
+    if (form == DW_FORM_block1 || form == DW_FORM_block2 ||
+        form == DW_FORM_block4 || form == DW_FORM_block) {
+        Dwarf_Block *block = 0;
+
+        res = dwarf_formblock(attr,&block,&error);
+        if (res == DW_DLV_OK) {
+            /* bl_data points into the section. */
+            add_expr(block->bl_data,block->bl_len,
+                address_size,offset_size,version);
+            dwarf_dealloc(dbg,block,DW_DLA_BLOCK);
+        }
+        return;
+    }
+    if (form == DW_FORM_sec_offset) {
+        Dwarf_Off off = 0;
+
+        res = dwarf_global_formref(attr,&off,&error);
+        offset = off;
+    } else if (form == DW_FORM_data4 || form == DW_FORM_data8) {
+        res = dwarf_formudata(attr,&offset,&error);
+    } else {
+        return;
+    }
+    if (res != DW_DLV_OK) {
+        return;
+    }
+    for (;;) {
+        Dwarf_Addr hipc = 0;
+        Dwarf_Addr lopc = 0;
+        Dwarf_Ptr data = 0;
+        Dwarf_Unsigned entry_len = 0;
+        Dwarf_Unsigned next_entry = 0;
+
+        res = dwarf_get_loclist_entry(dbg,offset,&hipc,&lopc,
+            &data,&entry_len,&next_entry,&error);
+        if (res != DW_DLV_OK || (lopc == 0 && hipc == 0)) {
+            return;
+        }
+        if (entry_len) {
+            add_expr(data,entry_len,address_size,offset_size,version);
+        }
+        offset = next_entry;
+    }
+}
+
+/*  Adds the expressions of die, its siblings after it
+    and all their children. */
+static void
+add_die_exprs(Dwarf_Debug dbg,Dwarf_Die in_die,
+    Dwarf_Half address_size,Dwarf_Half offset_size,
+    Dwarf_Half version)
+{
+    static const Dwarf_Half attrnums[] = {
+        DW_AT_location, DW_AT_frame_base };
+    Dwarf_Die die = in_die;
+
+    for (;;) {
+        Dwarf_Die child = 0;
+        Dwarf_Die sibling = 0;
+        Dwarf_Error error = 0;
+        unsigned i = 0;
+        int res = 0;
+
+        for (i = 0; i < sizeof(attrnums)/sizeof(attrnums[0]); ++i) {
+            Dwarf_Attribute attr = 0;
+
+            res = dwarf_attr(die,attrnums[i],&attr,&error);
+            if (res == DW_DLV_OK) {
+                add_attr_exprs(dbg,attr,address_size,offset_size,
+                    version);
+                dwarf_dealloc(dbg,attr,DW_DLA_ATTR);
+            }
+        }
+        res = dwarf_child(die,&child,&error);
+        if (res == DW_DLV_OK) {
+            add_die_exprs(dbg,child,address_size,offset_size,version);
+            dwarf_dealloc(dbg,child,DW_DLA_DIE);
+        }
+        res = dwarf_siblingof_b(dbg,die,TRUE,&sibling,&error);
+        if (die != in_die) {
+            dwarf_dealloc(dbg,die,DW_DLA_DIE);
+        }
+        if (res != DW_DLV_OK) {
+            return;
+        }
+        die = sibling;
+    }
+}
+
+static void
+collect_exprs(Dwarf_Debug dbg)
+{
+    for (;;) {
+        Dwarf_Unsigned cu_header_length = 0;
+        Dwarf_Half version_stamp = 0;
+        Dwarf_Off abbrev_offset = 0;
+        Dwarf_Half address_size = 0;
+        Dwarf_Half offset_size = 0;
+        Dwarf_Half extension_size = 0;
+        Dwarf_Sig8 signature;
+        Dwarf_Unsigned typeoffset = 0;
+        Dwarf_Unsigned next_cu_header = 0;
+        Dwarf_Half header_cu_type = 0;
+        Dwarf_Die cu_die = 0;
+        Dwarf_Error error = 0;
+        int res = 0;
+
+        res = dwarf_next_cu_header_d(dbg,TRUE,&cu_header_length,
+            &version_stamp,&abbrev_offset,&address_size,&offset_size,
+            &extension_size,&signature,&typeoffset,&next_cu_header,
+            &header_cu_type,&error);
+        if (res != DW_DLV_OK) {
+            return;
+        }
+        res = dwarf_siblingof_b(dbg,0,TRUE,&cu_die,&error);
+        if (res != DW_DLV_OK) {
+            continue;
+        }
+        add_die_exprs(dbg,cu_die,address_size,offset_size,
+            version_stamp);
+        dwarf_dealloc(dbg,cu_die,DW_DLA_DIE);
+    }
+}
+
+/*  The made up target. */
+static int
+read_register(void *user_data,Dwarf_Unsigned regnum,
+    Dwarf_Unsigned *value)
+{
+    *value = 0x7ffc00000000ULL + regnum * 0x1000;
+    return DW_DLV_OK;
+}
+
+static int
+read_memory(void *user_data,Dwarf_Addr addr,Dwarf_Small size,
+    Dwarf_Unsigned *value)
+{
+    Dwarf_Unsigned v = addr * 0x9e3779b97f4a7c15ULL;
+
+    v ^= v >> 29;
+    if (size < 8) {
+        v &= ((Dwarf_Unsigned)1 << (size * 8)) - 1;
+    }
+    *value = v;
+    return DW_DLV_OK;
+}
+
+static int
+frame_base(void *user_data,Dwarf_Addr *value)
+{
+    *value = 0x7ffd00001000ULL;
+    return DW_DLV_OK;
+}
+
+static int
+call_frame_cfa(void *user_data,Dwarf_Addr *value)
+{
+    *value = 0x7ffd00002000ULL;
+    return DW_DLV_OK;
+}
+
+static int
+tls_address(void *user_data,Dwarf_Unsigned offset,Dwarf_Addr *value)
+{
+    *value = 0x7f0000000000ULL + offset;
+    return DW_DLV_OK;
+}
+
+static Dwarf_Loc_Eval_Provider provider = {
+    0, read_register, read_memory, frame_base, call_frame_cfa,
+    tls_address };
+
+/*  v, a value of the address size generic type (zero
+    extended, within mask), as a signed number. */
+static Dwarf_Signed
+ref_signed(Dwarf_Unsigned v,Dwarf_Unsigned mask)
+{
+    if (v & (mask ^ (mask >> 1))) {
+        v |= ~mask;
+    }
+    return (Dwarf_Signed)v;
+}
+
+static int
+ref_loc_index(Dwarf_Locdesc *ld,Dwarf_Unsigned target)
+{
+    int i = 0;
+
+    for (i = 0; i < ld->ld_cents; ++i) {
+        if (ld->ld_s[i].lr_offset == target) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*  A plain interpreter over the Dwarf_Loc-s, to compare
+    dwarf_loc_program_eval() with, in time and in results.
+    Returns DW_DLV_NO_ENTRY for what it does not do
+    and DW_DLV_ERROR for a bad expression. */
+static int
+ref_eval(Dwarf_Locdesc *ld,Dwarf_Unsigned expr_len,
+    Dwarf_Half address_size,Dwarf_Loc_Value *values,Dwarf_Unsigned *value_count)
+{
+    Dwarf_Unsigned stack[REF_STACK_SIZE];
+    Dwarf_Unsigned mask = (address_size < 8)?
+        ((Dwarf_Unsigned)1 << (address_size * 8)) - 1 :
+        ~(Dwarf_Unsigned)0;
+    int kind = DW_LOC_VALUE_ADDRESS;
+    int sp = 0;
+    int i = 0;
+    int steps = 0;
+    Dwarf_Unsigned pieces = 0;
+
+    memset(values,0,sizeof(*values));
+    while (i < ld->ld_cents) {
+        Dwarf_Loc *op = ld->ld_s + i;
+        Dwarf_Small atom = op->lr_atom;
+        Dwarf_Unsigned a = 0;
+        Dwarf_Unsigned b = 0;
+        Dwarf_Addr v = 0;
+        int target = 0;
+
+        i++;
+        if (++steps > 100000) {
+            return DW_DLV_ERROR;
+        }
+        if (kind != DW_LOC_VALUE_ADDRESS && atom != DW_OP_piece &&
+            atom != DW_OP_bit_piece && atom != DW_OP_nop &&
+            atom != DW_OP_GNU_uninit) {
+            return DW_DLV_ERROR;
+        }
+        if (sp >= REF_STACK_SIZE - 1) {
+            return DW_DLV_ERROR;
+        }
+        if (atom >= DW_OP_lit0 && atom <= DW_OP_lit31) {
+            stack[sp++] = atom - DW_OP_lit0;
+            continue;
+        }
+        if (atom >= DW_OP_reg0 && atom <= DW_OP_reg31) {
+            kind = DW_LOC_VALUE_REGISTER;
+            a = atom - DW_OP_reg0;
+            values[pieces].dlv_value = a;
+            continue;
+        }
+        if (atom >= DW_OP_breg0 && atom <= DW_OP_breg31) {
+            read_register(0,atom - DW_OP_breg0,&a);
+            stack[sp++] = (a + op->lr_number) & mask;
+            continue;
+        }
+        switch (atom) {
+        case DW_OP_addr:
+        case DW_OP_const1u: case DW_OP_const1s:
+        case DW_OP_const2u: case DW_OP_const2s:
+        case DW_OP_const4u: case DW_OP_const4s:
+        case DW_OP_const8u: case DW_OP_const8s:
+        case DW_OP_constu:  case DW_OP_consts:
+            stack[sp++] = op->lr_number & mask;
+            break;
+        case DW_OP_regx:
+            kind = DW_LOC_VALUE_REGISTER;
+            values[pieces].dlv_value = op->lr_number;
+            break;
+        case DW_OP_bregx:
+            read_register(0,op->lr_number,&a);
+            stack[sp++] = (a + op->lr_number2) & mask;
+            break;
+        case DW_OP_fbreg:
+            frame_base(0,&v);
+            stack[sp++] = (v + op->lr_number) & mask;
+            break;
+        case DW_OP_call_frame_cfa:
+            call_frame_cfa(0,&v);
+            stack[sp++] = v & mask;
+            break;
+        case DW_OP_plus_uconst:
+            if (sp < 1) return DW_DLV_ERROR;
+            stack[sp-1] = (stack[sp-1] + op->lr_number) & mask;
+            break;
+        case DW_OP_dup:
+            if (sp < 1) return DW_DLV_ERROR;
+            stack[sp] = stack[sp-1];
+            sp++;
+            break;
+        case DW_OP_drop:
+            if (sp < 1) return DW_DLV_ERROR;
+            sp--;
+            break;
+        case DW_OP_over:
+            if (sp < 2) return DW_DLV_ERROR;
+            stack[sp] = stack[sp-2];
+            sp++;
+            break;
+        case DW_OP_pick:
+            if (op->lr_number >= (Dwarf_Unsigned)sp) return DW_DLV_ERROR;
+            stack[sp] = stack[sp - 1 - op->lr_number];
+            sp++;
+            break;
+        case DW_OP_swap:
+            if (sp < 2) return DW_DLV_ERROR;
+            a = stack[sp-1];
+            stack[sp-1] = stack[sp-2];
+            stack[sp-2] = a;
+            break;
+        case DW_OP_rot:
+            if (sp < 3) return DW_DLV_ERROR;
+            a = stack[sp-1];
+            stack[sp-1] = stack[sp-2];
+            stack[sp-2] = stack[sp-3];
+            stack[sp-3] = a;
+            break;
+        case DW_OP_deref:
+        case DW_OP_deref_size:
+            if (sp < 1) return DW_DLV_ERROR;
+            b = (atom == DW_OP_deref)? address_size : op->lr_number;
+            if (b < 1 || b > 8) return DW_DLV_NO_ENTRY;
+            read_memory(0,stack[sp-1],b,&a);
+            stack[sp-1] = a & mask;
+            break;
+        case DW_OP_abs:
+            if (sp < 1) return DW_DLV_ERROR;
+            if (ref_signed(stack[sp-1],mask) < 0) {
+                stack[sp-1] = -stack[sp-1] & mask;
+            }
+            break;
+        case DW_OP_neg:
+            if (sp < 1) return DW_DLV_ERROR;
+            stack[sp-1] = -stack[sp-1] & mask;
+            break;
+        case DW_OP_not:
+            if (sp < 1) return DW_DLV_ERROR;
+            stack[sp-1] = ~stack[sp-1] & mask;
+            break;
+        case DW_OP_and: case DW_OP_div: case DW_OP_minus:
+        case DW_OP_mod: case DW_OP_mul: case DW_OP_or:
+        case DW_OP_plus: case DW_OP_shl: case DW_OP_shr:
+        case DW_OP_shra: case DW_OP_xor: case DW_OP_eq:
+        case DW_OP_ge: case DW_OP_gt: case DW_OP_le:
+        case DW_OP_lt: case DW_OP_ne:
+            if (sp < 2) return DW_DLV_ERROR;
+            b = stack[--sp];
+            a = stack[sp-1];
+            switch (atom) {
+            case DW_OP_and: a &= b; break;
+            case DW_OP_div:
+                if (!b) return DW_DLV_ERROR;
+                a = (ref_signed(b,mask) == -1)? -a :
+                    (Dwarf_Unsigned)(ref_signed(a,mask) /
+                    ref_signed(b,mask));
+                break;
+            case DW_OP_minus: a -= b; break;
+            case DW_OP_mod:
+                if (!b) return DW_DLV_ERROR;
+                a %= b;
+                break;
+            case DW_OP_mul: a *= b; break;
+            case DW_OP_or: a |= b; break;
+            case DW_OP_plus: a += b; break;
+            case DW_OP_shl: a = (b >= 64)? 0 : a << b; break;
+            case DW_OP_shr: a = (b >= 64)? 0 : a >> b; break;
+            case DW_OP_shra:
+                if (b >= 64) {
+                    b = 63;
+                }
+                a = (Dwarf_Unsigned)ref_signed(a,mask);
+                a = (Dwarf_Unsigned)((Dwarf_Signed)a < 0?
+                    ~((~a) >> b) : a >> b);
+                break;
+            case DW_OP_xor: a ^= b; break;
+            case DW_OP_eq: a = a == b; break;
+            case DW_OP_ge:
+                a = ref_signed(a,mask) >= ref_signed(b,mask);
+                break;
+            case DW_OP_gt:
+                a = ref_signed(a,mask) > ref_signed(b,mask);
+                break;
+            case DW_OP_le:
+                a = ref_signed(a,mask) <= ref_signed(b,mask);
+                break;
+            case DW_OP_lt:
+                a = ref_signed(a,mask) < ref_signed(b,mask);
+                break;
+            case DW_OP_ne: a = a != b; break;
+            }
+            stack[sp-1] = a & mask;
+            break;
+        case DW_OP_skip:
+        case DW_OP_bra:
+            if (atom == DW_OP_bra) {
+                if (sp < 1) return DW_DLV_ERROR;
+                if (stack[--sp] == 0) {
+                    break;
+                }
+            }
+            b = op->lr_offset + 3 + (short)op->lr_number;
+            target = ref_loc_index(ld,b);
+            if (target < 0) {
+                if (b != expr_len) {
+                    return DW_DLV_ERROR;
+                }
+                target = ld->ld_cents;
+            }
+            i = target;
+            break;
+        case DW_OP_nop:
+        case DW_OP_GNU_uninit:
+            break;
+        case DW_OP_form_tls_address:
+        case DW_OP_GNU_push_tls_address:
+            if (sp < 1) return DW_DLV_ERROR;
+            tls_address(0,stack[sp-1],&v);
+            stack[sp-1] = v & mask;
+            break;
+        case DW_OP_stack_value:
+            if (sp < 1) return DW_DLV_ERROR;
+            kind = DW_LOC_VALUE_VALUE;
+            values[pieces].dlv_value = stack[--sp];
+            break;
+        case DW_OP_implicit_value:
+            kind = DW_LOC_VALUE_IMPLICIT;
+            values[pieces].dlv_block = (Dwarf_Ptr)op->lr_number2;
+            values[pieces].dlv_block_len = op->lr_number;
+            break;
+        case DW_OP_piece:
+        case DW_OP_bit_piece:
+            if (pieces + 1 >= MAX_PIECES) return DW_DLV_ERROR;
+            if (kind == DW_LOC_VALUE_ADDRESS) {
+                if (sp > 0) {
+                    values[pieces].dlv_value = stack[--sp];
+                } else {
+                    kind = DW_LOC_VALUE_EMPTY;
+                }
+            }
+            values[pieces].dlv_kind = kind;
+            values[pieces].dlv_piece_bits = (atom == DW_OP_piece)?
+                op->lr_number * 8 : op->lr_number;
+            values[pieces].dlv_piece_bit_offset = (atom == DW_OP_piece)?
+                0 : op->lr_number2;
+            pieces++;
+            memset(values + pieces,0,sizeof(*values));
+            kind = DW_LOC_VALUE_ADDRESS;
+            break;
+        default:
+            return DW_DLV_NO_ENTRY;
+        }
+    }
+    if (pieces) {
+        *value_count = pieces;
+        return DW_DLV_OK;
+    }
+    if (kind == DW_LOC_VALUE_ADDRESS) {
+        if (sp > 0) {
+            values->dlv_value = stack[--sp];
+        } else {
+            kind = DW_LOC_VALUE_EMPTY;
+        }
+    }
+    values->dlv_kind = kind;
+    *value_count = 1;
+    return DW_DLV_OK;
+}
+
+static int
+decode_and_eval(Dwarf_Debug dbg,struct expr_s *e,
+    Dwarf_Loc_Value *values,Dwarf_Unsigned *value_count)
+{
+    Dwarf_Locdesc *ld = 0;
+    Dwarf_Signed listlen = 0;
+    Dwarf_Error error = 0;
+    int res = 0;
+
+    res = dwarf_loclist_from_expr_b(dbg,e->ex_bytes,e->ex_len,
+        e->ex_address_size,e->ex_offset_size,e->ex_version,
+        &ld,&listlen,&error);
+    if (res != DW_DLV_OK) {
+        if (res == DW_DLV_ERROR) {
+            dwarf_dealloc(dbg,error,DW_DLA_ERROR);
+        }
+        return res;
+    }
+    res = ref_eval(ld,e->ex_len,e->ex_address_size,values,value_count);
+    dwarf_dealloc(dbg,ld->ld_s,DW_DLA_LOC_BLOCK);
+    dwarf_dealloc(dbg,ld,DW_DLA_LOCDESC);
+    return res;
+}
+
+static Dwarf_Unsigned
+sum_values(Dwarf_Loc_Value *values,Dwarf_Unsigned count)
+{
+    Dwarf_Unsigned sum = 0;
+    Dwarf_Unsigned i = 0;
+
+    for (i = 0; i < count; ++i) {
+        sum += values[i].dlv_kind + values[i].dlv_value +
+            values[i].dlv_block_len + values[i].dlv_piece_bits;
+    }
+    return sum;
+}
+
+static int
+same_values(Dwarf_Loc_Value *a,Dwarf_Loc_Value *b,Dwarf_Unsigned count)
+{
+    Dwarf_Unsigned i = 0;
+
+    for (i = 0; i < count; ++i) {
+        if (a[i].dlv_kind != b[i].dlv_kind ||
+            a[i].dlv_piece_bits != b[i].dlv_piece_bits ||
+            a[i].dlv_piece_bit_offset != b[i].dlv_piece_bit_offset) {
+            return FALSE;
+        }
+        if (a[i].dlv_kind == DW_LOC_VALUE_IMPLICIT) {
+            if (a[i].dlv_block != b[i].dlv_block ||
+                a[i].dlv_block_len != b[i].dlv_block_len) {
+                return FALSE;
+            }
+        } else if (a[i].dlv_kind != DW_LOC_VALUE_EMPTY &&
+            a[i].dlv_value != b[i].dlv_value) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/*  Expressions whose value depends on the generic type
+    being the 4 byte address size: each is checked as is,
+    so compile folds it, and after a DW_OP_skip to the next
+    operator, which stops the folding. */
+static const struct generic_check_s {
+    Dwarf_Small    gc_bytes[16];
+    Dwarf_Unsigned gc_len;
+    Dwarf_Unsigned gc_value;
+} generic_checks[] = {
+    /* 0 - 1 is 0xffffffff, logical shift right 4 */
+    {{DW_OP_lit0,DW_OP_lit1,DW_OP_minus,DW_OP_lit4,DW_OP_shr,
+        DW_OP_stack_value},6,0x0fffffff},
+    /* -1 arithmetic shift right 4 */
+    {{DW_OP_const4u,0xff,0xff,0xff,0xff,DW_OP_lit4,DW_OP_shra,
+        DW_OP_stack_value},8,0xffffffff},
+    /* -1 / 2 */
+    {{DW_OP_const4u,0xff,0xff,0xff,0xff,DW_OP_lit2,DW_OP_div,
+        DW_OP_stack_value},8,0},
+    /* -1 < 0 */
+    {{DW_OP_const4u,0xff,0xff,0xff,0xff,DW_OP_lit0,DW_OP_lt,
+        DW_OP_stack_value},8,1},
+    /* 0xffffffff + 1 wraps to 0 */
+    {{DW_OP_const4u,0xff,0xff,0xff,0xff,DW_OP_lit1,DW_OP_plus,
+        DW_OP_lit0,DW_OP_eq,DW_OP_stack_value},10,1},
+};
+
+/*  Returns the number of checks that failed. */
+static Dwarf_Unsigned
+check_generic_type(Dwarf_Debug dbg)
+{
+    Dwarf_Unsigned failed = 0;
+    unsigned c = 0;
+    int skip = 0;
+
+    for (c = 0; c < sizeof(generic_checks)/sizeof(generic_checks[0]);
+        ++c) {
+        for (skip = 0; skip < 2; ++skip) {
+            const struct generic_check_s *gc = generic_checks + c;
+            Dwarf_Small bytes[sizeof(gc->gc_bytes) + 3];
+            Dwarf_Loc_Value values[MAX_PIECES];
+            Dwarf_Loc_Value ref_values[MAX_PIECES];
+            Dwarf_Unsigned value_count = 0;
+            Dwarf_Unsigned ref_count = 0;
+            Dwarf_Loc_Program prog = 0;
+            Dwarf_Error error = 0;
+            struct expr_s ex;
+            int res = 0;
+
+            /*  DW_OP_skip 0 */
+            bytes[0] = DW_OP_skip;
+            bytes[1] = 0;
+            bytes[2] = 0;
+            memcpy(bytes + 3,gc->gc_bytes,gc->gc_len);
+            ex.ex_bytes = skip? bytes : bytes + 3;
+            ex.ex_len = gc->gc_len + (skip? 3 : 0);
+            ex.ex_address_size = 4;
+            ex.ex_offset_size = 4;
+            ex.ex_version = 4;
+            res = dwarf_loc_program_compile(dbg,ex.ex_bytes,ex.ex_len,
+                ex.ex_address_size,ex.ex_offset_size,ex.ex_version,
+                &prog,&error);
+            if (res == DW_DLV_OK) {
+                res = dwarf_loc_program_eval(prog,&provider,values,
+                    MAX_PIECES,&value_count,&error);
+                dwarf_loc_program_dealloc(prog);
+            }
+            if (res == DW_DLV_ERROR) {
+                dwarf_dealloc(dbg,error,DW_DLA_ERROR);
+            }
+            if (res != DW_DLV_OK ||
+                values[0].dlv_kind != DW_LOC_VALUE_VALUE ||
+                values[0].dlv_value != gc->gc_value) {
+                printf("FAIL: generic type check %u%s: compiled gives"
+                    " 0x%" DW_PR_DUx "\n",c,skip? " (not folded)" : "",
+                    res == DW_DLV_OK? values[0].dlv_value : 0);
+                failed++;
+            }
+            res = decode_and_eval(dbg,&ex,ref_values,&ref_count);
+            if (res != DW_DLV_OK ||
+                ref_values[0].dlv_kind != DW_LOC_VALUE_VALUE ||
+                ref_values[0].dlv_value != gc->gc_value) {
+                printf("FAIL: generic type check %u%s: interpreter"
+                    " gives 0x%" DW_PR_DUx "\n",c,
+                    skip? " (not folded)" : "",
+                    res == DW_DLV_OK? ref_values[0].dlv_value : 0);
+                failed++;
+            }
+        }
+    }
+    return failed;
+}
+
+static double
+seconds_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int
+startswithextractnum(const char *arg,const char *lookfor, int *numout)
+{
+    const char *s = 0;
+    unsigned prefixlen = strlen(lookfor);
+    int v = 0;
+    if(strncmp(arg,lookfor,prefixlen)) {
+        return FALSE;
+    }
+    s = arg+prefixlen;
+    v = atoi(s);
+    *numout = v;
+    return TRUE;
+}
+
+int
+main(int argc, char **argv)
+{
+    Dwarf_Debug dbg = 0;
+    int fd = -1;
+    const char *filepath = 0;
+    int res = DW_DLV_ERROR;
+    Dwarf_Error error = 0;
+    Dwarf_Loc_Program *progs = 0;
+    Dwarf_Locdesc **decoded = 0;
+    Dwarf_Loc_Value values[MAX_PIECES];
+    Dwarf_Loc_Value ref_values[MAX_PIECES];
+    Dwarf_Unsigned value_count = 0;
+    Dwarf_Unsigned ref_count = 0;
+    Dwarf_Unsigned shape_counts[DW_LOC_PROG_CFA_OFFSET+1];
+    Dwarf_Unsigned compiled = 0;
+    Dwarf_Unsigned mismatches = 0;
+    Dwarf_Unsigned ref_sum = 0;
+    Dwarf_Unsigned decoded_sum = 0;
+    Dwarf_Unsigned compiled_sum = 0;
+    double start = 0;
+    double decode_time = 0;
+    double decoded_time = 0;
+    double compile_time = 0;
+    double compiled_time = 0;
+    double evals = 0;
+    Dwarf_Unsigned e = 0;
+    int i = 0;
+
+    for(i = 1; i < (argc-1) ; ++i) {
+        if(startswithextractnum(argv[i],"--iterations=",
+            &iterations)) {
+            /* done */
+        } else {
+            printf("Unknown argument \"%s\" ignored\n",argv[i]);
+        }
+    }
+    if (argc < 2 || iterations < 1) {
+        printf("Usage: loceval [--iterations=n] objectfile\n");
+        exit(1);
+    }
+    filepath = argv[argc-1];
+    fd = open(filepath,O_RDONLY);
+    if(fd < 0) {
+        printf("Failure attempting to open \"%s\"\n",filepath);
+        exit(1);
+    }
+    res = dwarf_init(fd,DW_DLC_READ,0,0,&dbg,&error);
+    if(res != DW_DLV_OK) {
+        printf("Giving up, cannot do DWARF processing\n");
+        exit(1);
+    }
+    if (check_generic_type(dbg)) {
+        exit(1);
+    }
+    collect_exprs(dbg);
+    if (!expr_count) {
+        printf("No location expressions in \"%s\"\n",filepath);
+        exit(1);
+    }
+    progs = (Dwarf_Loc_Program *)calloc(expr_count,
+        sizeof(Dwarf_Loc_Program));
+    decoded = (Dwarf_Locdesc **)calloc(expr_count,
+        sizeof(Dwarf_Locdesc *));
+    if (!progs || !decoded) {
+        printf("Unable to malloc for %" DW_PR_DUu " expressions\n",
+            expr_count);
+        exit(1);
+    }
+
+    /*  Compile, and compare results with the interpreter. */
+    memset(shape_counts,0,sizeof(shape_counts));
+    start = seconds_now();
+    for (e = 0; e < expr_count; ++e) {
+        struct expr_s *ex = exprs + e;
+
+        res = dwarf_loc_program_compile(dbg,ex->ex_bytes,ex->ex_len,
+            ex->ex_address_size,ex->ex_offset_size,ex->ex_version,
+            progs + e,&error);
+        if (res == DW_DLV_ERROR) {
+            dwarf_dealloc(dbg,error,DW_DLA_ERROR);
+            error = 0;
+        }
+    }
+    compile_time = seconds_now() - start;
+    for (e = 0; e < expr_count; ++e) {
+        Dwarf_Small shape = 0;
+        Dwarf_Signed listlen = 0;
+        int ref_res = 0;
+
+        if (!progs[e]) {
+            continue;
+        }
+        compiled++;
+        dwarf_loc_program_info(progs[e],&shape,0,0,0,&error);
+        shape_counts[shape]++;
+        res = dwarf_loc_program_eval(progs[e],&provider,values,
+            MAX_PIECES,&value_count,&error);
+        if (res == DW_DLV_ERROR) {
+            dwarf_dealloc(dbg,error,DW_DLA_ERROR);
+            error = 0;
+        }
+        ref_res = decode_and_eval(dbg,exprs + e,ref_values,&ref_count);
+        if (res != ref_res || (res == DW_DLV_OK &&
+            (value_count != ref_count ||
+            !same_values(values,ref_values,value_count)))) {
+            mismatches++;
+        }
+        res = dwarf_loclist_from_expr_b(dbg,exprs[e].ex_bytes,
+            exprs[e].ex_len,exprs[e].ex_address_size,
+            exprs[e].ex_offset_size,exprs[e].ex_version,
+            decoded + e,&listlen,&error);
+        if (res != DW_DLV_OK) {
+            printf("FAIL: decoding a compiled expression failed\n");
+            exit(1);
+        }
+    }
+
+    /*  Only the expressions compile takes are timed, so
+        the three do the same work. */
+    start = seconds_now();
+    for (i = 0; i < iterations; ++i) {
+        for (e = 0; e < expr_count; ++e) {
+            if (progs[e] && decode_and_eval(dbg,exprs + e,ref_values,
+                &ref_count) == DW_DLV_OK) {
+                ref_sum += sum_values(ref_values,ref_count);
+            }
+        }
+    }
+    decode_time = seconds_now() - start;
+    start = seconds_now();
+    for (i = 0; i < iterations; ++i) {
+        for (e = 0; e < expr_count; ++e) {
+            if (decoded[e] && ref_eval(decoded[e],
+                exprs[e].ex_len,exprs[e].ex_address_size,ref_values,
+                &ref_count) == DW_DLV_OK) {
+                decoded_sum += sum_values(ref_values,ref_count);
+            }
+        }
+    }
+    decoded_time = seconds_now() - start;
+    start = seconds_now();
+    for (i = 0; i < iterations; ++i) {
+        for (e = 0; e < expr_count; ++e) {
+            if (progs[e] && dwarf_loc_program_eval(progs[e],&provider,
+                values,MAX_PIECES,&value_count,&error) == DW_DLV_OK) {
+                compiled_sum += sum_values(values,value_count);
+            }
+        }
+    }
+    compiled_time = seconds_now() - start;
+
+    evals = (double)compiled * iterations;
+    printf("%s: %" DW_PR_DUu " expressions, %" DW_PR_DUu
+        " compiled, %d iterations\n",
+        filepath,expr_count,compiled,iterations);
+    printf("shapes: general %" DW_PR_DUu " address %" DW_PR_DUu
+        " register %" DW_PR_DUu " reg+offset %" DW_PR_DUu
+        " fbreg+offset %" DW_PR_DUu " cfa+offset %" DW_PR_DUu "\n",
+        shape_counts[DW_LOC_PROG_GENERAL],
+        shape_counts[DW_LOC_PROG_ADDRESS],
+        shape_counts[DW_LOC_PROG_REGISTER],
+        shape_counts[DW_LOC_PROG_REG_OFFSET],
+        shape_counts[DW_LOC_PROG_FRAME_BASE_OFFSET],
+        shape_counts[DW_LOC_PROG_CFA_OFFSET]);
+    printf("compile: %.1f ns/expression\n",
+        compile_time * 1e9 / expr_count);
+    printf("decode each time: %.2f M evals/s, checksum 0x%"
+        DW_PR_DUx "\n",evals / decode_time / 1e6,ref_sum);
+    printf("decode once: %.2f M evals/s, checksum 0x%"
+        DW_PR_DUx "\n",evals / decoded_time / 1e6,decoded_sum);
+    printf("compiled: %.2f M evals/s, checksum 0x%"
+        DW_PR_DUx "\n",evals / compiled_time / 1e6,compiled_sum);
+    if (mismatches || ref_sum != compiled_sum ||
+        decoded_sum != compiled_sum) {
+        printf("FAIL: %" DW_PR_DUu " compiled results differ\n",
+            mismatches);
+        exit(1);
+    }
+
+    for (e = 0; e < expr_count; ++e) {
+        dwarf_loc_program_dealloc(progs[e]);
+        if (decoded[e]) {
+            dwarf_dealloc(dbg,decoded[e]->ld_s,DW_DLA_LOC_BLOCK);
+            dwarf_dealloc(dbg,decoded[e],DW_DLA_LOCDESC);
+        }
+    }
+    free(progs);
+    free(decoded);
+    free(exprs);
+    res = dwarf_finish(dbg,&error);
+    if(res != DW_DLV_OK) {
+        printf("dwarf_finish failed!\n");
+    }
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,607 @@
+/*
+  Copyright (c) 2026 The udb contributors.  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of the example nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY The udb contributors ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL The udb contributors BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+/*  namelookup.c
+    This is an example of finding DIEs by qualified name
+    with dwarf_lookup_name().  It collects the qualified
+    names of the functions, variables and types of
+    .debug_info with its own walk of the DIEs and then
+    looks a sample of them up in three ways:
+        walk: a walk of every DIE for each name, as a
+            program without an index would (a few names).
+        built: dwarf_build_name_index() without
+            accelerators reads every CU up front.
+        accelerated: dwarf_build_name_index() with
+            accelerators, in a second Dwarf_Debug, reads
+            only the CUs .debug_names or .gdb_index lists.
+            The first lookups (cold) read CUs, a second
+            pass (warm) does not.
+    and prints the time to build the index and the time
+    per lookup of each.  Each DIE found is checked to have
+    the name looked up, and the accelerated results are
+    compared with the built ones.
+
+    Options:
+        --names=n       Look up at most n names, default 2000.
+        --iterations=n  Repeat the warm lookups n times,
+                        default 20.
+
+    To use, try
+        make
+        ./namelookup namelookup
+*/
+#include "config.h"
+
+#include <sys/types.h> /* For open() */
+#include <sys/stat.h>  /* For open() */
+#include <fcntl.h>     /* For open() */
+#include <stdlib.h>     /* For exit() */
+#include <unistd.h>     /* For close() */
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include "dwarf.h"
+#include "libdwarf.h"
+
+#define TRUE 1
+#define FALSE 0
+
+#define WALK_LOOKUPS 20
+
+static char **names;
+static Dwarf_Unsigned name_count;
+static Dwarf_Unsigned name_space;
+static int max_names = 2000;
+static int iterations = 20;
+
+static void
+add_name(const char *prefix,const char *name)
+{
+    size_t len = (prefix? strlen(prefix) + 2 : 0) + strlen(name) + 1;
+    char *s = (char *)malloc(len);
+
+    if (!s) {
+        printf("Unable to malloc for a name\n");
+        exit(1);
+    }
+    if (prefix) {
+        snprintf(s,len,"%s::%s",prefix,name);
+    } else {
+        snprintf(s,len,"%s",name);
+    }
+    if (name_count == name_space) {
+        name_space = name_space? name_space * 2 : 1024;
+        names = (char **)realloc(names,name_space * sizeof(char *));
+        if (!names) {
+            printf("Unable to realloc for %" DW_PR_DUu " names\n",
+                name_space);
+            exit(1);
+        }
+    }
+    names[name_count++] = s;
+}
+
+static int
+is_scope(Dwarf_Half tag)
+{
+    return tag == DW_TAG_namespace || tag == DW_TAG_class_type ||
+        tag == DW_TAG_structure_type || tag == DW_TAG_union_type;
+}
+
+/*  Calls visit for each DIE from die on, its siblings and
+    (through namespaces, classes, structs and unions) their
+    children, with the qualified name of the scope of each.
+    Stops, returning TRUE, when visit does. */
+static int
+walk_dies(Dwarf_Debug dbg,Dwarf_Die die,const char *prefix,
+    int (*visit)(Dwarf_Debug,Dwarf_Die,Dwarf_Half,const char *,
+        const char *,void *),
+    void *data)
+{
+    Dwarf_Error error = 0;
+    int stop = FALSE;
+
+    while (!stop) {
+        Dwarf_Die child = 0;
+        Dwarf_Die sibling = 0;
+        Dwarf_Half tag = 0;
+        char *name = 0;
+        int res = 0;
+
+        res = dwarf_tag(die,&tag,&error);
+        if (res != DW_DLV_OK) {
+            printf("dwarf_tag failed\n");
+            exit(1);
+        }
+        res = dwarf_diename(die,&name,&error);
+        if (res == DW_DLV_ERROR) {
+            printf("dwarf_diename failed\n");
+            exit(1);
+        }
+        if (res == DW_DLV_NO_ENTRY && tag == DW_TAG_namespace) {
+            name = "(anonymous namespace)";
+        }
+        if (name) {
+            stop = visit(dbg,die,tag,prefix,name,data);
+        }
+        if (!stop && name && is_scope(tag) &&
+            dwarf_child(die,&child,&error) == DW_DLV_OK) {
+            size_t len = (prefix? strlen(prefix) + 2 : 0) +
+                strlen(name) + 1;
+            char *scope = (char *)malloc(len);
+
+            if (!scope) {
+                printf("Unable to malloc for a scope\n");
+                exit(1);
+            }
+            if (prefix) {
+                snprintf(scope,len,"%s::%s",prefix,name);
+            } else {
+                snprintf(scope,len,"%s",name);
+            }
+            stop = walk_dies(dbg,child,scope,visit,data);
+            free(scope);
+        }
+        res = dwarf_siblingof_b(dbg,die,TRUE,&sibling,&error);
+        dwarf_dealloc(dbg,die,DW_DLA_DIE);
+        if (res != DW_DLV_OK) {
+            break;
+        }
+        die = sibling;
+    }
+    return stop;
+}
+
+/*  Walks every CU of .debug_info. */
+static int
+walk_cus(Dwarf_Debug dbg,
+    int (*visit)(Dwarf_Debug,Dwarf_Die,Dwarf_Half,const char *,
+        const char *,void *),
+    void *data)
+{
+    Dwarf_Unsigned next_cu_header = 0;
+    Dwarf_Error error = 0;
+    int stop = FALSE;
+
+    for (;;) {
+        Dwarf_Die cu_die = 0;
+        Dwarf_Die child = 0;
+        int res = 0;
+
+        res = dwarf_next_cu_header_d(dbg,TRUE,0,0,0,0,0,0,0,0,
+            &next_cu_header,0,&error);
+        if (res != DW_DLV_OK) {
+            break;
+        }
+        if (stop) {
+            /*  Finish the CU list so the next walk starts
+                at the first CU. */
+            continue;
+        }
+        res = dwarf_siblingof_b(dbg,0,TRUE,&cu_die,&error);
+        if (res != DW_DLV_OK) {
+            continue;
+        }
+        if (dwarf_child(cu_die,&child,&error) == DW_DLV_OK) {
+            stop = walk_dies(dbg,child,0,visit,data);
+        }
+        dwarf_dealloc(dbg,cu_die,DW_DLA_DIE);
+    }
+    return stop;
+}
+
+/*  Collects the names of functions, variables and types
+    that are not out-of-line definitions. */
+static int
+collect_visit(Dwarf_Debug dbg,Dwarf_Die die,Dwarf_Half tag,
+    const char *prefix,const char *name,void *data)
+{
+    Dwarf_Bool has_spec = FALSE;
+    Dwarf_Error error = 0;
+
+    (void)dbg;
+    (void)data;
+    switch (tag) {
+    case DW_TAG_subprogram:
+    case DW_TAG_variable:
+    case DW_TAG_class_type:
+    case DW_TAG_structure_type:
+    case DW_TAG_enumeration_type:
+    case DW_TAG_typedef:
+        break;
+    default:
+        return FALSE;
+    }
+    if (dwarf_hasattr(die,DW_AT_specification,&has_spec,&error) ==
+        DW_DLV_OK && has_spec) {
+        return FALSE;
+    }
+    add_name(prefix,name);
+    return FALSE;
+}
+
+struct walk_find_s {
+    const char *wf_name;
+    Dwarf_Off   wf_offset;
+};
+
+static int
+find_visit(Dwarf_Debug dbg,Dwarf_Die die,Dwarf_Half tag,
+    const char *prefix,const char *name,void *data)
+{
+    struct walk_find_s *wf = (struct walk_find_s *)data;
+    const char *want = wf->wf_name;
+    Dwarf_Error error = 0;
+
+    (void)dbg;
+    (void)tag;
+    if (prefix) {
+        size_t plen = strlen(prefix);
+
+        if (strncmp(want,prefix,plen) || strncmp(want + plen,"::",2)) {
+            return FALSE;
+        }
+        want += plen + 2;
+    }
+    if (strcmp(want,name)) {
+        return FALSE;
+    }
+    dwarf_dieoffset(die,&wf->wf_offset,&error);
+    return TRUE;
+}
+
+/*  The part of name after the last "::" outside <> and (),
+    or from an operator keyword on. */
+static const char *
+last_component(const char *name)
+{
+    const char *last = name;
+    int depth = 0;
+
+    for ( ; *name; ++name) {
+        if (name == last && !strncmp(name,"operator",8) &&
+            !isalnum((unsigned char)name[8]) && name[8] != '_') {
+            break;
+        }
+        if (*name == '<' || *name == '(') {
+            ++depth;
+        } else if ((*name == '>' || *name == ')') && depth) {
+            --depth;
+        } else if (!depth && name[0] == ':' && name[1] == ':') {
+            last = name + 2;
+            ++name;
+        }
+    }
+    return last;
+}
+
+/*  Checks that the DIE at offset, or the declaration it
+    completes, is named like the last component of name. */
+static int
+check_found(Dwarf_Debug dbg,Dwarf_Off offset,const char *name)
+{
+    Dwarf_Die die = 0;
+    Dwarf_Error error = 0;
+    char *diename = 0;
+    int ok = FALSE;
+    int res = 0;
+
+    res = dwarf_offdie_b(dbg,offset,TRUE,&die,&error);
+    if (res != DW_DLV_OK) {
+        return FALSE;
+    }
+    res = dwarf_diename(die,&diename,&error);
+    if (res == DW_DLV_NO_ENTRY) {
+        Dwarf_Attribute attr = 0;
+        Dwarf_Off spec = 0;
+
+        if (dwarf_attr(die,DW_AT_specification,&attr,&error) ==
+            DW_DLV_OK) {
+            if (dwarf_global_formref(attr,&spec,&error) == DW_DLV_OK) {
+                ok = check_found(dbg,spec,name);
+            }
+            dwarf_dealloc(dbg,attr,DW_DLA_ATTR);
+        } else if (!strcmp(last_component(name),
+            "(anonymous namespace)")) {
+            ok = TRUE;
+        }
+    } else if (res == DW_DLV_OK) {
+        ok = !strcmp(diename,last_component(name));
+    }
+    dwarf_dealloc(dbg,die,DW_DLA_DIE);
+    return ok;
+}
+
+static double
+seconds_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int
+startswithextractnum(const char *arg,const char *lookfor, int *numout)
+{
+    const char *s = 0;
+    unsigned prefixlen = strlen(lookfor);
+    int v = 0;
+    if(strncmp(arg,lookfor,prefixlen)) {
+        return FALSE;
+    }
+    s = arg+prefixlen;
+    v = atoi(s);
+    *numout = v;
+    return TRUE;
+}
+
+static Dwarf_Debug
+open_dbg(const char *filepath,int *fd)
+{
+    Dwarf_Debug dbg = 0;
+    Dwarf_Error error = 0;
+    int res = 0;
+
+    *fd = open(filepath,O_RDONLY);
+    if(*fd < 0) {
+        printf("Failure attempting to open \"%s\"\n",filepath);
+        exit(1);
+    }
+    res = dwarf_init(*fd,DW_DLC_READ,0,0,&dbg,&error);
+    if(res != DW_DLV_OK) {
+        printf("Giving up, cannot do DWARF processing\n");
+        exit(1);
+    }
+    return dbg;
+}
+
+static const char *
+source_name(Dwarf_Small source)
+{
+    switch (source) {
+    case DW_NAME_INDEX_GDB_INDEX:
+        return ".gdb_index";
+    case DW_NAME_INDEX_DEBUG_NAMES:
+        return ".debug_names";
+    default:
+        break;
+    }
+    return "built";
+}
+
+int
+main(int argc, char **argv)
+{
+    Dwarf_Debug dbg = 0;
+    Dwarf_Debug adbg = 0;
+    int fd = -1;
+    int afd = -1;
+    const char *filepath = 0;
+    int res = DW_DLV_ERROR;
+    Dwarf_Error error = 0;
+    char **sample = 0;
+    Dwarf_Off *built_offsets = 0;
+    Dwarf_Unsigned sample_count = 0;
+    Dwarf_Unsigned step = 1;
+    Dwarf_Unsigned walk_count = 0;
+    Dwarf_Unsigned built_found = 0;
+    Dwarf_Unsigned accel_found = 0;
+    Dwarf_Unsigned accel_differ = 0;
+    Dwarf_Unsigned bad_names = 0;
+    Dwarf_Unsigned names_indexed = 0;
+    Dwarf_Unsigned cus_read = 0;
+    Dwarf_Unsigned first_cus_read = 0;
+    Dwarf_Off first_offset = 0;
+    Dwarf_Unsigned checksum = 0;
+    Dwarf_Small source = 0;
+    double start = 0;
+    double walk_time = 0;
+    double build_time = 0;
+    double built_time = 0;
+    double accel_build_time = 0;
+    double first_time = 0;
+    double cold_time = 0;
+    double warm_time = 0;
+    Dwarf_Unsigned n = 0;
+    int i = 0;
+
+    for(i = 1; i < (argc-1) ; ++i) {
+        if(startswithextractnum(argv[i],"--names=",&max_names)) {
+            /* done */
+        } else if(startswithextractnum(argv[i],"--iterations=",
+            &iterations)) {
+            /* done */
+        } else {
+            printf("Unknown argument \"%s\" ignored\n",argv[i]);
+        }
+    }
+    if (argc < 2 || max_names < 1 || iterations < 1) {
+        printf("Usage: namelookup [--names=n] [--iterations=n] "
+            "objectfile\n");
+        exit(1);
+    }
+    filepath = argv[argc-1];
+    dbg = open_dbg(filepath,&fd);
+    walk_cus(dbg,collect_visit,0);
+    if (!name_count) {
+        printf("No names in \"%s\"\n",filepath);
+        exit(1);
+    }
+
+    /*  An even spread of at most max_names names. */
+    if (name_count > (Dwarf_Unsigned)max_names) {
+        step = (name_count + max_names - 1) / max_names;
+    }
+    sample = (char **)malloc(name_count * sizeof(char *));
+    built_offsets = (Dwarf_Off *)malloc(name_count * sizeof(Dwarf_Off));
+    if (!sample || !built_offsets) {
+        printf("Unable to malloc for %" DW_PR_DUu " names\n",
+            name_count);
+        exit(1);
+    }
+    for (n = 0; n < name_count; n += step) {
+        sample[sample_count++] = names[n];
+    }
+
+    /*  A full walk per lookup, for a few names. */
+    walk_count = sample_count < WALK_LOOKUPS? sample_count :
+        WALK_LOOKUPS;
+    start = seconds_now();
+    for (n = 0; n < walk_count; ++n) {
+        struct walk_find_s wf;
+
+        wf.wf_name = sample[n * (sample_count / walk_count)];
+        wf.wf_offset = 0;
+        walk_cus(dbg,find_visit,&wf);
+        checksum += wf.wf_offset;
+    }
+    walk_time = seconds_now() - start;
+
+    start = seconds_now();
+    res = dwarf_build_name_index(dbg,FALSE,&error);
+    build_time = seconds_now() - start;
+    if (res != DW_DLV_OK) {
+        printf("FAIL: dwarf_build_name_index failed\n");
+        exit(1);
+    }
+    dwarf_get_name_index_info(dbg,0,&names_indexed,&cus_read,&error);
+    for (n = 0; n < sample_count; ++n) {
+        res = dwarf_lookup_name(dbg,sample[n],built_offsets + n,
+            &error);
+        if (res != DW_DLV_OK) {
+            printf("FAIL: \"%s\" not found\n",sample[n]);
+            exit(1);
+        }
+        if (!check_found(dbg,built_offsets[n],sample[n])) {
+            bad_names++;
+        }
+        built_found++;
+    }
+    start = seconds_now();
+    for (i = 0; i < iterations; ++i) {
+        for (n = 0; n < sample_count; ++n) {
+            Dwarf_Off offset = 0;
+
+            dwarf_lookup_name(dbg,sample[n],&offset,&error);
+            checksum += offset;
+        }
+    }
+    built_time = seconds_now() - start;
+
+    /*  A second Dwarf_Debug so nothing is read yet. */
+    adbg = open_dbg(filepath,&afd);
+    start = seconds_now();
+    res = dwarf_build_name_index(adbg,TRUE,&error);
+    accel_build_time = seconds_now() - start;
+    if (res != DW_DLV_OK) {
+        printf("FAIL: dwarf_build_name_index failed\n");
+        exit(1);
+    }
+    dwarf_get_name_index_info(adbg,&source,0,0,&error);
+
+    /*  One lookup on its own, of a name unlikely to be
+        in every CU. */
+    start = seconds_now();
+    dwarf_lookup_name(adbg,sample[sample_count / 2],&first_offset,
+        &error);
+    first_time = seconds_now() - start;
+    dwarf_get_name_index_info(adbg,0,0,&first_cus_read,&error);
+    start = seconds_now();
+    for (n = 0; n < sample_count; ++n) {
+        Dwarf_Off offset = 0;
+
+        res = dwarf_lookup_name(adbg,sample[n],&offset,&error);
+        if (res == DW_DLV_ERROR) {
+            printf("FAIL: dwarf_lookup_name failed\n");
+            exit(1);
+        }
+        if (res == DW_DLV_OK) {
+            accel_found++;
+            if (offset != built_offsets[n]) {
+                accel_differ++;
+            }
+        }
+    }
+    cold_time = seconds_now() - start;
+    start = seconds_now();
+    for (i = 0; i < iterations; ++i) {
+        for (n = 0; n < sample_count; ++n) {
+            Dwarf_Off offset = 0;
+
+            dwarf_lookup_name(adbg,sample[n],&offset,&error);
+            checksum += offset;
+        }
+    }
+    warm_time = seconds_now() - start;
+
+    printf("%s: %" DW_PR_DUu " names collected, %" DW_PR_DUu
+        " looked up\n",filepath,name_count,sample_count);
+    printf("walk: %.1f us/lookup (%" DW_PR_DUu " names)\n",
+        walk_time * 1e6 / walk_count,walk_count);
+    printf("built: index of %" DW_PR_DUu " names from %" DW_PR_DUu
+        " CUs in %.2f ms, %.1f ns/lookup\n",
+        names_indexed,cus_read,build_time * 1e3,
+        built_time * 1e9 / ((double)sample_count * iterations));
+    dwarf_get_name_index_info(adbg,0,&names_indexed,&cus_read,&error);
+    printf("accelerated (%s): setup %.2f ms, first lookup (%s) "
+        "%.1f us, %" DW_PR_DUu " CUs read\n",source_name(source),
+        accel_build_time * 1e3,sample[sample_count / 2],
+        first_time * 1e6,first_cus_read);
+    printf("accelerated: cold %.1f us/lookup, warm %.1f ns/lookup, %"
+        DW_PR_DUu " names from %" DW_PR_DUu " CUs\n",
+        cold_time * 1e6 / sample_count,
+        warm_time * 1e9 / ((double)sample_count * iterations),
+        names_indexed,cus_read);
+    printf("accelerated: %" DW_PR_DUu " of %" DW_PR_DUu
+        " found, %" DW_PR_DUu " at another offset, checksum 0x%"
+        DW_PR_DUx "\n",accel_found,built_found,accel_differ,checksum);
+    if (bad_names || accel_differ) {
+        printf("FAIL: %" DW_PR_DUu " DIEs found have another name, %"
+            DW_PR_DUu " accelerated results differ\n",
+            bad_names,accel_differ);
+        exit(1);
+    }
+
+    for (n = 0; n < name_count; ++n) {
+        free(names[n]);
+    }
+    free(names);
+    free(sample);
+    free(built_offsets);
+    res = dwarf_finish(adbg,&error);
+    if(res != DW_DLV_OK) {
+        printf("dwarf_finish failed!\n");
+    }
+    close(afd);
+    res = dwarf_finish(dbg,&error);
+    if(res != DW_DLV_OK) {
+        printf("dwarf_finish failed!\n");
+    }
+    close(fd);
+    return 0;
+}
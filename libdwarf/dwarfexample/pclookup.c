@@ -0,0 +1,411 @@
+/*
+  Copyright (c) 2026 The udb contributors.  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of the example nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY The udb contributors ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL The udb contributors BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+/*  pclookup.c
+    This is an example of finding the CU that contains an
+    address with dwarf_get_cu_die_offset_given_pc(), checked
+    against the linear path of dwarf_get_aranges(),
+    dwarf_get_arange() and dwarf_get_cu_die_offset().
+    The pcs looked up are the first and last address of
+    aranges, the address just past them, and random addresses
+    from the lowest address of the aranges and CU DIEs to
+    the highest.  The two paths
+    must agree wherever .debug_aranges has an entry;
+    anywhere else dwarf_get_cu_die_offset_given_pc() may
+    only return a CU DIE (from its DW_AT_ranges or
+    DW_AT_low_pc/DW_AT_high_pc).  Prints the time per
+    lookup of each.
+
+    Options:
+        --pcs=n     Look up n pcs, default 20000.
+
+    To use, try
+        make
+        ./pclookup pclookup
+*/
+#include "config.h"
+
+#include <sys/types.h> /* For open() */
+#include <sys/stat.h>  /* For open() */
+#include <fcntl.h>     /* For open() */
+#include <stdlib.h>     /* For exit() */
+#include <unistd.h>     /* For close() */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "dwarf.h"
+#include "libdwarf.h"
+
+#define TRUE 1
+#define FALSE 0
+
+static int pc_count = 20000;
+static Dwarf_Unsigned random_state = 0x2545f4914f6cdd1dULL;
+
+/*  The same pcs on every run. */
+static Dwarf_Unsigned
+next_random(void)
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 7;
+    random_state ^= random_state << 17;
+    return random_state;
+}
+
+static double
+seconds_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int
+startswithextractnum(const char *arg,const char *lookfor, int *numout)
+{
+    const char *s = 0;
+    unsigned prefixlen = strlen(lookfor);
+    int v = 0;
+    if(strncmp(arg,lookfor,prefixlen)) {
+        return FALSE;
+    }
+    s = arg+prefixlen;
+    v = atoi(s);
+    *numout = v;
+    return TRUE;
+}
+
+/*  The linear path: the first arange in the list
+    containing pc. */
+static int
+linear_lookup(Dwarf_Arange *aranges,Dwarf_Signed count,
+    Dwarf_Addr pc,Dwarf_Off *offset)
+{
+    Dwarf_Arange arange = 0;
+    Dwarf_Error error = 0;
+    int res = 0;
+
+    res = dwarf_get_arange(aranges,count,pc,&arange,&error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    return dwarf_get_cu_die_offset(arange,offset,&error);
+}
+
+/*  TRUE if an arange of the CU with DIE offset contains pc.
+    Where aranges of different CUs overlap the two paths
+    can pick different ones. */
+static int
+arange_of_cu_has_pc(Dwarf_Addr *starts,Dwarf_Unsigned *lengths,
+    Dwarf_Off *offsets,Dwarf_Signed count,
+    Dwarf_Addr pc,Dwarf_Off offset)
+{
+    Dwarf_Signed i = 0;
+
+    for (i = 0; i < count; ++i) {
+        if (offsets[i] == offset && pc >= starts[i] &&
+            pc - starts[i] < lengths[i]) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/*  Widens [*lowest,*highest] to take in the
+    DW_AT_low_pc/DW_AT_high_pc of every CU DIE, so
+    CUs .debug_aranges leaves out get looked up too. */
+static void
+widen_by_cu_dies(Dwarf_Debug dbg,Dwarf_Addr *lowest,
+    Dwarf_Addr *highest)
+{
+    Dwarf_Unsigned next_cu_header = 0;
+    Dwarf_Error error = 0;
+
+    for (;;) {
+        Dwarf_Die cu_die = 0;
+        Dwarf_Addr low = 0;
+        Dwarf_Addr high = 0;
+        Dwarf_Half form = 0;
+        enum Dwarf_Form_Class formclass = DW_FORM_CLASS_UNKNOWN;
+        int res = 0;
+
+        res = dwarf_next_cu_header_d(dbg,TRUE,0,0,0,0,0,0,0,0,
+            &next_cu_header,0,&error);
+        if (res != DW_DLV_OK) {
+            break;
+        }
+        res = dwarf_siblingof_b(dbg,0,TRUE,&cu_die,&error);
+        if (res != DW_DLV_OK) {
+            continue;
+        }
+        if (dwarf_lowpc(cu_die,&low,&error) == DW_DLV_OK &&
+            dwarf_highpc_b(cu_die,&high,&form,&formclass,&error) ==
+            DW_DLV_OK) {
+            if (formclass == DW_FORM_CLASS_CONSTANT) {
+                high += low;
+            }
+            if (high > low) {
+                if (low < *lowest) {
+                    *lowest = low;
+                }
+                if (high - 1 > *highest) {
+                    *highest = high - 1;
+                }
+            }
+        }
+        dwarf_dealloc(dbg,cu_die,DW_DLA_DIE);
+    }
+}
+
+/*  TRUE if offset is that of a CU DIE. */
+static int
+is_cu_die(Dwarf_Debug dbg,Dwarf_Off offset)
+{
+    Dwarf_Die die = 0;
+    Dwarf_Error error = 0;
+    Dwarf_Half tag = 0;
+    int res = 0;
+
+    res = dwarf_offdie_b(dbg,offset,TRUE,&die,&error);
+    if (res != DW_DLV_OK) {
+        return FALSE;
+    }
+    res = dwarf_tag(die,&tag,&error);
+    dwarf_dealloc(dbg,die,DW_DLA_DIE);
+    return res == DW_DLV_OK && (tag == DW_TAG_compile_unit ||
+        tag == DW_TAG_partial_unit);
+}
+
+int
+main(int argc, char **argv)
+{
+    Dwarf_Debug dbg = 0;
+    int fd = -1;
+    const char *filepath = 0;
+    int res = DW_DLV_ERROR;
+    Dwarf_Error error = 0;
+    Dwarf_Arange *aranges = 0;
+    Dwarf_Signed arange_count = 0;
+    Dwarf_Addr *starts = 0;
+    Dwarf_Unsigned *lengths = 0;
+    Dwarf_Off *offsets = 0;
+    Dwarf_Addr *pcs = 0;
+    Dwarf_Off *linear_offsets = 0;
+    int *linear_res = 0;
+    Dwarf_Addr lowest = ~(Dwarf_Addr)0;
+    Dwarf_Addr highest = 0;
+    Dwarf_Off offset = 0;
+    Dwarf_Unsigned found = 0;
+    Dwarf_Unsigned extra = 0;
+    Dwarf_Unsigned overlaps = 0;
+    Dwarf_Unsigned failures = 0;
+    Dwarf_Unsigned checksum = 0;
+    double start = 0;
+    double linear_time = 0;
+    double setup_time = 0;
+    double lookup_time = 0;
+    Dwarf_Signed a = 0;
+    int i = 0;
+
+    for(i = 1; i < (argc-1) ; ++i) {
+        if(startswithextractnum(argv[i],"--pcs=",&pc_count)) {
+            /* done */
+        } else {
+            printf("Unknown argument \"%s\" ignored\n",argv[i]);
+        }
+    }
+    if (argc < 2 || pc_count < 1) {
+        printf("Usage: pclookup [--pcs=n] objectfile\n");
+        exit(1);
+    }
+    filepath = argv[argc-1];
+    fd = open(filepath,O_RDONLY);
+    if(fd < 0) {
+        printf("Failure attempting to open \"%s\"\n",filepath);
+        exit(1);
+    }
+    res = dwarf_init(fd,DW_DLC_READ,0,0,&dbg,&error);
+    if(res != DW_DLV_OK) {
+        printf("Giving up, cannot do DWARF processing\n");
+        exit(1);
+    }
+    res = dwarf_get_aranges(dbg,&aranges,&arange_count,&error);
+    if (res == DW_DLV_ERROR) {
+        printf("FAIL: dwarf_get_aranges failed\n");
+        exit(1);
+    }
+    if (res == DW_DLV_NO_ENTRY || !arange_count) {
+        printf("No .debug_aranges in \"%s\"\n",filepath);
+        exit(1);
+    }
+    starts = (Dwarf_Addr *)malloc(arange_count * sizeof(Dwarf_Addr));
+    lengths = (Dwarf_Unsigned *)malloc(arange_count *
+        sizeof(Dwarf_Unsigned));
+    offsets = (Dwarf_Off *)malloc(arange_count * sizeof(Dwarf_Off));
+    pcs = (Dwarf_Addr *)malloc(pc_count * sizeof(Dwarf_Addr));
+    linear_offsets = (Dwarf_Off *)malloc(pc_count * sizeof(Dwarf_Off));
+    linear_res = (int *)malloc(pc_count * sizeof(int));
+    if (!starts || !lengths || !offsets || !pcs || !linear_offsets ||
+        !linear_res) {
+        printf("Unable to malloc for %d pcs\n",pc_count);
+        exit(1);
+    }
+    for (a = 0; a < arange_count; ++a) {
+        res = dwarf_get_arange_info_b(aranges[a],0,0,starts + a,
+            lengths + a,offsets + a,&error);
+        if (res != DW_DLV_OK) {
+            printf("FAIL: dwarf_get_arange_info_b failed\n");
+            exit(1);
+        }
+        if (!lengths[a]) {
+            continue;
+        }
+        if (starts[a] < lowest) {
+            lowest = starts[a];
+        }
+        if (starts[a] + lengths[a] - 1 > highest) {
+            highest = starts[a] + lengths[a] - 1;
+        }
+    }
+    widen_by_cu_dies(dbg,&lowest,&highest);
+    if (lowest > highest) {
+        printf("No address ranges in \"%s\"\n",filepath);
+        exit(1);
+    }
+
+    /*  Three pcs at the edges of an arange, then one
+        anywhere in the code. */
+    for (i = 0; i < pc_count; ++i) {
+        a = next_random() % arange_count;
+        switch (i % 4) {
+        case 0:
+            pcs[i] = starts[a];
+            break;
+        case 1:
+            pcs[i] = starts[a] + lengths[a] - 1;
+            break;
+        case 2:
+            pcs[i] = starts[a] + lengths[a];
+            break;
+        default:
+            pcs[i] = lowest + next_random() % (highest - lowest + 1);
+            break;
+        }
+    }
+
+    start = seconds_now();
+    for (i = 0; i < pc_count; ++i) {
+        linear_res[i] = linear_lookup(aranges,arange_count,pcs[i],
+            linear_offsets + i);
+    }
+    linear_time = seconds_now() - start;
+
+    /*  The first call builds the table. */
+    start = seconds_now();
+    res = dwarf_get_cu_die_offset_given_pc(dbg,pcs[0],&offset,&error);
+    setup_time = seconds_now() - start;
+    if (res == DW_DLV_ERROR) {
+        printf("FAIL: dwarf_get_cu_die_offset_given_pc failed\n");
+        exit(1);
+    }
+    start = seconds_now();
+    for (i = 0; i < pc_count; ++i) {
+        offset = 0;
+        dwarf_get_cu_die_offset_given_pc(dbg,pcs[i],&offset,&error);
+        checksum += offset;
+    }
+    lookup_time = seconds_now() - start;
+
+    for (i = 0; i < pc_count; ++i) {
+        offset = 0;
+        res = dwarf_get_cu_die_offset_given_pc(dbg,pcs[i],&offset,
+            &error);
+        if (res == DW_DLV_ERROR || linear_res[i] == DW_DLV_ERROR) {
+            printf("FAIL: lookup of pc 0x%" DW_PR_XZEROS DW_PR_DUx
+                " failed\n",pcs[i]);
+            exit(1);
+        }
+        if (linear_res[i] == DW_DLV_NO_ENTRY) {
+            if (res == DW_DLV_OK) {
+                /*  A CU .debug_aranges leaves out. */
+                extra++;
+                if (!is_cu_die(dbg,offset)) {
+                    printf("FAIL: pc 0x%" DW_PR_XZEROS DW_PR_DUx
+                        " gives 0x%" DW_PR_DUx ", not a CU DIE\n",
+                        pcs[i],offset);
+                    failures++;
+                }
+            }
+            continue;
+        }
+        found++;
+        if (res == DW_DLV_OK && offset == linear_offsets[i]) {
+            continue;
+        }
+        if (res == DW_DLV_OK && arange_of_cu_has_pc(starts,lengths,
+            offsets,arange_count,pcs[i],offset)) {
+            overlaps++;
+            continue;
+        }
+        printf("FAIL: pc 0x%" DW_PR_XZEROS DW_PR_DUx " gives %s0x%"
+            DW_PR_DUx ", linear path 0x%" DW_PR_DUx "\n",pcs[i],
+            res == DW_DLV_OK? "": "no entry, not ",
+            res == DW_DLV_OK? offset: 0,linear_offsets[i]);
+        failures++;
+    }
+
+    printf("%s: %" DW_PR_DSd " aranges, %d pcs looked up, %" DW_PR_DUu
+        " in .debug_aranges\n",filepath,arange_count,pc_count,found);
+    printf("linear: %.1f us/lookup\n",linear_time * 1e6 / pc_count);
+    printf("given_pc: setup %.2f ms, %.1f ns/lookup, checksum 0x%"
+        DW_PR_DUx "\n",setup_time * 1e3,
+        lookup_time * 1e9 / pc_count,checksum);
+    printf("given_pc: %" DW_PR_DUu " found outside .debug_aranges, %"
+        DW_PR_DUu " in overlapping aranges of another CU\n",
+        extra,overlaps);
+    if (failures) {
+        printf("FAIL: %" DW_PR_DUu " lookups differ\n",failures);
+        exit(1);
+    }
+
+    free(starts);
+    free(lengths);
+    free(offsets);
+    free(pcs);
+    free(linear_offsets);
+    free(linear_res);
+    for (a = 0; a < arange_count; ++a) {
+        dwarf_dealloc(dbg,aranges[a],DW_DLA_ARANGE);
+    }
+    dwarf_dealloc(dbg,aranges,DW_DLA_LIST);
+    res = dwarf_finish(dbg,&error);
+    if(res != DW_DLV_OK) {
+        printf("dwarf_finish failed!\n");
+    }
+    close(fd);
+    return 0;
+}
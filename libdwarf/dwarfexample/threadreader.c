@@ -0,0 +1,418 @@
+/*
+  Copyright (c) 2026 The udb contributors.  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of the example nor the
+    names of its contributors may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY The udb contributors ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL The udb contributors BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+/*  threadreader.c
+    This is an example of reading one object file from
+    several threads at once with dwarf_new_thread_dbg().
+    It doubles as a stress test: each thread walks every
+    DIE of its share of the CUs (every DIE attribute, the
+    source files and the line table) and the results are
+    compared with a walk done by a single thread.
+    Run it under a race detector (for example, build
+    with -fsanitize=thread) to check libdwarf itself.
+
+    Options:
+        --threads=n     Number of threads, default 4.
+        --iterations=n  Number of times to repeat the
+                        threaded walk, default 10.
+
+    To use, try
+        make
+        ./threadreader --threads=8 threadreader
+*/
+#include "config.h"
+
+#include <sys/types.h> /* For open() */
+#include <sys/stat.h>  /* For open() */
+#include <fcntl.h>     /* For open() */
+#include <stdlib.h>     /* For exit() */
+#include <unistd.h>     /* For close() */
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "dwarf.h"
+#include "libdwarf.h"
+
+#define TRUE 1
+#define FALSE 0
+
+struct threaddata {
+    Dwarf_Debug    td_dbg;
+    int            td_index;
+    int            td_count;
+    Dwarf_Unsigned td_cus;
+    Dwarf_Unsigned td_dies;
+    Dwarf_Unsigned td_sum;
+};
+
+static int threadcount = 4;
+static int iterations = 10;
+
+static void
+add_to_sum(Dwarf_Unsigned *sum,Dwarf_Unsigned v)
+{
+    /*  Mix before adding so that the total does not depend
+        on which thread (or in what order) a CU was read. */
+    v ^= v >> 33;
+    v *= 0xff51afd7ed558ccdULL;
+    v ^= v >> 33;
+    *sum += v;
+}
+
+static Dwarf_Unsigned
+string_sum(const char *s)
+{
+    Dwarf_Unsigned h = 14695981039346656037ULL;
+    for (; *s; ++s) {
+        h ^= (unsigned char)*s;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/*  Errors are part of the result, the same error must
+    show up in the same place whichever thread reads it. */
+static void
+add_error(Dwarf_Debug dbg,Dwarf_Error error,Dwarf_Unsigned *sum)
+{
+    add_to_sum(sum,0xe0000000 + dwarf_errno(error));
+    dwarf_dealloc(dbg,error,DW_DLA_ERROR);
+}
+
+static void
+sum_die(Dwarf_Debug dbg,Dwarf_Die die,Dwarf_Unsigned *sum)
+{
+    Dwarf_Half tag = 0;
+    Dwarf_Off offset = 0;
+    char *name = 0;
+    Dwarf_Attribute *attrs = 0;
+    Dwarf_Signed attrcount = 0;
+    Dwarf_Error error = 0;
+    Dwarf_Signed i = 0;
+    int res = 0;
+
+    res = dwarf_dieoffset(die,&offset,&error);
+    if (res == DW_DLV_ERROR) {
+        add_error(dbg,error,sum);
+    }
+    res = dwarf_tag(die,&tag,&error);
+    if (res == DW_DLV_ERROR) {
+        add_error(dbg,error,sum);
+    }
+    add_to_sum(sum,offset * 0x10000 + tag);
+    res = dwarf_diename(die,&name,&error);
+    if (res == DW_DLV_ERROR) {
+        add_error(dbg,error,sum);
+    } else if (res == DW_DLV_OK) {
+        add_to_sum(sum,string_sum(name));
+        dwarf_dealloc(dbg,name,DW_DLA_STRING);
+    }
+    res = dwarf_attrlist(die,&attrs,&attrcount,&error);
+    if (res == DW_DLV_ERROR) {
+        add_error(dbg,error,sum);
+        return;
+    }
+    if (res == DW_DLV_NO_ENTRY) {
+        return;
+    }
+    for (i = 0; i < attrcount; ++i) {
+        Dwarf_Attribute attr = attrs[i];
+        Dwarf_Half attrnum = 0;
+        Dwarf_Half form = 0;
+        Dwarf_Unsigned uval = 0;
+        char *str = 0;
+
+        dwarf_whatattr(attr,&attrnum,&error);
+        dwarf_whatform(attr,&form,&error);
+        add_to_sum(sum,attrnum * 0x10000 + form);
+        res = dwarf_formudata(attr,&uval,&error);
+        if (res == DW_DLV_OK) {
+            add_to_sum(sum,uval);
+        } else if (res == DW_DLV_ERROR) {
+            dwarf_dealloc(dbg,error,DW_DLA_ERROR);
+        }
+        res = dwarf_formstring(attr,&str,&error);
+        if (res == DW_DLV_OK) {
+            add_to_sum(sum,string_sum(str));
+        } else if (res == DW_DLV_ERROR) {
+            dwarf_dealloc(dbg,error,DW_DLA_ERROR);
+        }
+        dwarf_dealloc(dbg,attr,DW_DLA_ATTR);
+    }
+    dwarf_dealloc(dbg,attrs,DW_DLA_LIST);
+}
+
+static void
+sum_lines(Dwarf_Debug dbg,Dwarf_Die cu_die,Dwarf_Unsigned *sum)
+{
+    char **srcfiles = 0;
+    Dwarf_Signed srccount = 0;
+    Dwarf_Line *lines = 0;
+    Dwarf_Signed linecount = 0;
+    Dwarf_Error error = 0;
+    Dwarf_Signed i = 0;
+    int res = 0;
+
+    res = dwarf_srcfiles(cu_die,&srcfiles,&srccount,&error);
+    if (res == DW_DLV_ERROR) {
+        add_error(dbg,error,sum);
+    } else if (res == DW_DLV_OK) {
+        for (i = 0; i < srccount; ++i) {
+            add_to_sum(sum,string_sum(srcfiles[i]));
+            dwarf_dealloc(dbg,srcfiles[i],DW_DLA_STRING);
+        }
+        dwarf_dealloc(dbg,srcfiles,DW_DLA_LIST);
+    }
+    res = dwarf_srclines(cu_die,&lines,&linecount,&error);
+    if (res == DW_DLV_ERROR) {
+        add_error(dbg,error,sum);
+        return;
+    }
+    if (res == DW_DLV_NO_ENTRY) {
+        return;
+    }
+    for (i = 0; i < linecount; ++i) {
+        Dwarf_Addr addr = 0;
+        Dwarf_Unsigned lineno = 0;
+
+        dwarf_lineaddr(lines[i],&addr,&error);
+        dwarf_lineno(lines[i],&lineno,&error);
+        add_to_sum(sum,addr ^ (lineno << 48));
+    }
+    dwarf_srclines_dealloc(dbg,lines,linecount);
+}
+
+static void
+sum_die_and_children(struct threaddata *td,Dwarf_Die in_die)
+{
+    Dwarf_Debug dbg = td->td_dbg;
+    Dwarf_Die cur_die = in_die;
+    Dwarf_Error error = 0;
+    int res = 0;
+
+    for (;;) {
+        Dwarf_Die child = 0;
+        Dwarf_Die sib_die = 0;
+
+        sum_die(dbg,cur_die,&td->td_sum);
+        td->td_dies++;
+        res = dwarf_child(cur_die,&child,&error);
+        if (res == DW_DLV_ERROR) {
+            add_error(dbg,error,&td->td_sum);
+        } else if (res == DW_DLV_OK) {
+            sum_die_and_children(td,child);
+            dwarf_dealloc(dbg,child,DW_DLA_DIE);
+        }
+        res = dwarf_siblingof_b(dbg,cur_die,TRUE,&sib_die,&error);
+        if (cur_die != in_die) {
+            dwarf_dealloc(dbg,cur_die,DW_DLA_DIE);
+        }
+        if (res == DW_DLV_ERROR) {
+            add_error(dbg,error,&td->td_sum);
+            return;
+        }
+        if (res == DW_DLV_NO_ENTRY) {
+            return;
+        }
+        cur_die = sib_die;
+    }
+}
+
+/*  Reads CU number td_index, td_index+td_count, ...
+    Every thread runs through all the CU headers with its
+    own Dwarf_Debug, so each has a private CU cursor. */
+static void *
+read_cus(void *arg)
+{
+    struct threaddata *td = (struct threaddata *)arg;
+    Dwarf_Debug dbg = td->td_dbg;
+    Dwarf_Unsigned next_cu_header = 0;
+    Dwarf_Error error = 0;
+    int cu_number = 0;
+
+    for (;; ++cu_number) {
+        Dwarf_Die cu_die = 0;
+        int res = 0;
+
+        res = dwarf_next_cu_header_d(dbg,TRUE,0,0,0,0,0,0,0,0,
+            &next_cu_header,0,&error);
+        if (res == DW_DLV_ERROR) {
+            add_error(dbg,error,&td->td_sum);
+            return 0;
+        }
+        if (res == DW_DLV_NO_ENTRY) {
+            return 0;
+        }
+        if (cu_number % td->td_count != td->td_index) {
+            continue;
+        }
+        td->td_cus++;
+        res = dwarf_siblingof_b(dbg,0,TRUE,&cu_die,&error);
+        if (res == DW_DLV_ERROR) {
+            add_error(dbg,error,&td->td_sum);
+            continue;
+        }
+        if (res == DW_DLV_NO_ENTRY) {
+            continue;
+        }
+        sum_lines(dbg,cu_die,&td->td_sum);
+        sum_die_and_children(td,cu_die);
+        dwarf_dealloc(dbg,cu_die,DW_DLA_DIE);
+    }
+}
+
+static int
+run_threads(Dwarf_Debug dbg,int count,struct threaddata *total)
+{
+    struct threaddata *tds = 0;
+    pthread_t *threads = 0;
+    Dwarf_Error error = 0;
+    int i = 0;
+    int res = 0;
+
+    tds = (struct threaddata *)calloc(count,sizeof(*tds));
+    threads = (pthread_t *)calloc(count,sizeof(*threads));
+    if (!tds || !threads) {
+        printf("Out of memory\n");
+        exit(1);
+    }
+    /*  All the thread Dwarf_Debugs are created before
+        any thread starts. */
+    for (i = 0; i < count; ++i) {
+        res = dwarf_new_thread_dbg(dbg,&tds[i].td_dbg,&error);
+        if (res != DW_DLV_OK) {
+            printf("dwarf_new_thread_dbg failed: %s\n",
+                res == DW_DLV_ERROR? dwarf_errmsg(error):"no entry");
+            exit(1);
+        }
+        tds[i].td_index = i;
+        tds[i].td_count = count;
+    }
+    for (i = 0; i < count; ++i) {
+        if (pthread_create(&threads[i],0,read_cus,&tds[i])) {
+            printf("pthread_create failed\n");
+            exit(1);
+        }
+    }
+    memset(total,0,sizeof(*total));
+    for (i = 0; i < count; ++i) {
+        pthread_join(threads[i],0);
+        total->td_cus += tds[i].td_cus;
+        total->td_dies += tds[i].td_dies;
+        total->td_sum += tds[i].td_sum;
+        res = dwarf_finish(tds[i].td_dbg,&error);
+        if (res != DW_DLV_OK) {
+            printf("dwarf_finish of thread %d failed!\n",i);
+        }
+    }
+    free(threads);
+    free(tds);
+    return DW_DLV_OK;
+}
+
+static int
+startswithextractnum(const char *arg,const char *lookfor, int *numout)
+{
+    const char *s = 0;
+    unsigned prefixlen = strlen(lookfor);
+    int v = 0;
+    if(strncmp(arg,lookfor,prefixlen)) {
+        return FALSE;
+    }
+    s = arg+prefixlen;
+    v = atoi(s);
+    *numout = v;
+    return TRUE;
+}
+
+int
+main(int argc, char **argv)
+{
+    Dwarf_Debug dbg = 0;
+    int fd = -1;
+    const char *filepath = 0;
+    int res = DW_DLV_ERROR;
+    Dwarf_Error error = 0;
+    struct threaddata serial;
+    struct threaddata threaded;
+    int failures = 0;
+    int i = 0;
+
+    for(i = 1; i < (argc-1) ; ++i) {
+        if(startswithextractnum(argv[i],"--threads=",&threadcount)) {
+            /* done */
+        } else if(startswithextractnum(argv[i],"--iterations=",
+            &iterations)) {
+            /* done */
+        } else {
+            printf("Unknown argument \"%s\" ignored\n",argv[i]);
+        }
+    }
+    if (argc < 2 || threadcount < 1) {
+        printf("Usage: threadreader [--threads=n] [--iterations=n] "
+            "objectfile\n");
+        exit(1);
+    }
+    filepath = argv[argc-1];
+    fd = open(filepath,O_RDONLY);
+    if(fd < 0) {
+        printf("Failure attempting to open \"%s\"\n",filepath);
+        exit(1);
+    }
+    res = dwarf_init(fd,DW_DLC_READ,0,0,&dbg,&error);
+    if(res != DW_DLV_OK) {
+        printf("Giving up, cannot do DWARF processing\n");
+        exit(1);
+    }
+
+    memset(&serial,0,sizeof(serial));
+    serial.td_dbg = dbg;
+    serial.td_count = 1;
+    read_cus(&serial);
+    printf("%s: %" DW_PR_DUu " CUs, %" DW_PR_DUu " DIEs\n",
+        filepath,serial.td_cus,serial.td_dies);
+
+    for (i = 0; i < iterations; ++i) {
+        run_threads(dbg,threadcount,&threaded);
+        if (threaded.td_cus != serial.td_cus ||
+            threaded.td_dies != serial.td_dies ||
+            threaded.td_sum != serial.td_sum) {
+            printf("Iteration %d with %d threads differs: "
+                "%" DW_PR_DUu " CUs, %" DW_PR_DUu " DIEs\n",
+                i,threadcount,threaded.td_cus,threaded.td_dies);
+            failures++;
+        }
+    }
+    printf("%d of %d iterations with %d threads matched\n",
+        iterations - failures,iterations,threadcount);
+
+    res = dwarf_finish(dbg,&error);
+    if(res != DW_DLV_OK) {
+        printf("dwarf_finish failed!\n");
+    }
+    close(fd);
+    return failures? 1: 0;
+}
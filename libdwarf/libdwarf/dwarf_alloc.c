@@ -52,6 +52,7 @@
 #include "dwarf_gdbindex.h"
 #include "dwarf_xu_index.h"
 #include "dwarf_macro5.h"
+#include "dwarf_name_index.h"
 
 #define TRUE 1
 #define FALSE 0
@@ -93,19 +94,37 @@ struct Dwarf_Error_s _dwarf_failsafe_error = {
 
 /*  To do destructors we need some extra data in every
     _dwarf_get_alloc situation. */
-/* Here is the extra we malloc for a prefix. */
+/*  Here is the extra we malloc for a prefix.
+    Sixteen bytes even with 32 bit pointers so that
+    struct reserve_data_s fits. */
 struct reserve_size_s {
-   void *dummy_rsv1;
-   void *dummy_rsv2;
+   Dwarf_Unsigned dummy_rsv1;
+   Dwarf_Unsigned dummy_rsv2;
 };
 /* Here is how we use the extra prefix area. */
 struct reserve_data_s {
    void *rd_dbg;
-   unsigned short rd_length;
+   unsigned int rd_length;
    unsigned short rd_type;
+   /*  Non-zero if this came from de_alloc_slab, in which case
+       it is not in de_alloc_tree and must not be free()d. */
+   unsigned short rd_slab;
 };
 #define DW_RESERVE sizeof(struct reserve_size_s)
 
+/*  For DW_ALLOC_MODE_SLAB. Each block starts with this header,
+    sized like the reserve prefix so what follows stays aligned. */
+struct Dwarf_Alloc_Block_s {
+    struct Dwarf_Alloc_Block_s *ab_next;
+    void *ab_unused;
+};
+#define DW_SLAB_BLOCK_SIZE (64*1024)
+#define DW_SLAB_ALIGN      DW_RESERVE
+
+/*  The mode a Dwarf_Debug gets when it is created.
+    See dwarf_set_alloc_mode(). */
+static int _dwarf_alloc_mode = DW_ALLOC_MODE_TRACKED;
+
 
 static const
 struct ial_s alloc_instance_basics[ALLOC_AREA_INDEX_TABLE_MAX] = {
@@ -320,6 +339,76 @@ simple_compare_function(const void *l, const void *r)
     return 0;
 }
 
+/*  Returns previous value. */
+int
+dwarf_set_alloc_mode(int mode)
+{
+    int oldval = _dwarf_alloc_mode;
+    if (mode == DW_ALLOC_MODE_TRACKED || mode == DW_ALLOC_MODE_SLAB) {
+        _dwarf_alloc_mode = mode;
+    }
+    return oldval;
+}
+
+/*  Carve 'size' bytes (prefix included, a multiple of
+    DW_SLAB_ALIGN) out of the slab of dbg, taking a new block
+    when the current one is full.
+    Returns NULL if malloc fails. */
+static char *
+slab_get_space(Dwarf_Debug dbg, Dwarf_Unsigned size)
+{
+    struct Dwarf_Alloc_Slab_s *slab = &dbg->de_alloc_slab;
+    struct Dwarf_Alloc_Block_s *block = 0;
+    char *space = 0;
+
+    if ((Dwarf_Unsigned)(slab->as_end - slab->as_next) < size) {
+        block = malloc(DW_SLAB_BLOCK_SIZE);
+        if (!block) {
+            return NULL;
+        }
+        block->ab_next = slab->as_blocks;
+        slab->as_blocks = block;
+        slab->as_next = (char *)(block + 1);
+        slab->as_end = (char *)block + DW_SLAB_BLOCK_SIZE;
+    }
+    space = slab->as_next;
+    slab->as_next += size;
+    return space;
+}
+
+/*  Returns the list dealloc'd slab space of this type and
+    size (prefix included, rounded) is kept on, or NULL if
+    such space is too big to reuse and so is not taken
+    from the slab at all. */
+static void **
+slab_free_list(Dwarf_Debug dbg, unsigned type, Dwarf_Unsigned size)
+{
+    struct Dwarf_Alloc_Slab_s *slab = &dbg->de_alloc_slab;
+    Dwarf_Unsigned sizeclass = 0;
+
+    if (alloc_instance_basics[type].ia_multiply_count == MULTIPLY_NO) {
+        return &slab->as_free_lists[type];
+    }
+    sizeclass = size / DW_SLAB_ALIGN;
+    if (sizeclass < ALLOC_SLAB_SIZE_CLASS_MAX) {
+        return &slab->as_size_free_lists[sizeclass];
+    }
+    return NULL;
+}
+
+/*  Frees every slab block at once, at dwarf_finish() time. */
+static void
+slab_free_all(Dwarf_Debug dbg)
+{
+    struct Dwarf_Alloc_Block_s *block = dbg->de_alloc_slab.as_blocks;
+    while (block) {
+        struct Dwarf_Alloc_Block_s *next = block->ab_next;
+        free(block);
+        block = next;
+    }
+    memset(&dbg->de_alloc_slab, 0, sizeof(dbg->de_alloc_slab));
+}
+
 /*  This function returns a pointer to a region
     of memory.  For alloc_types that are not
     strings or lists of pointers, only 1 struct
@@ -345,6 +434,7 @@ _dwarf_get_alloc(Dwarf_Debug dbg,
     Dwarf_Signed size = 0;
     unsigned int type = alloc_type;
     short action = 0;
+    void **free_list = 0;
 
     if (dbg == NULL) {
         return NULL;
@@ -368,6 +458,49 @@ _dwarf_get_alloc(Dwarf_Debug dbg,
             sizeof(Dwarf_Addr) : sizeof(Dwarf_Off));
     }
     size += DW_RESERVE;
+    if (dbg->de_alloc_mode == DW_ALLOC_MODE_SLAB &&
+        !alloc_instance_basics[type].specialdestructor) {
+        Dwarf_Signed slab_size = (size + DW_SLAB_ALIGN - 1) &
+            ~((Dwarf_Signed)DW_SLAB_ALIGN - 1);
+
+        /*  Types with a destructor stay tracked so dwarf_finish
+            still finds them, as does anything too big to be
+            reused from a free list (so it is free()d by
+            dwarf_dealloc). Everything else lives in the slab
+            and is freed in bulk. */
+        free_list = slab_free_list(dbg,type,slab_size);
+        if (free_list) {
+            size = slab_size;
+        }
+    }
+    if (free_list) {
+        struct reserve_data_s *r = 0;
+
+        if (*free_list) {
+            alloc_mem = *free_list;
+            *free_list = *(void **)(alloc_mem + DW_RESERVE);
+        } else {
+            alloc_mem = slab_get_space(dbg,size);
+            if (!alloc_mem) {
+                return NULL;
+            }
+        }
+        memset(alloc_mem, 0, size);
+        r = (struct reserve_data_s*)alloc_mem;
+        r->rd_dbg = dbg;
+        r->rd_type = alloc_type;
+        r->rd_length = size;
+        r->rd_slab = 1;
+        if (alloc_instance_basics[type].specialconstructor) {
+            int res =
+                alloc_instance_basics[type].specialconstructor(dbg,
+                alloc_mem + DW_RESERVE);
+            if (res != DW_DLV_OK) {
+                return NULL;
+            }
+        }
+        return alloc_mem + DW_RESERVE;
+    }
     alloc_mem = malloc(size);
     if (!alloc_mem) {
         return NULL;
@@ -497,6 +630,21 @@ dwarf_dealloc(Dwarf_Debug dbg,
         return;
     }
 
+    if (r->rd_slab) {
+        /*  DW_ALLOC_MODE_SLAB. Goes on a free list by the type
+            it was allocated as (callers do not always pass
+            that type) if there is one, otherwise it waits for
+            dwarf_finish. Clearing rd_dbg makes a second
+            dwarf_dealloc of the same space harmless. */
+        void **free_list = slab_free_list(dbg,r->rd_type,r->rd_length);
+
+        if (free_list) {
+            *(void **)space = *free_list;
+            *free_list = malloc_addr;
+        }
+        r->rd_dbg = 0;
+        return;
+    }
 
     if (type == DW_DLA_STRING && string_is_in_debug_section(dbg,space)) {
         /*  A string pointer may point into .debug_info or .debug_string etc.
@@ -547,6 +695,7 @@ _dwarf_get_debug(void)
     /* Set up for a dwarf_tsearch hash table */
 
     dwarf_initialize_search_hash(&dbg->de_alloc_tree,simple_value_hashfunc,0);
+    dbg->de_alloc_mode = _dwarf_alloc_mode;
 
 
     return (dbg);
@@ -583,11 +732,8 @@ freecontextlist(Dwarf_Debug dbg, Dwarf_Debug_InfoTypes dis)
     Dwarf_CU_Context nextcontext = 0;
     for (context = dis->de_cu_context_list;
         context; context = nextcontext) {
-        Dwarf_Hash_Table hash_table = context->cc_abbrev_hash_table;
-        _dwarf_free_abbrev_hash_table_contents(dbg,hash_table);
         nextcontext = context->cc_next;
-        dwarf_dealloc(dbg, hash_table, DW_DLA_HASH_TABLE);
-        context->cc_abbrev_hash_table = 0;
+        context->cc_abbrev_table = 0;
         dwarf_dealloc(dbg, context, DW_DLA_CU_CONTEXT);
     }
     dis->de_cu_context_list = 0;
@@ -610,7 +756,12 @@ _dwarf_free_all_of_one_debug(Dwarf_Debug dbg)
     /*  To do complete validation that we have no surprising missing or
         erroneous deallocs it is advisable to do the dwarf_deallocs here
         that are not things the user can otherwise request.
-        Housecleaning.  */
+        Housecleaning.
+        A thread dbg shares the index headers of its de_shared_dbg. */
+    if (dbg->de_shared_dbg) {
+        dbg->de_cu_hashindex_data = 0;
+        dbg->de_tu_hashindex_data = 0;
+    }
     if (dbg->de_cu_hashindex_data) {
         dwarf_xu_header_free(dbg->de_cu_hashindex_data);
         dbg->de_cu_hashindex_data = 0;
@@ -620,8 +771,13 @@ _dwarf_free_all_of_one_debug(Dwarf_Debug dbg)
         dbg->de_tu_hashindex_data = 0;
     }
 
+    free(dbg->de_pc_ranges);
+    dbg->de_pc_ranges = 0;
+    _dwarf_name_index_destroy(dbg);
+
     freecontextlist(dbg,&dbg->de_info_reading);
     freecontextlist(dbg,&dbg->de_types_reading);
+    _dwarf_free_abbrev_tables(dbg);
 
     /* Housecleaning done. Now really free all the space. */
     rela_free(&dbg->de_debug_info);
@@ -659,6 +815,7 @@ _dwarf_free_all_of_one_debug(Dwarf_Debug dbg)
 
     dwarf_tdestroy(dbg->de_alloc_tree,tdestroy_free_node);
     dbg->de_alloc_tree = 0;
+    slab_free_all(dbg);
     if (dbg->de_tied_data.td_tied_search) {
         dwarf_tdestroy(dbg->de_tied_data.td_tied_search,
             _dwarf_tied_destroy_free_node);
@@ -36,3 +36,24 @@ struct Dwarf_Error_s * _dwarf_special_no_dbg_error_malloc(void);
     struct ial_s index_into_allocated array in dwarf_alloc.c
 */
 #define ALLOC_AREA_INDEX_TABLE_MAX 61
+
+/*  Variable length allocations (lists, location blocks)
+    up to this many 16 byte units are reused by size.
+    Bigger ones are malloc()d and free()d as in
+    DW_ALLOC_MODE_TRACKED. */
+#define ALLOC_SLAB_SIZE_CLASS_MAX 32
+
+/*  Per Dwarf_Debug state for DW_ALLOC_MODE_SLAB.
+    as_blocks chains every block so dwarf_finish can free
+    them all at once, as_next/as_end is the unused tail of the
+    newest block. as_free_lists holds dealloc'd objects of
+    each fixed size DW_DLA type for reuse and as_size_free_lists
+    dealloc'd small variable length ones by size. */
+struct Dwarf_Alloc_Block_s;
+struct Dwarf_Alloc_Slab_s {
+    struct Dwarf_Alloc_Block_s *as_blocks;
+    char *as_next;
+    char *as_end;
+    void *as_free_lists[ALLOC_AREA_INDEX_TABLE_MAX];
+    void *as_size_free_lists[ALLOC_SLAB_SIZE_CLASS_MAX];
+};
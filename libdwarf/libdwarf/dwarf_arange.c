@@ -30,6 +30,7 @@
 #include "config.h"
 #include "dwarf_incl.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include "dwarf_arange.h"
 #include "dwarf_global.h"  /* for _dwarf_fixup_* */
 
@@ -593,3 +594,377 @@ dwarf_get_arange_info_b(Dwarf_Arange arange,
     }
     return (DW_DLV_OK);
 }
+
+/*  Grows while building the table for
+    dwarf_get_cu_die_offset_given_pc(). */
+struct pc_range_table_s {
+    struct Dwarf_Pc_Range_s *pt_ranges;
+    Dwarf_Unsigned pt_count;
+    Dwarf_Unsigned pt_allocated;
+};
+
+static int
+add_pc_range(Dwarf_Debug dbg,
+    struct pc_range_table_s *table,
+    Dwarf_Addr low,
+    Dwarf_Addr high,
+    Dwarf_Off cu_die_offset,
+    Dwarf_Error *error)
+{
+    struct Dwarf_Pc_Range_s *range = 0;
+
+    if (high <= low) {
+        /* Empty ranges can never match. */
+        return DW_DLV_OK;
+    }
+    if (table->pt_count == table->pt_allocated) {
+        Dwarf_Unsigned newcount = table->pt_allocated?
+            table->pt_allocated * 2: 64;
+
+        range = (struct Dwarf_Pc_Range_s *)realloc(table->pt_ranges,
+            newcount * sizeof(struct Dwarf_Pc_Range_s));
+        if (!range) {
+            _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+            return DW_DLV_ERROR;
+        }
+        table->pt_ranges = range;
+        table->pt_allocated = newcount;
+    }
+    range = table->pt_ranges + table->pt_count;
+    range->pr_low = low;
+    range->pr_high = high;
+    range->pr_cu_die_offset = cu_die_offset;
+    table->pt_count++;
+    return DW_DLV_OK;
+}
+
+static int
+pc_range_compare(const void *l, const void *r)
+{
+    const struct Dwarf_Pc_Range_s *left =
+        (const struct Dwarf_Pc_Range_s *)l;
+    const struct Dwarf_Pc_Range_s *right =
+        (const struct Dwarf_Pc_Range_s *)r;
+
+    if (left->pr_low != right->pr_low) {
+        return left->pr_low < right->pr_low? -1: 1;
+    }
+    if (left->pr_high != right->pr_high) {
+        return left->pr_high < right->pr_high? -1: 1;
+    }
+    return 0;
+}
+
+static int
+offset_compare(const void *l, const void *r)
+{
+    Dwarf_Off left = *(const Dwarf_Off *)l;
+    Dwarf_Off right = *(const Dwarf_Off *)r;
+
+    if (left != right) {
+        return left < right? -1: 1;
+    }
+    return 0;
+}
+
+/*  Adds the pc ranges of the CU with DIE cu_die,
+    from DW_AT_ranges or from DW_AT_low_pc/DW_AT_high_pc. */
+static int
+add_cu_die_pc_ranges(Dwarf_Debug dbg,
+    struct pc_range_table_s *table,
+    Dwarf_Die cu_die,
+    Dwarf_Off cu_die_offset,
+    Dwarf_Error *error)
+{
+    Dwarf_Attribute attr = 0;
+    Dwarf_Addr base = 0;
+    Dwarf_Addr high = 0;
+    Dwarf_Half form = 0;
+    enum Dwarf_Form_Class formclass = DW_FORM_CLASS_UNKNOWN;
+    int have_base = false;
+    int res = 0;
+
+    res = dwarf_lowpc(cu_die, &base, error);
+    if (res == DW_DLV_ERROR) {
+        return res;
+    }
+    have_base = (res == DW_DLV_OK);
+    res = dwarf_attr(cu_die, DW_AT_ranges, &attr, error);
+    if (res == DW_DLV_ERROR) {
+        return res;
+    }
+    if (res == DW_DLV_OK) {
+        Dwarf_Unsigned ranges_offset = 0;
+        Dwarf_Ranges *ranges = 0;
+        Dwarf_Signed rangecount = 0;
+        Dwarf_Unsigned bytecount = 0;
+        Dwarf_Signed i = 0;
+
+        res = dwarf_global_formref(attr, &ranges_offset, error);
+        dwarf_dealloc(dbg, attr, DW_DLA_ATTR);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        res = dwarf_get_ranges_a(dbg, ranges_offset, cu_die,
+            &ranges, &rangecount, &bytecount, error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        for (i = 0; i < rangecount; ++i) {
+            Dwarf_Ranges *r = ranges + i;
+
+            if (r->dwr_type == DW_RANGES_ENTRY) {
+                res = add_pc_range(dbg, table, base + r->dwr_addr1,
+                    base + r->dwr_addr2, cu_die_offset, error);
+                if (res != DW_DLV_OK) {
+                    dwarf_ranges_dealloc(dbg, ranges, rangecount);
+                    return res;
+                }
+            } else if (r->dwr_type == DW_RANGES_ADDRESS_SELECTION) {
+                base = r->dwr_addr2;
+            } else {
+                break;
+            }
+        }
+        dwarf_ranges_dealloc(dbg, ranges, rangecount);
+        return DW_DLV_OK;
+    }
+    if (!have_base) {
+        /* No code in this CU. */
+        return DW_DLV_OK;
+    }
+    res = dwarf_highpc_b(cu_die, &high, &form, &formclass, error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    if (formclass == DW_FORM_CLASS_CONSTANT) {
+        high += base;
+    }
+    return add_pc_range(dbg, table, base, high, cu_die_offset, error);
+}
+
+/*  Fills table from .debug_aranges and, for each CU
+    .debug_aranges does not mention, from the CU DIE.
+    A CU that cannot be read ends the walk through
+    .debug_info (noted as a harmless error) but
+    what was found so far is kept. */
+static int
+collect_pc_ranges(Dwarf_Debug dbg,
+    struct pc_range_table_s *table,
+    Dwarf_Error *error)
+{
+    Dwarf_Off *arange_cus = 0;
+    Dwarf_Signed arange_cu_count = 0;
+    Dwarf_Unsigned info_size = dbg->de_debug_info.dss_size;
+    Dwarf_Off cu_offset = 0;
+    int res = 0;
+
+    if (!info_size) {
+        return DW_DLV_OK;
+    }
+    res = _dwarf_load_debug_info(dbg, error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    if (dbg->de_debug_aranges.dss_size) {
+        Dwarf_Chain head_chain = 0;
+        Dwarf_Chain curr_chain = 0;
+        Dwarf_Signed arange_count = 0;
+        Dwarf_Signed i = 0;
+        Dwarf_Unsigned header_size = 0;
+
+        res = _dwarf_load_section(dbg, &dbg->de_debug_aranges, error);
+        if (res == DW_DLV_ERROR) {
+            return res;
+        }
+        res = dwarf_get_aranges_list(dbg, &head_chain, &arange_count,
+            error);
+        if (res == DW_DLV_ERROR) {
+            return res;
+        }
+        res = DW_DLV_OK;
+        header_size = _dwarf_length_of_cu_header_simple(dbg, true);
+        if (arange_count > 0) {
+            arange_cus = (Dwarf_Off *)malloc(
+                arange_count * sizeof(Dwarf_Off));
+            if (!arange_cus) {
+                _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+                return DW_DLV_ERROR;
+            }
+        }
+        curr_chain = head_chain;
+        for (i = 0; i < arange_count; i++) {
+            Dwarf_Arange ar = curr_chain->ch_item;
+            Dwarf_Chain prev_chain = curr_chain;
+
+            curr_chain = curr_chain->ch_next;
+            /*  The CU header must fit in .debug_info
+                before its length is read. */
+            if (res == DW_DLV_OK && ar->ar_info_offset < info_size &&
+                info_size - ar->ar_info_offset > header_size) {
+                Dwarf_Off cu_die_offset = ar->ar_info_offset +
+                    _dwarf_length_of_cu_header(dbg,
+                        ar->ar_info_offset, true);
+
+                arange_cus[arange_cu_count++] = ar->ar_info_offset;
+                res = add_pc_range(dbg, table, ar->ar_address,
+                    ar->ar_address + ar->ar_length,
+                    cu_die_offset, error);
+            }
+            dwarf_dealloc(dbg, ar, DW_DLA_ARANGE);
+            dwarf_dealloc(dbg, prev_chain, DW_DLA_CHAIN);
+        }
+        if (res != DW_DLV_OK) {
+            free(arange_cus);
+            return res;
+        }
+        qsort(arange_cus, arange_cu_count, sizeof(Dwarf_Off),
+            offset_compare);
+    }
+
+    while (cu_offset + _dwarf_length_of_cu_header_simple(dbg, true) <
+        info_size) {
+        Dwarf_Off cu_die_offset = cu_offset +
+            _dwarf_length_of_cu_header(dbg, cu_offset, true);
+        Dwarf_CU_Context context = 0;
+        Dwarf_Die cu_die = 0;
+        Dwarf_Error err = 0;
+
+        res = dwarf_offdie_b(dbg, cu_die_offset, true, &cu_die, &err);
+        if (res == DW_DLV_OK) {
+            context = cu_die->di_cu_context;
+            if (!arange_cu_count || !bsearch(&cu_offset, arange_cus,
+                arange_cu_count, sizeof(Dwarf_Off), offset_compare)) {
+                res = add_cu_die_pc_ranges(dbg, table, cu_die,
+                    cu_die_offset, &err);
+            }
+            dwarf_dealloc(dbg, cu_die, DW_DLA_DIE);
+        }
+        if (res == DW_DLV_ERROR) {
+            char buf[200];
+            Dwarf_Unsigned errnum = dwarf_errno(err);
+
+            dwarf_dealloc(dbg, err, DW_DLA_ERROR);
+            if (errnum == DW_DLE_ALLOC_FAIL) {
+                free(arange_cus);
+                _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+                return DW_DLV_ERROR;
+            }
+            snprintf(buf, sizeof(buf),
+                "DW_DLE_ERROR %" DW_PR_DUu " reading the pc ranges"
+                " of the CU at offset 0x%" DW_PR_XZEROS DW_PR_DUx
+                " in .debug_info", errnum, cu_offset);
+            dwarf_insert_harmless_error(dbg, buf);
+        }
+        if (!context) {
+            break;
+        }
+        cu_offset = context->cc_debug_offset + context->cc_length +
+            context->cc_length_size + context->cc_extension_size;
+    }
+    free(arange_cus);
+    return DW_DLV_OK;
+}
+
+/*  Builds the sorted, non-overlapping table of pc ranges.
+    Where ranges of different CUs overlap the one starting
+    first keeps the overlap. */
+static int
+build_pc_ranges(Dwarf_Debug dbg, Dwarf_Error *error)
+{
+    struct pc_range_table_s table;
+    struct Dwarf_Pc_Range_s *ranges = 0;
+    Dwarf_Unsigned out = 0;
+    Dwarf_Unsigned i = 0;
+    int res = 0;
+
+    memset(&table, 0, sizeof(table));
+    res = collect_pc_ranges(dbg, &table, error);
+    if (res != DW_DLV_OK) {
+        free(table.pt_ranges);
+        return res;
+    }
+    ranges = table.pt_ranges;
+    qsort(ranges, table.pt_count, sizeof(struct Dwarf_Pc_Range_s),
+        pc_range_compare);
+    for (i = 0; i < table.pt_count; ++i) {
+        struct Dwarf_Pc_Range_s cur = ranges[i];
+
+        if (out) {
+            struct Dwarf_Pc_Range_s *last = ranges + out - 1;
+
+            if (cur.pr_low <= last->pr_high &&
+                cur.pr_cu_die_offset == last->pr_cu_die_offset) {
+                if (cur.pr_high > last->pr_high) {
+                    last->pr_high = cur.pr_high;
+                }
+                continue;
+            }
+            if (cur.pr_low < last->pr_high) {
+                if (cur.pr_high <= last->pr_high) {
+                    continue;
+                }
+                cur.pr_low = last->pr_high;
+            }
+        }
+        ranges[out++] = cur;
+    }
+    if (out && out < table.pt_allocated) {
+        struct Dwarf_Pc_Range_s *shrunk = (struct Dwarf_Pc_Range_s *)
+            realloc(ranges, out * sizeof(struct Dwarf_Pc_Range_s));
+        if (shrunk) {
+            ranges = shrunk;
+        }
+    }
+    dbg->de_pc_ranges = ranges;
+    dbg->de_pc_ranges_count = out;
+    dbg->de_pc_ranges_built = true;
+    return DW_DLV_OK;
+}
+
+/*  Returns the offset in .debug_info of the CU DIE
+    of the CU whose code includes address pc, a binary
+    search of a table built on the first call.
+    Returns DW_DLV_NO_ENTRY if no CU claims pc. */
+int
+dwarf_get_cu_die_offset_given_pc(Dwarf_Debug dbg,
+    Dwarf_Addr pc,
+    Dwarf_Off * cu_die_offset,
+    Dwarf_Error * error)
+{
+    Dwarf_Unsigned low = 0;
+    Dwarf_Unsigned high = 0;
+    struct Dwarf_Pc_Range_s *range = 0;
+
+    if (dbg == NULL) {
+        _dwarf_error(NULL, error, DW_DLE_DBG_NULL);
+        return (DW_DLV_ERROR);
+    }
+    if (!dbg->de_pc_ranges_built) {
+        int res = build_pc_ranges(dbg, error);
+
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+    }
+    /* Find the first range starting above pc. */
+    high = dbg->de_pc_ranges_count;
+    while (low < high) {
+        Dwarf_Unsigned mid = low + (high - low) / 2;
+
+        if (dbg->de_pc_ranges[mid].pr_low <= pc) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low == 0) {
+        return DW_DLV_NO_ENTRY;
+    }
+    range = dbg->de_pc_ranges + low - 1;
+    if (pc >= range->pr_high) {
+        return DW_DLV_NO_ENTRY;
+    }
+    *cu_die_offset = range->pr_cu_die_offset;
+    return DW_DLV_OK;
+}
@@ -60,3 +60,15 @@ _dwarf_get_aranges_addr_offsets(Dwarf_Debug dbg,
     Dwarf_Off ** offsets,
     Dwarf_Signed * count,
     Dwarf_Error * error);
+
+/*  One entry of the table searched by
+    dwarf_get_cu_die_offset_given_pc().
+    Addresses pr_low up to (not including) pr_high
+    belong to the CU whose CU DIE is at pr_cu_die_offset
+    in .debug_info.
+    The table is sorted by pr_low and entries do not overlap. */
+struct Dwarf_Pc_Range_s {
+    Dwarf_Addr pr_low;
+    Dwarf_Addr pr_high;
+    Dwarf_Off  pr_cu_die_offset;
+};
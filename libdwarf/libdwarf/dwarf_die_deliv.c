@@ -447,13 +447,6 @@ _dwarf_make_CU_Context(Dwarf_Debug dbg,
         return DW_DLV_ERROR;
     }
 
-    cu_context->cc_abbrev_hash_table =
-        (Dwarf_Hash_Table) _dwarf_get_alloc(dbg, DW_DLA_HASH_TABLE, 1);
-    if (cu_context->cc_abbrev_hash_table == NULL) {
-        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
-        return DW_DLV_ERROR;
-    }
-
     cu_context->cc_debug_offset = offset;
 
     dis->de_last_offset = max_cu_global_offset;
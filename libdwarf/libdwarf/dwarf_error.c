@@ -404,6 +404,13 @@ const char *_dwarf_errmsgs[] = {
     "DW_DLE_BAD_MACRO_INDEX(323)",
     "DW_DLE_MACRO_OP_UNHANDLED(324)",
     "DW_DLE_MACRO_PAST_END(325)",
+    "DW_DLE_LOC_EVAL_STACK_OVERFLOW(326) location expression stack too deep",
+    "DW_DLE_LOC_EVAL_STACK_UNDERFLOW(327) location expression stack empty",
+    "DW_DLE_LOC_EVAL_DIV_BY_ZERO(328) location expression divides by zero",
+    "DW_DLE_LOC_EVAL_BAD_BRANCH(329) branch not to an operator, or endless",
+    "DW_DLE_LOC_EVAL_BAD_PIECE(330) location not followed by piece or end",
+    "DW_DLE_DEBUG_NAMES_HEADER_ERROR(331) .debug_names header is corrupt",
+    "DW_DLE_DEBUG_NAMES_ENTRY_ERROR(332) .debug_names entry is corrupt",
 };
 
 
@@ -229,6 +229,11 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
     /*  is greater than search_pc_val.  */
     Dwarf_Bool search_over = false;
 
+    /*  When search_over becomes true this is the pc of the
+        row that was not entered, so the row returned covers
+        [current_loc,next_row_loc). */
+    Dwarf_Addr next_row_loc = 0;
+
     /*  Used by the DW_FRAME_advance_loc instr */
     /*  to hold the increment in pc value.  */
     Dwarf_Addr adv_pc;
@@ -371,6 +376,8 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
                 /* If gone past pc needed, retain old pc.  */
                 if (!search_over) {
                     current_loc = current_loc + adv_pc;
+                } else {
+                    next_row_loc = current_loc + adv_pc;
                 }
                 break;
             }
@@ -444,6 +451,8 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
                 /* If gone past pc needed, retain old pc.  */
                 if (!search_over) {
                     current_loc = new_loc;
+                } else {
+                    next_row_loc = new_loc;
                 }
                 fp_offset = new_loc;
                 break;
@@ -465,6 +474,8 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
                 /* If gone past pc needed, retain old pc.  */
                 if (!search_over) {
                     current_loc = current_loc + adv_loc;
+                } else {
+                    next_row_loc = current_loc + adv_loc;
                 }
                 break;
             }
@@ -487,6 +498,8 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
                 /* If gone past pc needed, retain old pc.  */
                 if (!search_over) {
                     current_loc = current_loc + adv_loc;
+                } else {
+                    next_row_loc = current_loc + adv_loc;
                 }
                 break;
             }
@@ -509,6 +522,8 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
                 /* If gone past pc needed, retain old pc.  */
                 if (!search_over) {
                     current_loc = current_loc + adv_loc;
+                } else {
+                    next_row_loc = current_loc + adv_loc;
                 }
                 break;
             }
@@ -1026,6 +1041,7 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
         unsigned curreg = 0;
 
         table->fr_loc = current_loc;
+        table->fr_next_loc = next_row_loc;
         for (; curreg < minregcount ; curreg++, t3reg++, t2reg++) {
             *t2reg = *t3reg;
         }
@@ -2011,6 +2027,35 @@ dwarf_get_fde_n(Dwarf_Fde * fde_data,
 }
 
 
+/*  The fdes are sorted by their addresses. Binary search to
+    find correct fde. Returns its index or -1 if no fde
+    contains pc_of_interest. */
+static Dwarf_Signed
+find_fde_index(Dwarf_Fde * fde_data,
+    Dwarf_Signed fdecount,
+    Dwarf_Addr pc_of_interest)
+{
+    Dwarf_Signed low = 0;
+    Dwarf_Signed high = fdecount - 1L;
+    Dwarf_Signed middle = 0;
+    Dwarf_Fde cur_fde;
+
+    while (low <= high) {
+        middle = (low + high) / 2;
+        cur_fde = fde_data[middle];
+        if (pc_of_interest < cur_fde->fd_initial_location) {
+            high = middle - 1;
+        } else if (pc_of_interest >=
+            (cur_fde->fd_initial_location +
+            cur_fde->fd_address_range)) {
+            low = middle + 1;
+        } else {
+            return middle;
+        }
+    }
+    return -1;
+}
+
 /*  Lopc and hipc are extensions to the interface to
     return the range of addresses that are described
     by the returned fde.  */
@@ -2025,6 +2070,7 @@ dwarf_get_fde_at_pc(Dwarf_Fde * fde_data,
     Dwarf_Fde fde = NULL;
     Dwarf_Fde entryfde = NULL;
     Dwarf_Signed fdecount = 0;
+    Dwarf_Signed fdeindex = 0;
 
     if (fde_data == NULL) {
         _dwarf_error(NULL, error, DW_DLE_FDE_PTR_NULL);
@@ -2041,31 +2087,9 @@ dwarf_get_fde_at_pc(Dwarf_Fde * fde_data,
     }
     fdecount = entryfde->fd_is_eh?
         dbg->de_fde_count_eh:dbg->de_fde_count;
-    {
-        /*  The fdes are sorted by their addresses. Binary search to
-            find correct fde. */
-        Dwarf_Signed low = 0;
-        Dwarf_Signed high = fdecount - 1L;
-        Dwarf_Signed middle = 0;
-        Dwarf_Fde cur_fde;
-
-        while (low <= high) {
-            middle = (low + high) / 2;
-            cur_fde = fde_data[middle];
-            if (pc_of_interest < cur_fde->fd_initial_location) {
-                high = middle - 1;
-            } else if (pc_of_interest >=
-                (cur_fde->fd_initial_location +
-                cur_fde->fd_address_range)) {
-                low = middle + 1;
-            } else {
-                fde = fde_data[middle];
-                break;
-            }
-        }
-    }
-
-    if (fde) {
+    fdeindex = find_fde_index(fde_data,fdecount,pc_of_interest);
+    if (fdeindex >= 0) {
+        fde = fde_data[fdeindex];
         if (lopc != NULL)
             *lopc = fde->fd_initial_location;
         if (hipc != NULL)
@@ -2078,6 +2102,393 @@ dwarf_get_fde_at_pc(Dwarf_Fde * fde_data,
     return (DW_DLV_NO_ENTRY);
 }
 
+/*  Frame table row cache.
+    Each fde of the list gets a sorted array of the rows
+    computed so far.  Finding a row is a binary search
+    for the fde and one in its rows. A row not found is
+    computed as dwarf_get_fde_info_for_all_regs3() would
+    compute it and inserted, keeping only the register
+    rules that are not the initial rule. */
+static int
+frame_cache_rule_is_initial(struct Dwarf_Reg_Rule_s *rule,
+    int initial_value)
+{
+    return !rule->ru_is_off &&
+        rule->ru_value_type == DW_EXPR_OFFSET &&
+        rule->ru_register == initial_value &&
+        rule->ru_offset_or_block_len == 0 &&
+        rule->ru_block == 0;
+}
+
+/*  Index of the fde containing pc, or -1 if there is none. */
+static Dwarf_Signed
+find_frame_cache_fde(Dwarf_Frame_Cache cache,Dwarf_Addr pc)
+{
+    Dwarf_Signed low = 0;
+    Dwarf_Signed high = cache->fc_fde_count - 1L;
+    Dwarf_Signed middle = 0;
+    Dwarf_Signed found = -1;
+    Dwarf_Fde fde = 0;
+
+    while (low <= high) {
+        middle = (low + high) / 2;
+        if (cache->fc_fde_lopcs[middle] <= pc) {
+            found = middle;
+            low = middle + 1;
+        } else {
+            high = middle - 1;
+        }
+    }
+    if (found < 0) {
+        return -1;
+    }
+    fde = cache->fc_fde_data[found];
+    if (pc >= fde->fd_initial_location + fde->fd_address_range) {
+        return -1;
+    }
+    return found;
+}
+
+/*  Index of the last row starting at or before pc,
+    or -1 if there is none. */
+static Dwarf_Signed
+find_frame_cache_row(struct Dwarf_Frame_Cache_Fde_s *cfde,
+    Dwarf_Addr pc)
+{
+    Dwarf_Signed low = 0;
+    Dwarf_Signed high = (Dwarf_Signed)cfde->fcf_row_count - 1L;
+    Dwarf_Signed middle = 0;
+    Dwarf_Signed found = -1;
+
+    while (low <= high) {
+        middle = (low + high) / 2;
+        if (cfde->fcf_rows[middle].fcw_lopc <= pc) {
+            found = middle;
+            low = middle + 1;
+        } else {
+            high = middle - 1;
+        }
+    }
+    return found;
+}
+
+/*  Makes fc_template right for a caller table of size
+    entries and the current frame rule values. */
+static int
+make_frame_cache_template(Dwarf_Frame_Cache cache,
+    Dwarf_Half size,
+    Dwarf_Error * error)
+{
+    Dwarf_Debug dbg = cache->fc_dbg;
+    struct Dwarf_Regtable_Entry3_s *rules = 0;
+    int real_size = 0;
+
+    if (cache->fc_template &&
+        cache->fc_template_size == size &&
+        cache->fc_template_reg_count ==
+            dbg->de_frame_reg_rules_entry_count &&
+        cache->fc_template_initial_value ==
+            dbg->de_frame_rule_initial_value &&
+        cache->fc_template_undefined_value ==
+            dbg->de_frame_undefined_value_number) {
+        return DW_DLV_OK;
+    }
+    rules = (struct Dwarf_Regtable_Entry3_s *)malloc(
+        (size? size : 1) * sizeof(struct Dwarf_Regtable_Entry3_s));
+    if (!rules) {
+        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+        return DW_DLV_ERROR;
+    }
+    real_size = MIN(size, dbg->de_frame_reg_rules_entry_count);
+    dwarf_init_reg_rules_dw3(rules, 0, real_size,
+        dbg->de_frame_rule_initial_value);
+    dwarf_init_reg_rules_dw3(rules, real_size, size,
+        dbg->de_frame_undefined_value_number);
+    free(cache->fc_template);
+    cache->fc_template = rules;
+    cache->fc_template_size = size;
+    cache->fc_template_reg_count = dbg->de_frame_reg_rules_entry_count;
+    cache->fc_template_initial_value = dbg->de_frame_rule_initial_value;
+    cache->fc_template_undefined_value =
+        dbg->de_frame_undefined_value_number;
+    return DW_DLV_OK;
+}
+
+/*  Computes the row of fde containing pc and inserts it
+    at index position of the rows of cfde. */
+static int
+add_frame_cache_row(Dwarf_Frame_Cache cache,
+    Dwarf_Fde fde,
+    struct Dwarf_Frame_Cache_Fde_s *cfde,
+    Dwarf_Addr pc,
+    Dwarf_Unsigned position,
+    Dwarf_Error * error)
+{
+    Dwarf_Debug dbg = cache->fc_dbg;
+    struct Dwarf_Frame_s *table = &cache->fc_table;
+    struct Dwarf_Frame_Cache_Row_s newrow;
+    struct Dwarf_Reg_Rule_s *rule = 0;
+    Dwarf_Addr fde_hipc = fde->fd_initial_location +
+        fde->fd_address_range;
+    int initial_value = dbg->de_frame_rule_initial_value;
+    unsigned long i = 0;
+    int res = 0;
+
+    if (table->fr_reg_count != dbg->de_frame_reg_rules_entry_count) {
+        /*  dwarf_set_frame_rule_table_size() was called after
+            the cache was created. */
+        dwarf_free_fde_table(table);
+        res = dwarf_initialize_fde_table(dbg, table,
+            dbg->de_frame_reg_rules_entry_count, error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+    }
+    res = _dwarf_get_fde_info_for_a_pc_row(fde, pc, table,
+        dbg->de_frame_cfa_col_number, error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+
+    memset(&newrow, 0, sizeof(newrow));
+    newrow.fcw_lopc = table->fr_loc;
+    newrow.fcw_hipc = fde_hipc;
+    if (table->fr_next_loc && table->fr_next_loc < fde_hipc) {
+        newrow.fcw_hipc = table->fr_next_loc;
+    }
+    /*  Keep the rows sorted and disjoint even if the frame
+        instructions are odd. */
+    if (newrow.fcw_lopc > pc) {
+        newrow.fcw_lopc = pc;
+    }
+    if (newrow.fcw_hipc <= pc) {
+        newrow.fcw_hipc = pc + 1;
+    }
+    if (position > 0 &&
+        newrow.fcw_lopc < cfde->fcf_rows[position - 1].fcw_hipc) {
+        newrow.fcw_lopc = cfde->fcf_rows[position - 1].fcw_hipc;
+    }
+    if (position < cfde->fcf_row_count &&
+        newrow.fcw_hipc > cfde->fcf_rows[position].fcw_lopc) {
+        newrow.fcw_hipc = cfde->fcf_rows[position].fcw_lopc;
+    }
+    newrow.fcw_cfa_rule = table->fr_cfa_rule;
+
+    rule = table->fr_reg;
+    for (i = 0; i < table->fr_reg_count; ++i, ++rule) {
+        if (!frame_cache_rule_is_initial(rule, initial_value)) {
+            newrow.fcw_rule_count++;
+        }
+    }
+    if (newrow.fcw_rule_count) {
+        struct Dwarf_Frame_Cache_Rule_s *out = 0;
+
+        newrow.fcw_rules = (struct Dwarf_Frame_Cache_Rule_s *)
+            malloc(newrow.fcw_rule_count *
+                sizeof(struct Dwarf_Frame_Cache_Rule_s));
+        if (!newrow.fcw_rules) {
+            _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+            return DW_DLV_ERROR;
+        }
+        out = newrow.fcw_rules;
+        rule = table->fr_reg;
+        for (i = 0; i < table->fr_reg_count; ++i, ++rule) {
+            if (!frame_cache_rule_is_initial(rule, initial_value)) {
+                out->fcr_regnum = i;
+                out->fcr_rule = *rule;
+                ++out;
+            }
+        }
+    }
+
+    if (cfde->fcf_row_count == cfde->fcf_row_space) {
+        Dwarf_Unsigned newspace = cfde->fcf_row_space?
+            cfde->fcf_row_space * 2 : 4;
+        struct Dwarf_Frame_Cache_Row_s *newrows =
+            (struct Dwarf_Frame_Cache_Row_s *)realloc(cfde->fcf_rows,
+            newspace * sizeof(struct Dwarf_Frame_Cache_Row_s));
+
+        if (!newrows) {
+            free(newrow.fcw_rules);
+            _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+            return DW_DLV_ERROR;
+        }
+        cfde->fcf_rows = newrows;
+        cfde->fcf_row_space = newspace;
+    }
+    memmove(cfde->fcf_rows + position + 1, cfde->fcf_rows + position,
+        (cfde->fcf_row_count - position) *
+        sizeof(struct Dwarf_Frame_Cache_Row_s));
+    cfde->fcf_rows[position] = newrow;
+    cfde->fcf_row_count++;
+    return DW_DLV_OK;
+}
+
+int
+dwarf_frame_cache_create(Dwarf_Fde * fde_data,
+    Dwarf_Frame_Cache * returned_cache,
+    Dwarf_Error * error)
+{
+    Dwarf_Debug dbg = 0;
+    Dwarf_Frame_Cache cache = 0;
+    Dwarf_Signed fdecount = 0;
+    Dwarf_Signed i = 0;
+    int res = 0;
+
+    if (fde_data == NULL) {
+        _dwarf_error(NULL, error, DW_DLE_FDE_PTR_NULL);
+        return (DW_DLV_ERROR);
+    }
+    /*  Assumes fde_data table has at least one entry. */
+    FDE_NULL_CHECKS_AND_SET_DBG(*fde_data, dbg);
+    fdecount = fde_data[0]->fd_is_eh?
+        dbg->de_fde_count_eh:dbg->de_fde_count;
+
+    cache = (Dwarf_Frame_Cache)calloc(1,
+        sizeof(struct Dwarf_Frame_Cache_s));
+    if (!cache) {
+        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+        return DW_DLV_ERROR;
+    }
+    cache->fc_dbg = dbg;
+    cache->fc_fde_data = fde_data;
+    cache->fc_fde_count = fdecount;
+    cache->fc_fdes = (struct Dwarf_Frame_Cache_Fde_s *)calloc(
+        fdecount? fdecount : 1,
+        sizeof(struct Dwarf_Frame_Cache_Fde_s));
+    cache->fc_fde_lopcs = (Dwarf_Addr *)malloc(
+        (fdecount? fdecount : 1) * sizeof(Dwarf_Addr));
+    if (!cache->fc_fdes || !cache->fc_fde_lopcs) {
+        dwarf_frame_cache_dealloc(cache);
+        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+        return DW_DLV_ERROR;
+    }
+    for (i = 0; i < fdecount; ++i) {
+        cache->fc_fde_lopcs[i] = fde_data[i]->fd_initial_location;
+    }
+    res = dwarf_initialize_fde_table(dbg, &cache->fc_table,
+        dbg->de_frame_reg_rules_entry_count, error);
+    if (res != DW_DLV_OK) {
+        dwarf_frame_cache_dealloc(cache);
+        return res;
+    }
+    *returned_cache = cache;
+    return DW_DLV_OK;
+}
+
+int
+dwarf_frame_cache_get_regs3(Dwarf_Frame_Cache cache,
+    Dwarf_Addr pc_requested,
+    Dwarf_Regtable3 * reg_table,
+    Dwarf_Addr * row_pc,
+    Dwarf_Addr * row_hipc,
+    Dwarf_Fde * returned_fde,
+    Dwarf_Error * error)
+{
+    Dwarf_Debug dbg = 0;
+    Dwarf_Signed fdeindex = 0;
+    Dwarf_Signed rowindex = 0;
+    Dwarf_Fde fde = 0;
+    struct Dwarf_Frame_Cache_Fde_s *cfde = 0;
+    struct Dwarf_Frame_Cache_Row_s *row = 0;
+    struct Dwarf_Frame_Cache_Rule_s *rule = 0;
+    struct Dwarf_Regtable_Entry3_s *out_rule = NULL;
+    Dwarf_Unsigned i = 0;
+    int output_table_real_data_size = 0;
+    int res = 0;
+
+    if (cache == NULL) {
+        _dwarf_error(NULL, error, DW_DLE_FDE_PTR_NULL);
+        return (DW_DLV_ERROR);
+    }
+    dbg = cache->fc_dbg;
+    fdeindex = find_frame_cache_fde(cache, pc_requested);
+    if (fdeindex < 0) {
+        return DW_DLV_NO_ENTRY;
+    }
+    fde = cache->fc_fde_data[fdeindex];
+    cfde = cache->fc_fdes + fdeindex;
+    rowindex = find_frame_cache_row(cfde, pc_requested);
+    if (rowindex < 0 ||
+        pc_requested >= cfde->fcf_rows[rowindex].fcw_hipc) {
+        rowindex++;
+        res = add_frame_cache_row(cache, fde, cfde, pc_requested,
+            rowindex, error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+    }
+    row = cfde->fcf_rows + rowindex;
+
+    res = make_frame_cache_template(cache,
+        reg_table->rt3_reg_table_size, error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    memcpy(reg_table->rt3_rules, cache->fc_template,
+        reg_table->rt3_reg_table_size *
+        sizeof(struct Dwarf_Regtable_Entry3_s));
+    output_table_real_data_size =
+        MIN(reg_table->rt3_reg_table_size,
+            dbg->de_frame_reg_rules_entry_count);
+    rule = row->fcw_rules;
+    for (i = 0; i < row->fcw_rule_count; ++i, ++rule) {
+        if (rule->fcr_regnum >= output_table_real_data_size) {
+            break;
+        }
+        out_rule = &reg_table->rt3_rules[rule->fcr_regnum];
+        out_rule->dw_offset_relevant = rule->fcr_rule.ru_is_off;
+        out_rule->dw_value_type = rule->fcr_rule.ru_value_type;
+        out_rule->dw_regnum = rule->fcr_rule.ru_register;
+        out_rule->dw_offset_or_block_len =
+            rule->fcr_rule.ru_offset_or_block_len;
+        out_rule->dw_block_ptr = rule->fcr_rule.ru_block;
+    }
+
+    reg_table->rt3_cfa_rule.dw_offset_relevant =
+        row->fcw_cfa_rule.ru_is_off;
+    reg_table->rt3_cfa_rule.dw_value_type =
+        row->fcw_cfa_rule.ru_value_type;
+    reg_table->rt3_cfa_rule.dw_regnum =
+        row->fcw_cfa_rule.ru_register;
+    reg_table->rt3_cfa_rule.dw_offset_or_block_len =
+        row->fcw_cfa_rule.ru_offset_or_block_len;
+    reg_table->rt3_cfa_rule.dw_block_ptr =
+        row->fcw_cfa_rule.ru_block;
+
+    if (row_pc != NULL)
+        *row_pc = row->fcw_lopc;
+    if (row_hipc != NULL)
+        *row_hipc = row->fcw_hipc - 1;
+    if (returned_fde != NULL)
+        *returned_fde = fde;
+    return DW_DLV_OK;
+}
+
+void
+dwarf_frame_cache_dealloc(Dwarf_Frame_Cache cache)
+{
+    Dwarf_Signed i = 0;
+
+    if (!cache) {
+        return;
+    }
+    for (i = 0; cache->fc_fdes && i < cache->fc_fde_count; ++i) {
+        struct Dwarf_Frame_Cache_Fde_s *cfde = cache->fc_fdes + i;
+        Dwarf_Unsigned r = 0;
+
+        for (r = 0; r < cfde->fcf_row_count; ++r) {
+            free(cfde->fcf_rows[r].fcw_rules);
+        }
+        free(cfde->fcf_rows);
+    }
+    free(cache->fc_fdes);
+    free(cache->fc_fde_lopcs);
+    free(cache->fc_template);
+    dwarf_free_fde_table(&cache->fc_table);
+    free(cache);
+}
+
 
 /*  Expands a single frame instruction block
     from a specific cie
@@ -155,6 +155,10 @@ struct Dwarf_Frame_s {
     /* Pc value corresponding to this row of the frame table. */
     Dwarf_Addr fr_loc;
 
+    /*  Set by a pc search: the pc of the row after this one,
+        or 0 if this row runs to the end of the instructions. */
+    Dwarf_Addr fr_next_loc;
+
     /* Rules for all the registers in this row. */
     struct Dwarf_Reg_Rule_s fr_cfa_rule;
 
@@ -315,6 +319,56 @@ struct Dwarf_Fde_s {
 
 };
 
+/*  A Dwarf_Frame_Cache holds frame table rows already computed
+    by dwarf_frame_cache_get_regs3().  Only the register rules
+    that differ from de_frame_rule_initial_value are kept,
+    so a row is a few rules, not de_frame_reg_rules_entry_count.
+*/
+struct Dwarf_Frame_Cache_Rule_s {
+    Dwarf_Half              fcr_regnum;
+    struct Dwarf_Reg_Rule_s fcr_rule;
+};
+
+/*  The row covers [fcw_lopc,fcw_hipc). */
+struct Dwarf_Frame_Cache_Row_s {
+    Dwarf_Addr fcw_lopc;
+    Dwarf_Addr fcw_hipc;
+    struct Dwarf_Reg_Rule_s fcw_cfa_rule;
+    Dwarf_Unsigned fcw_rule_count;
+    struct Dwarf_Frame_Cache_Rule_s *fcw_rules;
+};
+
+/*  The rows of one fde seen so far, sorted by fcw_lopc. */
+struct Dwarf_Frame_Cache_Fde_s {
+    struct Dwarf_Frame_Cache_Row_s *fcf_rows;
+    Dwarf_Unsigned fcf_row_count;
+    Dwarf_Unsigned fcf_row_space;
+};
+
+struct Dwarf_Frame_Cache_s {
+    Dwarf_Debug fc_dbg;
+    /*  The fde list given to dwarf_frame_cache_create(),
+        fc_fdes[i] holds the rows of fc_fde_data[i]. */
+    Dwarf_Fde * fc_fde_data;
+    Dwarf_Signed fc_fde_count;
+    struct Dwarf_Frame_Cache_Fde_s *fc_fdes;
+    /*  fd_initial_location of each fde, so the fde search
+        reads one array rather than every fde it passes. */
+    Dwarf_Addr *fc_fde_lopcs;
+    /*  Scratch row for computing a row not cached yet. */
+    struct Dwarf_Frame_s fc_table;
+    /*  A Dwarf_Regtable3 rules array of fc_template_size
+        entries with no rule set, copied into the caller's
+        table before the rules of the row are filled in.
+        Rebuilt when the size or the frame rule values
+        it was built with change. */
+    struct Dwarf_Regtable_Entry3_s *fc_template;
+    Dwarf_Half fc_template_size;
+    Dwarf_Half fc_template_reg_count;
+    Dwarf_Half fc_template_initial_value;
+    Dwarf_Half fc_template_undefined_value;
+};
+
 
 int
 _dwarf_frame_address_offsets(Dwarf_Debug dbg, Dwarf_Addr ** addrlist,
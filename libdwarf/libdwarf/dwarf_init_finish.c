@@ -929,6 +929,91 @@ dwarf_object_finish(Dwarf_Debug dbg, Dwarf_Error * error)
     return res;
 }
 
+/*  Make a Dwarf_Debug for one thread that reads the
+    sections already loaded in dbg.
+    All the sections are loaded (and relocated or decompressed)
+    here so nothing in dbg is written once threads start.
+    The new Dwarf_Debug starts with its own CU lists,
+    allocations, frame data and harmless-error list.  */
+int
+dwarf_new_thread_dbg(Dwarf_Debug dbg,
+    Dwarf_Debug *thread_dbg_out,
+    Dwarf_Error *error)
+{
+    Dwarf_Debug tdbg = 0;
+    void *alloc_tree = 0;
+    Dwarf_Small alloc_mode = 0;
+    unsigned i = 0;
+    int res = 0;
+
+    if (!dbg) {
+        DWARF_DBG_ERROR(NULL, DW_DLE_DBG_NULL, DW_DLV_ERROR);
+    }
+    if (dbg->de_shared_dbg) {
+        dbg = dbg->de_shared_dbg;
+    }
+    for (i = 0; i < dbg->de_debug_sections_total_entries; ++i) {
+        struct Dwarf_Section_s *section =
+            dbg->de_debug_sections[i].ds_secdata;
+
+        if (!section->dss_size) {
+            continue;
+        }
+        res = _dwarf_load_section(dbg, section, error);
+        if (res == DW_DLV_ERROR) {
+            return res;
+        }
+    }
+
+    tdbg = _dwarf_get_debug();
+    if (!tdbg) {
+        DWARF_DBG_ERROR(dbg, DW_DLE_DBG_ALLOC, DW_DLV_ERROR);
+    }
+    alloc_tree = tdbg->de_alloc_tree;
+    alloc_mode = tdbg->de_alloc_mode;
+    memcpy(tdbg, dbg, sizeof(*tdbg));
+    tdbg->de_alloc_tree = alloc_tree;
+    tdbg->de_alloc_mode = alloc_mode;
+    memset(&tdbg->de_alloc_slab, 0, sizeof(tdbg->de_alloc_slab));
+    tdbg->de_shared_dbg = dbg;
+
+    /*  The section table points at the sections inside
+        the Dwarf_Debug, so point it at our copies.
+        Section data belongs to dbg and is never freed here. */
+    for (i = 0; i < tdbg->de_debug_sections_total_entries; ++i) {
+        struct Dwarf_dbg_sect_s *ds = &tdbg->de_debug_sections[i];
+
+        ds->ds_secdata = (struct Dwarf_Section_s *)
+            ((char *)tdbg + ((char *)ds->ds_secdata - (char *)dbg));
+        ds->ds_secdata->dss_data_was_malloc = FALSE;
+    }
+    memset(&tdbg->de_info_reading, 0, sizeof(tdbg->de_info_reading));
+    memset(&tdbg->de_types_reading, 0, sizeof(tdbg->de_types_reading));
+    tdbg->de_cie_data = 0;
+    tdbg->de_cie_count = 0;
+    tdbg->de_cie_data_eh = 0;
+    tdbg->de_cie_count_eh = 0;
+    tdbg->de_fde_data = 0;
+    tdbg->de_fde_count = 0;
+    tdbg->de_fde_data_eh = 0;
+    tdbg->de_fde_count_eh = 0;
+    tdbg->de_printf_callback.dp_buffer = 0;
+    tdbg->de_printf_callback.dp_buffer_len = 0;
+    tdbg->de_printf_callback.dp_buffer_user_provided = FALSE;
+    memset(&tdbg->de_tied_data, 0, sizeof(tdbg->de_tied_data));
+    tdbg->de_pc_ranges_built = FALSE;
+    tdbg->de_pc_ranges = 0;
+    tdbg->de_pc_ranges_count = 0;
+    tdbg->de_abbrev_tables = 0;
+    tdbg->de_abbrev_table_bucket_count = 0;
+    tdbg->de_abbrev_table_count = 0;
+    tdbg->de_name_index = 0;
+    dwarf_harmless_init(&tdbg->de_harmless_errors,
+        DW_HARMLESS_ERROR_CIRCULAR_LIST_DEFAULT_SIZE);
+    *thread_dbg_out = tdbg;
+    return DW_DLV_OK;
+}
+
 #ifdef HAVE_ZLIB
 /*  The input stream is assumed to contain
     the four letters
@@ -1002,6 +1087,12 @@ _dwarf_load_section(Dwarf_Debug dbg,
     if (section->dss_data !=  NULL) {
         return DW_DLV_OK;
     }
+    if (dbg->de_shared_dbg) {
+        /*  Every non-empty section was loaded before this
+            dbg was made, the object file belongs to
+            another thread. */
+        return DW_DLV_NO_ENTRY;
+    }
     o = dbg->de_obj_file;
     /*  There is an elf convention that section index 0  is reserved,
         and that section is always empty.
@@ -39,14 +39,14 @@
 #define BYTESLEBMAX 10
 
 
-/* Decode ULEB */
+/*  Decode ULEB */
 Dwarf_Unsigned
 _dwarf_decode_u_leb128(Dwarf_Small * leb128, Dwarf_Word * leb128_length)
 {
-    unsigned char byte;
-    Dwarf_Word word_number;
-    Dwarf_Unsigned number;
-    Dwarf_Sword shift;
+    Dwarf_Unsigned byte = 0;
+    Dwarf_Word word_number = 0;
+    Dwarf_Unsigned number = 0;
+    unsigned shift = 0;
     /*  The byte_length value will be a small non-negative integer. */
     unsigned byte_length = 0;
 
@@ -84,27 +84,195 @@ _dwarf_decode_u_leb128(Dwarf_Small * leb128, Dwarf_Word * leb128_length)
         return (word_number);
     }
 
-    /*  The rest handles long numbers Because the 'number' may be larger
-        than the default int/unsigned, we must cast the 'byte' before
-        the shift for the shift to have a defined result. */
+    /*  The rest handles long numbers. The first four bytes are
+        known to carry on, so start from the fifth rather than
+        going over them again. 'byte' is as wide as 'number' so
+        the shift has a defined result. */
+    number = *leb128 & 0x7f;
+    number |= (*(leb128 + 1) & 0x7f) << 7;
+    number |= (*(leb128 + 2) & 0x7f) << 14;
+    number |= (*(leb128 + 3) & 0x7f) << 21;
+    shift = 28;
+    for (byte_length = 4; byte_length < BYTESLEBMAX; ++byte_length) {
+        byte = leb128[byte_length];
+        number |= (byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            if (leb128_length != NULL)
+                *leb128_length = byte_length + 1;
+            return (number);
+        }
+        shift += 7;
+    }
+    /*  Erroneous input. What to do?
+        Abort? Return error? Just stop here?*/
+    if (leb128_length != NULL)
+        *leb128_length = BYTESLEBMAX;
+    return number;
+}
+
+#define BITSINBYTE 8
+
+/*  decode SLEB
+    Like the ULEB case a one byte value, the common case,
+    is handled first: bit 6 is the sign.  */
+Dwarf_Signed
+_dwarf_decode_s_leb128(Dwarf_Small * leb128, Dwarf_Word * leb128_length)
+{
+    Dwarf_Unsigned byte = leb128[0];
+    Dwarf_Unsigned number = 0;
+    unsigned shift = 7;
+    /*  The byte_length value will be a small non-negative integer. */
+    unsigned byte_length = 1;
+
+    if ((byte & 0x80) == 0) {
+        if (leb128_length != NULL)
+            *leb128_length = 1;
+        return (Dwarf_Signed)(byte ^ 0x40) - 0x40;
+    }
+    number = byte & 0x7f;
+
+    /*  byte_length being the number of bytes of data absorbed so far in
+        turning the leb into a Dwarf_Signed. */
+    for (;;) {
+        byte = leb128[byte_length];
+        number |= (byte & 0x7f) << shift;
+        shift += 7;
+        byte_length++;
+        if ((byte & 0x80) == 0) {
+            break;
+        }
+        if (byte_length >= BYTESLEBMAX) {
+            /*  Erroneous input. What to do?
+                Abort? Return error? Just stop here?*/
+            if (leb128_length != NULL)
+                *leb128_length = BYTESLEBMAX;
+            return (Dwarf_Signed)number;
+        }
+    }
+
+    if ((shift < sizeof(Dwarf_Signed) * BITSINBYTE) && (byte & 0x40)) {
+        number |= ~(Dwarf_Unsigned)0 << shift;
+    }
+
+    if (leb128_length != NULL)
+        *leb128_length = byte_length;
+    return (Dwarf_Signed)number;
+}
+
+#ifdef TESTING
+/*  Checks the decoders above against plain byte at a time
+    decoders on well formed and random input, then times them
+    against the decoders they replaced.
+    Build with 'make tests'. */
+#include <stdlib.h>
+#include <time.h>
+
+#define TESTBUFSIZE (BYTESLEBMAX + 4)
+
+static Dwarf_Unsigned
+ref_decode_u_leb128(Dwarf_Small * leb128, Dwarf_Word * leb128_length)
+{
+    Dwarf_Unsigned number = 0;
+    unsigned shift = 0;
+    unsigned byte_length = 0;
+
+    for (;;) {
+        Dwarf_Small byte = leb128[byte_length];
+
+        if (shift < 64) {
+            number |= ((Dwarf_Unsigned)(byte & 0x7f)) << shift;
+        }
+        byte_length++;
+        if ((byte & 0x80) == 0 || byte_length == BYTESLEBMAX) {
+            break;
+        }
+        shift += 7;
+    }
+    *leb128_length = byte_length;
+    return number;
+}
+
+static Dwarf_Signed
+ref_decode_s_leb128(Dwarf_Small * leb128, Dwarf_Word * leb128_length)
+{
+    Dwarf_Unsigned number = 0;
+    unsigned shift = 0;
+    unsigned byte_length = 0;
+    Dwarf_Small byte = 0;
+
+    for (;;) {
+        byte = leb128[byte_length];
+        if (shift < 64) {
+            number |= ((Dwarf_Unsigned)(byte & 0x7f)) << shift;
+        }
+        shift += 7;
+        byte_length++;
+        if ((byte & 0x80) == 0) {
+            break;
+        }
+        if (byte_length == BYTESLEBMAX) {
+            *leb128_length = byte_length;
+            return (Dwarf_Signed)number;
+        }
+    }
+    if (shift < 64 && (byte & 0x40)) {
+        number |= ~(Dwarf_Unsigned)0 << shift;
+    }
+    *leb128_length = byte_length;
+    return (Dwarf_Signed)number;
+}
+
+/*  The decoders as they were before the ones above, kept
+    here only to be timed against. */
+static Dwarf_Unsigned
+prev_decode_u_leb128(Dwarf_Small * leb128, Dwarf_Word * leb128_length)
+{
+    unsigned char byte;
+    Dwarf_Word word_number;
+    Dwarf_Unsigned number;
+    Dwarf_Sword shift;
+    unsigned byte_length = 0;
+
+    if ((*leb128 & 0x80) == 0) {
+        if (leb128_length != NULL)
+            *leb128_length = 1;
+        return (*leb128);
+    } else if ((*(leb128 + 1) & 0x80) == 0) {
+        if (leb128_length != NULL)
+            *leb128_length = 2;
+        word_number = *leb128 & 0x7f;
+        word_number |= (*(leb128 + 1) & 0x7f) << 7;
+        return (word_number);
+    } else if ((*(leb128 + 2) & 0x80) == 0) {
+        if (leb128_length != NULL)
+            *leb128_length = 3;
+        word_number = *leb128 & 0x7f;
+        word_number |= (*(leb128 + 1) & 0x7f) << 7;
+        word_number |= (*(leb128 + 2) & 0x7f) << 14;
+        return (word_number);
+    } else if ((*(leb128 + 3) & 0x80) == 0) {
+        if (leb128_length != NULL)
+            *leb128_length = 4;
+        word_number = *leb128 & 0x7f;
+        word_number |= (*(leb128 + 1) & 0x7f) << 7;
+        word_number |= (*(leb128 + 2) & 0x7f) << 14;
+        word_number |= (*(leb128 + 3) & 0x7f) << 21;
+        return (word_number);
+    }
     number = 0;
     shift = 0;
     byte_length = 1;
     byte = *(leb128);
     for (;;) {
         number |= ((Dwarf_Unsigned) (byte & 0x7f)) << shift;
-
         if ((byte & 0x80) == 0) {
             if (leb128_length != NULL)
                 *leb128_length = byte_length;
             return (number);
         }
         shift += 7;
-
         byte_length++;
         if (byte_length > BYTESLEBMAX) {
-            /*  Erroneous input. What to do?
-                Abort? Return error? Just stop here?*/
             *leb128_length = BYTESLEBMAX;
             return number;
         }
@@ -113,28 +281,19 @@ _dwarf_decode_u_leb128(Dwarf_Small * leb128, Dwarf_Word * leb128_length)
     }
 }
 
-#define BITSINBYTE 8
-
-/*  decode SLEB */
-Dwarf_Signed
-_dwarf_decode_s_leb128(Dwarf_Small * leb128, Dwarf_Word * leb128_length)
+static Dwarf_Signed
+prev_decode_s_leb128(Dwarf_Small * leb128, Dwarf_Word * leb128_length)
 {
     Dwarf_Signed number = 0;
     Dwarf_Bool sign = 0;
     Dwarf_Word shift = 0;
     unsigned char byte = *leb128;
-    /*  The byte_length value will be a small non-negative integer. */
     unsigned byte_length = 1;
 
-
-    /*  byte_length being the number of bytes of data absorbed so far in
-        turning the leb into a Dwarf_Signed. */
-
     for (;;) {
         sign = byte & 0x40;
         number |= ((Dwarf_Signed) ((byte & 0x7f))) << shift;
         shift += 7;
-
         if ((byte & 0x80) == 0) {
             break;
         }
@@ -142,18 +301,275 @@ _dwarf_decode_s_leb128(Dwarf_Small * leb128, Dwarf_Word * leb128_length)
         byte = *leb128;
         byte_length++;
         if (byte_length > BYTESLEBMAX) {
-            /*  Erroneous input. What to do?
-                Abort? Return error? Just stop here?*/
             *leb128_length = BYTESLEBMAX;
             return number;
         }
     }
-
     if ((shift < sizeof(Dwarf_Signed) * BITSINBYTE) && sign) {
         number |= -((Dwarf_Signed) 1 << shift);
     }
-
     if (leb128_length != NULL)
         *leb128_length = byte_length;
     return (number);
 }
+
+static Dwarf_Unsigned randstate = 0x2545f4914f6cdd1dULL;
+
+static Dwarf_Unsigned
+nextrand(void)
+{
+    randstate ^= randstate << 13;
+    randstate ^= randstate >> 7;
+    randstate ^= randstate << 17;
+    return randstate;
+}
+
+static unsigned
+encode_u_leb128(Dwarf_Unsigned value, Dwarf_Small *out)
+{
+    unsigned len = 0;
+
+    do {
+        Dwarf_Small byte = value & 0x7f;
+
+        value >>= 7;
+        if (value) {
+            byte |= 0x80;
+        }
+        out[len++] = byte;
+    } while (value);
+    return len;
+}
+
+static unsigned
+encode_s_leb128(Dwarf_Signed value, Dwarf_Small *out)
+{
+    unsigned len = 0;
+
+    for (;;) {
+        Dwarf_Small byte = value & 0x7f;
+
+        /* Arithmetic shift, as the compilers we build with do. */
+        value >>= 7;
+        if ((value == 0 && !(byte & 0x40)) ||
+            (value == -1 && (byte & 0x40))) {
+            out[len++] = byte;
+            return len;
+        }
+        out[len++] = byte | 0x80;
+    }
+}
+
+/*  Values of the sizes DWARF is made of: mostly one
+    or two bytes, a few addresses and offsets.
+    The other shapes time each path on its own. */
+#define SHAPE_DWARF 0
+#define SHAPE_1BYTE 1
+#define SHAPE_2BYTE 2
+#define SHAPE_40BIT 3
+#define SHAPE_COUNT 4
+static const char *shape_names[SHAPE_COUNT] = {
+    "dwarf-like","1 byte","2 byte","40 bit"
+};
+
+static Dwarf_Unsigned
+shaped_value(int shape)
+{
+    Dwarf_Unsigned r = nextrand();
+    unsigned pick = r % 100;
+
+    r >>= 8;
+    switch (shape) {
+    case SHAPE_1BYTE:
+        return r % 64;
+    case SHAPE_2BYTE:
+        return 128 + r % 8000;
+    case SHAPE_40BIT:
+        return r % ((Dwarf_Unsigned)1 << 40);
+    default:
+        break;
+    }
+    if (pick < 70) {
+        return r % 128;
+    }
+    if (pick < 92) {
+        return r % 16384;
+    }
+    return r % ((Dwarf_Unsigned)1 << 40);
+}
+
+static int
+check_one(Dwarf_Small *buf)
+{
+    Dwarf_Word len = 0;
+    Dwarf_Word reflen = 0;
+    Dwarf_Unsigned u = _dwarf_decode_u_leb128(buf,&len);
+    Dwarf_Unsigned refu = ref_decode_u_leb128(buf,&reflen);
+    Dwarf_Signed sv = 0;
+    Dwarf_Signed refs = 0;
+
+    if (u != refu || len != reflen) {
+        printf("FAIL ULEB 0x%" DW_PR_DUx " len %u, expected 0x%"
+            DW_PR_DUx " len %u\n",u,(unsigned)len,refu,(unsigned)reflen);
+        return 1;
+    }
+    sv = _dwarf_decode_s_leb128(buf,&len);
+    refs = ref_decode_s_leb128(buf,&reflen);
+    if (sv != refs || len != reflen) {
+        printf("FAIL SLEB 0x%" DW_PR_DUx " len %u, expected 0x%"
+            DW_PR_DUx " len %u\n",(Dwarf_Unsigned)sv,(unsigned)len,
+            (Dwarf_Unsigned)refs,(unsigned)reflen);
+        return 1;
+    }
+    return 0;
+}
+
+static double
+seconds(void)
+{
+    return (double)clock() / CLOCKS_PER_SEC;
+}
+
+/*  Called through pointers so none of them is inlined into
+    the timing loop and the comparison is like for like. */
+typedef Dwarf_Unsigned (*udecoder)(Dwarf_Small *,Dwarf_Word *);
+typedef Dwarf_Signed (*sdecoder)(Dwarf_Small *,Dwarf_Word *);
+static volatile udecoder udecoders[2] = {
+    prev_decode_u_leb128,_dwarf_decode_u_leb128
+};
+static volatile sdecoder sdecoders[2] = {
+    prev_decode_s_leb128,_dwarf_decode_s_leb128
+};
+
+#define BENCHPASSES 9
+
+int
+main(void)
+{
+    Dwarf_Small buf[TESTBUFSIZE];
+    Dwarf_Small *bench = 0;
+    unsigned long benchcount = 4000000;
+    int shape = 0;
+    int pass = 0;
+    unsigned long i = 0;
+    unsigned shift = 0;
+    int failcount = 0;
+
+    /* Every power of two and its neighbors. */
+    for (shift = 0; shift < 64; ++shift) {
+        Dwarf_Unsigned v = (Dwarf_Unsigned)1 << shift;
+        Dwarf_Unsigned tries[3];
+        unsigned t = 0;
+
+        tries[0] = v - 1;
+        tries[1] = v;
+        tries[2] = v + 1;
+        for (t = 0; t < 3; ++t) {
+            Dwarf_Word len = 0;
+
+            memset(buf,0,sizeof(buf));
+            encode_u_leb128(tries[t],buf);
+            failcount += check_one(buf);
+            if (_dwarf_decode_u_leb128(buf,&len) != tries[t]) {
+                printf("FAIL ULEB round trip 0x%" DW_PR_DUx "\n",
+                    tries[t]);
+                failcount++;
+            }
+            memset(buf,0,sizeof(buf));
+            encode_s_leb128(-(Dwarf_Signed)tries[t],buf);
+            failcount += check_one(buf);
+            if (_dwarf_decode_s_leb128(buf,&len) !=
+                -(Dwarf_Signed)tries[t]) {
+                printf("FAIL SLEB round trip -0x%" DW_PR_DUx "\n",
+                    tries[t]);
+                failcount++;
+            }
+        }
+    }
+    /*  Random bytes, continuation bits included: overlong,
+        unterminated and non-canonical encodings. */
+    for (i = 0; i < 2000000 && failcount < 10; ++i) {
+        Dwarf_Unsigned r = nextrand();
+        unsigned j = 0;
+
+        for (j = 0; j < TESTBUFSIZE; ++j) {
+            buf[j] = (Dwarf_Small)(nextrand() >> 11);
+        }
+        /* Mostly short values, like real DWARF. */
+        buf[r % TESTBUFSIZE] &= 0x7f;
+        failcount += check_one(buf);
+    }
+    if (failcount) {
+        printf("FAIL %d leb128 mismatches\n",failcount);
+        return 1;
+    }
+    printf("PASS leb128\n");
+
+    bench = (Dwarf_Small *)malloc(benchcount * BYTESLEBMAX);
+    if (!bench) {
+        return 0;
+    }
+    printf("ns/value, best of %d passes over %lu values:\n",
+        BENCHPASSES,benchcount);
+    for (shape = 0; shape < SHAPE_COUNT; ++shape) {
+        Dwarf_Unsigned usums[2];
+        Dwarf_Signed ssums[2];
+        double usecs[2];
+        double ssecs[2];
+        unsigned long usize = 0;
+        unsigned long ssize = 0;
+        int k = 0;
+
+        /*  Half the buffer ULEBs, half SLEBs of the same
+            magnitudes, half of those negative. */
+        for (i = 0; i < benchcount / 2; ++i) {
+            usize += encode_u_leb128(shaped_value(shape),bench + usize);
+        }
+        ssize = usize;
+        for (i = 0; i < benchcount / 2; ++i) {
+            Dwarf_Signed v = (Dwarf_Signed)(shaped_value(shape) >> 1);
+
+            ssize += encode_s_leb128((nextrand() & 1)? -v: v,
+                bench + ssize);
+        }
+        for (k = 0; k < 2; ++k) {
+            usecs[k] = ssecs[k] = 1e9;
+            usums[k] = 0;
+            ssums[k] = 0;
+        }
+        for (pass = 0; pass < BENCHPASSES; ++pass) {
+            for (k = 0; k < 2; ++k) {
+                Dwarf_Small *p = 0;
+                Dwarf_Word len = 0;
+                double start = seconds();
+                double secs = 0;
+
+                for (p = bench; p < bench + usize; p += len) {
+                    usums[k] += udecoders[k](p,&len);
+                }
+                secs = seconds() - start;
+                if (secs < usecs[k]) {
+                    usecs[k] = secs;
+                }
+                start = seconds();
+                for (p = bench + usize; p < bench + ssize; p += len) {
+                    ssums[k] += sdecoders[k](p,&len);
+                }
+                secs = seconds() - start;
+                if (secs < ssecs[k]) {
+                    ssecs[k] = secs;
+                }
+            }
+        }
+        printf("  %-10s ULEB previous %5.2f current %5.2f"
+            "   SLEB previous %5.2f current %5.2f%s\n",
+            shape_names[shape],
+            usecs[0] * 2e9 / benchcount,usecs[1] * 2e9 / benchcount,
+            ssecs[0] * 2e9 / benchcount,ssecs[1] * 2e9 / benchcount,
+            (usums[0] == usums[1] && ssums[0] == ssums[1])?
+                "": " (MISMATCH)");
+    }
+    free(bench);
+    return 0;
+}
+#endif /* TESTING */
@@ -502,6 +502,8 @@ _dwarf_internal_srclines(Dwarf_Die die,
     Dwarf_Signed * linecount_actuals,
     Dwarf_Bool doaddrs,
     Dwarf_Bool dolines,
+    Dwarf_Line_Row_Callback row_callback,
+    void *row_callback_data,
     Dwarf_Error * error)
 {
     /*  This pointer is used to scan the portion of the .debug_line
@@ -657,6 +659,9 @@ _dwarf_internal_srclines(Dwarf_Die die,
         /* Normal style (single level) line table. */
         Dwarf_Bool is_actuals_table = false;
         Dwarf_Bool local_is_single_table = true;
+
+        line_context->lc_row_callback = row_callback;
+        line_context->lc_row_callback_data = row_callback_data;
         res = read_line_table_program(dbg,
             line_ptr, line_ptr_end, orig_line_ptr,
             section_start,
@@ -666,6 +671,8 @@ _dwarf_internal_srclines(Dwarf_Die die,
             is_actuals_table,
             error,
             &err_count_out);
+        line_context->lc_row_callback = 0;
+        line_context->lc_row_callback_data = 0;
         if (res != DW_DLV_OK) {
             if(is_new_interface) {
                 dwarf_srclines_dealloc_b(line_context);
@@ -864,6 +871,7 @@ dwarf_srclines(Dwarf_Die die,
         /*linecount_actuals*/0,
         /* addrlist= */ false,
         /* linelist= */ true,
+        /* row_callback= */ 0, 0,
         error);
     return res;
 }
@@ -891,6 +899,7 @@ dwarf_srclines_two_level(Dwarf_Die die,
         linecount_actuals,
         /* addrlist= */ false,
         /* linelist= */ true,
+        /* row_callback= */ 0, 0,
         error);
    return res;
 }
@@ -922,6 +931,7 @@ dwarf_srclines_b(Dwarf_Die die,
         &linecount_actuals,
         /* addrlist= */ false,
         /* linelist= */ true,
+        /* row_callback= */ 0, 0,
         error);
     if (res == DW_DLV_OK) {
         (*line_context)->lc_new_style_access = true;
@@ -937,6 +947,102 @@ dwarf_srclines_b(Dwarf_Die die,
 }
 
 
+/*  The rows of a two-level table, already read into
+    Dwarf_Lines, passed on to a dwarf_srclines_stream()
+    callback. Returns DW_DLV_NO_ENTRY if the callback
+    wants no more rows. */
+static int
+pass_lines_to_row_callback(Dwarf_Line *linebuf,
+    Dwarf_Signed linecount,
+    Dwarf_Line_Row_Callback callback,
+    void *user_data)
+{
+    Dwarf_Signed i = 0;
+
+    for (; i < linecount; ++i) {
+        Dwarf_Line line = linebuf[i];
+        Dwarf_Line_Row row;
+
+        row.dlr_address = line->li_address;
+        row.dlr_file = line->li_addr_line.li_l_data.li_file;
+        row.dlr_line = line->li_addr_line.li_l_data.li_line;
+        row.dlr_column = line->li_addr_line.li_l_data.li_column;
+        row.dlr_isa = line->li_addr_line.li_l_data.li_isa;
+        row.dlr_discriminator =
+            line->li_addr_line.li_l_data.li_discriminator;
+        row.dlr_call_context =
+            line->li_addr_line.li_l_data.li_call_context;
+        row.dlr_subprogram = line->li_addr_line.li_l_data.li_subprogram;
+        row.dlr_is_stmt = line->li_addr_line.li_l_data.li_is_stmt;
+        row.dlr_basic_block = line->li_addr_line.li_l_data.li_basic_block;
+        row.dlr_end_sequence =
+            line->li_addr_line.li_l_data.li_end_sequence;
+        row.dlr_prologue_end =
+            line->li_addr_line.li_l_data.li_prologue_end;
+        row.dlr_epilogue_begin =
+            line->li_addr_line.li_l_data.li_epilogue_begin;
+        row.dlr_is_addr_set = line->li_addr_line.li_l_data.li_is_addr_set;
+        row.dlr_is_actuals_table = line->li_is_actuals_table;
+        if (callback(&row,user_data) != DW_DLV_OK) {
+            return DW_DLV_NO_ENTRY;
+        }
+    }
+    return DW_DLV_OK;
+}
+
+/* New October 2026. */
+int
+dwarf_srclines_stream(Dwarf_Die die,
+    Dwarf_Line_Row_Callback callback,
+    void *user_data,
+    Dwarf_Unsigned * version_out,
+    Dwarf_Line_Context * line_context_out,
+    Dwarf_Error * error)
+{
+    Dwarf_Line_Context line_context = 0;
+    Dwarf_Small table_count = 0;
+    Dwarf_Line *linebuf = 0;
+    Dwarf_Signed linecount = 0;
+    Dwarf_Line *linebuf_actuals = 0;
+    Dwarf_Signed linecount_actuals = 0;
+    Dwarf_Bool is_new_interface = true;
+    int res = 0;
+
+    res  = _dwarf_internal_srclines(die,
+        is_new_interface,
+        version_out,
+        &table_count,
+        &line_context,
+        &linebuf,
+        &linecount,
+        &linebuf_actuals,
+        &linecount_actuals,
+        /* addrlist= */ false,
+        /* linelist= */ true,
+        callback, user_data,
+        error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    line_context->lc_new_style_access = true;
+
+    /*  Rows of a single level table have all been passed
+        to callback already, only a two-level table
+        leaves any Dwarf_Lines here. */
+    res = pass_lines_to_row_callback(linebuf,linecount,
+        callback,user_data);
+    if (res == DW_DLV_OK) {
+        pass_lines_to_row_callback(linebuf_actuals,linecount_actuals,
+            callback,user_data);
+    }
+    if (line_context_out) {
+        *line_context_out = line_context;
+    } else {
+        dwarf_srclines_dealloc_b(line_context);
+    }
+    return DW_DLV_OK;
+}
+
 /* New October 2015. */
 int
 dwarf_srclines_from_linecontext(Dwarf_Line_Context line_context,
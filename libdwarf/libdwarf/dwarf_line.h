@@ -207,6 +207,11 @@ struct Dwarf_Line_Context_s {
     Dwarf_Line   *lc_linebuf_actuals;
     Dwarf_Signed lc_linecount_actuals;
 
+    /*  Set only while dwarf_srclines_stream() reads a
+        single level table. Rows then go to the callback
+        and no Dwarf_Line is created. */
+    Dwarf_Line_Row_Callback lc_row_callback;
+    void *lc_row_callback_data;
 };
 
 
@@ -327,6 +332,8 @@ int _dwarf_internal_srclines(Dwarf_Die die,
     Dwarf_Signed * count_actuals,
     Dwarf_Bool doaddrs,
     Dwarf_Bool dolines,
+    Dwarf_Line_Row_Callback row_callback,
+    void *row_callback_data,
     Dwarf_Error * error);
 
 /*  The LOP, WHAT_IS_OPCODE stuff is here so it can
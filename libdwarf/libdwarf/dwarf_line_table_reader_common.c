@@ -771,6 +771,135 @@ _dwarf_read_line_table_header(Dwarf_Debug dbg,
 }
 
 
+/*  The Dwarf_Line records of the table being read, in a
+    DW_DLA_LIST block that grows by doubling. */
+struct Dwarf_Line_Block_s {
+    Dwarf_Line *lb_lines;
+    Dwarf_Signed lb_count;
+    Dwarf_Signed lb_space;
+};
+
+static void
+free_line_block(Dwarf_Debug dbg, struct Dwarf_Line_Block_s *block)
+{
+    Dwarf_Signed i = 0;
+
+    for (; i < block->lb_count; ++i) {
+        dwarf_dealloc(dbg, block->lb_lines[i], DW_DLA_LINE);
+    }
+    if (block->lb_lines) {
+        dwarf_dealloc(dbg, block->lb_lines, DW_DLA_LIST);
+    }
+    block->lb_lines = 0;
+    block->lb_count = 0;
+    block->lb_space = 0;
+}
+
+static int
+add_to_line_block(Dwarf_Debug dbg, struct Dwarf_Line_Block_s *block,
+    Dwarf_Line line, Dwarf_Error *error)
+{
+    if (block->lb_count == block->lb_space) {
+        Dwarf_Signed newspace = block->lb_space? 2*block->lb_space: 64;
+        Dwarf_Line *newlines = (Dwarf_Line *)
+            _dwarf_get_alloc(dbg, DW_DLA_LIST, newspace);
+
+        if (newlines == NULL) {
+            _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+            return (DW_DLV_ERROR);
+        }
+        if (block->lb_lines) {
+            memcpy(newlines, block->lb_lines,
+                block->lb_count * sizeof(Dwarf_Line));
+            dwarf_dealloc(dbg, block->lb_lines, DW_DLA_LIST);
+        }
+        block->lb_lines = newlines;
+        block->lb_space = newspace;
+    }
+    block->lb_lines[block->lb_count++] = line;
+    return DW_DLV_OK;
+}
+
+/*  Record the row the registers now describe. If
+    dwarf_srclines_stream() is reading the table the row
+    goes to its callback and nothing is allocated,
+    otherwise it becomes a new Dwarf_Line in block.
+    Returns DW_DLV_NO_ENTRY if the callback wants no more rows. */
+static int
+add_line_row(Dwarf_Debug dbg,
+    Dwarf_Line_Context line_context,
+    struct Dwarf_Line_Registers_s *regs,
+    Dwarf_Bool is_addr_set,
+    Dwarf_Bool is_actuals_table,
+    struct Dwarf_Line_Block_s *block,
+    Dwarf_Error *error)
+{
+    Dwarf_Line curr_line = 0;
+    int res = 0;
+
+    if (line_context->lc_row_callback) {
+        Dwarf_Line_Row row;
+
+        row.dlr_address = regs->lr_address;
+        row.dlr_file = regs->lr_file;
+        row.dlr_line = regs->lr_line;
+        row.dlr_column = regs->lr_column;
+        row.dlr_isa = regs->lr_isa;
+        row.dlr_discriminator = regs->lr_discriminator;
+        row.dlr_call_context = regs->lr_call_context;
+        row.dlr_subprogram = regs->lr_subprogram;
+        row.dlr_is_stmt = regs->lr_is_stmt;
+        row.dlr_basic_block = regs->lr_basic_block;
+        row.dlr_end_sequence = regs->lr_end_sequence;
+        row.dlr_prologue_end = regs->lr_prologue_end;
+        row.dlr_epilogue_begin = regs->lr_epilogue_begin;
+        row.dlr_is_addr_set = is_addr_set;
+        row.dlr_is_actuals_table = is_actuals_table;
+        res = line_context->lc_row_callback(&row,
+            line_context->lc_row_callback_data);
+        return (res == DW_DLV_OK)? DW_DLV_OK: DW_DLV_NO_ENTRY;
+    }
+
+    curr_line = (Dwarf_Line) _dwarf_get_alloc(dbg, DW_DLA_LINE, 1);
+    if (curr_line == NULL) {
+        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+        return (DW_DLV_ERROR);
+    }
+    /* Mark a line record as being DW_LNS_set_address */
+    curr_line->li_addr_line.li_l_data.li_is_addr_set = is_addr_set;
+    curr_line->li_address = regs->lr_address;
+    curr_line->li_addr_line.li_l_data.li_file =
+        (Dwarf_Sword) regs->lr_file;
+    curr_line->li_addr_line.li_l_data.li_line =
+        (Dwarf_Sword) regs->lr_line;
+    curr_line->li_addr_line.li_l_data.li_column =
+        (Dwarf_Half) regs->lr_column;
+    curr_line->li_addr_line.li_l_data.li_is_stmt = regs->lr_is_stmt;
+    curr_line->li_addr_line.li_l_data.li_basic_block =
+        regs->lr_basic_block;
+    curr_line->li_addr_line.li_l_data.li_end_sequence =
+        regs->lr_end_sequence;
+    curr_line->li_addr_line.li_l_data.li_epilogue_begin =
+        regs->lr_epilogue_begin;
+    curr_line->li_addr_line.li_l_data.li_prologue_end =
+        regs->lr_prologue_end;
+    curr_line->li_addr_line.li_l_data.li_isa = regs->lr_isa;
+    curr_line->li_addr_line.li_l_data.li_discriminator =
+        regs->lr_discriminator;
+    curr_line->li_addr_line.li_l_data.li_call_context =
+        regs->lr_call_context;
+    curr_line->li_addr_line.li_l_data.li_subprogram =
+        regs->lr_subprogram;
+    curr_line->li_context = line_context;
+    curr_line->li_is_actuals_table = is_actuals_table;
+    res = add_to_line_block(dbg,block,curr_line,error);
+    if (res != DW_DLV_OK) {
+        dwarf_dealloc(dbg, curr_line, DW_DLA_LINE);
+        return res;
+    }
+    return DW_DLV_OK;
+}
+
 /*  Read one line table program. For two-level line tables, this
     function is called once for each table. */
 static int
@@ -788,17 +917,12 @@ read_line_table_program(Dwarf_Debug dbg,
     Dwarf_Error *error,
     int *err_count_out)
 {
-    Dwarf_Sword i = 0;
     Dwarf_File_Entry cur_file_entry = 0;
     Dwarf_Line *logicals = line_context->lc_linebuf_logicals;
     Dwarf_Signed logicals_count = line_context->lc_linecount_logicals;;
 
     struct Dwarf_Line_Registers_s regs;
 
-    /*  This is a pointer to the current line being added to the line
-        matrix. */
-    Dwarf_Line curr_line = 0;
-
     /*  These variables are used to decode leb128 numbers. Leb128_num
         holds the decoded number, and leb128_length is its length in
         bytes. */
@@ -817,26 +941,26 @@ read_line_table_program(Dwarf_Debug dbg,
     Dwarf_Word instr_length = 0;
 
 
-    /*  Used to chain together pointers to line table entries that are
-        later used to create a block of Dwarf_Line entries. */
-    Dwarf_Chain chain_line = NULL;
-    Dwarf_Chain head_chain = NULL;
-    Dwarf_Chain curr_chain = NULL;
+    /*  The Dwarf_Line entries made so far, this becomes the
+        block of Dwarf_Lines returned in linebuf. */
+    struct Dwarf_Line_Block_s block;
 
-    /*  This points to a block of Dwarf_Lines, a pointer to which is
-        returned in linebuf. */
-    Dwarf_Line *block_line = 0;
+    /*  Set when the dwarf_srclines_stream() callback asks
+        for no more rows. */
+    Dwarf_Bool stop_reading = false;
 
     /*  Mark a line record as being DW_LNS_set_address */
     Dwarf_Bool is_addr_set = false;
 
+    memset(&block,0,sizeof(block));
+
     /*  Initialize the one state machine variable that depends on the
         prefix.  */
     _dwarf_set_line_table_regs_default_values(&regs,
         line_context->lc_default_is_stmt);
 
     /* Start of statement program.  */
-    while (line_ptr < line_ptr_end) {
+    while (line_ptr < line_ptr_end && !stop_reading) {
         int type = 0;
         Dwarf_Small opcode = 0;
 
@@ -918,54 +1042,16 @@ read_line_table_program(Dwarf_Debug dbg,
 #endif /* PRINTING_DETAILS */
 
             if (dolines) {
-                curr_line =
-                    (Dwarf_Line) _dwarf_get_alloc(dbg, DW_DLA_LINE, 1);
-                if (curr_line == NULL) {
-                    _dwarf_free_chain_entries(dbg,head_chain,line_count);
-                    _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
-                    return (DW_DLV_ERROR);
+                int res = add_line_row(dbg,line_context,&regs,
+                    is_addr_set,is_actuals_table,&block,error);
+                if (res == DW_DLV_ERROR) {
+                    free_line_block(dbg,&block);
+                    return res;
                 }
-
+                stop_reading = (res == DW_DLV_NO_ENTRY);
                 /* Mark a line record as being DW_LNS_set_address */
-                curr_line->li_addr_line.li_l_data.li_is_addr_set = is_addr_set;
                 is_addr_set = false;
-
-                curr_line->li_address = regs.lr_address;
-                curr_line->li_addr_line.li_l_data.li_file =
-                    (Dwarf_Sword) regs.lr_file;
-                curr_line->li_addr_line.li_l_data.li_line =
-                    (Dwarf_Sword) regs.lr_line;
-                curr_line->li_addr_line.li_l_data.li_column =
-                    (Dwarf_Half) regs.lr_column;
-                curr_line->li_addr_line.li_l_data.li_is_stmt =
-                    regs.lr_is_stmt;
-                curr_line->li_addr_line.li_l_data.li_basic_block =
-                    regs.lr_basic_block;
-                curr_line->li_addr_line.li_l_data.li_end_sequence =
-                    curr_line->li_addr_line.li_l_data.
-                    li_epilogue_begin = regs.lr_epilogue_begin;
-                curr_line->li_addr_line.li_l_data.li_prologue_end =
-                    regs.lr_prologue_end;
-                curr_line->li_addr_line.li_l_data.li_isa = regs.lr_isa;
-                curr_line->li_addr_line.li_l_data.li_discriminator =
-                    regs.lr_discriminator;
-                curr_line->li_addr_line.li_l_data.li_call_context =
-                    regs.lr_call_context;
-                curr_line->li_addr_line.li_l_data.li_subprogram =
-                    regs.lr_subprogram;
-                curr_line->li_context = line_context;
-                curr_line->li_is_actuals_table = is_actuals_table;
                 line_count++;
-
-                chain_line = (Dwarf_Chain)
-                    _dwarf_get_alloc(dbg, DW_DLA_CHAIN, 1);
-                if (chain_line == NULL) {
-                    _dwarf_free_chain_entries(dbg,head_chain,line_count);
-                    _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
-                    return (DW_DLV_ERROR);
-                }
-                chain_line->ch_item = curr_line;
-                _dwarf_update_chain_list(chain_line,&head_chain,&curr_chain);
             }
 
             regs.lr_basic_block = false;
@@ -982,56 +1068,16 @@ read_line_table_program(Dwarf_Debug dbg,
                     opcode,line_count+1, &regs,is_single_table, is_actuals_table);
 #endif /* PRINTING_DETAILS */
                 if (dolines) {
-                    curr_line = (Dwarf_Line) _dwarf_get_alloc(dbg,
-                        DW_DLA_LINE, 1);
-                    if (curr_line == NULL) {
-                        _dwarf_free_chain_entries(dbg,head_chain,line_count);
-                        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
-                        return (DW_DLV_ERROR);
+                    int res = add_line_row(dbg,line_context,&regs,
+                        is_addr_set,is_actuals_table,&block,error);
+                    if (res == DW_DLV_ERROR) {
+                        free_line_block(dbg,&block);
+                        return res;
                     }
-
+                    stop_reading = (res == DW_DLV_NO_ENTRY);
                     /* Mark a line record as being DW_LNS_set_address */
-                    curr_line->li_addr_line.li_l_data.li_is_addr_set =
-                        is_addr_set;
                     is_addr_set = false;
-
-                    curr_line->li_address = regs.lr_address;
-                    curr_line->li_addr_line.li_l_data.li_file =
-                        (Dwarf_Sword) regs.lr_file;
-                    curr_line->li_addr_line.li_l_data.li_line =
-                        (Dwarf_Sword) regs.lr_line;
-                    curr_line->li_addr_line.li_l_data.li_column =
-                        (Dwarf_Half) regs.lr_column;
-                    curr_line->li_addr_line.li_l_data.li_is_stmt =
-                        regs.lr_is_stmt;
-                    curr_line->li_addr_line.li_l_data.
-                        li_basic_block = regs.lr_basic_block;
-                    curr_line->li_addr_line.li_l_data.
-                        li_end_sequence = regs.lr_end_sequence;
-                    curr_line->li_context = line_context;
-                    curr_line->li_is_actuals_table = is_actuals_table;
-                    curr_line->li_addr_line.li_l_data.
-                        li_epilogue_begin = regs.lr_epilogue_begin;
-                    curr_line->li_addr_line.li_l_data.
-                        li_prologue_end = regs.lr_prologue_end;
-                    curr_line->li_addr_line.li_l_data.li_isa = regs.lr_isa;
-                    curr_line->li_addr_line.li_l_data.li_discriminator =
-                        regs.lr_discriminator;
-                    curr_line->li_addr_line.li_l_data.li_call_context =
-                        regs.lr_call_context;
-                    curr_line->li_addr_line.li_l_data.li_subprogram =
-                        regs.lr_subprogram;
                     line_count++;
-
-                    chain_line = (Dwarf_Chain)
-                        _dwarf_get_alloc(dbg, DW_DLA_CHAIN, 1);
-                    if (chain_line == NULL) {
-                        _dwarf_free_chain_entries(dbg,head_chain,line_count);
-                        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
-                        return (DW_DLV_ERROR);
-                    }
-                    chain_line->ch_item = curr_line;
-                    _dwarf_update_chain_list(chain_line,&head_chain,&curr_chain);
                 }
 
                 regs.lr_basic_block = false;
@@ -1193,7 +1239,7 @@ read_line_table_program(Dwarf_Debug dbg,
                     /*  The value of the isa did not fit in our
                         local so we record it wrong. declare an
                         error. */
-                    _dwarf_free_chain_entries(dbg,head_chain,line_count);
+                    free_line_block(dbg,&block);
                     _dwarf_error(dbg, error,
                         DW_DLE_LINE_NUM_OPERANDS_BAD);
                     return (DW_DLV_ERROR);
@@ -1276,14 +1322,11 @@ read_line_table_program(Dwarf_Debug dbg,
                 /* Experimental two-level line tables */
             case DW_LNS_pop_context: {
                 Dwarf_Unsigned logical_num = regs.lr_call_context;
-                Dwarf_Chain logical_chain = head_chain;
                 Dwarf_Line logical_line = 0;
 
-                if (logical_num > 0 && logical_num <= line_count) {
-                    for (i = 1; i < logical_num; i++) {
-                        logical_chain = logical_chain->ch_next;
-                    }
-                    logical_line = (Dwarf_Line) logical_chain->ch_item;
+                if (logical_num > 0 &&
+                    logical_num <= (Dwarf_Unsigned)block.lb_count) {
+                    logical_line = block.lb_lines[logical_num - 1];
                     regs.lr_file =
                         logical_line->li_addr_line.li_l_data.li_file;
                     regs.lr_line =
@@ -1328,55 +1371,24 @@ read_line_table_program(Dwarf_Debug dbg,
             case DW_LNE_end_sequence:{
                 regs.lr_end_sequence = true;
                 if (dolines) {
-                    curr_line = (Dwarf_Line)
-                        _dwarf_get_alloc(dbg, DW_DLA_LINE, 1);
-                    if (curr_line == NULL) {
-                        _dwarf_free_chain_entries(dbg,head_chain,line_count);
-                        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
-                        return (DW_DLV_ERROR);
-                    }
+                    int res = 0;
 
 #ifdef PRINTING_DETAILS
                     print_line_detail(dbg,"DW_LNE_end_sequence extended",
                         ext_opcode, line_count+1,&regs,
                         is_single_table, is_actuals_table);
 #endif /* PRINTING_DETAILS */
-                    curr_line->li_address = regs.lr_address;
-                    curr_line->li_addr_line.li_l_data.li_file =
-                        (Dwarf_Sword) regs.lr_file;
-                    curr_line->li_addr_line.li_l_data.li_line =
-                        (Dwarf_Sword) regs.lr_line;
-                    curr_line->li_addr_line.li_l_data.li_column =
-                        (Dwarf_Half) regs.lr_column;
-                    curr_line->li_addr_line.li_l_data.li_is_stmt =
-                        regs.lr_is_stmt;
-                    curr_line->li_addr_line.li_l_data.
-                        li_basic_block = regs.lr_basic_block;
-                    curr_line->li_addr_line.li_l_data.
-                        li_end_sequence = regs.lr_end_sequence;
-                    curr_line->li_context = line_context;
-                    curr_line->li_is_actuals_table = is_actuals_table;
-                    curr_line->li_addr_line.li_l_data.
-                        li_epilogue_begin = regs.lr_epilogue_begin;
-                    curr_line->li_addr_line.li_l_data.
-                        li_prologue_end = regs.lr_prologue_end;
-                    curr_line->li_addr_line.li_l_data.li_isa = regs.lr_isa;
-                    curr_line->li_addr_line.li_l_data.li_discriminator =
-                        regs.lr_discriminator;
-                    curr_line->li_addr_line.li_l_data.li_call_context =
-                        regs.lr_call_context;
-                    curr_line->li_addr_line.li_l_data.li_subprogram =
-                        regs.lr_subprogram;
-                    line_count++;
-                    chain_line = (Dwarf_Chain)
-                        _dwarf_get_alloc(dbg, DW_DLA_CHAIN, 1);
-                    if (chain_line == NULL) {
-                        _dwarf_free_chain_entries(dbg,head_chain,line_count);
-                        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
-                        return (DW_DLV_ERROR);
+                    /*  The end_sequence row is never marked as
+                        DW_LNS_set_address, and leaves is_addr_set
+                        for the row after it. */
+                    res = add_line_row(dbg,line_context,&regs,
+                        false,is_actuals_table,&block,error);
+                    if (res == DW_DLV_ERROR) {
+                        free_line_block(dbg,&block);
+                        return res;
                     }
-                    chain_line->ch_item = curr_line;
-                    _dwarf_update_chain_list(chain_line,&head_chain,&curr_chain);
+                    stop_reading = (res == DW_DLV_NO_ENTRY);
+                    line_count++;
                 }
                 _dwarf_set_line_table_regs_default_values(&regs,
                     line_context->lc_default_is_stmt);
@@ -1396,10 +1408,11 @@ read_line_table_program(Dwarf_Debug dbg,
 #endif /* PRINTING_DETAILS */
                 if (doaddrs) {
                     /* SGI IRIX rqs processing only. */
-                    curr_line = (Dwarf_Line) _dwarf_get_alloc(dbg,
+                    int res = 0;
+                    Dwarf_Line curr_line = (Dwarf_Line) _dwarf_get_alloc(dbg,
                         DW_DLA_LINE, 1);
                     if (curr_line == NULL) {
-                        _dwarf_free_chain_entries(dbg,head_chain,line_count);
+                        free_line_block(dbg,&block);
                         _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
                         return (DW_DLV_ERROR);
                     }
@@ -1413,17 +1426,13 @@ read_line_table_program(Dwarf_Debug dbg,
                     curr_line->li_addr_line.li_offset =
                         line_ptr - dbg->de_debug_line.dss_data;
 #endif /* __sgi */
-                    line_count++;
-                    chain_line = (Dwarf_Chain)
-                        _dwarf_get_alloc(dbg, DW_DLA_CHAIN, 1);
-                    if (chain_line == NULL) {
-                        _dwarf_free_chain_entries(dbg,head_chain,line_count);
-                        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
-                        return (DW_DLV_ERROR);
+                    res = add_to_line_block(dbg,&block,curr_line,error);
+                    if (res != DW_DLV_OK) {
+                        dwarf_dealloc(dbg,curr_line,DW_DLA_LINE);
+                        free_line_block(dbg,&block);
+                        return res;
                     }
-                    chain_line->ch_item = curr_line;
-
-                    _dwarf_update_chain_list(chain_line,&head_chain,&curr_chain);
+                    line_count++;
                 }
                 regs.lr_op_index = 0;
                 line_ptr += address_size;
@@ -1445,7 +1454,7 @@ read_line_table_program(Dwarf_Debug dbg,
                     res = _dwarf_check_string_valid(dbg,
                         line_ptr,line_ptr,line_ptr_end,error);
                     if (res != DW_DLV_OK) {
-                        _dwarf_free_chain_entries(dbg,head_chain,line_count);
+                        free_line_block(dbg,&block);
                         return res;
                     }
                     line_ptr = line_ptr + strlen((char *) line_ptr) + 1;
@@ -1498,7 +1507,7 @@ read_line_table_program(Dwarf_Debug dbg,
                     and the op code and the bytes of operand. */
                 Dwarf_Unsigned remaining_bytes = instr_length -1;
                 if (instr_length < 1 || remaining_bytes > DW_LNE_LEN_MAX) {
-                    _dwarf_free_chain_entries(dbg,head_chain,line_count);
+                    free_line_block(dbg,&block);
                     _dwarf_error(dbg, error,
                         DW_DLE_LINE_EXT_OPCODE_BAD);
                     return (DW_DLV_ERROR);
@@ -1528,32 +1537,22 @@ read_line_table_program(Dwarf_Debug dbg,
             } /* End switch. */
         }
     }
-    block_line = (Dwarf_Line *)
-        _dwarf_get_alloc(dbg, DW_DLA_LIST, line_count);
-    if (block_line == NULL) {
-        curr_chain = head_chain;
-        /*  FIXME: chain cleanup should be a function and called at
-            more places in this function.  */
-        _dwarf_free_chain_entries(dbg,head_chain,line_count);
-        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
-        return (DW_DLV_ERROR);
-    }
-
-    curr_chain = head_chain;
-    for (i = 0; i < line_count; i++) {
-        Dwarf_Chain t = 0;
-        *(block_line + i) = curr_chain->ch_item;
-        t = curr_chain;
-        curr_chain = curr_chain->ch_next;
-        dwarf_dealloc(dbg, t, DW_DLA_CHAIN);
+    if (!block.lb_lines) {
+        /*  No rows, or they all went to a callback.
+            Callers still expect a (zero length) block. */
+        block.lb_lines = (Dwarf_Line *)
+            _dwarf_get_alloc(dbg, DW_DLA_LIST, 0);
+        if (block.lb_lines == NULL) {
+            _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+            return (DW_DLV_ERROR);
+        }
     }
-
     if (is_single_table || !is_actuals_table) {
-        line_context->lc_linebuf_logicals = block_line;
-        line_context->lc_linecount_logicals = line_count;
+        line_context->lc_linebuf_logicals = block.lb_lines;
+        line_context->lc_linecount_logicals = block.lb_count;
     } else {
-        line_context->lc_linebuf_actuals = block_line;
-        line_context->lc_linecount_actuals = line_count;
+        line_context->lc_linebuf_actuals = block.lb_lines;
+        line_context->lc_linecount_actuals = block.lb_count;
     }
 #ifdef PRINTING_DETAILS
     if (is_single_table) {
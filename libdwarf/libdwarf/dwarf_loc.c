@@ -96,7 +96,7 @@ read_encoded_addr(Dwarf_Small *loc_ptr, Dwarf_Debug dbg,
     extract operator fields. For any
     DWARF version.
 */
-static int
+int
 _dwarf_read_loc_expr_op(Dwarf_Debug dbg,
     Dwarf_Block_c * loc_block,
     /* Caller: Start numbering at 0. */
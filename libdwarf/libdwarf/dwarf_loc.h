@@ -147,3 +147,50 @@ struct Dwarf_Loc_Head_c_s {
 int _dwarf_loc_block_sanity_check(Dwarf_Debug dbg,
     Dwarf_Block_c *loc_block,Dwarf_Error*error);
 
+int _dwarf_read_loc_expr_op(Dwarf_Debug dbg,
+    Dwarf_Block_c * loc_block,
+    Dwarf_Signed opnumber,
+    Dwarf_Half version_stamp,
+    Dwarf_Half offset_size,
+    Dwarf_Half address_size,
+    Dwarf_Signed startoffset_in,
+    Dwarf_Unsigned *nextoffset_out,
+    Dwarf_Loc_c curr_loc,
+    Dwarf_Error * error);
+
+/*  One operator of a compiled location expression.
+    lpo_op is one of the LPO_ values in dwarf_loc_eval.c. */
+struct Dwarf_Loc_Prog_Op_s {
+    Dwarf_Small    lpo_op;
+    /*  Bytes read by a deref. */
+    Dwarf_Small    lpo_size;
+    /*  Register of a register or register-relative operator. */
+    Dwarf_Unsigned lpo_reg;
+    /*  The constant, offset, branch target index, or
+        piece size in bits. */
+    Dwarf_Unsigned lpo_number;
+    /*  Bit offset of a bit piece. */
+    Dwarf_Unsigned lpo_number2;
+    /*  The bytes of DW_OP_implicit_value, lpo_number long. */
+    Dwarf_Small   *lpo_block;
+};
+
+/*  A location expression compiled by dwarf_loc_program_compile().
+    lp_ops is allocated along with the struct. */
+struct Dwarf_Loc_Program_s {
+    Dwarf_Debug    lp_dbg;
+    Dwarf_Unsigned lp_address_mask;
+    Dwarf_Small    lp_address_size;
+    /*  A DW_LOC_PROG_ shape. For all but DW_LOC_PROG_GENERAL
+        eval uses these and not lp_ops. */
+    Dwarf_Small    lp_shape;
+    Dwarf_Unsigned lp_shape_reg;
+    Dwarf_Signed   lp_shape_offset;
+    /*  Set if the expression branches, so eval must
+        stop an endless loop. */
+    Dwarf_Small    lp_has_branch;
+    Dwarf_Unsigned lp_piece_count;
+    Dwarf_Unsigned lp_op_count;
+    struct Dwarf_Loc_Prog_Op_s *lp_ops;
+};
+
@@ -0,0 +1,955 @@
+/*
+
+  Copyright (C) 2026 The udb contributors. All Rights Reserved.
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of version 2.1 of the GNU Lesser General Public License
+  as published by the Free Software Foundation.
+
+  This program is distributed in the hope that it would be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  Further, this software is distributed without any warranty that it is
+  free of the rightful claim of any third person regarding infringement
+  or the like.  Any license provided herein, whether implied or
+  otherwise, applies only to this software file.  Patent licenses, if
+  any, provided herein do not apply to combinations of this program with
+  other software, or any other product whatsoever.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program; if not, write the Free Software
+  Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston MA 02110-1301,
+  USA.
+
+*/
+
+/*  Compiling and evaluating location expressions.
+
+    dwarf_loc_program_compile() decodes the expression with
+    _dwarf_read_loc_expr_op() and turns each operator into a
+    struct Dwarf_Loc_Prog_Op_s.  The many encodings of one
+    thing become one LPO_ value (all the DW_OP_lit*, DW_OP_const*
+    and DW_OP_addr are LPO_CONST, all the DW_OP_breg* and
+    DW_OP_bregx are LPO_BREG) so eval switches over a few
+    dense values.  While appending, constant arithmetic at
+    the end of the program is folded into the operator before
+    it.  A program that ends up a single register, register
+    plus offset, frame base plus offset, CFA plus offset or
+    address operator is given a shape and eval does it
+    without running the program at all.
+
+    Folding is not done in an expression with DW_OP_bra or
+    DW_OP_skip, as a branch could land between the operators
+    folded together. Those are translated one for one and
+    branch byte offsets become operator indexes.
+*/
+
+#include "config.h"
+#include "dwarf_incl.h"
+#include "dwarf_loc.h"
+#include <stdlib.h> /* for malloc(), free(). */
+
+#define TRUE 1
+#define FALSE 0
+
+/*  The DWARF standard suggests no limit, gdb uses a
+    growable stack.  Real expressions use a handful. */
+#define LOC_EVAL_STACK_SIZE 64
+
+/*  Only an expression with a backward branch can run longer
+    than it has operators. */
+#define LOC_EVAL_STEP_LIMIT 100000
+
+enum Dwarf_Loc_Prog_Op_e {
+    LPO_NOP,
+    LPO_CONST,          /* push lpo_number */
+    LPO_REG,            /* in register lpo_reg */
+    LPO_BREG,           /* push register lpo_reg + lpo_number */
+    LPO_FBREG,          /* push frame base + lpo_number */
+    LPO_CFA,            /* push CFA + lpo_number */
+    LPO_PLUS_CONST,     /* add lpo_number to the top */
+    LPO_DUP,
+    LPO_DROP,
+    LPO_OVER,
+    LPO_PICK,           /* push entry lpo_number from the top */
+    LPO_SWAP,
+    LPO_ROT,
+    LPO_DEREF,          /* read lpo_size bytes */
+    LPO_ABS,
+    LPO_NEG,
+    LPO_NOT,
+    LPO_AND,
+    LPO_DIV,
+    LPO_MINUS,
+    LPO_MOD,
+    LPO_MUL,
+    LPO_OR,
+    LPO_PLUS,
+    LPO_SHL,
+    LPO_SHR,
+    LPO_SHRA,
+    LPO_XOR,
+    LPO_EQ,
+    LPO_GE,
+    LPO_GT,
+    LPO_LE,
+    LPO_LT,
+    LPO_NE,
+    LPO_SKIP,           /* continue at operator lpo_number */
+    LPO_BRA,            /* pop, if non-zero continue at lpo_number */
+    LPO_TLS,            /* replace the top by its TLS address */
+    LPO_STACK_VALUE,
+    LPO_IMPLICIT_VALUE, /* lpo_number bytes at lpo_block */
+    LPO_PIECE           /* lpo_number bits at bit lpo_number2 */
+};
+
+/*  Binary operators are applied as second_from_top OP top. */
+static int
+is_binary_op(Dwarf_Small op)
+{
+    return op >= LPO_AND && op <= LPO_NE;
+}
+
+static int
+is_unary_op(Dwarf_Small op)
+{
+    return op == LPO_ABS || op == LPO_NEG || op == LPO_NOT;
+}
+
+/*  Operators whose lpo_number is added to what they push. */
+static int
+is_offset_op(Dwarf_Small op)
+{
+    return op == LPO_CONST || op == LPO_BREG || op == LPO_FBREG ||
+        op == LPO_CFA || op == LPO_PLUS_CONST;
+}
+
+/*  Whether, having run without error, op leaves a value
+    on the stack. Folding away an operator that needs one
+    must not hide an underflow. */
+static int
+leaves_value(Dwarf_Small op)
+{
+    switch (op) {
+    case LPO_NOP:
+    case LPO_REG:
+    case LPO_DROP:
+    case LPO_SKIP:
+    case LPO_BRA:
+    case LPO_STACK_VALUE:
+    case LPO_IMPLICIT_VALUE:
+    case LPO_PIECE:
+        return FALSE;
+    default:
+        break;
+    }
+    return TRUE;
+}
+
+/*  The generic type is address size bytes. Stack values
+    are kept zero extended from that size by and-ing them
+    with mask, the program's lp_address_mask. Returns a
+    as a signed value of that size. */
+static Dwarf_Signed
+sign_extend(Dwarf_Unsigned a, Dwarf_Unsigned mask)
+{
+    Dwarf_Unsigned sign_bit = mask ^ (mask >> 1);
+
+    if (a & sign_bit) {
+        a |= ~mask;
+    }
+    return (Dwarf_Signed)a;
+}
+
+static Dwarf_Unsigned
+apply_unary_op(Dwarf_Small op, Dwarf_Unsigned a, Dwarf_Unsigned mask)
+{
+    a &= mask;
+    switch (op) {
+    case LPO_ABS:
+        return (sign_extend(a, mask) < 0)? -a & mask : a;
+    case LPO_NEG:
+        return -a & mask;
+    case LPO_NOT:
+        return ~a & mask;
+    default:
+        break;
+    }
+    return a;
+}
+
+/*  Caller checks b is not zero for LPO_DIV and LPO_MOD.
+    Comparisons and DW_OP_div are signed, as the
+    generic type of DWARF3 and 4 is. The result is
+    reduced to the address size like the operands. */
+static Dwarf_Unsigned
+apply_binary_op(Dwarf_Small op, Dwarf_Unsigned a, Dwarf_Unsigned b,
+    Dwarf_Unsigned mask)
+{
+    Dwarf_Signed sa = 0;
+    Dwarf_Signed sb = 0;
+    Dwarf_Unsigned r = 0;
+
+    a &= mask;
+    b &= mask;
+    sa = sign_extend(a, mask);
+    sb = sign_extend(b, mask);
+    switch (op) {
+    case LPO_AND:   r = a & b; break;
+    case LPO_DIV:
+        if (sb == -1) {
+            /*  Avoids the overflow of the most negative
+                value divided by -1. */
+            r = -a;
+        } else {
+            r = (Dwarf_Unsigned)(sa / sb);
+        }
+        break;
+    case LPO_MINUS: r = a - b; break;
+    case LPO_MOD:   r = a % b; break;
+    case LPO_MUL:   r = a * b; break;
+    case LPO_OR:    r = a | b; break;
+    case LPO_PLUS:  r = a + b; break;
+    case LPO_SHL:   r = (b >= 64)? 0 : a << b; break;
+    case LPO_SHR:   r = (b >= 64)? 0 : a >> b; break;
+    case LPO_SHRA:
+        /*  sa is sign extended to 64 bits, so shifting it
+            shifts in copies of the address size sign bit. */
+        if (b >= 64) {
+            b = 63;
+        }
+        if (sa < 0) {
+            r = ~((~(Dwarf_Unsigned)sa) >> b);
+        } else {
+            r = a >> b;
+        }
+        break;
+    case LPO_XOR:   r = a ^ b; break;
+    case LPO_EQ:    return a == b;
+    case LPO_GE:    return sa >= sb;
+    case LPO_GT:    return sa > sb;
+    case LPO_LE:    return sa <= sb;
+    case LPO_LT:    return sa < sb;
+    case LPO_NE:    return a != b;
+    default:
+        break;
+    }
+    return r & mask;
+}
+
+/*  Fills in op for the decoded operator loc.
+    Returns DW_DLV_NO_ENTRY for an operator eval does not do. */
+static int
+translate_loc_op(struct Dwarf_Loc_c_s *loc,
+    Dwarf_Half address_size,
+    struct Dwarf_Loc_Prog_Op_s *op)
+{
+    Dwarf_Small atom = loc->lr_atom;
+
+    memset(op, 0, sizeof(*op));
+    if (atom >= DW_OP_lit0 && atom <= DW_OP_lit31) {
+        op->lpo_op = LPO_CONST;
+        op->lpo_number = atom - DW_OP_lit0;
+        return DW_DLV_OK;
+    }
+    if (atom >= DW_OP_reg0 && atom <= DW_OP_reg31) {
+        op->lpo_op = LPO_REG;
+        op->lpo_reg = atom - DW_OP_reg0;
+        return DW_DLV_OK;
+    }
+    if (atom >= DW_OP_breg0 && atom <= DW_OP_breg31) {
+        op->lpo_op = LPO_BREG;
+        op->lpo_reg = atom - DW_OP_breg0;
+        op->lpo_number = loc->lr_number;
+        return DW_DLV_OK;
+    }
+    switch (atom) {
+    case DW_OP_addr:
+    case DW_OP_const1u:
+    case DW_OP_const1s:
+    case DW_OP_const2u:
+    case DW_OP_const2s:
+    case DW_OP_const4u:
+    case DW_OP_const4s:
+    case DW_OP_const8u:
+    case DW_OP_const8s:
+    case DW_OP_constu:
+    case DW_OP_consts:
+        /*  _dwarf_read_loc_expr_op() sign extended the
+            signed ones. */
+        op->lpo_op = LPO_CONST;
+        op->lpo_number = loc->lr_number;
+        break;
+    case DW_OP_regx:
+        op->lpo_op = LPO_REG;
+        op->lpo_reg = loc->lr_number;
+        break;
+    case DW_OP_bregx:
+        op->lpo_op = LPO_BREG;
+        op->lpo_reg = loc->lr_number;
+        op->lpo_number = loc->lr_number2;
+        break;
+    case DW_OP_fbreg:
+        op->lpo_op = LPO_FBREG;
+        op->lpo_number = loc->lr_number;
+        break;
+    case DW_OP_call_frame_cfa:
+        op->lpo_op = LPO_CFA;
+        break;
+    case DW_OP_plus_uconst:
+        op->lpo_op = LPO_PLUS_CONST;
+        op->lpo_number = loc->lr_number;
+        break;
+    case DW_OP_dup:   op->lpo_op = LPO_DUP; break;
+    case DW_OP_drop:  op->lpo_op = LPO_DROP; break;
+    case DW_OP_over:  op->lpo_op = LPO_OVER; break;
+    case DW_OP_pick:
+        op->lpo_op = LPO_PICK;
+        op->lpo_number = loc->lr_number;
+        break;
+    case DW_OP_swap:  op->lpo_op = LPO_SWAP; break;
+    case DW_OP_rot:   op->lpo_op = LPO_ROT; break;
+    case DW_OP_deref:
+        op->lpo_op = LPO_DEREF;
+        op->lpo_size = address_size;
+        break;
+    case DW_OP_deref_size:
+        if (loc->lr_number < 1 || loc->lr_number > 8) {
+            return DW_DLV_NO_ENTRY;
+        }
+        op->lpo_op = LPO_DEREF;
+        op->lpo_size = loc->lr_number;
+        break;
+    case DW_OP_abs:   op->lpo_op = LPO_ABS; break;
+    case DW_OP_neg:   op->lpo_op = LPO_NEG; break;
+    case DW_OP_not:   op->lpo_op = LPO_NOT; break;
+    case DW_OP_and:   op->lpo_op = LPO_AND; break;
+    case DW_OP_div:   op->lpo_op = LPO_DIV; break;
+    case DW_OP_minus: op->lpo_op = LPO_MINUS; break;
+    case DW_OP_mod:   op->lpo_op = LPO_MOD; break;
+    case DW_OP_mul:   op->lpo_op = LPO_MUL; break;
+    case DW_OP_or:    op->lpo_op = LPO_OR; break;
+    case DW_OP_plus:  op->lpo_op = LPO_PLUS; break;
+    case DW_OP_shl:   op->lpo_op = LPO_SHL; break;
+    case DW_OP_shr:   op->lpo_op = LPO_SHR; break;
+    case DW_OP_shra:  op->lpo_op = LPO_SHRA; break;
+    case DW_OP_xor:   op->lpo_op = LPO_XOR; break;
+    case DW_OP_eq:    op->lpo_op = LPO_EQ; break;
+    case DW_OP_ge:    op->lpo_op = LPO_GE; break;
+    case DW_OP_gt:    op->lpo_op = LPO_GT; break;
+    case DW_OP_le:    op->lpo_op = LPO_LE; break;
+    case DW_OP_lt:    op->lpo_op = LPO_LT; break;
+    case DW_OP_ne:    op->lpo_op = LPO_NE; break;
+    case DW_OP_skip:
+    case DW_OP_bra:
+        /*  The target is fixed up once all the operators
+            have been read. */
+        op->lpo_op = (atom == DW_OP_skip)? LPO_SKIP : LPO_BRA;
+        break;
+    case DW_OP_nop:
+    case DW_OP_GNU_uninit:
+        op->lpo_op = LPO_NOP;
+        break;
+    case DW_OP_form_tls_address:
+    case DW_OP_GNU_push_tls_address:
+        op->lpo_op = LPO_TLS;
+        break;
+    case DW_OP_stack_value:
+        op->lpo_op = LPO_STACK_VALUE;
+        break;
+    case DW_OP_implicit_value:
+        op->lpo_op = LPO_IMPLICIT_VALUE;
+        op->lpo_number = loc->lr_number;
+        op->lpo_block = (Dwarf_Small *)loc->lr_number2;
+        break;
+    case DW_OP_piece:
+        op->lpo_op = LPO_PIECE;
+        op->lpo_number = loc->lr_number * 8;
+        break;
+    case DW_OP_bit_piece:
+        op->lpo_op = LPO_PIECE;
+        op->lpo_number = loc->lr_number;
+        op->lpo_number2 = loc->lr_number2;
+        break;
+    default:
+        return DW_DLV_NO_ENTRY;
+    }
+    return DW_DLV_OK;
+}
+
+/*  Appends op to the program, folding it into the
+    operators before it when they are constants. */
+static void
+append_folded_op(Dwarf_Loc_Program prog,
+    struct Dwarf_Loc_Prog_Op_s *op)
+{
+    struct Dwarf_Loc_Prog_Op_s *ops = prog->lp_ops;
+
+    if (op->lpo_op == LPO_NOP) {
+        return;
+    }
+    ops[prog->lp_op_count++] = *op;
+    for (;;) {
+        Dwarf_Unsigned n = prog->lp_op_count;
+        struct Dwarf_Loc_Prog_Op_s *last = 0;
+        struct Dwarf_Loc_Prog_Op_s *prev = 0;
+        struct Dwarf_Loc_Prog_Op_s *prev2 = 0;
+
+        if (n < 2) {
+            return;
+        }
+        last = ops + n - 1;
+        prev = ops + n - 2;
+        prev2 = (n >= 3)? ops + n - 3 : 0;
+        if (last->lpo_op == LPO_PLUS_CONST && is_offset_op(prev->lpo_op)) {
+            /*  DW_OP_breg6 -8 DW_OP_plus_uconst 4 is DW_OP_breg6 -4 */
+            prev->lpo_number += last->lpo_number;
+            prog->lp_op_count--;
+            continue;
+        }
+        if (last->lpo_op == LPO_PLUS_CONST && last->lpo_number == 0 &&
+            leaves_value(prev->lpo_op)) {
+            prog->lp_op_count--;
+            continue;
+        }
+        if (prev2 && leaves_value(prev2->lpo_op) &&
+            prev->lpo_op == LPO_CONST &&
+            (last->lpo_op == LPO_PLUS || last->lpo_op == LPO_MINUS)) {
+            /*  Adding a constant. It folds further if
+                what is before it is a constant or offset. */
+            prev->lpo_op = LPO_PLUS_CONST;
+            if (last->lpo_op == LPO_MINUS) {
+                prev->lpo_number = -prev->lpo_number;
+            }
+            prog->lp_op_count--;
+            continue;
+        }
+        if (prev->lpo_op == LPO_CONST && is_unary_op(last->lpo_op)) {
+            prev->lpo_number = apply_unary_op(last->lpo_op,
+                prev->lpo_number, prog->lp_address_mask);
+            prog->lp_op_count--;
+            continue;
+        }
+        if (prev2 && prev2->lpo_op == LPO_CONST &&
+            prev->lpo_op == LPO_CONST && is_binary_op(last->lpo_op) &&
+            !((last->lpo_op == LPO_DIV || last->lpo_op == LPO_MOD) &&
+            !(prev->lpo_number & prog->lp_address_mask))) {
+            prev2->lpo_number = apply_binary_op(last->lpo_op,
+                prev2->lpo_number, prev->lpo_number,
+                prog->lp_address_mask);
+            prog->lp_op_count -= 2;
+            continue;
+        }
+        return;
+    }
+}
+
+/*  Index of the decoded operator at byte offset target,
+    count if target is the end of the expression,
+    or -1 if no operator starts there. */
+static Dwarf_Signed
+find_loc_op_at_offset(struct Dwarf_Loc_c_s *locs,
+    Dwarf_Unsigned count,
+    Dwarf_Unsigned expression_length,
+    Dwarf_Signed target)
+{
+    Dwarf_Signed low = 0;
+    Dwarf_Signed high = (Dwarf_Signed)count - 1;
+
+    if (target == (Dwarf_Signed)expression_length) {
+        return count;
+    }
+    while (low <= high) {
+        Dwarf_Signed middle = (low + high) / 2;
+        Dwarf_Signed offset = (Dwarf_Signed)locs[middle].lr_offset;
+
+        if (offset == target) {
+            return middle;
+        }
+        if (offset < target) {
+            low = middle + 1;
+        } else {
+            high = middle - 1;
+        }
+    }
+    return -1;
+}
+
+static void
+set_loc_program_shape(Dwarf_Loc_Program prog)
+{
+    struct Dwarf_Loc_Prog_Op_s *op = prog->lp_ops;
+
+    prog->lp_shape = DW_LOC_PROG_GENERAL;
+    if (prog->lp_op_count != 1 || prog->lp_has_branch) {
+        return;
+    }
+    switch (op->lpo_op) {
+    case LPO_CONST:
+        prog->lp_shape = DW_LOC_PROG_ADDRESS;
+        break;
+    case LPO_REG:
+        prog->lp_shape = DW_LOC_PROG_REGISTER;
+        break;
+    case LPO_BREG:
+        prog->lp_shape = DW_LOC_PROG_REG_OFFSET;
+        break;
+    case LPO_FBREG:
+        prog->lp_shape = DW_LOC_PROG_FRAME_BASE_OFFSET;
+        break;
+    case LPO_CFA:
+        prog->lp_shape = DW_LOC_PROG_CFA_OFFSET;
+        break;
+    default:
+        return;
+    }
+    prog->lp_shape_reg = op->lpo_reg;
+    prog->lp_shape_offset = (Dwarf_Signed)op->lpo_number;
+}
+
+int
+dwarf_loc_program_compile(Dwarf_Debug dbg,
+    Dwarf_Ptr expression_in,
+    Dwarf_Unsigned expression_length,
+    Dwarf_Half address_size,
+    Dwarf_Half offset_size,
+    Dwarf_Small dwarf_version,
+    Dwarf_Loc_Program * returned_program,
+    Dwarf_Error * error)
+{
+    Dwarf_Block_c loc_block;
+    struct Dwarf_Loc_c_s *locs = 0;
+    Dwarf_Unsigned loc_count = 0;
+    Dwarf_Unsigned offset = 0;
+    Dwarf_Unsigned i = 0;
+    Dwarf_Bool has_branch = FALSE;
+    Dwarf_Loc_Program prog = 0;
+    int res = 0;
+
+    if (dbg == NULL) {
+        _dwarf_error(NULL, error, DW_DLE_DBG_NULL);
+        return (DW_DLV_ERROR);
+    }
+    if (address_size < 1 || address_size > sizeof(Dwarf_Addr)) {
+        _dwarf_error(dbg, error, DW_DLE_ADDRESS_SIZE_ERROR);
+        return (DW_DLV_ERROR);
+    }
+    memset(&loc_block,0,sizeof(loc_block));
+    loc_block.bl_len = expression_length;
+    loc_block.bl_data = expression_in;
+
+    /*  Every operator is at least one byte. */
+    locs = (struct Dwarf_Loc_c_s *)malloc(
+        (expression_length? expression_length : 1) *
+        sizeof(struct Dwarf_Loc_c_s));
+    if (!locs) {
+        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+        return DW_DLV_ERROR;
+    }
+    for (;;) {
+        Dwarf_Unsigned nextoffset = 0;
+
+        res = _dwarf_read_loc_expr_op(dbg, &loc_block,
+            loc_count, dwarf_version, offset_size, address_size,
+            offset, &nextoffset, locs + loc_count, error);
+        if (res == DW_DLV_NO_ENTRY) {
+            break;
+        }
+        if (res == DW_DLV_ERROR) {
+            free(locs);
+            return res;
+        }
+        if (locs[loc_count].lr_atom == DW_OP_bra ||
+            locs[loc_count].lr_atom == DW_OP_skip) {
+            has_branch = TRUE;
+        }
+        loc_count++;
+        offset = nextoffset;
+    }
+
+    prog = (Dwarf_Loc_Program)malloc(sizeof(struct Dwarf_Loc_Program_s) +
+        loc_count * sizeof(struct Dwarf_Loc_Prog_Op_s));
+    if (!prog) {
+        free(locs);
+        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+        return DW_DLV_ERROR;
+    }
+    memset(prog, 0, sizeof(*prog));
+    prog->lp_dbg = dbg;
+    prog->lp_address_size = address_size;
+    prog->lp_address_mask = (address_size < sizeof(Dwarf_Addr))?
+        ((Dwarf_Unsigned)1 << (address_size * 8)) - 1 :
+        ~(Dwarf_Unsigned)0;
+    prog->lp_has_branch = has_branch;
+    prog->lp_ops = (struct Dwarf_Loc_Prog_Op_s *)(prog + 1);
+
+    for (i = 0; i < loc_count; ++i) {
+        struct Dwarf_Loc_Prog_Op_s op;
+
+        res = translate_loc_op(locs + i, address_size, &op);
+        if (res != DW_DLV_OK) {
+            free(locs);
+            free(prog);
+            return res;
+        }
+        if (op.lpo_op == LPO_SKIP || op.lpo_op == LPO_BRA) {
+            /*  The 2 byte operand counts from the end of
+                this 3 byte operator. */
+            Dwarf_Signed target = (Dwarf_Signed)locs[i].lr_offset + 3 +
+                (Dwarf_Signed)(short)(locs[i].lr_number & 0xffff);
+            Dwarf_Signed index = find_loc_op_at_offset(locs,
+                loc_count, expression_length, target);
+
+            if (index < 0) {
+                free(locs);
+                free(prog);
+                _dwarf_error(dbg, error, DW_DLE_LOC_EVAL_BAD_BRANCH);
+                return DW_DLV_ERROR;
+            }
+            op.lpo_number = index;
+        }
+        if (op.lpo_op == LPO_PIECE) {
+            prog->lp_piece_count++;
+        }
+        if (has_branch) {
+            prog->lp_ops[prog->lp_op_count++] = op;
+        } else {
+            append_folded_op(prog, &op);
+        }
+    }
+    free(locs);
+    if (!prog->lp_piece_count) {
+        prog->lp_piece_count = 1;
+    }
+    set_loc_program_shape(prog);
+    *returned_program = prog;
+    return DW_DLV_OK;
+}
+
+int
+dwarf_loc_program_info(Dwarf_Loc_Program prog,
+    Dwarf_Small * shape,
+    Dwarf_Unsigned * regnum,
+    Dwarf_Signed * offset,
+    Dwarf_Unsigned * piece_count,
+    Dwarf_Error * error)
+{
+    if (prog == NULL) {
+        _dwarf_error(NULL, error, DW_DLE_LOC_EXPR_BAD);
+        return (DW_DLV_ERROR);
+    }
+    if (shape) {
+        *shape = prog->lp_shape;
+    }
+    if (regnum) {
+        *regnum = prog->lp_shape_reg;
+    }
+    if (offset) {
+        *offset = prog->lp_shape_offset;
+    }
+    if (piece_count) {
+        *piece_count = prog->lp_piece_count;
+    }
+    return DW_DLV_OK;
+}
+
+/*  Sets value from how the location (or piece) ended:
+    in a register, an implicit value, or else the top of
+    the stack, which is an address unless DW_OP_stack_value
+    said it is the value. */
+static void
+take_loc_value(Dwarf_Small loc_kind,
+    struct Dwarf_Loc_Prog_Op_s *loc_op,
+    Dwarf_Unsigned *stack,
+    int *sp,
+    Dwarf_Loc_Value *value)
+{
+    switch (loc_kind) {
+    case DW_LOC_VALUE_REGISTER:
+        value->dlv_kind = DW_LOC_VALUE_REGISTER;
+        value->dlv_value = loc_op->lpo_reg;
+        return;
+    case DW_LOC_VALUE_IMPLICIT:
+        value->dlv_kind = DW_LOC_VALUE_IMPLICIT;
+        value->dlv_block = loc_op->lpo_block;
+        value->dlv_block_len = loc_op->lpo_number;
+        return;
+    case DW_LOC_VALUE_VALUE:
+        value->dlv_kind = DW_LOC_VALUE_VALUE;
+        value->dlv_value = stack[--*sp];
+        return;
+    default:
+        break;
+    }
+    if (*sp > 0) {
+        value->dlv_kind = DW_LOC_VALUE_ADDRESS;
+        value->dlv_value = stack[--*sp];
+    } else {
+        value->dlv_kind = DW_LOC_VALUE_EMPTY;
+    }
+}
+
+#define PROVIDER_CALL(fn, args)                              \
+    do {                                                     \
+        int pres_ = DW_DLV_NO_ENTRY;                         \
+        if (provider && provider->fn) {                      \
+            pres_ = provider->fn args;                       \
+        }                                                    \
+        if (pres_ != DW_DLV_OK) {                            \
+            return DW_DLV_NO_ENTRY;                          \
+        }                                                    \
+    } while (0)
+
+#define EVAL_ERROR(code)                                     \
+    do {                                                     \
+        _dwarf_error(prog->lp_dbg, error, (code));           \
+        return DW_DLV_ERROR;                                 \
+    } while (0)
+
+#define NEED(n)                                              \
+    do {                                                     \
+        if (sp < (n)) {                                      \
+            EVAL_ERROR(DW_DLE_LOC_EVAL_STACK_UNDERFLOW);     \
+        }                                                    \
+    } while (0)
+
+/*  Every value on the stack is reduced to the address
+    size, see sign_extend(). */
+#define PUSH(v)                                              \
+    do {                                                     \
+        if (sp >= LOC_EVAL_STACK_SIZE) {                     \
+            EVAL_ERROR(DW_DLE_LOC_EVAL_STACK_OVERFLOW);      \
+        }                                                    \
+        stack[sp] = (v) & prog->lp_address_mask;             \
+        sp++;                                                \
+    } while (0)
+
+int
+dwarf_loc_program_eval(Dwarf_Loc_Program prog,
+    const Dwarf_Loc_Eval_Provider * provider,
+    Dwarf_Loc_Value * values,
+    Dwarf_Unsigned value_space,
+    Dwarf_Unsigned * value_count,
+    Dwarf_Error * error)
+{
+    void *user_data = provider? provider->lep_user_data : 0;
+    Dwarf_Unsigned stack[LOC_EVAL_STACK_SIZE];
+    int sp = 0;
+    Dwarf_Unsigned pc = 0;
+    Dwarf_Unsigned steps = 0;
+    Dwarf_Unsigned pieces = 0;
+    Dwarf_Small loc_kind = DW_LOC_VALUE_ADDRESS;
+    struct Dwarf_Loc_Prog_Op_s *loc_op = 0;
+    Dwarf_Unsigned v = 0;
+
+    if (prog == NULL) {
+        _dwarf_error(NULL, error, DW_DLE_LOC_EXPR_BAD);
+        return (DW_DLV_ERROR);
+    }
+    if (value_space < prog->lp_piece_count) {
+        EVAL_ERROR(DW_DLE_LOC_EVAL_BAD_PIECE);
+    }
+    memset(values, 0, sizeof(*values));
+    *value_count = 1;
+    switch (prog->lp_shape) {
+    case DW_LOC_PROG_ADDRESS:
+        values->dlv_kind = DW_LOC_VALUE_ADDRESS;
+        values->dlv_value = prog->lp_shape_offset &
+            prog->lp_address_mask;
+        return DW_DLV_OK;
+    case DW_LOC_PROG_REGISTER:
+        values->dlv_kind = DW_LOC_VALUE_REGISTER;
+        values->dlv_value = prog->lp_shape_reg;
+        return DW_DLV_OK;
+    case DW_LOC_PROG_REG_OFFSET:
+        PROVIDER_CALL(lep_read_register,
+            (user_data, prog->lp_shape_reg, &v));
+        values->dlv_kind = DW_LOC_VALUE_ADDRESS;
+        values->dlv_value = (v + prog->lp_shape_offset) &
+            prog->lp_address_mask;
+        return DW_DLV_OK;
+    case DW_LOC_PROG_FRAME_BASE_OFFSET:
+        PROVIDER_CALL(lep_frame_base, (user_data, &v));
+        values->dlv_kind = DW_LOC_VALUE_ADDRESS;
+        values->dlv_value = (v + prog->lp_shape_offset) &
+            prog->lp_address_mask;
+        return DW_DLV_OK;
+    case DW_LOC_PROG_CFA_OFFSET:
+        PROVIDER_CALL(lep_call_frame_cfa, (user_data, &v));
+        values->dlv_kind = DW_LOC_VALUE_ADDRESS;
+        values->dlv_value = (v + prog->lp_shape_offset) &
+            prog->lp_address_mask;
+        return DW_DLV_OK;
+    default:
+        break;
+    }
+
+    while (pc < prog->lp_op_count) {
+        struct Dwarf_Loc_Prog_Op_s *op = prog->lp_ops + pc;
+        Dwarf_Unsigned a = 0;
+        Dwarf_Unsigned b = 0;
+
+        pc++;
+        if (prog->lp_has_branch && ++steps > LOC_EVAL_STEP_LIMIT) {
+            EVAL_ERROR(DW_DLE_LOC_EVAL_BAD_BRANCH);
+        }
+        if (loc_kind != DW_LOC_VALUE_ADDRESS &&
+            op->lpo_op != LPO_PIECE && op->lpo_op != LPO_NOP) {
+            /*  DW_OP_reg*, DW_OP_stack_value and
+                DW_OP_implicit_value end a location. */
+            EVAL_ERROR(DW_DLE_LOC_EVAL_BAD_PIECE);
+        }
+        switch (op->lpo_op) {
+        case LPO_NOP:
+            break;
+        case LPO_CONST:
+            PUSH(op->lpo_number);
+            break;
+        case LPO_REG:
+            loc_kind = DW_LOC_VALUE_REGISTER;
+            loc_op = op;
+            break;
+        case LPO_BREG:
+            PROVIDER_CALL(lep_read_register,
+                (user_data, op->lpo_reg, &v));
+            PUSH(v + op->lpo_number);
+            break;
+        case LPO_FBREG:
+            PROVIDER_CALL(lep_frame_base, (user_data, &v));
+            PUSH(v + op->lpo_number);
+            break;
+        case LPO_CFA:
+            PROVIDER_CALL(lep_call_frame_cfa, (user_data, &v));
+            PUSH(v + op->lpo_number);
+            break;
+        case LPO_PLUS_CONST:
+            NEED(1);
+            stack[sp - 1] = (stack[sp - 1] + op->lpo_number) &
+                prog->lp_address_mask;
+            break;
+        case LPO_DUP:
+            NEED(1);
+            PUSH(stack[sp - 1]);
+            break;
+        case LPO_DROP:
+            NEED(1);
+            sp--;
+            break;
+        case LPO_OVER:
+            NEED(2);
+            PUSH(stack[sp - 2]);
+            break;
+        case LPO_PICK:
+            if (op->lpo_number >= (Dwarf_Unsigned)sp) {
+                EVAL_ERROR(DW_DLE_LOC_EVAL_STACK_UNDERFLOW);
+            }
+            PUSH(stack[sp - 1 - op->lpo_number]);
+            break;
+        case LPO_SWAP:
+            NEED(2);
+            a = stack[sp - 1];
+            stack[sp - 1] = stack[sp - 2];
+            stack[sp - 2] = a;
+            break;
+        case LPO_ROT:
+            /*  The top moves to third, the others up one. */
+            NEED(3);
+            a = stack[sp - 1];
+            stack[sp - 1] = stack[sp - 2];
+            stack[sp - 2] = stack[sp - 3];
+            stack[sp - 3] = a;
+            break;
+        case LPO_DEREF:
+            NEED(1);
+            PROVIDER_CALL(lep_read_memory,
+                (user_data, stack[sp - 1], op->lpo_size, &v));
+            stack[sp - 1] = v & prog->lp_address_mask;
+            break;
+        case LPO_ABS:
+        case LPO_NEG:
+        case LPO_NOT:
+            NEED(1);
+            stack[sp - 1] = apply_unary_op(op->lpo_op, stack[sp - 1],
+                prog->lp_address_mask);
+            break;
+        case LPO_DIV:
+        case LPO_MOD:
+            NEED(2);
+            if (stack[sp - 1] == 0) {
+                EVAL_ERROR(DW_DLE_LOC_EVAL_DIV_BY_ZERO);
+            }
+            /* FALLTHRU */
+        case LPO_AND:
+        case LPO_MINUS:
+        case LPO_MUL:
+        case LPO_OR:
+        case LPO_PLUS:
+        case LPO_SHL:
+        case LPO_SHR:
+        case LPO_SHRA:
+        case LPO_XOR:
+        case LPO_EQ:
+        case LPO_GE:
+        case LPO_GT:
+        case LPO_LE:
+        case LPO_LT:
+        case LPO_NE:
+            NEED(2);
+            b = stack[--sp];
+            stack[sp - 1] = apply_binary_op(op->lpo_op,
+                stack[sp - 1], b, prog->lp_address_mask);
+            break;
+        case LPO_SKIP:
+            pc = op->lpo_number;
+            break;
+        case LPO_BRA:
+            NEED(1);
+            if (stack[--sp] != 0) {
+                pc = op->lpo_number;
+            }
+            break;
+        case LPO_TLS:
+            NEED(1);
+            PROVIDER_CALL(lep_tls_address,
+                (user_data, stack[sp - 1], &v));
+            stack[sp - 1] = v & prog->lp_address_mask;
+            break;
+        case LPO_STACK_VALUE:
+            NEED(1);
+            loc_kind = DW_LOC_VALUE_VALUE;
+            break;
+        case LPO_IMPLICIT_VALUE:
+            loc_kind = DW_LOC_VALUE_IMPLICIT;
+            loc_op = op;
+            break;
+        case LPO_PIECE:
+            if (pieces >= prog->lp_piece_count) {
+                /*  Only a backward branch gets here. */
+                EVAL_ERROR(DW_DLE_LOC_EVAL_BAD_PIECE);
+            }
+            memset(values + pieces, 0, sizeof(*values));
+            take_loc_value(loc_kind, loc_op, stack, &sp,
+                values + pieces);
+            values[pieces].dlv_piece_bits = op->lpo_number;
+            values[pieces].dlv_piece_bit_offset = op->lpo_number2;
+            pieces++;
+            loc_kind = DW_LOC_VALUE_ADDRESS;
+            break;
+        default:
+            break;
+        }
+    }
+    if (pieces) {
+        *value_count = pieces;
+    } else {
+        take_loc_value(loc_kind, loc_op, stack, &sp, values);
+    }
+    return DW_DLV_OK;
+}
+
+void
+dwarf_loc_program_dealloc(Dwarf_Loc_Program prog)
+{
+    free(prog);
+}
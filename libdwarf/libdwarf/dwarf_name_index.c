@@ -0,0 +1,1626 @@
+/*
+
+  Copyright (C) 2026 The udb contributors. All Rights Reserved.
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of version 2.1 of the GNU Lesser General Public License
+  as published by the Free Software Foundation.
+
+  This program is distributed in the hope that it would be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  Further, this software is distributed without any warranty that it is
+  free of the rightful claim of any third person regarding infringement
+  or the like.  Any license provided herein, whether implied or
+  otherwise, applies only to this software file.  Patent licenses, if
+  any, provided herein do not apply to combinations of this program with
+  other software, or any other product whatsoever.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program; if not, write the Free Software
+  Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston MA 02110-1301,
+  USA.
+
+*/
+
+/*  dwarf_lookup_name() and the index behind it: fully
+    qualified names ("ns::Foo::bar") of the DIEs in
+    .debug_info, hashed to their DIE offsets.
+
+    A .debug_names or .gdb_index section, when present and
+    wanted, only decides which CUs to read for a name. The
+    names themselves always come from the DIEs, so a lookup
+    returns the same offsets whichever way the CU was found. */
+
+#include "config.h"
+#include "dwarf_incl.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "dwarf_gdbindex.h"
+#include "dwarf_name_index.h"
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#define NAME_INDEX_MIN_BUCKETS 1024
+#define NAME_INDEX_MIN_ENTRIES 1024
+#define NAME_BLOCK_SIZE        65536
+
+/*  The name given an unnamed DW_TAG_namespace, as
+    gdb and the demanglers spell it. */
+#define ANONYMOUS_NAMESPACE_NAME "(anonymous namespace)"
+
+/*  64 bit FNV-1a. */
+static Dwarf_Unsigned
+name_hash(const char *name)
+{
+    Dwarf_Unsigned h = 0xcbf29ce484222325ULL;
+    const unsigned char *p = (const unsigned char *)name;
+
+    for ( ; *p; ++p) {
+        h ^= *p;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+/*  Doubles the bucket array and rechains every group. */
+static int
+grow_buckets(struct Dwarf_Name_Index_s *ni)
+{
+    Dwarf_Unsigned count = ni->ni_bucket_count ?
+        ni->ni_bucket_count * 2 : NAME_INDEX_MIN_BUCKETS;
+    Dwarf_Unsigned *buckets = 0;
+    Dwarf_Unsigned i = 0;
+
+    buckets = (Dwarf_Unsigned *)calloc(count, sizeof(Dwarf_Unsigned));
+    if (!buckets) {
+        return DW_DLV_ERROR;
+    }
+    for (i = 0; i < ni->ni_group_count; ++i) {
+        struct Dwarf_Name_Group_s *g = ni->ni_groups + i;
+        Dwarf_Unsigned b = g->ng_hash & (count - 1);
+
+        g->ng_next = buckets[b];
+        buckets[b] = i + 1;
+    }
+    free(ni->ni_buckets);
+    ni->ni_buckets = buckets;
+    ni->ni_bucket_count = count;
+    return DW_DLV_OK;
+}
+
+/*  Returns the group of name, or NULL if there is none. */
+static struct Dwarf_Name_Group_s *
+find_group(struct Dwarf_Name_Index_s *ni, const char *name,
+    Dwarf_Unsigned hash)
+{
+    Dwarf_Unsigned next = 0;
+
+    if (!ni->ni_bucket_count) {
+        return 0;
+    }
+    next = ni->ni_buckets[hash & (ni->ni_bucket_count - 1)];
+    while (next) {
+        struct Dwarf_Name_Group_s *g = ni->ni_groups + next - 1;
+
+        if (g->ng_hash == hash && !strcmp(g->ng_name, name)) {
+            return g;
+        }
+        next = g->ng_next;
+    }
+    return 0;
+}
+
+/*  Returns the index of the group of name, adding
+    one if need be. */
+static int
+add_group(Dwarf_Debug dbg, struct Dwarf_Name_Index_s *ni,
+    const char *name, Dwarf_Unsigned *group_out, Dwarf_Error *error)
+{
+    Dwarf_Unsigned hash = name_hash(name);
+    struct Dwarf_Name_Group_s *g = find_group(ni, name, hash);
+    Dwarf_Unsigned b = 0;
+
+    if (g) {
+        *group_out = g - ni->ni_groups;
+        return DW_DLV_OK;
+    }
+    if (ni->ni_group_count == ni->ni_group_space) {
+        Dwarf_Unsigned space = ni->ni_group_space ?
+            ni->ni_group_space * 2 : NAME_INDEX_MIN_ENTRIES;
+        struct Dwarf_Name_Group_s *groups =
+            (struct Dwarf_Name_Group_s *)realloc(ni->ni_groups,
+            space * sizeof(struct Dwarf_Name_Group_s));
+
+        if (!groups) {
+            _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+            return DW_DLV_ERROR;
+        }
+        ni->ni_groups = groups;
+        ni->ni_group_space = space;
+    }
+    if (ni->ni_group_count >= ni->ni_bucket_count) {
+        if (grow_buckets(ni) != DW_DLV_OK) {
+            _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+            return DW_DLV_ERROR;
+        }
+    }
+    g = ni->ni_groups + ni->ni_group_count;
+    memset(g, 0, sizeof(*g));
+    g->ng_name = name;
+    g->ng_hash = hash;
+    g->ng_sorted = TRUE;
+    b = hash & (ni->ni_bucket_count - 1);
+    g->ng_next = ni->ni_buckets[b];
+    *group_out = ni->ni_group_count;
+    ni->ni_group_count++;
+    ni->ni_buckets[b] = ni->ni_group_count;
+    return DW_DLV_OK;
+}
+
+/*  Entry order in a group: definitions first, then
+    by offset. */
+static int
+entry_before(struct Dwarf_Name_Entry_s *a, struct Dwarf_Name_Entry_s *b)
+{
+    if (a->ne_declaration != b->ne_declaration) {
+        return a->ne_declaration < b->ne_declaration;
+    }
+    return a->ne_die_offset < b->ne_die_offset;
+}
+
+/*  Appends an entry for the DIE at die_offset to
+    group. */
+static int
+add_entry(Dwarf_Debug dbg, struct Dwarf_Name_Index_s *ni,
+    Dwarf_Unsigned group, Dwarf_Off die_offset,
+    Dwarf_Bool declaration, Dwarf_Error *error)
+{
+    struct Dwarf_Name_Group_s *g = 0;
+    struct Dwarf_Name_Entry_s *e = 0;
+
+    if (ni->ni_entry_count == ni->ni_entry_space) {
+        Dwarf_Unsigned space = ni->ni_entry_space ?
+            ni->ni_entry_space * 2 : NAME_INDEX_MIN_ENTRIES;
+        struct Dwarf_Name_Entry_s *entries =
+            (struct Dwarf_Name_Entry_s *)realloc(ni->ni_entries,
+            space * sizeof(struct Dwarf_Name_Entry_s));
+
+        if (!entries) {
+            _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+            return DW_DLV_ERROR;
+        }
+        ni->ni_entries = entries;
+        ni->ni_entry_space = space;
+    }
+    g = ni->ni_groups + group;
+    e = ni->ni_entries + ni->ni_entry_count;
+    e->ne_die_offset = die_offset;
+    e->ne_group = group;
+    e->ne_same = 0;
+    e->ne_declaration = declaration ? 1 : 0;
+    ni->ni_entry_count++;
+    if (g->ng_last) {
+        struct Dwarf_Name_Entry_s *last = ni->ni_entries +
+            g->ng_last - 1;
+
+        /*  Entries mostly come in order, as CUs are
+            usually read in order. */
+        if (entry_before(e, last)) {
+            g->ng_sorted = FALSE;
+        }
+        last->ne_same = ni->ni_entry_count;
+    } else {
+        g->ng_first = ni->ni_entry_count;
+    }
+    g->ng_last = ni->ni_entry_count;
+    g->ng_count++;
+    return DW_DLV_OK;
+}
+
+static int
+entry_compare(const void *l, const void *r)
+{
+    const struct Dwarf_Name_Entry_s *a =
+        *(const struct Dwarf_Name_Entry_s * const *)l;
+    const struct Dwarf_Name_Entry_s *b =
+        *(const struct Dwarf_Name_Entry_s * const *)r;
+
+    if (a->ne_declaration != b->ne_declaration) {
+        return a->ne_declaration < b->ne_declaration ? -1 : 1;
+    }
+    if (a->ne_die_offset != b->ne_die_offset) {
+        return a->ne_die_offset < b->ne_die_offset ? -1 : 1;
+    }
+    return 0;
+}
+
+/*  Puts the entry list of g in entry_before() order. */
+static int
+sort_group(Dwarf_Debug dbg, struct Dwarf_Name_Index_s *ni,
+    struct Dwarf_Name_Group_s *g, Dwarf_Error *error)
+{
+    struct Dwarf_Name_Entry_s **list = 0;
+    Dwarf_Unsigned next = g->ng_first;
+    Dwarf_Unsigned i = 0;
+
+    list = (struct Dwarf_Name_Entry_s **)malloc(g->ng_count *
+        sizeof(struct Dwarf_Name_Entry_s *));
+    if (!list) {
+        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+        return DW_DLV_ERROR;
+    }
+    for (i = 0; i < g->ng_count; ++i) {
+        list[i] = ni->ni_entries + next - 1;
+        next = list[i]->ne_same;
+    }
+    qsort(list, g->ng_count, sizeof(struct Dwarf_Name_Entry_s *),
+        entry_compare);
+    g->ng_first = (list[0] - ni->ni_entries) + 1;
+    for (i = 0; i + 1 < g->ng_count; ++i) {
+        list[i]->ne_same = (list[i + 1] - ni->ni_entries) + 1;
+    }
+    list[i]->ne_same = 0;
+    g->ng_last = (list[i] - ni->ni_entries) + 1;
+    g->ng_sorted = TRUE;
+    free(list);
+    return DW_DLV_OK;
+}
+
+/*  Returns "prefix::name" in ni_blocks space,
+    or NULL if out of memory. */
+static const char *
+qualify_name(struct Dwarf_Name_Index_s *ni,
+    const char *prefix, const char *name)
+{
+    size_t plen = strlen(prefix);
+    size_t nlen = strlen(name);
+    size_t len = plen + 2 + nlen + 1;
+    char *out = 0;
+
+    if (len > ni->ni_block_left) {
+        size_t size = len > NAME_BLOCK_SIZE ? len : NAME_BLOCK_SIZE;
+        struct Dwarf_Name_Block_s *block =
+            (struct Dwarf_Name_Block_s *)malloc(
+            sizeof(struct Dwarf_Name_Block_s) + size);
+
+        if (!block) {
+            return 0;
+        }
+        block->nb_next = ni->ni_blocks;
+        ni->ni_blocks = block;
+        ni->ni_block_next = (char *)(block + 1);
+        ni->ni_block_left = size;
+    }
+    out = ni->ni_block_next;
+    memcpy(out, prefix, plen);
+    out[plen] = ':';
+    out[plen + 1] = ':';
+    memcpy(out + plen + 2, name, nlen + 1);
+    ni->ni_block_next += len;
+    ni->ni_block_left -= len;
+    return out;
+}
+
+/*  Gives back the space of name, the last string
+    qualify_name() returned. */
+static void
+release_last_name(struct Dwarf_Name_Index_s *ni, const char *name)
+{
+    size_t len = strlen(name) + 1;
+
+    ni->ni_block_next -= len;
+    ni->ni_block_left += len;
+}
+
+/*  The tags whose DIEs are given a name in the index.
+    DW_TAG_member is also indexed, but only for the
+    declarations of static data members. */
+static int
+is_indexed_tag(Dwarf_Half tag)
+{
+    switch (tag) {
+    case DW_TAG_base_type:
+    case DW_TAG_class_type:
+    case DW_TAG_structure_type:
+    case DW_TAG_union_type:
+    case DW_TAG_enumeration_type:
+    case DW_TAG_interface_type:
+    case DW_TAG_typedef:
+    case DW_TAG_subprogram:
+    case DW_TAG_variable:
+    case DW_TAG_constant:
+    case DW_TAG_namespace:
+    case DW_TAG_enumerator:
+    case DW_TAG_unspecified_type:
+    case DW_TAG_member:
+        return TRUE;
+    default:
+        break;
+    }
+    return FALSE;
+}
+
+/*  The tags whose names qualify the names of their
+    children. */
+static int
+is_scope_tag(Dwarf_Half tag)
+{
+    switch (tag) {
+    case DW_TAG_namespace:
+    case DW_TAG_class_type:
+    case DW_TAG_structure_type:
+    case DW_TAG_union_type:
+    case DW_TAG_interface_type:
+        return TRUE;
+    default:
+        break;
+    }
+    return FALSE;
+}
+
+/*  The tags that may complete an earlier declaration
+    through DW_AT_specification. */
+static int
+has_specification_tag(Dwarf_Half tag)
+{
+    switch (tag) {
+    case DW_TAG_subprogram:
+    case DW_TAG_variable:
+    case DW_TAG_class_type:
+    case DW_TAG_structure_type:
+    case DW_TAG_union_type:
+        return TRUE;
+    default:
+        break;
+    }
+    return FALSE;
+}
+
+/*  An out-of-line definition (DW_AT_specification) is
+    named like the declaration it completes, so is put
+    in its group. The declaration is earlier in the same
+    CU, and the entries of a CU are added in DIE order so
+    are sorted by offset from cu_first_entry on. */
+static int
+specification_group(Dwarf_Debug dbg,
+    struct Dwarf_Name_Index_s *ni,
+    Dwarf_Die die,
+    Dwarf_Unsigned cu_first_entry,
+    Dwarf_Unsigned *group_out,
+    Dwarf_Error *error)
+{
+    Dwarf_Attribute attr = 0;
+    Dwarf_Off spec_offset = 0;
+    Dwarf_Unsigned low = cu_first_entry;
+    Dwarf_Unsigned high = ni->ni_entry_count;
+    int res = 0;
+
+    res = dwarf_attr(die, DW_AT_specification, &attr, error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    res = dwarf_global_formref(attr, &spec_offset, error);
+    dwarf_dealloc(dbg, attr, DW_DLA_ATTR);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    while (low < high) {
+        Dwarf_Unsigned mid = low + (high - low) / 2;
+        struct Dwarf_Name_Entry_s *e = ni->ni_entries + mid;
+
+        if (e->ne_die_offset == spec_offset) {
+            *group_out = e->ne_group;
+            return DW_DLV_OK;
+        }
+        if (e->ne_die_offset < spec_offset) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return DW_DLV_NO_ENTRY;
+}
+
+static int index_dies(Dwarf_Debug dbg,
+    struct Dwarf_Name_Index_s *ni,
+    Dwarf_Die die,
+    const char *prefix,
+    Dwarf_Unsigned cu_first_entry,
+    Dwarf_Error *error);
+
+/*  Indexes the children of die, if any. */
+static int
+index_children(Dwarf_Debug dbg,
+    struct Dwarf_Name_Index_s *ni,
+    Dwarf_Die die,
+    const char *prefix,
+    Dwarf_Unsigned cu_first_entry,
+    Dwarf_Error *error)
+{
+    Dwarf_Die child = 0;
+    int res = dwarf_child(die, &child, error);
+
+    if (res != DW_DLV_OK) {
+        return res == DW_DLV_NO_ENTRY ? DW_DLV_OK : res;
+    }
+    return index_dies(dbg, ni, child, prefix, cu_first_entry, error);
+}
+
+/*  Adds the name of die, if it has one, then the names
+    of its children if die is a scope or an enumeration.
+    prefix is NULL at CU level. */
+static int
+index_die(Dwarf_Debug dbg,
+    struct Dwarf_Name_Index_s *ni,
+    Dwarf_Die die,
+    Dwarf_Half tag,
+    const char *prefix,
+    Dwarf_Unsigned cu_first_entry,
+    Dwarf_Error *error)
+{
+    char *name = 0;
+    const char *qualified = 0;
+    const char *child_prefix = 0;
+    Dwarf_Bool declaration = FALSE;
+    Dwarf_Off die_offset = 0;
+    Dwarf_Unsigned group = 0;
+    int have_group = FALSE;
+    int res = 0;
+
+    if (tag == DW_TAG_member) {
+        /*  Only a static data member is a declaration. */
+        res = dwarf_hasattr(die, DW_AT_declaration, &declaration,
+            error);
+        if (res != DW_DLV_OK || !declaration) {
+            return res;
+        }
+    }
+    res = dwarf_diename(die, &name, error);
+    if (res == DW_DLV_ERROR) {
+        return res;
+    }
+    if (has_specification_tag(tag)) {
+        res = specification_group(dbg, ni, die, cu_first_entry,
+            &group, error);
+        if (res == DW_DLV_ERROR) {
+            return res;
+        }
+        have_group = res == DW_DLV_OK;
+    }
+    if (!have_group) {
+        if (!name) {
+            if (tag == DW_TAG_enumeration_type) {
+                /*  The enumerators of an unnamed enumeration
+                    are still named in the enclosing scope. */
+                return index_children(dbg, ni, die, prefix,
+                    cu_first_entry, error);
+            }
+            if (tag != DW_TAG_namespace) {
+                return DW_DLV_OK;
+            }
+            name = ANONYMOUS_NAMESPACE_NAME;
+        }
+        qualified = name;
+        if (prefix) {
+            qualified = qualify_name(ni, prefix, name);
+            if (!qualified) {
+                _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+                return DW_DLV_ERROR;
+            }
+        }
+        res = add_group(dbg, ni, qualified, &group, error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        if (qualified != name &&
+            ni->ni_groups[group].ng_name != qualified) {
+            /*  Seen before, so the copy is not needed. */
+            release_last_name(ni, qualified);
+        }
+    }
+    qualified = ni->ni_groups[group].ng_name;
+    if (!declaration) {
+        res = dwarf_hasattr(die, DW_AT_declaration, &declaration,
+            error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+    }
+    res = dwarf_dieoffset(die, &die_offset, error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    res = add_entry(dbg, ni, group, die_offset, declaration, error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    if (tag == DW_TAG_enumeration_type) {
+        Dwarf_Bool enum_class = FALSE;
+
+        /*  Only the enumerators of an enum class are
+            scoped by the enumeration. */
+        res = dwarf_hasattr(die, DW_AT_enum_class, &enum_class, error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        child_prefix = enum_class ? qualified : prefix;
+    } else if (is_scope_tag(tag)) {
+        child_prefix = qualified;
+    } else {
+        return DW_DLV_OK;
+    }
+    return index_children(dbg, ni, die, child_prefix, cu_first_entry,
+        error);
+}
+
+/*  Indexes die and its siblings, deallocating each. */
+static int
+index_dies(Dwarf_Debug dbg,
+    struct Dwarf_Name_Index_s *ni,
+    Dwarf_Die die,
+    const char *prefix,
+    Dwarf_Unsigned cu_first_entry,
+    Dwarf_Error *error)
+{
+    for (;;) {
+        Dwarf_Die sibling = 0;
+        Dwarf_Half tag = 0;
+        int res = 0;
+
+        res = dwarf_tag(die, &tag, error);
+        if (res == DW_DLV_OK && is_indexed_tag(tag)) {
+            res = index_die(dbg, ni, die, tag, prefix, cu_first_entry,
+                error);
+        }
+        if (res == DW_DLV_ERROR) {
+            dwarf_dealloc(dbg, die, DW_DLA_DIE);
+            return res;
+        }
+        res = dwarf_siblingof_b(dbg, die, TRUE, &sibling, error);
+        dwarf_dealloc(dbg, die, DW_DLA_DIE);
+        if (res != DW_DLV_OK) {
+            return res == DW_DLV_NO_ENTRY ? DW_DLV_OK : res;
+        }
+        die = sibling;
+    }
+}
+
+/*  Records cu_offset in the sorted ni_cus_read.
+    Returns DW_DLV_NO_ENTRY if it was already there. */
+static int
+mark_cu_read(Dwarf_Debug dbg, struct Dwarf_Name_Index_s *ni,
+    Dwarf_Off cu_offset, Dwarf_Error *error)
+{
+    Dwarf_Unsigned low = 0;
+    Dwarf_Unsigned high = ni->ni_cus_read_count;
+
+    while (low < high) {
+        Dwarf_Unsigned mid = low + (high - low) / 2;
+
+        if (ni->ni_cus_read[mid] == cu_offset) {
+            return DW_DLV_NO_ENTRY;
+        }
+        if (ni->ni_cus_read[mid] < cu_offset) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (ni->ni_cus_read_count == ni->ni_cus_read_space) {
+        Dwarf_Unsigned space = ni->ni_cus_read_space ?
+            ni->ni_cus_read_space * 2 : 64;
+        Dwarf_Off *cus = (Dwarf_Off *)realloc(ni->ni_cus_read,
+            space * sizeof(Dwarf_Off));
+
+        if (!cus) {
+            _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+            return DW_DLV_ERROR;
+        }
+        ni->ni_cus_read = cus;
+        ni->ni_cus_read_space = space;
+    }
+    memmove(ni->ni_cus_read + low + 1, ni->ni_cus_read + low,
+        (ni->ni_cus_read_count - low) * sizeof(Dwarf_Off));
+    ni->ni_cus_read[low] = cu_offset;
+    ni->ni_cus_read_count++;
+    return DW_DLV_OK;
+}
+
+/*  Adds the names of the CU whose header is at cu_offset
+    in .debug_info, unless done already. A CU that cannot
+    be read is reported as a harmless error and is not
+    tried again. Sets *next_cu_offset, if not NULL, to the
+    offset of the following CU header, or to zero if that
+    is not known. */
+static int
+read_cu(Dwarf_Debug dbg, struct Dwarf_Name_Index_s *ni,
+    Dwarf_Off cu_offset, Dwarf_Off *next_cu_offset,
+    Dwarf_Error *error)
+{
+    Dwarf_Unsigned info_size = dbg->de_debug_info.dss_size;
+    Dwarf_Off cu_die_offset = 0;
+    Dwarf_CU_Context context = 0;
+    Dwarf_Die cu_die = 0;
+    Dwarf_Die child = 0;
+    Dwarf_Error err = 0;
+    int already_read = FALSE;
+    int res = 0;
+
+    if (next_cu_offset) {
+        *next_cu_offset = 0;
+    }
+    if (cu_offset + _dwarf_length_of_cu_header_simple(dbg, TRUE) >=
+        info_size) {
+        return DW_DLV_NO_ENTRY;
+    }
+    res = mark_cu_read(dbg, ni, cu_offset, error);
+    if (res == DW_DLV_ERROR) {
+        return res;
+    }
+    already_read = res == DW_DLV_NO_ENTRY;
+    if (already_read && !next_cu_offset) {
+        return DW_DLV_OK;
+    }
+    cu_die_offset = cu_offset +
+        _dwarf_length_of_cu_header(dbg, cu_offset, TRUE);
+    res = dwarf_offdie_b(dbg, cu_die_offset, TRUE, &cu_die, &err);
+    if (res == DW_DLV_OK) {
+        context = cu_die->di_cu_context;
+        if (!already_read) {
+            res = dwarf_child(cu_die, &child, &err);
+            if (res == DW_DLV_OK) {
+                res = index_dies(dbg, ni, child, 0,
+                    ni->ni_entry_count, &err);
+            }
+        }
+        dwarf_dealloc(dbg, cu_die, DW_DLA_DIE);
+    }
+    if (res == DW_DLV_ERROR) {
+        char buf[200];
+        Dwarf_Unsigned errnum = dwarf_errno(err);
+
+        dwarf_dealloc(dbg, err, DW_DLA_ERROR);
+        if (errnum == DW_DLE_ALLOC_FAIL) {
+            _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+            return DW_DLV_ERROR;
+        }
+        snprintf(buf, sizeof(buf),
+            "DW_DLE_ERROR %" DW_PR_DUu " reading the names"
+            " of the CU at offset 0x%" DW_PR_XZEROS DW_PR_DUx
+            " in .debug_info", errnum, cu_offset);
+        dwarf_insert_harmless_error(dbg, buf);
+    }
+    if (context && next_cu_offset) {
+        *next_cu_offset = context->cc_debug_offset +
+            context->cc_length + context->cc_length_size +
+            context->cc_extension_size;
+    }
+    return DW_DLV_OK;
+}
+
+static int
+read_all_cus(Dwarf_Debug dbg, struct Dwarf_Name_Index_s *ni,
+    Dwarf_Error *error)
+{
+    Dwarf_Off cu_offset = 0;
+
+    for (;;) {
+        Dwarf_Off next_cu_offset = 0;
+        int res = read_cu(dbg, ni, cu_offset, &next_cu_offset, error);
+
+        if (res == DW_DLV_ERROR) {
+            return res;
+        }
+        if (res == DW_DLV_NO_ENTRY || next_cu_offset <= cu_offset) {
+            break;
+        }
+        cu_offset = next_cu_offset;
+    }
+    return DW_DLV_OK;
+}
+
+/*  Returns the slot of ni_done_names holding name,
+    or else the empty slot where it would go. */
+static Dwarf_Unsigned
+find_done_slot(const char **names, Dwarf_Unsigned size,
+    const char *name)
+{
+    Dwarf_Unsigned slot = name_hash(name) & (size - 1);
+
+    while (names[slot] && strcmp(names[slot], name)) {
+        slot = (slot + 1) & (size - 1);
+    }
+    return slot;
+}
+
+static int
+is_done_name(struct Dwarf_Name_Index_s *ni, const char *name)
+{
+    if (!ni->ni_done_count) {
+        return FALSE;
+    }
+    return ni->ni_done_names[find_done_slot(ni->ni_done_names,
+        ni->ni_done_size, name)] != 0;
+}
+
+/*  Records that every CU the accelerator lists for name
+    has been read. name must stay valid (it points into
+    the accelerator section or .debug_str). */
+static int
+add_done_name(Dwarf_Debug dbg, struct Dwarf_Name_Index_s *ni,
+    const char *name, Dwarf_Error *error)
+{
+    Dwarf_Unsigned slot = 0;
+
+    if ((ni->ni_done_count + 1) * 2 > ni->ni_done_size) {
+        Dwarf_Unsigned size = ni->ni_done_size ?
+            ni->ni_done_size * 2 : NAME_INDEX_MIN_BUCKETS;
+        const char **names = (const char **)calloc(size,
+            sizeof(const char *));
+        Dwarf_Unsigned i = 0;
+
+        if (!names) {
+            _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+            return DW_DLV_ERROR;
+        }
+        for (i = 0; i < ni->ni_done_size; ++i) {
+            const char *old = ni->ni_done_names[i];
+
+            if (old) {
+                names[find_done_slot(names, size, old)] = old;
+            }
+        }
+        free(ni->ni_done_names);
+        ni->ni_done_names = names;
+        ni->ni_done_size = size;
+    }
+    slot = find_done_slot(ni->ni_done_names, ni->ni_done_size, name);
+    if (!ni->ni_done_names[slot]) {
+        ni->ni_done_names[slot] = name;
+        ni->ni_done_count++;
+    }
+    return DW_DLV_OK;
+}
+
+/*  Reports err, which ended the use of an accelerator,
+    as a harmless error. An allocation failure is
+    returned instead. */
+static int
+accelerator_failed(Dwarf_Debug dbg, Dwarf_Error err,
+    const char *section_name, Dwarf_Error *error)
+{
+    char buf[200];
+    Dwarf_Unsigned errnum = dwarf_errno(err);
+
+    dwarf_dealloc(dbg, err, DW_DLA_ERROR);
+    if (errnum == DW_DLE_ALLOC_FAIL) {
+        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+        return DW_DLV_ERROR;
+    }
+    snprintf(buf, sizeof(buf),
+        "DW_DLE_ERROR %" DW_PR_DUu " reading %s, names are"
+        " read from .debug_info instead", errnum, section_name);
+    dwarf_insert_harmless_error(dbg, buf);
+    return DW_DLV_OK;
+}
+
+/*  The hash of .gdb_index symbols (gdb's
+    mapped_index_string_hash). Version 5 and later
+    fold ASCII case. */
+static Dwarf_Unsigned
+gdbindex_hash(Dwarf_Unsigned version, const char *name)
+{
+    Dwarf_Unsigned r = 0;
+    const unsigned char *p = (const unsigned char *)name;
+
+    for ( ; *p; ++p) {
+        unsigned c = *p;
+
+        if (version >= 5 && c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+        }
+        r = (r * 67 + c - 113) & 0xffffffff;
+    }
+    return r;
+}
+
+/*  Reads the CUs the .gdb_index symbol table lists for
+    name. Returns DW_DLV_NO_ENTRY if name is not there. */
+static int
+gdbindex_read_cus(Dwarf_Debug dbg, struct Dwarf_Name_Index_s *ni,
+    const char *name, Dwarf_Error *error)
+{
+    Dwarf_Gdbindex gi = ni->ni_gdbindex;
+    Dwarf_Small *section_end = gi->gi_section_data +
+        gi->gi_section_length;
+    Dwarf_Unsigned name_len = strlen(name) + 1;
+    Dwarf_Unsigned size = 0;
+    Dwarf_Unsigned hash = 0;
+    Dwarf_Unsigned slot = 0;
+    Dwarf_Unsigned step = 0;
+    Dwarf_Unsigned probe = 0;
+    Dwarf_Unsigned cuvec = 0;
+    Dwarf_Unsigned cu_count = 0;
+    Dwarf_Unsigned count = 0;
+    Dwarf_Unsigned i = 0;
+    const char *symbol = 0;
+    int found = FALSE;
+    int res = 0;
+
+    if (is_done_name(ni, name)) {
+        return DW_DLV_OK;
+    }
+    res = dwarf_gdbindex_symboltable_array(gi, &size, error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    if (!size || (size & (size - 1))) {
+        return DW_DLV_NO_ENTRY;
+    }
+    hash = gdbindex_hash(ni->ni_gdbindex_version, name);
+    slot = hash & (size - 1);
+    step = ((hash * 17) & (size - 1)) | 1;
+    for (probe = 0; probe < size; ++probe) {
+        Dwarf_Unsigned string_offset = 0;
+
+        res = dwarf_gdbindex_symboltable_entry(gi, slot,
+            &string_offset, &cuvec, error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        if (!string_offset && !cuvec) {
+            break;
+        }
+        res = dwarf_gdbindex_string_by_offset(gi, string_offset,
+            &symbol, error);
+        if (res == DW_DLV_ERROR) {
+            return res;
+        }
+        if (res == DW_DLV_OK &&
+            (Dwarf_Unsigned)(section_end -
+                (Dwarf_Small *)symbol) >= name_len &&
+            !memcmp(symbol, name, name_len)) {
+            found = TRUE;
+            break;
+        }
+        slot = (slot + step) & (size - 1);
+    }
+    if (!found) {
+        return DW_DLV_NO_ENTRY;
+    }
+    res = dwarf_gdbindex_culist_array(gi, &cu_count, error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    res = dwarf_gdbindex_cuvector_length(gi, cuvec, &count, error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    for (i = 0; i < count; ++i) {
+        Dwarf_Unsigned attr = 0;
+        Dwarf_Unsigned cu_index = 0;
+        Dwarf_Unsigned cu_offset = 0;
+        Dwarf_Unsigned cu_length = 0;
+
+        res = dwarf_gdbindex_cuvector_inner_attributes(gi, cuvec, i,
+            &attr, error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        cu_index = attr & 0xffffff;
+        if (cu_index >= cu_count) {
+            /*  A type unit; .debug_types is not indexed. */
+            continue;
+        }
+        res = dwarf_gdbindex_culist_entry(gi, cu_index, &cu_offset,
+            &cu_length, error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        res = read_cu(dbg, ni, cu_offset, 0, error);
+        if (res == DW_DLV_ERROR) {
+            return res;
+        }
+    }
+    return add_done_name(dbg, ni, symbol, error);
+}
+
+/*  Records the layout of each name index of .debug_names
+    in ni_tables. */
+static int
+debug_names_setup(Dwarf_Debug dbg, struct Dwarf_Name_Index_s *ni,
+    Dwarf_Error *error)
+{
+    Dwarf_Small *ptr = 0;
+    Dwarf_Small *end = 0;
+    int res = 0;
+
+    if (!dbg->de_debug_names.dss_size) {
+        return DW_DLV_NO_ENTRY;
+    }
+    res = _dwarf_load_section(dbg, &dbg->de_debug_names, error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    res = _dwarf_load_section(dbg, &dbg->de_debug_str, error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    ptr = dbg->de_debug_names.dss_data;
+    end = ptr + dbg->de_debug_names.dss_size;
+    while (ptr < end) {
+        struct Dwarf_Name_Table_s table;
+        struct Dwarf_Name_Table_s *tables = 0;
+        Dwarf_Unsigned length = 0;
+        Dwarf_Unsigned local_tu_count = 0;
+        Dwarf_Unsigned foreign_tu_count = 0;
+        Dwarf_Unsigned abbrev_size = 0;
+        Dwarf_Unsigned aug_size = 0;
+        Dwarf_Unsigned needed = 0;
+        Dwarf_Half version = 0;
+        Dwarf_Small *unit_end = 0;
+        int length_size = 0;
+        int exten_size = 0;
+        unsigned os = 0;
+
+        memset(&table, 0, sizeof(table));
+        if (end - ptr < 4 + 2 + 2 + 7 * 4) {
+            _dwarf_error(dbg, error, DW_DLE_DEBUG_NAMES_HEADER_ERROR);
+            return DW_DLV_ERROR;
+        }
+        READ_AREA_LENGTH(dbg, length, Dwarf_Unsigned, ptr,
+            length_size, exten_size);
+        /*  The unit length is all that is needed here. */
+        (void)exten_size;
+        if (length > (Dwarf_Unsigned)(end - ptr) ||
+            length < 2 + 2 + 7 * 4) {
+            _dwarf_error(dbg, error, DW_DLE_DEBUG_NAMES_HEADER_ERROR);
+            return DW_DLV_ERROR;
+        }
+        unit_end = ptr + length;
+        READ_UNALIGNED(dbg, version, Dwarf_Half, ptr, 2);
+        if (version != 5) {
+            _dwarf_error(dbg, error, DW_DLE_DEBUG_NAMES_HEADER_ERROR);
+            return DW_DLV_ERROR;
+        }
+        /* The version and two bytes of padding. */
+        ptr += 4;
+        READ_UNALIGNED(dbg, table.nt_cu_count, Dwarf_Unsigned, ptr, 4);
+        ptr += 4;
+        READ_UNALIGNED(dbg, local_tu_count, Dwarf_Unsigned, ptr, 4);
+        ptr += 4;
+        READ_UNALIGNED(dbg, foreign_tu_count, Dwarf_Unsigned, ptr, 4);
+        ptr += 4;
+        READ_UNALIGNED(dbg, table.nt_bucket_count, Dwarf_Unsigned,
+            ptr, 4);
+        ptr += 4;
+        READ_UNALIGNED(dbg, table.nt_name_count, Dwarf_Unsigned,
+            ptr, 4);
+        ptr += 4;
+        READ_UNALIGNED(dbg, abbrev_size, Dwarf_Unsigned, ptr, 4);
+        ptr += 4;
+        READ_UNALIGNED(dbg, aug_size, Dwarf_Unsigned, ptr, 4);
+        ptr += 4;
+        if (aug_size > (Dwarf_Unsigned)(unit_end - ptr)) {
+            _dwarf_error(dbg, error, DW_DLE_DEBUG_NAMES_HEADER_ERROR);
+            return DW_DLV_ERROR;
+        }
+        ptr += aug_size;
+
+        /*  Each count is at most 32 bits, so this sum
+            cannot overflow. */
+        os = length_size;
+        table.nt_offset_size = os;
+        needed = (table.nt_cu_count + local_tu_count) * os +
+            foreign_tu_count * 8 +
+            table.nt_bucket_count * 4 +
+            (table.nt_bucket_count ? table.nt_name_count * 4 : 0) +
+            table.nt_name_count * os * 2 +
+            abbrev_size;
+        if (needed > (Dwarf_Unsigned)(unit_end - ptr)) {
+            _dwarf_error(dbg, error, DW_DLE_DEBUG_NAMES_HEADER_ERROR);
+            return DW_DLV_ERROR;
+        }
+        table.nt_cu_list = ptr;
+        ptr += (table.nt_cu_count + local_tu_count) * os +
+            foreign_tu_count * 8;
+        table.nt_buckets = ptr;
+        ptr += table.nt_bucket_count * 4;
+        table.nt_hashes = ptr;
+        if (table.nt_bucket_count) {
+            ptr += table.nt_name_count * 4;
+        }
+        table.nt_string_offsets = ptr;
+        ptr += table.nt_name_count * os;
+        table.nt_entry_offsets = ptr;
+        ptr += table.nt_name_count * os;
+        table.nt_abbrevs = ptr;
+        ptr += abbrev_size;
+        table.nt_entry_pool = ptr;
+        table.nt_end = unit_end;
+
+        tables = (struct Dwarf_Name_Table_s *)realloc(ni->ni_tables,
+            (ni->ni_table_count + 1) *
+            sizeof(struct Dwarf_Name_Table_s));
+        if (!tables) {
+            _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+            return DW_DLV_ERROR;
+        }
+        ni->ni_tables = tables;
+        ni->ni_tables[ni->ni_table_count++] = table;
+        ptr = unit_end;
+    }
+    return DW_DLV_OK;
+}
+
+/*  The .debug_names hash: DJB with ASCII case folding. */
+static Dwarf_Unsigned
+debug_names_hash(const char *name)
+{
+    Dwarf_Unsigned h = 5381;
+    const unsigned char *p = (const unsigned char *)name;
+
+    for ( ; *p; ++p) {
+        unsigned c = *p;
+
+        if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+        }
+        h = (h * 33 + c) & 0xffffffff;
+    }
+    return h;
+}
+
+/*  Whether name starts with the keyword operator. */
+static int
+is_operator_name(const char *name)
+{
+    char c = 0;
+
+    if (strncmp(name, "operator", 8)) {
+        return FALSE;
+    }
+    c = name[8];
+    return !((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+        (c >= '0' && c <= '9') || c == '_');
+}
+
+/*  Returns the unqualified last component of name, the
+    part after the last "::" not inside <> or (). An
+    operator name ("operator<", "operator std::string")
+    is all one component. */
+static const char *
+simple_name(const char *name)
+{
+    const char *last = name;
+    const char *p = name;
+    int depth = 0;
+
+    for ( ; *p; ++p) {
+        if (p == last && is_operator_name(p)) {
+            break;
+        }
+        if (*p == '<' || *p == '(') {
+            ++depth;
+        } else if ((*p == '>' || *p == ')') && depth > 0) {
+            --depth;
+        } else if (!depth && p[0] == ':' && p[1] == ':') {
+            last = p + 2;
+            ++p;
+        }
+    }
+    return last;
+}
+
+/*  Reads an unsigned LEB128 number that must end
+    before end. */
+static int
+read_uleb_bounded(Dwarf_Small **pp, Dwarf_Small *end,
+    Dwarf_Unsigned *value)
+{
+    Dwarf_Small *p = *pp;
+    Dwarf_Unsigned v = 0;
+    unsigned shift = 0;
+
+    for (;;) {
+        Dwarf_Unsigned byte = 0;
+
+        if (p >= end || shift >= 64) {
+            return DW_DLV_ERROR;
+        }
+        byte = *p++;
+        v |= (byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            break;
+        }
+        shift += 7;
+    }
+    *pp = p;
+    *value = v;
+    return DW_DLV_OK;
+}
+
+/*  Reads one attribute value of a name entry. */
+static int
+read_entry_value(Dwarf_Debug dbg, Dwarf_Unsigned form,
+    Dwarf_Small **pp, Dwarf_Small *end, Dwarf_Unsigned *value)
+{
+    Dwarf_Small *p = *pp;
+    Dwarf_Unsigned size = 0;
+
+    switch (form) {
+    case DW_FORM_flag_present:
+        *value = 1;
+        return DW_DLV_OK;
+    case DW_FORM_data1:
+    case DW_FORM_ref1:
+    case DW_FORM_flag:
+        size = 1;
+        break;
+    case DW_FORM_data2:
+    case DW_FORM_ref2:
+        size = 2;
+        break;
+    case DW_FORM_data4:
+    case DW_FORM_ref4:
+        size = 4;
+        break;
+    case DW_FORM_data8:
+    case DW_FORM_ref8:
+    case DW_FORM_ref_sig8:
+        size = 8;
+        break;
+    case DW_FORM_udata:
+    case DW_FORM_ref_udata:
+        return read_uleb_bounded(pp, end, value);
+    default:
+        return DW_DLV_ERROR;
+    }
+    if (size > (Dwarf_Unsigned)(end - p)) {
+        return DW_DLV_ERROR;
+    }
+    READ_UNALIGNED(dbg, *value, Dwarf_Unsigned, p, size);
+    *pp = p + size;
+    return DW_DLV_OK;
+}
+
+/*  Finds the abbreviation code in the abbreviation table
+    of t, returning a pointer to its attribute list. */
+static int
+find_debug_names_abbrev(struct Dwarf_Name_Table_s *t,
+    Dwarf_Unsigned code, Dwarf_Small **attrs_out)
+{
+    Dwarf_Small *p = t->nt_abbrevs;
+    Dwarf_Small *end = t->nt_entry_pool;
+
+    for (;;) {
+        Dwarf_Unsigned acode = 0;
+        Dwarf_Unsigned tag = 0;
+
+        if (read_uleb_bounded(&p, end, &acode) != DW_DLV_OK ||
+            !acode) {
+            return DW_DLV_ERROR;
+        }
+        if (read_uleb_bounded(&p, end, &tag) != DW_DLV_OK) {
+            return DW_DLV_ERROR;
+        }
+        if (acode == code) {
+            *attrs_out = p;
+            return DW_DLV_OK;
+        }
+        for (;;) {
+            Dwarf_Unsigned idx = 0;
+            Dwarf_Unsigned form = 0;
+
+            if (read_uleb_bounded(&p, end, &idx) != DW_DLV_OK ||
+                read_uleb_bounded(&p, end, &form) != DW_DLV_OK) {
+                return DW_DLV_ERROR;
+            }
+            if (!idx && !form) {
+                break;
+            }
+        }
+    }
+}
+
+/*  Reads the CUs of the entries of name number
+    name_index (from zero) of t. */
+static int
+debug_names_read_entries(Dwarf_Debug dbg,
+    struct Dwarf_Name_Index_s *ni,
+    struct Dwarf_Name_Table_s *t,
+    Dwarf_Unsigned name_index,
+    Dwarf_Error *error)
+{
+    Dwarf_Unsigned entry_offset = 0;
+    Dwarf_Small *p = 0;
+    unsigned os = t->nt_offset_size;
+
+    READ_UNALIGNED(dbg, entry_offset, Dwarf_Unsigned,
+        t->nt_entry_offsets + name_index * os, os);
+    if (entry_offset >= (Dwarf_Unsigned)(t->nt_end - t->nt_entry_pool)) {
+        _dwarf_error(dbg, error, DW_DLE_DEBUG_NAMES_ENTRY_ERROR);
+        return DW_DLV_ERROR;
+    }
+    p = t->nt_entry_pool + entry_offset;
+    for (;;) {
+        Dwarf_Unsigned code = 0;
+        Dwarf_Unsigned cu_index = t->nt_cu_count == 1 ? 0 :
+            t->nt_cu_count;
+        Dwarf_Bool type_unit = FALSE;
+        Dwarf_Small *attrs = 0;
+
+        if (read_uleb_bounded(&p, t->nt_end, &code) != DW_DLV_OK) {
+            _dwarf_error(dbg, error, DW_DLE_DEBUG_NAMES_ENTRY_ERROR);
+            return DW_DLV_ERROR;
+        }
+        if (!code) {
+            break;
+        }
+        if (find_debug_names_abbrev(t, code, &attrs) != DW_DLV_OK) {
+            _dwarf_error(dbg, error, DW_DLE_DEBUG_NAMES_ENTRY_ERROR);
+            return DW_DLV_ERROR;
+        }
+        for (;;) {
+            Dwarf_Unsigned idx = 0;
+            Dwarf_Unsigned form = 0;
+            Dwarf_Unsigned value = 0;
+
+            /*  The abbreviation was read whole by
+                find_debug_names_abbrev(). */
+            DECODE_LEB128_UWORD(attrs, idx);
+            DECODE_LEB128_UWORD(attrs, form);
+            if (!idx && !form) {
+                break;
+            }
+            if (read_entry_value(dbg, form, &p, t->nt_end,
+                &value) != DW_DLV_OK) {
+                _dwarf_error(dbg, error,
+                    DW_DLE_DEBUG_NAMES_ENTRY_ERROR);
+                return DW_DLV_ERROR;
+            }
+            if (idx == DW_IDX_compile_unit) {
+                cu_index = value;
+            } else if (idx == DW_IDX_type_unit) {
+                type_unit = TRUE;
+            }
+        }
+        if (!type_unit && cu_index < t->nt_cu_count) {
+            Dwarf_Unsigned cu_offset = 0;
+            int res = 0;
+
+            READ_UNALIGNED(dbg, cu_offset, Dwarf_Unsigned,
+                t->nt_cu_list + cu_index * os, os);
+            res = read_cu(dbg, ni, cu_offset, 0, error);
+            if (res == DW_DLV_ERROR) {
+                return res;
+            }
+        }
+    }
+    return DW_DLV_OK;
+}
+
+/*  Returns name number name_index of t, in .debug_str,
+    if it is name, else NULL. */
+static const char *
+debug_names_name_matches(Dwarf_Debug dbg,
+    struct Dwarf_Name_Table_s *t,
+    Dwarf_Unsigned name_index,
+    const char *name,
+    Dwarf_Unsigned name_len)
+{
+    Dwarf_Unsigned string_offset = 0;
+    const char *str = 0;
+    unsigned os = t->nt_offset_size;
+
+    READ_UNALIGNED(dbg, string_offset, Dwarf_Unsigned,
+        t->nt_string_offsets + name_index * os, os);
+    if (string_offset >= dbg->de_debug_str.dss_size ||
+        dbg->de_debug_str.dss_size - string_offset < name_len) {
+        return 0;
+    }
+    str = (const char *)dbg->de_debug_str.dss_data + string_offset;
+    return memcmp(str, name, name_len) ? 0 : str;
+}
+
+/*  Reads the CUs .debug_names lists for the last
+    component of name. Returns DW_DLV_NO_ENTRY if no
+    name index has it. */
+static int
+debug_names_read_cus(Dwarf_Debug dbg, struct Dwarf_Name_Index_s *ni,
+    const char *name, Dwarf_Error *error)
+{
+    const char *simple = simple_name(name);
+    Dwarf_Unsigned name_len = strlen(simple) + 1;
+    Dwarf_Unsigned hash = debug_names_hash(simple);
+    Dwarf_Unsigned ti = 0;
+    const char *found = 0;
+
+    if (is_done_name(ni, simple)) {
+        return DW_DLV_OK;
+    }
+    for (ti = 0; ti < ni->ni_table_count; ++ti) {
+        struct Dwarf_Name_Table_s *t = ni->ni_tables + ti;
+        Dwarf_Unsigned first = 0;
+        Dwarf_Unsigned i = 0;
+        Dwarf_Unsigned bucket = 0;
+        const char *str = 0;
+
+        if (t->nt_bucket_count) {
+            bucket = hash % t->nt_bucket_count;
+            READ_UNALIGNED(dbg, first, Dwarf_Unsigned,
+                t->nt_buckets + bucket * 4, 4);
+            if (!first) {
+                continue;
+            }
+            /* Name indexes in buckets start at one. */
+            first--;
+        }
+        for (i = first; i < t->nt_name_count; ++i) {
+            if (t->nt_bucket_count) {
+                Dwarf_Unsigned h = 0;
+
+                READ_UNALIGNED(dbg, h, Dwarf_Unsigned,
+                    t->nt_hashes + i * 4, 4);
+                if (h % t->nt_bucket_count != bucket) {
+                    break;
+                }
+                if (h != hash) {
+                    continue;
+                }
+            }
+            str = debug_names_name_matches(dbg, t, i, simple, name_len);
+            if (str) {
+                int res = debug_names_read_entries(dbg, ni, t, i,
+                    error);
+
+                if (res != DW_DLV_OK) {
+                    return res;
+                }
+                found = str;
+            }
+        }
+    }
+    if (!found) {
+        return DW_DLV_NO_ENTRY;
+    }
+    return add_done_name(dbg, ni, found, error);
+}
+
+void
+_dwarf_name_index_destroy(Dwarf_Debug dbg)
+{
+    struct Dwarf_Name_Index_s *ni = dbg->de_name_index;
+
+    if (!ni) {
+        return;
+    }
+    while (ni->ni_blocks) {
+        struct Dwarf_Name_Block_s *next = ni->ni_blocks->nb_next;
+
+        free(ni->ni_blocks);
+        ni->ni_blocks = next;
+    }
+    free(ni->ni_entries);
+    free(ni->ni_groups);
+    free(ni->ni_buckets);
+    free(ni->ni_cus_read);
+    free(ni->ni_tables);
+    free(ni->ni_done_names);
+    dwarf_gdbindex_free(ni->ni_gdbindex);
+    free(ni);
+    dbg->de_name_index = 0;
+}
+
+/*  Creates the index dwarf_lookup_name() uses, replacing
+    any earlier one. With use_accelerators a .debug_names
+    or else a .gdb_index section is used if it can be read,
+    and CUs are read only as lookups need them. Otherwise
+    the names of every CU are read now. */
+int
+dwarf_build_name_index(Dwarf_Debug dbg,
+    Dwarf_Bool use_accelerators,
+    Dwarf_Error *error)
+{
+    struct Dwarf_Name_Index_s *ni = 0;
+    int res = 0;
+
+    if (dbg == NULL) {
+        _dwarf_error(NULL, error, DW_DLE_DBG_NULL);
+        return (DW_DLV_ERROR);
+    }
+    _dwarf_name_index_destroy(dbg);
+    res = _dwarf_load_debug_info(dbg, error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    ni = (struct Dwarf_Name_Index_s *)calloc(1,
+        sizeof(struct Dwarf_Name_Index_s));
+    if (!ni) {
+        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+        return DW_DLV_ERROR;
+    }
+    dbg->de_name_index = ni;
+    if (use_accelerators) {
+        Dwarf_Error err = 0;
+        Dwarf_Unsigned unused = 0;
+        const char *section_name = 0;
+
+        res = debug_names_setup(dbg, ni, &err);
+        if (res == DW_DLV_OK && ni->ni_table_count) {
+            ni->ni_source = DW_NAME_INDEX_DEBUG_NAMES;
+            return DW_DLV_OK;
+        }
+        free(ni->ni_tables);
+        ni->ni_tables = 0;
+        ni->ni_table_count = 0;
+        if (res == DW_DLV_ERROR &&
+            accelerator_failed(dbg, err, ".debug_names",
+            error) != DW_DLV_OK) {
+            _dwarf_name_index_destroy(dbg);
+            return DW_DLV_ERROR;
+        }
+
+        res = dwarf_gdbindex_header(dbg, &ni->ni_gdbindex,
+            &ni->ni_gdbindex_version, &unused, &unused, &unused,
+            &unused, &unused, &unused, &unused, &section_name, &err);
+        if (res == DW_DLV_OK) {
+            ni->ni_source = DW_NAME_INDEX_GDB_INDEX;
+            return DW_DLV_OK;
+        }
+        ni->ni_gdbindex = 0;
+        if (res == DW_DLV_ERROR &&
+            accelerator_failed(dbg, err, ".gdb_index",
+            error) != DW_DLV_OK) {
+            _dwarf_name_index_destroy(dbg);
+            return DW_DLV_ERROR;
+        }
+    }
+    ni->ni_source = DW_NAME_INDEX_BUILT;
+    res = read_all_cus(dbg, ni, error);
+    if (res != DW_DLV_OK) {
+        _dwarf_name_index_destroy(dbg);
+        return res;
+    }
+    return DW_DLV_OK;
+}
+
+/*  Returns the offsets of the DIEs named name:
+    definitions first, then declarations, each in
+    increasing offset order. *offsets_count is the number
+    found, which may be more than offsets_space. The
+    index is created (using accelerators) if there is
+    none yet. */
+int
+dwarf_lookup_name_b(Dwarf_Debug dbg,
+    const char *name,
+    Dwarf_Off *die_offsets,
+    Dwarf_Unsigned offsets_space,
+    Dwarf_Unsigned *offsets_count,
+    Dwarf_Error *error)
+{
+    struct Dwarf_Name_Index_s *ni = 0;
+    struct Dwarf_Name_Group_s *g = 0;
+    Dwarf_Unsigned next = 0;
+    Dwarf_Unsigned i = 0;
+    int res = DW_DLV_OK;
+
+    if (dbg == NULL) {
+        _dwarf_error(NULL, error, DW_DLE_DBG_NULL);
+        return (DW_DLV_ERROR);
+    }
+    if (!name) {
+        _dwarf_error(dbg, error, DW_DLE_STRING_PTR_NULL);
+        return DW_DLV_ERROR;
+    }
+    if (!die_offsets) {
+        offsets_space = 0;
+    }
+    if (!dbg->de_name_index) {
+        res = dwarf_build_name_index(dbg, TRUE, error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+    }
+    ni = dbg->de_name_index;
+    if (ni->ni_source != DW_NAME_INDEX_BUILT) {
+        Dwarf_Error err = 0;
+        const char *section_name = ".gdb_index";
+
+        if (ni->ni_source == DW_NAME_INDEX_GDB_INDEX) {
+            res = gdbindex_read_cus(dbg, ni, name, &err);
+        } else {
+            section_name = ".debug_names";
+            res = debug_names_read_cus(dbg, ni, name, &err);
+        }
+        if (res == DW_DLV_NO_ENTRY) {
+            return res;
+        }
+        if (res == DW_DLV_ERROR) {
+            /*  Carry on without the accelerator. */
+            res = accelerator_failed(dbg, err, section_name, error);
+            if (res != DW_DLV_OK) {
+                return res;
+            }
+            ni->ni_source = DW_NAME_INDEX_BUILT;
+            res = read_all_cus(dbg, ni, error);
+            if (res != DW_DLV_OK) {
+                return res;
+            }
+        }
+    }
+    g = find_group(ni, name, name_hash(name));
+    if (!g) {
+        return DW_DLV_NO_ENTRY;
+    }
+    if (!g->ng_sorted && offsets_space) {
+        res = sort_group(dbg, ni, g, error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+    }
+    next = g->ng_first;
+    for (i = 0; i < offsets_space && next; ++i) {
+        struct Dwarf_Name_Entry_s *e = ni->ni_entries + next - 1;
+
+        die_offsets[i] = e->ne_die_offset;
+        next = e->ne_same;
+    }
+    *offsets_count = g->ng_count;
+    return DW_DLV_OK;
+}
+
+/*  Returns the offset of the first DIE
+    dwarf_lookup_name_b() would: the definition with the
+    lowest offset if there is one. */
+int
+dwarf_lookup_name(Dwarf_Debug dbg,
+    const char *name,
+    Dwarf_Off *die_offset,
+    Dwarf_Error *error)
+{
+    Dwarf_Unsigned count = 0;
+
+    return dwarf_lookup_name_b(dbg, name, die_offset, 1, &count,
+        error);
+}
+
+/*  Says where the names of the index come from, a
+    DW_NAME_INDEX_ value, how many are indexed and from
+    how many CUs so far. Returns DW_DLV_NO_ENTRY if no
+    index has been created. */
+int
+dwarf_get_name_index_info(Dwarf_Debug dbg,
+    Dwarf_Small *source,
+    Dwarf_Unsigned *names_indexed,
+    Dwarf_Unsigned *cus_read,
+    Dwarf_Error *error)
+{
+    struct Dwarf_Name_Index_s *ni = 0;
+
+    if (dbg == NULL) {
+        _dwarf_error(NULL, error, DW_DLE_DBG_NULL);
+        return (DW_DLV_ERROR);
+    }
+    ni = dbg->de_name_index;
+    if (!ni) {
+        return DW_DLV_NO_ENTRY;
+    }
+    if (source) {
+        *source = ni->ni_source;
+    }
+    if (names_indexed) {
+        *names_indexed = ni->ni_group_count;
+    }
+    if (cus_read) {
+        *cus_read = ni->ni_cus_read_count;
+    }
+    return DW_DLV_OK;
+}
@@ -0,0 +1,129 @@
+/*
+
+  Copyright (C) 2026 The udb contributors. All Rights Reserved.
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of version 2.1 of the GNU Lesser General Public License
+  as published by the Free Software Foundation.
+
+  This program is distributed in the hope that it would be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  Further, this software is distributed without any warranty that it is
+  free of the rightful claim of any third person regarding infringement
+  or the like.  Any license provided herein, whether implied or
+  otherwise, applies only to this software file.  Patent licenses, if
+  any, provided herein do not apply to combinations of this program with
+  other software, or any other product whatsoever.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program; if not, write the Free Software
+  Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston MA 02110-1301,
+  USA.
+
+*/
+
+/*  One DIE named in .debug_info. */
+struct Dwarf_Name_Entry_s {
+    Dwarf_Off      ne_die_offset;
+    /*  Index in ni_groups of its name. */
+    Dwarf_Unsigned ne_group;
+    /*  Index plus one of the next entry with the same
+        name. Zero ends the list. */
+    Dwarf_Unsigned ne_same;
+    Dwarf_Small    ne_declaration;
+};
+
+/*  One fully qualified name ("ns::Foo::bar") and the list
+    of the entries with that name. The list is sorted,
+    definitions first then by offset, when a lookup needs
+    it to be. */
+struct Dwarf_Name_Group_s {
+    /*  Points into a string section when the name
+        is not qualified, else into ni_blocks. */
+    const char    *ng_name;
+    Dwarf_Unsigned ng_hash;
+    /*  Index plus one of the next group in the same
+        hash chain. Zero ends the chain. */
+    Dwarf_Unsigned ng_next;
+    /*  Index plus one of the first and last entries. */
+    Dwarf_Unsigned ng_first;
+    Dwarf_Unsigned ng_last;
+    Dwarf_Unsigned ng_count;
+    Dwarf_Small    ng_sorted;
+};
+
+/*  One name index (unit) of .debug_names. The pointers
+    are into the section. */
+struct Dwarf_Name_Table_s {
+    Dwarf_Half     nt_offset_size;
+    Dwarf_Unsigned nt_cu_count;
+    Dwarf_Unsigned nt_bucket_count;
+    Dwarf_Unsigned nt_name_count;
+    Dwarf_Small   *nt_cu_list;
+    Dwarf_Small   *nt_buckets;
+    Dwarf_Small   *nt_hashes;
+    Dwarf_Small   *nt_string_offsets;
+    Dwarf_Small   *nt_entry_offsets;
+    Dwarf_Small   *nt_abbrevs;
+    Dwarf_Small   *nt_entry_pool;
+    Dwarf_Small   *nt_end;
+};
+
+/*  Space for qualified names, allocated in blocks. */
+struct Dwarf_Name_Block_s {
+    struct Dwarf_Name_Block_s *nb_next;
+};
+
+/*  The index dwarf_lookup_name() searches, in the
+    Dwarf_Debug as de_name_index. All malloc space.
+
+    Names are read from .debug_info a CU at a time into
+    a chained hash table. With no accelerator every CU is
+    read when the index is created. With .debug_names or
+    .gdb_index a lookup first reads the CUs the section
+    lists for the name, so only those are ever read. */
+struct Dwarf_Name_Index_s {
+    /*  A DW_NAME_INDEX_ value. */
+    Dwarf_Small    ni_source;
+
+    /*  In DIE order within each CU. */
+    struct Dwarf_Name_Entry_s *ni_entries;
+    Dwarf_Unsigned ni_entry_count;
+    Dwarf_Unsigned ni_entry_space;
+
+    struct Dwarf_Name_Group_s *ni_groups;
+    Dwarf_Unsigned ni_group_count;
+    Dwarf_Unsigned ni_group_space;
+
+    /*  Index plus one of the first group of each chain.
+        ni_bucket_count is a power of two. */
+    Dwarf_Unsigned *ni_buckets;
+    Dwarf_Unsigned ni_bucket_count;
+
+    struct Dwarf_Name_Block_s *ni_blocks;
+    char          *ni_block_next;
+    Dwarf_Unsigned ni_block_left;
+
+    /*  Offsets in .debug_info of the CU headers read,
+        sorted. */
+    Dwarf_Off     *ni_cus_read;
+    Dwarf_Unsigned ni_cus_read_count;
+    Dwarf_Unsigned ni_cus_read_space;
+
+    /*  The accelerator names whose CUs have all been read,
+        an open addressed hash table (a power of two in
+        size) of pointers into the accelerator's strings. */
+    const char   **ni_done_names;
+    Dwarf_Unsigned ni_done_size;
+    Dwarf_Unsigned ni_done_count;
+
+    Dwarf_Gdbindex ni_gdbindex;
+    Dwarf_Unsigned ni_gdbindex_version;
+
+    struct Dwarf_Name_Table_s *ni_tables;
+    Dwarf_Unsigned ni_table_count;
+};
+
+void _dwarf_name_index_destroy(Dwarf_Debug dbg);
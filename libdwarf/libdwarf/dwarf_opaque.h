@@ -243,9 +243,9 @@ struct Dwarf_CU_Context_s {
         Set when the CU die is accessed by dwarf_siblingof(). */
     Dwarf_Unsigned cc_cu_die_global_sec_offset;
 
-    Dwarf_Byte_Ptr cc_last_abbrev_ptr;
-    Dwarf_Byte_Ptr cc_last_abbrev_endptr;
-    Dwarf_Hash_Table cc_abbrev_hash_table;
+    /*  Shared with every other CU using the same cc_abbrev_offset.
+        Found on the first abbrev lookup for this CU. */
+    Dwarf_Abbrev_Table cc_abbrev_table;
     Dwarf_CU_Context cc_next;
 
     /*unsigned char cc_offset_length; */
@@ -547,6 +547,12 @@ struct Dwarf_Debug_s {
         Null till a tree is created */
     void * de_alloc_tree;
 
+    /*  set at creation of a Dwarf_Debug from dwarf_set_alloc_mode().
+        DW_ALLOC_MODE_SLAB takes most allocations from de_alloc_slab
+        rather than malloc and de_alloc_tree. */
+    Dwarf_Small de_alloc_mode;
+    struct Dwarf_Alloc_Slab_s de_alloc_slab;
+
     /*  These fields are used to process debug_frame section.  **Updated
         by dwarf_get_fde_list in dwarf_frame.h */
     /*  Points to contiguous block of pointers to Dwarf_Cie_s structs. */
@@ -623,6 +629,23 @@ struct Dwarf_Debug_s {
     Dwarf_Xu_Index_Header  de_cu_hashindex_data;
     Dwarf_Xu_Index_Header  de_tu_hashindex_data;
 
+    /*  Created by the first dwarf_get_cu_die_offset_given_pc()
+        call. de_pc_ranges is malloc space. */
+    Dwarf_Bool de_pc_ranges_built;
+    struct Dwarf_Pc_Range_s *de_pc_ranges;
+    Dwarf_Unsigned de_pc_ranges_count;
+
+    /*  The abbreviation tables read so far, by .debug_abbrev offset.
+        A chained hash table of de_abbrev_table_bucket_count buckets
+        (a power of two), malloc space. */
+    Dwarf_Abbrev_Table *de_abbrev_tables;
+    Dwarf_Unsigned de_abbrev_table_bucket_count;
+    Dwarf_Unsigned de_abbrev_table_count;
+
+    /*  The index of dwarf_lookup_name(), created by
+        dwarf_build_name_index(). malloc space. */
+    struct Dwarf_Name_Index_s *de_name_index;
+
     void *(*de_copy_word) (void *, const void *, size_t);
     unsigned char de_same_endian;
     unsigned char de_elf_must_close; /* If non-zero, then
@@ -651,6 +674,11 @@ struct Dwarf_Debug_s {
 
     struct Dwarf_Tied_Data_s de_tied_data;
 
+    /*  Non-null only in a Dwarf_Debug made by dwarf_new_thread_dbg().
+        Points to the Dwarf_Debug whose object file and
+        section data this one shares (read-only). */
+    Dwarf_Debug de_shared_dbg;
+
 };
 
 int dwarf_printf(Dwarf_Debug dbg, const char * format, ...)
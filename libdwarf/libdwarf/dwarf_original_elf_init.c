@@ -185,7 +185,10 @@ dwarf_finish(Dwarf_Debug dbg, Dwarf_Error * error)
     if(!dbg) {
         DWARF_DBG_ERROR(NULL, DW_DLE_DBG_NULL, DW_DLV_ERROR);
     }
-    dwarf_elf_object_access_finish(dbg->de_obj_file);
+    if (!dbg->de_shared_dbg) {
+        /*  A thread dbg does not own its object file. */
+        dwarf_elf_object_access_finish(dbg->de_obj_file);
+    }
 
     return dwarf_object_finish(dbg, error);
 }
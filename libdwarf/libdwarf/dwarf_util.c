@@ -30,6 +30,7 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <stdlib.h> /* For free() */
+#include <string.h> /* For memset() */
 #include "dwarf_die_deliv.h"
 #include "pro_encode_nm.h"
 
@@ -345,6 +346,16 @@ _dwarf_get_size_of_val(Dwarf_Debug dbg,
     test multiple, but for now we don't do that.  */
 #define HT_MULTIPLE 8
 
+/*  A code is kept in the dense abt_by_code array as long as
+    the array stays within about twice the number of abbrevs
+    read, plus this much slack for tables that do not
+    start at code 1. */
+#define ABBREV_DENSE_SLACK 64
+
+/*  Starting bucket count for the per-Dwarf_Debug table of
+    abbreviation tables. A power of two. */
+#define ABBREV_TABLE_BUCKETS 64
+
 /*  Copy the old entries, updating each to be in
     a new list.  Don't delete anything. Leave the
     htin with stale data. */
@@ -378,6 +389,231 @@ copy_abbrev_table_to_new_table(Dwarf_Hash_Table htin,
     }
 }
 
+/*  Add one abbrev to a hash table, growing the table
+    first if its chains have become long. */
+static int
+add_to_abbrev_hash_table(Dwarf_Debug dbg,
+    Dwarf_Hash_Table hash_table_base,
+    Dwarf_Abbrev_List entry)
+{
+    Dwarf_Hash_Table_Entry entry_cur = 0;
+
+    if (!hash_table_base->tb_entries) {
+        hash_table_base->tb_table_entry_count =  HT_MULTIPLE;
+        hash_table_base->tb_total_abbrev_count= 0;
+        hash_table_base->tb_entries =
+            (struct  Dwarf_Hash_Table_Entry_s *)_dwarf_get_alloc(dbg,
+            DW_DLA_HASH_TABLE_ENTRY,
+            hash_table_base->tb_table_entry_count);
+        if (!hash_table_base->tb_entries) {
+            return DW_DLV_NO_ENTRY;
+        }
+    } else if (hash_table_base->tb_total_abbrev_count >
+        ( hash_table_base->tb_table_entry_count * HT_MULTIPLE) ) {
+        struct Dwarf_Hash_Table_s newht;
+        /* Effectively multiplies by >= HT_MULTIPLE */
+        newht.tb_table_entry_count =  hash_table_base->tb_total_abbrev_count;
+        newht.tb_total_abbrev_count = 0;
+        newht.tb_entries =
+            (struct  Dwarf_Hash_Table_Entry_s *)_dwarf_get_alloc(dbg,
+            DW_DLA_HASH_TABLE_ENTRY,
+            newht.tb_table_entry_count);
+
+        if (!newht.tb_entries) {
+            return DW_DLV_NO_ENTRY;
+        }
+        /*  Copy the existing entries to the new table,
+            rehashing each.  */
+        copy_abbrev_table_to_new_table(hash_table_base, &newht);
+        /*  Dealloc only the entries hash table array, not the lists
+            of things pointed to by a hash table entry array. */
+        dwarf_dealloc(dbg, hash_table_base->tb_entries,DW_DLA_HASH_TABLE_ENTRY);
+        hash_table_base->tb_entries = 0;
+        /*  Now overwrite the existing table descriptor with
+            the new, newly valid, contents. */
+        *hash_table_base = newht;
+    } /* Else is ok as is, add entry */
+
+    entry_cur = hash_table_base->tb_entries +
+        (entry->ab_code % hash_table_base->tb_table_entry_count);
+    entry->ab_next = entry_cur->at_head;
+    entry_cur->at_head = entry;
+    hash_table_base->tb_total_abbrev_count++;
+    return DW_DLV_OK;
+}
+
+static Dwarf_Abbrev_List
+find_in_abbrev_table(Dwarf_Abbrev_Table table, Dwarf_Unsigned code)
+{
+    Dwarf_Hash_Table sparse = &table->abt_sparse;
+    Dwarf_Abbrev_List entry = 0;
+
+    if (code < table->abt_by_code_count) {
+        entry = table->abt_by_code[code];
+        if (entry) {
+            return entry;
+        }
+    }
+    if (!sparse->tb_total_abbrev_count) {
+        return 0;
+    }
+    entry = sparse->tb_entries[code % sparse->tb_table_entry_count].at_head;
+    for (; entry; entry = entry->ab_next) {
+        if (entry->ab_code == code) {
+            return entry;
+        }
+    }
+    return 0;
+}
+
+/*  Where a code appears twice in one table the first
+    definition is the one kept, as that is the one a
+    sequential search of the section would find.
+    Returns DW_DLV_NO_ENTRY on a duplicate or if out
+    of memory, and the caller then owns entry. */
+static int
+add_to_abbrev_table(Dwarf_Debug dbg, Dwarf_Abbrev_Table table,
+    Dwarf_Abbrev_List entry)
+{
+    Dwarf_Unsigned code = entry->ab_code;
+    Dwarf_Unsigned dense_limit = 0;
+
+    if (find_in_abbrev_table(table,code)) {
+        return DW_DLV_NO_ENTRY;
+    }
+    dense_limit = 2*table->abt_abbrev_count + ABBREV_DENSE_SLACK;
+    if (code >= table->abt_by_code_count && code < dense_limit) {
+        Dwarf_Unsigned newcount = 2*table->abt_by_code_count;
+        Dwarf_Abbrev_List *newarray = 0;
+
+        if (newcount < ABBREV_DENSE_SLACK) {
+            newcount = ABBREV_DENSE_SLACK;
+        }
+        if (newcount <= code) {
+            newcount = code + 1;
+        }
+        newarray = (Dwarf_Abbrev_List *)realloc(table->abt_by_code,
+            newcount * sizeof(Dwarf_Abbrev_List));
+        if (!newarray) {
+            return DW_DLV_NO_ENTRY;
+        }
+        memset(newarray + table->abt_by_code_count, 0,
+            (newcount - table->abt_by_code_count) *
+            sizeof(Dwarf_Abbrev_List));
+        table->abt_by_code = newarray;
+        table->abt_by_code_count = newcount;
+    }
+    if (code < table->abt_by_code_count) {
+        table->abt_by_code[code] = entry;
+    } else {
+        int res = add_to_abbrev_hash_table(dbg,&table->abt_sparse,entry);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+    }
+    table->abt_abbrev_count++;
+    return DW_DLV_OK;
+}
+
+static Dwarf_Unsigned
+abbrev_table_bucket(Dwarf_Unsigned offset, Dwarf_Unsigned bucket_count)
+{
+    /*  Offsets are all over the section, mix the bits a
+        little so nearby offsets land in different buckets. */
+    return (offset ^ (offset >> 7) ^ (offset >> 17)) & (bucket_count - 1);
+}
+
+static int
+grow_abbrev_table_buckets(Dwarf_Debug dbg)
+{
+    Dwarf_Unsigned oldcount = dbg->de_abbrev_table_bucket_count;
+    Dwarf_Unsigned newcount = oldcount? 2*oldcount: ABBREV_TABLE_BUCKETS;
+    Dwarf_Abbrev_Table *newbuckets = 0;
+    Dwarf_Unsigned k = 0;
+
+    newbuckets = (Dwarf_Abbrev_Table *)calloc(newcount,
+        sizeof(Dwarf_Abbrev_Table));
+    if (!newbuckets) {
+        return DW_DLV_NO_ENTRY;
+    }
+    for (; k < oldcount; ++k) {
+        Dwarf_Abbrev_Table table = dbg->de_abbrev_tables[k];
+        Dwarf_Abbrev_Table nexttable = 0;
+
+        for (; table; table = nexttable) {
+            Dwarf_Unsigned b = abbrev_table_bucket(table->abt_offset,
+                newcount);
+            nexttable = table->abt_next;
+            table->abt_next = newbuckets[b];
+            newbuckets[b] = table;
+        }
+    }
+    free(dbg->de_abbrev_tables);
+    dbg->de_abbrev_tables = newbuckets;
+    dbg->de_abbrev_table_bucket_count = newcount;
+    return DW_DLV_OK;
+}
+
+/*  Find the abbreviation table for the CU's abbrev offset,
+    creating an empty one if this is the first CU to use
+    that offset. */
+static int
+get_abbrev_table(Dwarf_CU_Context cu_context,
+    Dwarf_Abbrev_Table *table_out)
+{
+    Dwarf_Debug dbg = cu_context->cc_dbg;
+    Dwarf_Unsigned offset = cu_context->cc_abbrev_offset;
+    Dwarf_Abbrev_Table table = 0;
+    Dwarf_Unsigned b = 0;
+
+    if (dbg->de_abbrev_table_bucket_count) {
+        b = abbrev_table_bucket(offset,dbg->de_abbrev_table_bucket_count);
+        for (table = dbg->de_abbrev_tables[b]; table;
+            table = table->abt_next) {
+            if (table->abt_offset == offset) {
+                *table_out = table;
+                return DW_DLV_OK;
+            }
+        }
+    }
+    if (dbg->de_abbrev_table_count >=
+        dbg->de_abbrev_table_bucket_count) {
+        int res = grow_abbrev_table_buckets(dbg);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+    }
+
+    table = (Dwarf_Abbrev_Table)calloc(1,sizeof(struct Dwarf_Abbrev_Table_s));
+    if (!table) {
+        return DW_DLV_NO_ENTRY;
+    }
+    table->abt_offset = offset;
+    /*  This is ok because cc_abbrev_offset includes DWP
+        offset if appropriate. */
+    table->abt_next_ptr = dbg->de_debug_abbrev.dss_data + offset;
+    if (cu_context->cc_dwp_offsets.pcu_type)  {
+        /*  In a DWP the abbrevs
+            for this context are known quite precisely. */
+        Dwarf_Unsigned size = 0;
+        /* Ignore the offset returned. Already in cc_abbrev_offset. */
+        _dwarf_get_dwp_extra_offset(&cu_context->cc_dwp_offsets,
+            DW_SECT_ABBREV,&size);
+        /*  ASSERT: size != 0 */
+        table->abt_end_ptr = table->abt_next_ptr + size;
+    } else {
+        table->abt_end_ptr = dbg->de_debug_abbrev.dss_data +
+            dbg->de_debug_abbrev.dss_size;
+    }
+
+    b = abbrev_table_bucket(offset,dbg->de_abbrev_table_bucket_count);
+    table->abt_next = dbg->de_abbrev_tables[b];
+    dbg->de_abbrev_tables[b] = table;
+    dbg->de_abbrev_table_count++;
+    *table_out = table;
+    return DW_DLV_OK;
+}
+
 /*  We allow zero form here, end of list. */
 int
 _dwarf_valid_form_we_know(Dwarf_Debug dbg,
@@ -403,28 +639,19 @@ _dwarf_valid_form_we_know(Dwarf_Debug dbg,
 }
 
 /*  This function returns a pointer to a Dwarf_Abbrev_List_s
-    struct for the abbrev with the given code.  It puts the
-    struct on the appropriate hash table.  It also adds all
-    the abbrev between the last abbrev added and this one to
-    the hash table.  In other words, the .debug_abbrev section
-    is scanned sequentially from the top for an abbrev with
-    the given code.  All intervening abbrevs are also put
-    into the hash table.
-
-    This function hashes the given code, and checks the chain
-    at that hash table entry to see if a Dwarf_Abbrev_List_s
-    with the given code exists.  If yes, it returns a pointer
-    to that struct.  Otherwise, it scans the .debug_abbrev
-    section from the last byte scanned for that CU till either
-    an abbrev with the given code is found, or an abbrev code
-    of 0 is read.  It puts Dwarf_Abbrev_List_s entries for all
-    abbrev's read till that point into the hash table.  The
-    hash table contains both a head pointer and a tail pointer
-    for each entry.
-
-    While the lists can move and entries can be moved between
-    lists on reallocation, any given Dwarf_Abbrev_list entry
-    never moves once allocated, so the pointer is safe to return.
+    struct for the abbrev with the given code.
+
+    The CU's abbreviation table is shared with every CU using
+    the same .debug_abbrev offset.  If the code has already
+    been read (for this CU or any other using the table) it
+    is found directly. Otherwise the .debug_abbrev section
+    is scanned sequentially from the last byte scanned for
+    that table till either an abbrev with the given code is
+    found, or an abbrev code of 0 is read.  All intervening
+    abbrevs are also put into the table.
+
+    Any given Dwarf_Abbrev_list entry never moves once
+    allocated, so the pointer is safe to return.
 
     Returns NULL on error.  */
 int
@@ -433,103 +660,37 @@ _dwarf_get_abbrev_for_code(Dwarf_CU_Context cu_context, Dwarf_Unsigned code,
     Dwarf_Error *error)
 {
     Dwarf_Debug dbg = cu_context->cc_dbg;
-    Dwarf_Hash_Table hash_table_base = cu_context->cc_abbrev_hash_table;
-    Dwarf_Hash_Table_Entry entry_base = 0;
-    Dwarf_Hash_Table_Entry entry_cur = 0;
-    Dwarf_Word hash_num = 0;
+    Dwarf_Abbrev_Table table = cu_context->cc_abbrev_table;
     Dwarf_Unsigned abbrev_code = 0;
     Dwarf_Unsigned abbrev_tag  = 0;
     Dwarf_Unsigned attr_name = 0;
     Dwarf_Unsigned attr_form = 0;
-    Dwarf_Abbrev_List hash_abbrev_entry = 0;
     Dwarf_Abbrev_List inner_list_entry = 0;
-    Dwarf_Hash_Table_Entry inner_hash_entry = 0;
-
     Dwarf_Byte_Ptr abbrev_ptr = 0;
     Dwarf_Byte_Ptr end_abbrev_ptr = 0;
-    unsigned hashable_val = 0;
-
-    if (!hash_table_base->tb_entries) {
-        hash_table_base->tb_table_entry_count =  HT_MULTIPLE;
-        hash_table_base->tb_total_abbrev_count= 0;
-        hash_table_base->tb_entries =
-            (struct  Dwarf_Hash_Table_Entry_s *)_dwarf_get_alloc(dbg,
-            DW_DLA_HASH_TABLE_ENTRY,
-            hash_table_base->tb_table_entry_count);
-        if (!hash_table_base->tb_entries) {
-            return DW_DLV_NO_ENTRY;
-        }
-
-    } else if (hash_table_base->tb_total_abbrev_count >
-        ( hash_table_base->tb_table_entry_count * HT_MULTIPLE) ) {
-        struct Dwarf_Hash_Table_s newht;
-        /* Effectively multiplies by >= HT_MULTIPLE */
-        newht.tb_table_entry_count =  hash_table_base->tb_total_abbrev_count;
-        newht.tb_total_abbrev_count = 0;
-        newht.tb_entries =
-            (struct  Dwarf_Hash_Table_Entry_s *)_dwarf_get_alloc(dbg,
-            DW_DLA_HASH_TABLE_ENTRY,
-            newht.tb_table_entry_count);
 
-        if (!newht.tb_entries) {
-            return DW_DLV_NO_ENTRY;
+    if (!table) {
+        int res = get_abbrev_table(cu_context,&table);
+        if (res != DW_DLV_OK) {
+            return res;
         }
-        /*  Copy the existing entries to the new table,
-            rehashing each.  */
-        copy_abbrev_table_to_new_table(hash_table_base, &newht);
-        /*  Dealloc only the entries hash table array, not the lists
-            of things pointed to by a hash table entry array. */
-        dwarf_dealloc(dbg, hash_table_base->tb_entries,DW_DLA_HASH_TABLE_ENTRY);
-        hash_table_base->tb_entries = 0;
-        /*  Now overwrite the existing table descriptor with
-            the new, newly valid, contents. */
-        *hash_table_base = newht;
-    } /* Else is ok as is, add entry */
+        cu_context->cc_abbrev_table = table;
+    }
 
-    hashable_val = code;
-    hash_num = hashable_val %
-        hash_table_base->tb_table_entry_count;
-    entry_base = hash_table_base->tb_entries;
-    entry_cur  = entry_base + hash_num;
-
-    /* Determine if the 'code' is the list of synonyms already. */
-    for (hash_abbrev_entry = entry_cur->at_head;
-        hash_abbrev_entry != NULL && hash_abbrev_entry->ab_code != code;
-        hash_abbrev_entry = hash_abbrev_entry->ab_next);
-    if (hash_abbrev_entry != NULL) {
+    inner_list_entry = find_in_abbrev_table(table,code);
+    if (inner_list_entry) {
         /*  This returns a pointer to an abbrev list entry, not
             the list itself. */
-        *list_out = hash_abbrev_entry;
+        *list_out = inner_list_entry;
         return DW_DLV_OK;
     }
 
-    if (cu_context->cc_last_abbrev_ptr) {
-        abbrev_ptr = cu_context->cc_last_abbrev_ptr;
-        end_abbrev_ptr = cu_context->cc_last_abbrev_endptr;
-    } else {
-        /*  This is ok because cc_abbrev_offset includes DWP
-            offset if appropriate. */
-        abbrev_ptr = dbg->de_debug_abbrev.dss_data +
-            cu_context->cc_abbrev_offset;
-
-        if (cu_context->cc_dwp_offsets.pcu_type)  {
-            /*  In a DWP the abbrevs
-                for this context are known quite precisely. */
-            Dwarf_Unsigned size = 0;
-            /* Ignore the offset returned. Already in cc_abbrev_offset. */
-            _dwarf_get_dwp_extra_offset(&cu_context->cc_dwp_offsets,
-                DW_SECT_ABBREV,&size);
-            /*  ASSERT: size != 0 */
-            end_abbrev_ptr = abbrev_ptr + size;
-        } else {
-            end_abbrev_ptr = abbrev_ptr +
-                dbg->de_debug_abbrev.dss_size;
-        }
-    }
+    abbrev_ptr = table->abt_next_ptr;
+    end_abbrev_ptr = table->abt_end_ptr;
 
     /*  End of abbrev's as we are past the end entirely.
         This can happen. */
-    if (abbrev_ptr > end_abbrev_ptr) {
+    if (abbrev_ptr >= end_abbrev_ptr) {
         return DW_DLV_NO_ENTRY;
     }
     /*  End of abbrev's for this cu, since abbrev code is 0. */
@@ -538,7 +699,8 @@ _dwarf_get_abbrev_for_code(Dwarf_CU_Context cu_context, Dwarf_Unsigned code,
     }
 
     do {
-        unsigned new_hashable_val = 0;
+        int res = 0;
+
         DECODE_LEB128_UWORD(abbrev_ptr, abbrev_code);
         DECODE_LEB128_UWORD(abbrev_ptr, abbrev_tag);
 
@@ -547,36 +709,38 @@ _dwarf_get_abbrev_for_code(Dwarf_CU_Context cu_context, Dwarf_Unsigned code,
         if (inner_list_entry == NULL) {
             return DW_DLV_NO_ENTRY;
         }
-
-        new_hashable_val = abbrev_code;
-        hash_num = new_hashable_val %
-            hash_table_base->tb_table_entry_count;
-        inner_hash_entry = entry_base + hash_num;
-        /* Move_entry_to_new_hash */
-        inner_list_entry->ab_next = inner_hash_entry->at_head;
-        inner_hash_entry->at_head = inner_list_entry;
-
-        hash_table_base->tb_total_abbrev_count++;
-
         inner_list_entry->ab_code = abbrev_code;
         inner_list_entry->ab_tag = abbrev_tag;
         inner_list_entry->ab_has_child = *(abbrev_ptr++);
         inner_list_entry->ab_abbrev_ptr = abbrev_ptr;
 
-        hash_table_base->tb_total_abbrev_count++;
-
         /*  Cycle thru the abbrev content, ignoring the content except
             to find the end of the content. */
         do {
             DECODE_LEB128_UWORD(abbrev_ptr, attr_name);
             DECODE_LEB128_UWORD(abbrev_ptr, attr_form);
             if (!_dwarf_valid_form_we_know(dbg,attr_form,attr_name)) {
+                dwarf_dealloc(dbg,inner_list_entry,DW_DLA_ABBREV_LIST);
                 _dwarf_error(dbg,error,DW_DLE_UNKNOWN_FORM);
                 return DW_DLV_ERROR;
             }
 
         } while (attr_name != 0 && attr_form != 0);
 
+        res = add_to_abbrev_table(dbg,table,inner_list_entry);
+        if (res != DW_DLV_OK) {
+            dwarf_dealloc(dbg,inner_list_entry,DW_DLA_ABBREV_LIST);
+            inner_list_entry = find_in_abbrev_table(table,abbrev_code);
+            if (!inner_list_entry) {
+                /* Out of memory. */
+                return DW_DLV_NO_ENTRY;
+            }
+        }
+        /*  Only complete abbrevs are passed over, a bad
+            one is read again (and reported again) by the
+            next lookup that gets this far. */
+        table->abt_next_ptr = abbrev_ptr;
+
         /*  We may have fallen off the end of content,  that is not
             a botch in the section, as there is no rule that the last
             abbrev need have abbrev_code of 0. */
@@ -584,8 +748,6 @@ _dwarf_get_abbrev_for_code(Dwarf_CU_Context cu_context, Dwarf_Unsigned code,
     } while ((abbrev_ptr < end_abbrev_ptr) &&
         *abbrev_ptr != 0 && abbrev_code != code);
 
-    cu_context->cc_last_abbrev_ptr = abbrev_ptr;
-    cu_context->cc_last_abbrev_endptr = end_abbrev_ptr;
     if(abbrev_code == code) {
         *list_out = inner_list_entry;
         return DW_DLV_OK;
@@ -820,6 +982,36 @@ _dwarf_free_abbrev_hash_table_contents(Dwarf_Debug dbg,Dwarf_Hash_Table hash_tab
     hash_table->tb_entries = 0;
 }
 
+void
+_dwarf_free_abbrev_tables(Dwarf_Debug dbg)
+{
+    Dwarf_Unsigned b = 0;
+
+    for (; b < dbg->de_abbrev_table_bucket_count; ++b) {
+        Dwarf_Abbrev_Table table = dbg->de_abbrev_tables[b];
+        Dwarf_Abbrev_Table nexttable = 0;
+
+        for (; table; table = nexttable) {
+            Dwarf_Unsigned k = 0;
+
+            nexttable = table->abt_next;
+            for (; k < table->abt_by_code_count; ++k) {
+                if (table->abt_by_code[k]) {
+                    dwarf_dealloc(dbg, table->abt_by_code[k],
+                        DW_DLA_ABBREV_LIST);
+                }
+            }
+            free(table->abt_by_code);
+            _dwarf_free_abbrev_hash_table_contents(dbg,&table->abt_sparse);
+            free(table);
+        }
+    }
+    free(dbg->de_abbrev_tables);
+    dbg->de_abbrev_tables = 0;
+    dbg->de_abbrev_table_bucket_count = 0;
+    dbg->de_abbrev_table_count = 0;
+}
+
 /*
     If no die provided the size value returned might be wrong.
     If different compilation units have different address sizes
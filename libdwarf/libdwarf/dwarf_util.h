@@ -290,6 +290,30 @@ struct Dwarf_Hash_Table_Entry_s {
     Dwarf_Abbrev_List at_head;
 };
 
+/*  The abbreviations at one offset in .debug_abbrev.
+    Every CU whose header names that offset shares the one
+    table, so it is read once however many CUs use it.
+    Abbrevs are read lazily, only as far as the highest code
+    asked for so far.  Codes are normally 1,2,3... so a
+    code is found by indexing abt_by_code. A code too large
+    to keep that array dense goes in abt_sparse instead. */
+struct Dwarf_Abbrev_Table_s {
+    Dwarf_Unsigned abt_offset;
+
+    /*  Where reading resumes, and the end of the
+        abbrevs this table may use. */
+    Dwarf_Byte_Ptr abt_next_ptr;
+    Dwarf_Byte_Ptr abt_end_ptr;
+    Dwarf_Unsigned abt_abbrev_count;
+
+    /*  malloc space, abt_by_code_count entries. */
+    Dwarf_Abbrev_List *abt_by_code;
+    Dwarf_Unsigned abt_by_code_count;
+    struct Dwarf_Hash_Table_s abt_sparse;
+
+    struct Dwarf_Abbrev_Table_s *abt_next;
+};
+
 
 
 int _dwarf_get_abbrev_for_code(Dwarf_CU_Context cu_context,
@@ -312,6 +336,7 @@ int  _dwarf_load_debug_info(Dwarf_Debug dbg, Dwarf_Error *error);
 int  _dwarf_load_debug_types(Dwarf_Debug dbg, Dwarf_Error *error);
 void _dwarf_free_abbrev_hash_table_contents(Dwarf_Debug dbg,
     struct Dwarf_Hash_Table_s* hash_table);
+void _dwarf_free_abbrev_tables(Dwarf_Debug dbg);
 int _dwarf_get_address_size(Dwarf_Debug dbg, Dwarf_Die die);
 int _dwarf_reference_outside_section(Dwarf_Die die,
     Dwarf_Small * startaddr,
@@ -568,6 +568,8 @@ struct Dwarf_Line_Context_s;
 typedef struct Dwarf_Line_Context_s *Dwarf_Line_Context;
 struct Dwarf_Macro_Context_s;
 typedef struct Dwarf_Macro_Context_s *Dwarf_Macro_Context;
+struct Dwarf_Frame_Cache_s;
+typedef struct Dwarf_Frame_Cache_s *Dwarf_Frame_Cache;
 
 
 /* Opaque types for Producer Library. */
@@ -1242,9 +1244,16 @@ struct Dwarf_Obj_Access_Interface_s {
 #define DW_DLE_BAD_MACRO_INDEX                 323
 #define DW_DLE_MACRO_OP_UNHANDLED              324
 #define DW_DLE_MACRO_PAST_END                  325
+#define DW_DLE_LOC_EVAL_STACK_OVERFLOW         326
+#define DW_DLE_LOC_EVAL_STACK_UNDERFLOW        327
+#define DW_DLE_LOC_EVAL_DIV_BY_ZERO            328
+#define DW_DLE_LOC_EVAL_BAD_BRANCH             329
+#define DW_DLE_LOC_EVAL_BAD_PIECE              330
+#define DW_DLE_DEBUG_NAMES_HEADER_ERROR        331
+#define DW_DLE_DEBUG_NAMES_ENTRY_ERROR         332
 
     /* DW_DLE_LAST MUST EQUAL LAST ERROR NUMBER */
-#define DW_DLE_LAST        325
+#define DW_DLE_LAST        332
 #define DW_DLE_LO_USER     0x10000
 
     /*  Taken as meaning 'undefined value', this is not
@@ -1354,6 +1363,20 @@ int dwarf_set_tied_dbg(Dwarf_Debug /*basedbg*/,
 int dwarf_object_finish(Dwarf_Debug /* dbg */,
     Dwarf_Error* /* error */);
 
+/*  Returns a new Dwarf_Debug sharing the object file and
+    section data of dbg, for use by a single thread.
+    Each thread reading the same object concurrently should
+    have its own, as CU lists and other state are kept in
+    the Dwarf_Debug.
+    All sections of dbg are loaded by this call, so create
+    every thread Dwarf_Debug before any thread starts reading,
+    and call dwarf_finish() on each before calling it on dbg.
+    dbg itself remains usable, by one thread only.
+    A thread Dwarf_Debug has no tied file (see dwarf_set_tied_dbg). */
+int dwarf_new_thread_dbg(Dwarf_Debug /*dbg*/,
+    Dwarf_Debug*  /*thread_dbg_out*/,
+    Dwarf_Error*  /*error*/);
+
 /*  Section name access.  Because sections might
     now end with .dwo or be .zdebug  or might not.
 */
@@ -1656,6 +1679,118 @@ int dwarf_loclist_from_expr_b(Dwarf_Debug /*dbg*/,
     Dwarf_Signed * /*listlen*/ ,
     Dwarf_Error *  /*error*/ );
 
+/*  New October 2026. A location expression compiled once
+    by dwarf_loc_program_compile() and then evaluated
+    any number of times by dwarf_loc_program_eval().
+    The arguments to compile are those of
+    dwarf_loclist_from_expr_b(). Compiling folds constant
+    arithmetic (for example DW_OP_breg6 -8 DW_OP_lit4
+    DW_OP_plus becomes DW_OP_breg6 -4) and recognizes the
+    common one-step shapes, which dwarf_loc_program_info()
+    reports and eval does with one provider call.
+    Compile returns DW_DLV_NO_ENTRY for an expression using
+    an operator eval cannot do (DW_OP_entry_value,
+    typed stack operators, DW_OP_addrx, calls and so on).
+    The program refers to the expression bytes for
+    DW_OP_implicit_value, so it must not outlive the
+    Dwarf_Debug. */
+typedef struct Dwarf_Loc_Program_s *Dwarf_Loc_Program;
+
+/*  Shapes reported by dwarf_loc_program_info(). */
+#define DW_LOC_PROG_GENERAL           0 /* None of the below. */
+#define DW_LOC_PROG_ADDRESS           1 /* DW_OP_addr: at offset */
+#define DW_LOC_PROG_REGISTER          2 /* In register regnum. */
+#define DW_LOC_PROG_REG_OFFSET        3 /* At register regnum
+                                           plus offset. */
+#define DW_LOC_PROG_FRAME_BASE_OFFSET 4 /* At frame base plus
+                                           offset. */
+#define DW_LOC_PROG_CFA_OFFSET        5 /* At CFA plus offset. */
+
+/*  What an evaluated location (or one piece of it) is. */
+#define DW_LOC_VALUE_EMPTY     0 /* Optimized out. */
+#define DW_LOC_VALUE_ADDRESS   1 /* In memory at dlv_value. */
+#define DW_LOC_VALUE_REGISTER  2 /* In DWARF register dlv_value. */
+#define DW_LOC_VALUE_VALUE     3 /* DW_OP_stack_value: the value
+                                    is dlv_value. */
+#define DW_LOC_VALUE_IMPLICIT  4 /* DW_OP_implicit_value: the value
+                                    is the dlv_block_len bytes at
+                                    dlv_block. */
+
+typedef struct Dwarf_Loc_Value_s {
+    Dwarf_Small    dlv_kind;
+    Dwarf_Unsigned dlv_value;
+    Dwarf_Ptr      dlv_block;
+    Dwarf_Unsigned dlv_block_len;
+    /*  For DW_OP_piece and DW_OP_bit_piece the size of the
+        piece in bits, and for DW_OP_bit_piece the offset
+        in bits. Zero if the location is not in pieces. */
+    Dwarf_Unsigned dlv_piece_bits;
+    Dwarf_Unsigned dlv_piece_bit_offset;
+} Dwarf_Loc_Value;
+
+/*  How dwarf_loc_program_eval() reads the target.
+    Each function returns DW_DLV_OK, or DW_DLV_NO_ENTRY
+    if the value is not available (a register not saved
+    in this frame, unreadable memory) in which case eval
+    returns DW_DLV_NO_ENTRY too. A NULL function is
+    treated as always returning DW_DLV_NO_ENTRY.
+    lep_read_memory reads size bytes, 1 to 8, zero
+    extended to 64 bits in target byte order.
+    lep_frame_base is the value of the function's
+    DW_AT_frame_base (which is itself an expression the
+    caller can compile), lep_call_frame_cfa the CFA for
+    DW_OP_call_frame_cfa and lep_tls_address the
+    address of offset in this thread's TLS block for
+    DW_OP_form_tls_address. */
+typedef struct Dwarf_Loc_Eval_Provider_s {
+    void * lep_user_data;
+    int (*lep_read_register)(void * /*user_data*/,
+        Dwarf_Unsigned /*regnum*/, Dwarf_Unsigned * /*value*/);
+    int (*lep_read_memory)(void * /*user_data*/,
+        Dwarf_Addr /*addr*/, Dwarf_Small /*size*/,
+        Dwarf_Unsigned * /*value*/);
+    int (*lep_frame_base)(void * /*user_data*/,
+        Dwarf_Addr * /*frame_base*/);
+    int (*lep_call_frame_cfa)(void * /*user_data*/,
+        Dwarf_Addr * /*cfa*/);
+    int (*lep_tls_address)(void * /*user_data*/,
+        Dwarf_Unsigned /*offset*/, Dwarf_Addr * /*address*/);
+} Dwarf_Loc_Eval_Provider;
+
+int dwarf_loc_program_compile(Dwarf_Debug /*dbg*/,
+    Dwarf_Ptr      /*expression_in*/ ,
+    Dwarf_Unsigned /*expression_length*/ ,
+    Dwarf_Half     /*addr_size*/ ,
+    Dwarf_Half     /*offset_size*/ ,
+    Dwarf_Small    /*dwarf_version*/ ,
+    Dwarf_Loc_Program * /*returned_program*/,
+    Dwarf_Error *  /*error*/ );
+
+/*  piece_count is the number of Dwarf_Loc_Value-s eval
+    fills in: the number of pieces, or 1 if the location
+    is not in pieces. regnum and offset are set
+    for the shapes that have them. Any pointer may be NULL. */
+int dwarf_loc_program_info(Dwarf_Loc_Program /*program*/,
+    Dwarf_Small    * /*shape*/,
+    Dwarf_Unsigned * /*regnum*/,
+    Dwarf_Signed   * /*offset*/,
+    Dwarf_Unsigned * /*piece_count*/,
+    Dwarf_Error    * /*error*/);
+
+/*  Fills in values[0..piece_count-1], value_space must be
+    at least piece_count. Stack values are of the generic
+    type, addr_size bytes: each result is reduced to that
+    size, and DW_OP_div, DW_OP_shra and the comparisons
+    treat values as signed numbers of that size. */
+int dwarf_loc_program_eval(Dwarf_Loc_Program /*program*/,
+    const Dwarf_Loc_Eval_Provider * /*provider*/,
+    Dwarf_Loc_Value * /*values*/,
+    Dwarf_Unsigned    /*value_space*/,
+    Dwarf_Unsigned  * /*value_count*/,
+    Dwarf_Error     * /*error*/);
+
+void dwarf_loc_program_dealloc(Dwarf_Loc_Program /*program*/);
+
 int dwarf_lowpc(Dwarf_Die /*die*/,
     Dwarf_Addr  *    /*returned_addr*/,
     Dwarf_Error*     /*error*/);
@@ -1892,6 +2027,53 @@ int dwarf_srclines_two_level_from_linecontext(
    and dwarf_srclines_b()  allocate.  */
 void dwarf_srclines_dealloc_b(Dwarf_Line_Context /*line_context*/);
 
+/*  New October 2026. One row of a line table as the
+    line table state machine produces it.
+    dlr_file is numbered as dwarf_line_srcfileno() numbers it. */
+typedef struct Dwarf_Line_Row_s {
+    Dwarf_Addr     dlr_address;
+    Dwarf_Unsigned dlr_file;
+    Dwarf_Unsigned dlr_line;
+    Dwarf_Unsigned dlr_column;
+    Dwarf_Unsigned dlr_isa;
+    Dwarf_Unsigned dlr_discriminator;
+    Dwarf_Unsigned dlr_call_context;
+    Dwarf_Unsigned dlr_subprogram;
+    Dwarf_Bool     dlr_is_stmt;
+    Dwarf_Bool     dlr_basic_block;
+    Dwarf_Bool     dlr_end_sequence;
+    Dwarf_Bool     dlr_prologue_end;
+    Dwarf_Bool     dlr_epilogue_begin;
+    Dwarf_Bool     dlr_is_addr_set;
+    Dwarf_Bool     dlr_is_actuals_table;
+} Dwarf_Line_Row;
+
+/*  Return DW_DLV_OK to be given the next row,
+    DW_DLV_NO_ENTRY to stop reading the table. */
+typedef int (*Dwarf_Line_Row_Callback)(const Dwarf_Line_Row * /*row*/,
+    void * /*user_data*/);
+
+/*  New October 2026.  Reads the line table of the CU of die
+    and passes each row to callback as it is produced, without
+    creating a Dwarf_Line for any of them. Only the row
+    being passed is valid during the callback.
+    Rows of a single level table are never stored at all.
+    For an experimental two-level table the logicals are
+    needed to read the actuals, so those tables are
+    read as dwarf_srclines_b() reads them and then passed
+    to callback, logicals first.
+    If line_context is non-NULL the Dwarf_Line_Context, with
+    the file and include directory tables, is returned in it.
+    Free that with dwarf_srclines_dealloc_b().
+    Returns DW_DLV_OK even if callback stopped the reading
+    early. */
+int dwarf_srclines_stream(Dwarf_Die /*die*/,
+    Dwarf_Line_Row_Callback /*callback*/,
+    void *               /*user_data*/,
+    Dwarf_Unsigned     * /*version_out*/,
+    Dwarf_Line_Context * /*line_context*/,
+    Dwarf_Error        * /*error*/);
+
 /*  New October 2015. */
 /*    The offset is in the relevent .debug_line or .debug_line.dwo
     section (and in a split dwarf package file includes)
@@ -2483,6 +2665,33 @@ int dwarf_get_fde_at_pc(Dwarf_Fde* /*fde_data*/,
     Dwarf_Addr*      /*hipc*/,
     Dwarf_Error*     /*error*/);
 
+/*  New October 2026. A cache of frame table rows for repeated
+    unwinding at the same pcs.  fde_data is the list from
+    dwarf_get_fde_list() or dwarf_get_fde_list_eh() and must
+    stay valid until dwarf_frame_cache_dealloc() is called.
+    Rows are computed when first asked for and found again
+    with two binary searches (the fde, then its rows).
+    Rows use the frame rule settings (dwarf_set_frame_*())
+    in effect when they are computed, so set those first. */
+int dwarf_frame_cache_create(Dwarf_Fde* /*fde_data*/,
+    Dwarf_Frame_Cache * /*returned_cache*/,
+    Dwarf_Error*     /*error*/);
+
+/*  Fills in reg_table exactly as dwarf_get_fde_info_for_all_regs3()
+    would for the fde containing pc.  row_pc and row_hipc,
+    if non-NULL, are the first and last pc the row applies to
+    and returned_fde, if non-NULL, the fde.
+    Returns DW_DLV_NO_ENTRY if no fde contains pc. */
+int dwarf_frame_cache_get_regs3(Dwarf_Frame_Cache /*cache*/,
+    Dwarf_Addr       /*pc_requested*/,
+    Dwarf_Regtable3* /*reg_table*/,
+    Dwarf_Addr*      /*row_pc*/,
+    Dwarf_Addr*      /*row_hipc*/,
+    Dwarf_Fde  *     /*returned_fde*/,
+    Dwarf_Error*     /*error*/);
+
+void dwarf_frame_cache_dealloc(Dwarf_Frame_Cache /*cache*/);
+
 /* GNU .eh_frame augmentation information, raw form, see
    Linux Standard Base Core Specification version 3.0 . */
 int dwarf_get_cie_augmentation_data(Dwarf_Cie /* cie*/,
@@ -2563,6 +2772,18 @@ int dwarf_get_arange_info_b(
     Dwarf_Off     *  /*cu_die_offset*/,
     Dwarf_Error   *  /*error*/ );
 
+/*  Returns the offset of the CU DIE (in .debug_info) of the
+    compilation unit whose code contains pc.
+    The first call builds a sorted table from .debug_aranges,
+    using the DW_AT_ranges or DW_AT_low_pc/DW_AT_high_pc of
+    the CU DIE for any CU .debug_aranges does not list, so
+    later calls are a binary search.
+    Returns DW_DLV_NO_ENTRY if no CU contains pc. */
+int dwarf_get_cu_die_offset_given_pc(Dwarf_Debug /*dbg*/,
+    Dwarf_Addr     /*pc*/,
+    Dwarf_Off *    /*cu_die_offset*/,
+    Dwarf_Error *  /*error*/);
+
 /*  BEGIN: DWARF5 .debug_macro  interfaces
     NEW November 2015.  */
 int dwarf_get_macro_context(Dwarf_Die /*die*/,
@@ -2922,6 +3143,69 @@ void dwarf_gdbindex_free(Dwarf_Gdbindex /*gdbindexptr*/);
 
 /*  END gdbindex/debugfission operations. */
 
+/*  New October 2026. Finding DIEs by fully qualified name
+    ("ns::Foo::bar", "(anonymous namespace)::x") through
+    a hash of the names of the DIEs in .debug_info.
+    .debug_types is not indexed.
+
+    Named are types, typedefs, functions, variables,
+    constants, namespaces, enumerators (in the enclosing
+    scope unless of an enum class) and static data members.
+    An out-of-line definition (DW_AT_specification) is
+    named like its declaration.
+
+    With use_accelerators a .debug_names section, or else
+    a .gdb_index section, picks the CUs whose names are
+    read for each lookup, so a lookup costs only the CUs
+    it needs. A name the accelerator does not list is not
+    found even if some DIE has it (gold's .gdb_index, for
+    example, leaves out typedefs and static members).
+    A section that cannot be read is reported as a
+    harmless error and every CU is read instead.
+    Without use_accelerators every CU is read by
+    dwarf_build_name_index() itself. */
+#define DW_NAME_INDEX_BUILT        0
+#define DW_NAME_INDEX_GDB_INDEX    1
+#define DW_NAME_INDEX_DEBUG_NAMES  2
+
+/*  Creates the index, replacing any earlier one.
+    dwarf_lookup_name() creates one with use_accelerators
+    TRUE if none exists. The index is freed by dwarf_finish(). */
+int dwarf_build_name_index(Dwarf_Debug /*dbg*/,
+    Dwarf_Bool     /*use_accelerators*/,
+    Dwarf_Error *  /*error*/);
+
+/*  Returns the offset of a DIE named name: the definition
+    with the lowest offset or, with no definition, the
+    declaration with the lowest offset.
+    Returns DW_DLV_NO_ENTRY if there is none. */
+int dwarf_lookup_name(Dwarf_Debug /*dbg*/,
+    const char *   /*name*/,
+    Dwarf_Off *    /*die_offset*/,
+    Dwarf_Error *  /*error*/);
+
+/*  Fills die_offsets with the offsets of up to
+    offsets_space DIEs named name, definitions first, then
+    declarations, each in increasing offset order.
+    *offsets_count is the number of DIEs with the name,
+    which may exceed offsets_space. */
+int dwarf_lookup_name_b(Dwarf_Debug /*dbg*/,
+    const char *   /*name*/,
+    Dwarf_Off *    /*die_offsets*/,
+    Dwarf_Unsigned /*offsets_space*/,
+    Dwarf_Unsigned * /*offsets_count*/,
+    Dwarf_Error *  /*error*/);
+
+/*  Returns how the index finds names (a DW_NAME_INDEX_
+    value), the distinct names indexed and the CUs read
+    so far. Any pointer may be NULL.
+    Returns DW_DLV_NO_ENTRY if there is no index. */
+int dwarf_get_name_index_info(Dwarf_Debug /*dbg*/,
+    Dwarf_Small *    /*source*/,
+    Dwarf_Unsigned * /*names_indexed*/,
+    Dwarf_Unsigned * /*cus_read*/,
+    Dwarf_Error *    /*error*/);
+
 /*  START debugfission dwp .debug_cu_index and .debug_tu_index operations. */
 
 int dwarf_get_xu_index_header(Dwarf_Debug /*dbg*/,
@@ -3057,6 +3341,25 @@ int dwarf_set_stringcheck(int /*stringcheck*/);
     Returns previous value.  */
 int dwarf_set_reloc_application(int /*apply*/);
 
+/*  'mode' defaults to DW_ALLOC_MODE_TRACKED, where every
+    allocation libdwarf makes is a separate malloc recorded
+    in a search tree so dwarf_finish() can free whatever the
+    caller did not dwarf_dealloc().
+    DW_ALLOC_MODE_SLAB instead carves allocations out of large
+    blocks owned by the Dwarf_Debug. dwarf_dealloc() of a fixed size
+    type makes the space available for the next allocation
+    of that DW_DLA type, and of variable length space
+    (including DW_DLA_STRING) for the next one of the same
+    size. Variable length space over 512 bytes is malloc()d
+    and free()d as in DW_ALLOC_MODE_TRACKED.
+    Much faster when reading a lot of DIEs, at the cost of
+    holding on to memory until dwarf_finish().
+    Applies to Dwarf_Debug opened after the call.
+    Returns previous value.  */
+#define DW_ALLOC_MODE_TRACKED 0
+#define DW_ALLOC_MODE_SLAB    1
+int dwarf_set_alloc_mode(int /*mode*/);
+
 /* Unimplemented */
 Dwarf_Handler dwarf_seterrhand(Dwarf_Debug /*dbg*/, Dwarf_Handler /*errhand*/);
 
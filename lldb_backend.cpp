@@ -1,5 +1,7 @@
 #include <stdio.h>
 #include <string.h>
+#include <limits.h>
+#include <sys/stat.h>
 
 #include <lldb/API/LLDB.h>
 #include <lldb/API/SBExpressionOptions.h>
@@ -14,8 +16,13 @@ struct DebugContext {
   lldb::SBProcess process;
   bool is_executing;
   lldb::StateType current_process_state;
+  int outputFD;
+  char outputDirectory[PATH_MAX];
+  char outputPath[PATH_MAX];
 };
 
+#define PROCESS_OUTPUT_PIPE_SIZE (1024 * 1024)
+
 static void
 lldb_log_callback(const char *log, void *baton)
 {
@@ -34,6 +41,9 @@ void lldb_initialize(DebugContext *context, const char *executable_file) {
   context->debugger = lldb::SBDebugger::Create(true, lldb_log_callback, NULL);
   //debugger.EnableLog(channel, categories);
   context->debugger.SetAsync(false);
+  context->outputFD = -1;
+  context->outputDirectory[0] = 0;
+  context->outputPath[0] = 0;
   
   context->target = context->debugger.CreateTarget(executable_file);
   if (!context->target.IsValid()) {
@@ -41,8 +51,15 @@ void lldb_initialize(DebugContext *context, const char *executable_file) {
   }
 }
 
+static void lldb_remove_output_fifo(DebugContext *context);
+
 void lldb_terminate(DebugContext *context) {
   context->process.Destroy();
+  if (context->outputFD != -1) {
+    close(context->outputFD);
+    context->outputFD = -1;
+  }
+  lldb_remove_output_fifo(context);
   context->debugger.DeleteTarget(context->target);
   lldb::SBDebugger::Destroy(context->debugger);
 }
@@ -78,13 +95,104 @@ void lldb_step_out(DebugContext *context) {
   thread.StepOut();
 }
 
+//NOTE(Torin) The inferior is launched by lldb-server so its stdout and stderr
+//are attached by path to a fifo we hold the read end of. A pipe instead of a
+//pty keeps up with chatty programs since it can be grown well past the few
+//kilobytes a pty buffers between frames; the cost is that stdio in the
+//inferior is block rather than line buffered. The fifo lives in a private
+//mkdtemp directory so no other user can create or open it first.
+static void
+lldb_remove_output_fifo(DebugContext *context)
+{
+  if (context->outputPath[0] != 0) {
+    unlink(context->outputPath);
+    context->outputPath[0] = 0;
+  }
+  if (context->outputDirectory[0] != 0) {
+    rmdir(context->outputDirectory);
+    context->outputDirectory[0] = 0;
+  }
+}
+
+static void
+lldb_open_output_fifo(DebugContext *context)
+{
+  if (context->outputFD != -1) {
+    close(context->outputFD);
+    context->outputFD = -1;
+  }
+  lldb_remove_output_fifo(context);
+
+  const char *tempDirectory = getenv("TMPDIR");
+  if (tempDirectory == NULL || tempDirectory[0] == 0) tempDirectory = "/tmp";
+  int length = snprintf(context->outputDirectory, sizeof(context->outputDirectory),
+    "%s/udb-XXXXXX", tempDirectory);
+  if (length < 0 || length >= (int)sizeof(context->outputDirectory) ||
+      mkdtemp(context->outputDirectory) == NULL) {
+    log_error("could not create output fifo directory in %s: %s",
+      tempDirectory, strerror(errno));
+    context->outputDirectory[0] = 0;
+    return;
+  }
+
+  length = snprintf(context->outputPath, sizeof(context->outputPath), "%s/output",
+    context->outputDirectory);
+  if (length < 0 || length >= (int)sizeof(context->outputPath)) {
+    log_error("output fifo path is too long: %.64s...", context->outputDirectory);
+    context->outputPath[0] = 0;
+    lldb_remove_output_fifo(context);
+    return;
+  }
+  if (mkfifo(context->outputPath, 0600) != 0) {
+    log_error("could not create output fifo %s: %s", context->outputPath, strerror(errno));
+    context->outputPath[0] = 0;
+    lldb_remove_output_fifo(context);
+    return;
+  }
+
+  context->outputFD = open(context->outputPath, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+  if (context->outputFD == -1) {
+    log_error("could not open output fifo %s: %s", context->outputPath, strerror(errno));
+    lldb_remove_output_fifo(context);
+    return;
+  }
+  if (fcntl(context->outputFD, F_SETPIPE_SZ, PROCESS_OUTPUT_PIPE_SIZE) == -1) {
+    log_debug("could not grow output fifo: %s", strerror(errno));
+  }
+}
+
 void lldb_run_executable(DebugContext *context, const char **argv) {
   lldb::SBError error;
   lldb::SBLaunchInfo launch_info(argv);
+
+  lldb_open_output_fifo(context);
+  if (context->outputPath[0] != 0) {
+    launch_info.AddOpenFileAction(STDOUT_FILENO, context->outputPath, false, true);
+    launch_info.AddOpenFileAction(STDERR_FILENO, context->outputPath, false, true);
+  }
+
   context->process = context->target.Launch(launch_info, error);
   if (!context->process.IsValid() || !error.IsValid()) {
     log_error("lldb failed to launch debug process for executable\n");
   }  
+
+  //NOTE(Torin) The inferior has its end open once launch returns
+  lldb_remove_output_fifo(context);
+}
+
+//NOTE(Torin) Never blocks, returns 0 when there is nothing to read
+static size_t
+lldb_read_process_output(DebugContext *context, char *buffer, size_t bufferSize)
+{
+  if (context->outputFD == -1) return 0;
+  ssize_t result = read(context->outputFD, buffer, bufferSize);
+  if (result == -1) {
+    if (errno != EAGAIN && errno != EINTR) {
+      log_error("failed to read process output: %s", strerror(errno));
+    }
+    return 0;
+  }
+  return (size_t)result;
 }
 
 struct PrintValue {
@@ -99,19 +207,16 @@ struct PrintInfo {
   PrintValue values[16];
 };
 
-//XXX TODO(TORIN) fix hacxz
-static char string_test[128];
-
-
-
-PrintInfo lldb_print_identifier(DebugContext *context, const char *identifier)  {
+//NOTE(Torin) The strings in the returned PrintInfo are copied into the
+//provided arena so they do not point into storage owned by lldb
+PrintInfo lldb_print_identifier(DebugContext *context, const char *identifier, MemoryArena *arena)  {
   PrintInfo info = {};
 
-  auto AddPrintValue = [](PrintInfo& info, lldb::SBValue& value) {
+  auto AddPrintValue = [arena](PrintInfo& info, lldb::SBValue& value) {
     PrintValue& printValue = info.values[info.value_count];
-    printValue.name_string = value.GetName();
-    printValue.type_string = value.GetTypeName();
-    printValue.value_string = value.GetValue();
+    printValue.name_string = PushCString(arena, value.GetName());
+    printValue.type_string = PushCString(arena, value.GetTypeName());
+    printValue.value_string = PushCString(arena, value.GetValue());
     if (value.GetNumChildren() > 0) {
       printValue.value_string = "...";
     }
@@ -126,10 +231,10 @@ PrintInfo lldb_print_identifier(DebugContext *context, const char *identifier)
     info.value_count++;
   };
 
-  static auto AddTypePrintValue = [](PrintInfo& info, const char *name, const char *type){
+  auto AddTypePrintValue = [arena](PrintInfo& info, const char *name, const char *type){
     PrintValue& printValue = info.values[info.value_count];
-    printValue.name_string = name; 
-    printValue.type_string = type; 
+    printValue.name_string = PushCString(arena, name); 
+    printValue.type_string = PushCString(arena, type); 
     printValue.value_string = 0; 
     if (printValue.value_string == NULL)
       printValue.value_string = "INVALID VALUE";
@@ -182,7 +287,7 @@ PrintInfo lldb_print_identifier(DebugContext *context, const char *identifier)
   if (!is_expr_compound) {
     lldb::SBType type = context->target.FindFirstType(temp);
     if (type.IsValid()) {
-      info.values[0].type_string = type.GetName();
+      info.values[0].type_string = PushCString(arena, type.GetName());
       info.values[0].name_string = " ";
       info.values[0].value_string = " ";
       info.value_count = 1;
@@ -217,24 +322,14 @@ PrintInfo lldb_print_identifier(DebugContext *context, const char *identifier)
     
     if (strcmp(base_value.GetTypeName(), "const char *") == 0) {
       base_value.SetFormat(lldb::Format::eFormatCString);
-      info.values[info.value_count].value_string = base_value.GetValue(); 
+      info.values[info.value_count].value_string = PushCString(arena, base_value.GetValue()); 
       if (info.values[info.value_count].value_string == NULL) {
         info.values[info.value_count].value_string = "NULL";
       }
-      info.values[info.value_count].name_string = base_value.GetName(); 
-      info.values[info.value_count].type_string = base_value.GetTypeName(); 
+      info.values[info.value_count].name_string = PushCString(arena, base_value.GetName()); 
+      info.values[info.value_count].type_string = PushCString(arena, base_value.GetTypeName()); 
       info.value_count++;
     }
-#if 0
-      if (child_count > 0) {
-        for (uint32_t i = 0; i < child_count; i++) {
-            lldb::SBValue child = base_value.GetChildAtIndex(i);
-            string_test[i] = child.GetValue()[0];
-          }
-          string_test[child_count] = 0;
-          info.values[info.value_count].value_string = string_test;
-        }
-#endif
 
         else if (child_count > 0) {
 
@@ -26,6 +26,8 @@ static void AddConsoleEntryFmt(const char *fmt, ...);
 #include <cmath>
 #include <functional>
 
+#include "arena.cpp"
+
 #if 0
 #include "gdb_backend.cpp"
 #else
@@ -73,6 +75,14 @@ struct RGBA8
   uint8_t a;
 };
 
+#include "text_buffer.cpp"
+#include "syntax.cpp"
+#include "fuzzy_search.cpp"
+#include "glyph_atlas.cpp"
+#include "source_cache.cpp"
+#include "console.cpp"
+#include "headless.cpp"
+
 struct Panel 
 {
   uint32_t x, y;
@@ -106,8 +116,11 @@ struct SyntaxStyle {
   RGBA8 typeColor;
   RGBA8 identColor;
   RGBA8 valueColor;
+  RGBA8 changedValueColor;
   RGBA8 stringColor;
   RGBA8 commentColor;
+  RGBA8 numberColor;
+  RGBA8 preprocessorColor;
 };
 
 struct InputState
@@ -123,32 +136,33 @@ struct StringBuffer
   size_t used;
 };
 
-enum ConsoleEntryType {
-  ConsoleEntryType_APPLICATION,
-  ConsoleEntryType_DEBUGGER,
-};
-
-struct ConsoleEntry {
-  ConsoleEntryType type;
-  const char *text;
-  size_t length;
-};
-
-struct Console {
-  static const size_t MAX_ENTRY_COUNT = 1024;
-
-  uint32_t entryCount;
-  ConsoleEntry entries[MAX_ENTRY_COUNT];
-  StringBuffer buffer;
-};
+//NOTE(Torin) Children are only materialized when an expression is expanded
+//and only one page of them at a time so watching huge arrays stays cheap
+#define EXPRESSION_PAGE_SIZE 256
+#define EXPRESSION_NAME_CAPACITY 1024
+#define EXPRESSION_VALUE_CAPACITY 256
+//NOTE(Torin) Aggregates bigger than this are not read just to hash them
+#define EXPRESSION_HASH_BYTE_LIMIT 4096
 
 struct Expression {
   bool isExpanded;
+  bool isPointer;
+  //NOTE(Torin) Set when the hash does not cover the children: synthetic
+  //providers (std::vector, std::string) and aggregates over the hash limit
+  bool hasUnhashedChildren;
   const char *name;
   const char *type;
   const char *value;
   uint32_t childCount;
   uint32_t depth;
+  uint32_t indexInParent;
+  uint32_t pageIndex;
+  uint32_t materializedChildCount;
+  uint32_t lastUpdateStopID;
+  uint32_t changedStopID;
+  uint32_t subtreeChangedStopID;
+  uint64_t valueHash;
+  char *valueStorage;
   Expression *children;
 };
 
@@ -162,6 +176,19 @@ struct ExpressionList {
   Expression *expressions[128]; 
   uint32_t count;
   uint32_t currentLineNumber;
+
+  uint32_t topRow;
+  uint32_t visibleRowCount;
+  uint32_t currentStopID;
+  bool showChangedOnly;
+
+  uint32_t reportedStopID;
+  uint32_t refreshFetchedCount;
+  uint32_t refreshSkippedCount;
+
+  MemoryPool rootPool;
+  MemoryPool pagePool;
+  MemoryPool valuePool;
 };
 
 struct BreakpointList {
@@ -186,6 +213,9 @@ struct Controls {
 
   bool showFuzzySearch;
   bool continueExecution;
+  bool toggleChangedOnly;
+  bool toggleDebugOverlay;
+  bool cycleConsoleFilter;
   
   bool isActionDown;
   bool isRemoveDown;
@@ -204,22 +234,27 @@ struct GUIContext
   uint32_t screen_width;
   uint32_t screen_height;
 
-  char active_filename[256];
+  //NOTE(Torin) session lives until exit, each cached source file has its own
+  //arena, stop is reset when the inferior resumes, hover when the identifier
+  //under the mouse is printed again and frame every frame
+  MemoryArena sessionArena;
+  MemoryArena stopArena;
+  MemoryArena hoverArena;
+  MemoryArena frameArena;
+  bool showDebugOverlay;
+
+  char active_filename[PATH_MAX];
   size_t active_filename_length;
-  char *active_filedata;
-  size_t active_filesize;
+  SourceCache sourceCache;
+  SourceFile *activeSource;
 
-  const char **functionNameList;
-  size_t functionNameListCount;
+  SymbolSearch symbolSearch;
   
   BreakpointList breakpointList;
   bool breakpointWasJustHit;
 
   ExpressionList expressionList;
 
-  uint32_t line_offsets[10000];
-  uint32_t line_count;
-
   uint32_t cursor_line_number;
   uint32_t cursor_column_number;
   float cursor_time_elapsed_since_last_blink;
@@ -276,6 +311,31 @@ struct GUIContext
   SDL_Window *window;  
   TTF_Font *font;
 
+  GlyphAtlas glyphAtlases[4];
+  uint32_t glyphAtlasCount;
+  TTF_Font *failedGlyphAtlasFont;
+  TextBatch textBatch;
+  float frameMilliseconds;
+  float hoverMicroseconds;
+
+  uint64_t processOutputBytes;
+  uint64_t processOutputWindowBytes;
+  uint64_t processOutputWindowBegin;
+  float processOutputMegabytesPerSecond;
+
+  //NOTE(Torin) @Damage The text, output and watch panels are drawn into
+  //panelCache and only redrawn when their signature changes, the tooltip
+  //and other overlays are composited on top of it
+  SDL_Texture *panelCache;
+  uint64_t panelSignatures[PanelType_Count];
+  bool isPanelDirty[PanelType_Count];
+  bool hadInputEvent;
+  bool wasLastFrameIdle;
+  bool wasOverlayVisible;
+  uint32_t panelsRedrawnLastFrame;
+  uint64_t framesPresented;
+  uint64_t framesSkipped;
+
   Controls controls;
 
   //GDBContext gdb;
@@ -336,14 +396,15 @@ void ClearStringBuffer(StringBuffer *buffer) {
 //===========================================================
 static 
 void AddConsoleEntryFmt(const char *fmt, ...) {
-  Console& console = GetConsole();
+  char text[2048];
   va_list args;
   va_start(args, fmt);
-  ConsoleEntry& entry = console.entries[console.entryCount];
-  entry.text = AppendFmtToStringBuffer(&console.buffer, &entry.length, fmt, args);
-  entry.type = ConsoleEntryType_DEBUGGER;
-  console.entryCount++;
+  int length = vsnprintf(text, sizeof(text) - 1, fmt, args);
   va_end(args);
+  if (length < 0) return;
+  if ((size_t)length > sizeof(text) - 2) length = sizeof(text) - 2;
+  text[length++] = '\n';
+  AppendConsoleText(&GetConsole(), ConsoleEntryType_DEBUGGER, text, length);
 }
 
 #include "expression.cpp"
@@ -381,8 +442,6 @@ static inline void screen_to_panel_text_region_coordinates(GUIContext * context,
 static inline void gui_goto_line(GUIContext *context, uint32_t line_number);
 static inline void gui_draw_panel(GUIContext* context, Panel *panel, const PanelStyle& style);
 
-//static inline void GUIShowFuzzySearch(GUIContext *context);
-
 void ToggleBreakpointAtLine(GUIContext *context, const uint32_t requestedLineNumber) {
   BreakpointList& bpList = context->breakpointList;
   for (uint32_t i = 0; i < bpList.breakpointCount; i++) {
@@ -432,54 +491,31 @@ static inline
 void SetActiveSourceFile(GUIContext *context, const char *filename)
 {
   size_t filenameLength = strlen(filename);
-  assert(filenameLength < ARRAYCOUNT(context->active_filename));
+  if (filenameLength >= ARRAYCOUNT(context->active_filename)) {
+    log_error("path is too long to display: %.64s...", filename);
+    return;
+  }
   context->active_filename_length = filenameLength;
   memcpy(context->active_filename, filename, filenameLength);
   context->active_filename[filenameLength] = 0;
 
-  //We assume that if the file is not found this is an internal error because all the paths
-  //should have been confirmed to be valid before now
-  //TODO(Torin) add a more robust error checking on this file
-  FILE *file = fopen(context->active_filename, "rb");
-  if (file == nullptr) {
-    log_error("Could not find file %s."
+  //NOTE(Torin) If the file has moved or been deleted since the target was compiled
+  //there is no active source and nothing is drawn
+  uint64_t previousMissCount = context->sourceCache.missCount;
+  context->activeSource = AcquireSourceFile(&context->sourceCache, context->active_filename);
+  context->top_line_in_panel = 1;
+  if (context->activeSource == NULL) {
+    log_error("Could not load file %s. "
       "Has the file moved or been deleted since the last time the target executable was compiled?", 
       filename);
-  }
-  fseek(file, 0, SEEK_END);
-  context->active_filesize = ftell(file);
-  fseek(file, 0, SEEK_SET);
-
-  //TODO(Torin) Make check to see if the current buffer is big enough to hold the
-  //new filedata the we require to avoid calling malloc
-  if (context->active_filedata != nullptr) 
-    free(context->active_filedata);
-  context->active_filedata = (char *)malloc(context->active_filesize + 1);
-  context->active_filedata[context->active_filesize] = 0;
-  fread(context->active_filedata, 1, context->active_filesize, file);
-  fclose(file);
-
-  memset(context->line_offsets, 0, ARRAYCOUNT(context->line_offsets));
-  context->line_count = 0;
-
-  char *current = context->active_filedata;
-  uint32_t current_offset = 0;
-  context->line_offsets[0] = 0;
-  context->line_count++;
-  while (current[current_offset] != 0) {
-    if (current[current_offset] == '\n') {
-      context->line_offsets[context->line_count] = current_offset + 1;
-      context->line_count++;
-    }
-    current_offset++;
+    return;
   }
 
-  //NOTE(Torin) bad if file is empy but it doesnt matter beacause if we break in the file
-  //its imposible that its empty //TODO(Torin) unless the file has been modified and the line count
-  //no longer coresponds to the line count in the binary in which case the program would crash
-  context->line_offsets[context->line_count] = context->line_offsets[context->line_count - 1];
-  context->top_line_in_panel = 1;
-  log_debug("opened file %s", filename);
+  const TextBuffer& buffer = context->activeSource->buffer;
+  if (context->sourceCache.missCount != previousMissCount) {
+    log_debug("opened file %s: %u lines, %lu bytes indexed in %.2f ms", filename,
+      buffer.lineCount, buffer.size, buffer.indexMilliseconds);
+  }
 }
 
 #define INVALID_INDEX_32 ((uint32_t)((uint64_t)1 << 32) - 1)
@@ -504,43 +540,6 @@ uint32_t GetLineNumberAtScreenPointInPanel(int x, int y, const Panel& panel, con
   return lineNumber;
 }
 
-#if 1
-static Expression * 
-GetExpressionAtLineIndex(Expression* expr, uint32_t *currentIndex, uint32_t requestedIndex) {
-  if (*currentIndex >= requestedIndex) {
-    return expr;
-  }
-
-  *currentIndex = *currentIndex + 1;
-  if (expr->isExpanded) {
-    for(uint32_t i = 0; i < expr->childCount; i++) {
-      Expression* child = &expr->children[i];
-      auto foundExpr = GetExpressionAtLineIndex(child, currentIndex, requestedIndex);
-      if (foundExpr) {
-        return foundExpr;
-      }
-    }
-  } 
-
-  return nullptr;
-}
-#endif
-
-static Expression *
-GetExpressionAtLineIndex(ExpressionList *list, 
-uint32_t requestedIndex, uint32_t *rootIndex) {
-  uint32_t currentIndex = 0;
-  for (uint32_t i = 0; i < list->count; i++) {
-    Expression* expr = list->expressions[i];
-    Expression* result = GetExpressionAtLineIndex(expr, &currentIndex, requestedIndex);
-    if (result != nullptr) {
-      *rootIndex = currentIndex;
-      return result;
-    }
-  }
-  return nullptr;
-}
-
 static inline
 uint32_t gui_get_line_number_at_mouse(GUIContext *context) {
   int text_x, text_y;
@@ -574,13 +573,20 @@ void ProcessPanelBasedInput(GUIContext *context) {
         uint32_t lineNumber = GetLineNumberAtScreenPointInPanel(context->input.mouse_x, context->input.mouse_y, 
           context->expressionPanel, context->expressionPanelStyle);
 
-        uint32_t rootExprIndex = 0;
-        Expression *expr = GetExpressionAtLineIndex(&list, lineNumber, &rootExprIndex);
-        if(expr != nullptr){
-          if(context->controls.isRemoveDown){
-            DestroyWatchExpression(rootExprIndex, &list);
+        ExpressionRow row = {};
+        if(GetExpressionRowAtIndex(&list, list.topRow + lineNumber, &row)){
+          if(row.isPageControl){
+            //NOTE(Torin) Click pages forward, ctrl+click pages backward
+            if(context->controls.isRemoveDown){
+              if(row.expr->pageIndex > 0)
+                SetExpressionPage(row.expr, row.expr->pageIndex - 1, &list);
+            } else {
+              SetExpressionPage(row.expr, row.expr->pageIndex + 1, &list);
+            }
+          } else if(context->controls.isRemoveDown){
+            DestroyWatchExpression(row.rootIndex, &list);
           } else {
-            expr->isExpanded = !expr->isExpanded;
+            SetExpressionExpanded(row.expr, !row.expr->isExpanded, &list);
           }
         }
       }
@@ -616,86 +622,81 @@ static inline int gui_get_ident_under_point(GUIContext *context,
   int line_number = text_y / line_height;
   line_number += context->top_line_in_panel - 1;
 
-  if (line_number < (int)context->line_count) {
-    int line_length = context->line_offsets[line_number + 1] -
-      context->line_offsets[line_number];
-
-    char *line_begin = context->active_filedata + context->line_offsets[line_number];
-    char *current = line_begin;
-    int total_width = 0;
+  SourceFile *source = context->activeSource;
+  if (source != NULL && line_number >= 0 && line_number < (int)source->buffer.lineCount) {
+    uint32_t line_length = 0;
+    const char *line_begin = GetTextBufferLine(&source->buffer, 
+      line_number, &line_length);
+    const char *line_end = line_begin + line_length;
+    const char *current = line_begin;
+
+    //NOTE(Torin) Tokens are still scanned from the start of the line so that
+    //member access chains are collected but nothing is measured, the scan
+    //stops at the first token that ends past the hovered character
+    const GlyphAtlas *atlas = GetGlyphAtlas(context, context->font);
+    if (atlas == NULL) return 0;
+    const int32_t *advances = GetLineAdvances(&source->lineAdvanceCache, atlas, 
+      line_number, line_begin, line_length, &source->arena);
+    uint32_t hit_index = FindCharIndexAtOffset(advances, line_length, text_x);
+    if (hit_index >= line_length) {
+      return 0;
+    }
 
     char *write_pos = dest;
 
-    while ((current - line_begin) < line_length) {
+    while (current < line_end) {
       if (*current == '.') {
         assert((size_t)((write_pos + 1) - dest) < destSize);
         memcpy(write_pos, current, 1);
         write_pos[1] = 0;
         current++;
-        int text_width, text_height;
-        TTF_SizeText(context->font, write_pos, &text_width, &text_height);
         write_pos += 1;
-        total_width += text_width;
-        if (total_width > text_x) {
+        if ((uint32_t)(current - line_begin) > hit_index) {
           memset(dest, 0, destSize);
           return 0;
         }
       }
 
-      else if ((*current == '-' && *(current + 1) == '>')) {
+      else if ((*current == '-' && (current + 1) < line_end && *(current + 1) == '>')) {
         assert((size_t)((write_pos + 2) - dest) < destSize);
         memcpy(write_pos, current, 2);
         write_pos[2] = 0;
-        int text_width, text_height;
-        TTF_SizeText(context->font, write_pos, &text_width, &text_height);
         write_pos += 2;
         current += 2;
-        total_width += text_width;
-        if (total_width > text_x) {
+        if ((uint32_t)(current - line_begin) > hit_index) {
           memset(dest, 0, destSize);
           return 0;
         }
       }
 
       else if (isalpha(*current) || *current == '_') {
-        char *ident_begin = current;
-        while (isalnum(*current) || *current == '_' || *current == '[' || *current == ']')
+        const char *ident_begin = current;
+        while (current < line_end && (isalnum(*current) || 
+              *current == '_' || *current == '[' || *current == ']'))
           current++;
         size_t ident_length = current - ident_begin;
         assert((size_t)((write_pos + ident_length) - dest) < destSize);
         memcpy(write_pos, ident_begin, ident_length);
         write_pos[ident_length] = 0;
-        int text_width, text_height;
-        TTF_SizeText(context->font, write_pos, &text_width, &text_height);
         write_pos += ident_length;
-        total_width += text_width;
-        if (total_width > text_x) {
+        if ((uint32_t)(current - line_begin) > hit_index) {
           return 1;
         }
       }
 
       else {
         write_pos = dest;
-        char *text_begin = current;
         if (isspace(*current)) {
-          while (isspace(*current))
+          while (current < line_end && isspace(*current))
             current++;
         } else if (isdigit(*current)) {
-          while (!isspace(*current))
+          while (current < line_end && !isspace(*current))
             current++;
         } else {
           current++;
         }
 
-        size_t text_length = current - text_begin;
-        memcpy(write_pos, text_begin, text_length);
-        write_pos[text_length] = 0;
-
-        int text_width, text_height;
-        TTF_SizeText(context->font, dest, &text_width, &text_height);
-        total_width += text_width;
-
-        if (total_width > text_x) {
+        if ((uint32_t)(current - line_begin) > hit_index) {
           memset(dest, 0, destSize);
           return 0;
         }
@@ -706,43 +707,65 @@ static inline int gui_get_ident_under_point(GUIContext *context,
 }
 
 
-  static inline
-int copy_line_to_buffer(GUIContext* context, uint32_t lineNumber, char *buffer, size_t bufferLength) 
-{
-  assert(lineNumber < context->line_count);
-  uint32_t lineIndex = lineNumber - 1;
-
-  uint32_t lineOffsetA = context->line_offsets[lineIndex];
-  uint32_t lineOffsetB = context->line_offsets[lineIndex+1];
-  const char *lineData = context->active_filedata + lineOffsetA;
-  uint32_t lineLength = lineOffsetB - lineOffsetA;
-  //NOTE(Torin) This is to remove the newline char since we are storing
-  //the offset into the filebuffer rather than lineLengths directly
-  //TODO(Torin) This will break with non unix line endings
-  //consider just storing the length and a pointer upfront with each line entry
-  if (lineLength > 0) {
-    lineLength--;
+static inline
+RGBA8 GetSyntaxColor(const SyntaxStyle& style, uint8_t kind, const RGBA8& defaultColor) {
+  switch (kind) {
+    case SyntaxKind_Keyword: return style.keywordColor;
+    case SyntaxKind_Type: return style.typeColor;
+    case SyntaxKind_Number: return style.numberColor;
+    case SyntaxKind_String: return style.stringColor;
+    case SyntaxKind_Comment: return style.commentColor;
+    case SyntaxKind_Preprocessor: return style.preprocessorColor;
   }
+  return defaultColor;
+}
 
-  size_t bufferIndex = 0;
-  for (uint32_t i = 0; i < lineLength; i++) {
-    if (lineData[i] == '\t') {
-      buffer[bufferIndex] = ' ';
-      buffer[bufferIndex+1] = ' ';
-      bufferIndex += 2;
-      if (bufferIndex > bufferLength) {
-        return 0;
-      }
-    } else {
-      buffer[bufferIndex] = lineData[i];
-      bufferIndex++;
-      if (bufferIndex > bufferLength) {
-        return 0;
+//NOTE(Torin) Tabs are drawn as two spaces which GetLineAdvances relies on for
+//hit testing. Glyphs are measured as they are copied out, like DrawConsole
+//does, so nothing past maxX is pushed to the text batch
+static void
+DrawSourceLine(GUIContext *context, uint32_t lineIndex, int x, int y, int maxX, 
+const RGBA8& defaultColor)
+{
+  SourceFile *source = context->activeSource;
+  const GlyphAtlas *atlas = GetGlyphAtlas(context, context->font);
+  if (atlas == NULL) return;
+  uint32_t runCount = 0;
+  const SyntaxRun *runs = HighlightSourceLine(&source->syntaxCache, &source->buffer,
+    lineIndex, &context->frameArena, &runCount);
+  uint32_t lineLength = 0;
+  const char *lineData = GetTextBufferLine(&source->buffer, lineIndex, &lineLength);
+
+  int spaceWidth = atlas->glyphRects[GetGlyphIndex(' ')].w;
+  bool isClipped = false;
+  char expanded[256];
+  for (uint32_t i = 0; i < runCount && !isClipped; i++) {
+    const SyntaxRun& run = runs[i];
+    RGBA8 color = GetSyntaxColor(context->syntaxStyle, run.kind, defaultColor);
+    uint32_t current = run.begin;
+    uint32_t end = run.begin + run.length;
+    while (current < end && !isClipped) {
+      uint32_t expandedLength = 0;
+      int expandedX = x;
+      while (current < end && expandedLength + 2 <= ARRAYCOUNT(expanded)) {
+        char c = lineData[current];
+        int width = (c == '\t') ? spaceWidth * 2 : atlas->glyphRects[GetGlyphIndex(c)].w;
+        if (expandedX + width > maxX) {
+          isClipped = true;
+          break;
+        }
+        expandedX += width;
+        if (c == '\t') {
+          expanded[expandedLength++] = ' ';
+          expanded[expandedLength++] = ' ';
+        } else {
+          expanded[expandedLength++] = c;
+        }
+        current++;
       }
+      x += DrawTextRun(context, context->font, expanded, expandedLength, x, y, color);
     }
-  } 
-  buffer[bufferIndex] = 0;
-  return 1;
+  }
 }
 
 static inline
@@ -774,60 +797,182 @@ void gui_render_buffer(GUIContext *context)
     }
   }
   
-  SDL_Color color = { 215, 215, 215, 255 };
-  uint32_t line_count_to_render = min(context->max_lines_in_panel, context->line_count);
+  RGBA8 color = { 215, 215, 215, 255 };
+  uint32_t line_count = GetActiveSourceLineCount(context);
+  uint32_t line_count_to_render = 0;
+  if (context->top_line_in_panel <= line_count) {
+    line_count_to_render = min(context->max_lines_in_panel, 
+      line_count - context->top_line_in_panel + 1);
+  }
 
 
   uint32_t lineNumberRectWidth = GetRequiredLineNumberRectWidth(context);
+  int maxTextX = (int)(panel->x + panel->w - style.border_size);
   
   for (uint32_t i = 0; i < line_count_to_render; i++) {
     uint32_t lineNumber = context->top_line_in_panel + i;
-    char line_buffer[512];
-    copy_line_to_buffer(context, lineNumber, line_buffer, ARRAYCOUNT(line_buffer)); 
 
     uint32_t verticalDisplacementPerLine = context->line_spacing + context->font_size;
 
 
+    int textX = (int)(style.border_size + style.pad_left);
+    int textY = (int)((i * verticalDisplacementPerLine) + style.border_size + (int)style.pad_top);
     if (style.drawLineNumbers) {
       char lineNumberText[10];
-      snprintf(lineNumberText, 10, "%d", (int)lineNumber);
-     
-      SDL_Surface *lineNumberSurface = TTF_RenderText_Blended(context->font, 
-          lineNumberText, color);
-      SDL_Texture *lineNumberTexture = SDL_CreateTextureFromSurface(context->renderer, 
-          lineNumberSurface);
-
-      SDL_Rect lineNumberRect =  {
-        (int)(style.border_size + style.pad_left),
-        (int)((i * verticalDisplacementPerLine) + style.border_size + (int)style.pad_top),
-        lineNumberSurface->w,
-        lineNumberSurface->h,
-      };
-
-      SDL_RenderCopy(context->renderer, lineNumberTexture, NULL, &lineNumberRect);
-      SDL_DestroyTexture(lineNumberTexture);
-      SDL_FreeSurface(lineNumberSurface);
+      int lineNumberLength = snprintf(lineNumberText, 10, "%d", (int)lineNumber);
+      DrawTextRun(context, context->font, lineNumberText, lineNumberLength, textX, textY, color);
+      textX += lineNumberRectWidth; 
     }
 
-    if (line_buffer[0] != 0) {
-      SDL_Surface *text_surface = TTF_RenderText_Blended(context->font, line_buffer, color);
-      
-      SDL_Rect text_rect = {
-          (int)(style.border_size + style.pad_left),
-          (int)((i * verticalDisplacementPerLine) + style.border_size + (int)style.pad_top),
-          text_surface->w,
-          text_surface->h
-      };
-
-      if (style.drawLineNumbers) {
-        text_rect.x += lineNumberRectWidth; 
+    DrawSourceLine(context, lineNumber - 1, textX, textY, maxTextX, color);
+  }
+}
+
+static void
+ShowSourceLocation(GUIContext *context, lldb::SBFileSpec fileSpec, uint32_t lineNumber)
+{
+  char path[PATH_MAX];
+  if (fileSpec.GetPath(path, sizeof(path)) >= sizeof(path)) {
+    log_error("path is too long to display");
+    return;
+  }
+  if (strcmp(path, context->active_filename)) {
+    SetActiveSourceFile(context, path);
+  }
+  gui_goto_line(context, lineNumber);
+}
+
+static void
+SelectSymbolSearchResult(GUIContext *context)
+{
+  SymbolSearch& search = context->symbolSearch;
+  if (search.resultCount == 0) return;
+  const SymbolEntry& entry = search.entries[search.results[search.selectedResult].entryIndex];
+  lldb::SBTarget& target = context->debug_context.target;
+
+  switch (entry.kind) {
+    case SymbolKind_Function: {
+      lldb::SBModule module = target.GetModuleAtIndex(entry.moduleIndex);
+      lldb::SBSymbol symbol = module.GetSymbolAtIndex(entry.symbolIndex);
+      lldb::SBLineEntry lineEntry = symbol.GetStartAddress().GetLineEntry();
+      if (lineEntry.IsValid()) {
+        ShowSourceLocation(context, lineEntry.GetFileSpec(), lineEntry.GetLine());
+      } else {
+        log_info("no line information for %s", entry.name);
       }
+    } break;
+
+    case SymbolKind_Global: {
+      lldb::SBValue value = target.FindFirstGlobalVariable(entry.name);
+      lldb::SBDeclaration declaration = value.GetDeclaration();
+      if (declaration.IsValid()) {
+        ShowSourceLocation(context, declaration.GetFileSpec(), declaration.GetLine());
+      } else {
+        log_info("no declaration for %s", entry.name);
+      }
+    } break;
+
+    case SymbolKind_Type: {
+      lldb::SBType type = target.FindFirstType(entry.name);
+      if (type.IsValid()) {
+        log_info("type %s: %lu bytes", type.GetName(), (unsigned long)type.GetByteSize());
+      }
+    } break;
 
-          SDL_Texture *text_texture = SDL_CreateTextureFromSurface(context->renderer, text_surface);
-      SDL_RenderCopy(context->renderer, text_texture, NULL, &text_rect);
-      SDL_DestroyTexture(text_texture);
-      SDL_FreeSurface(text_surface);
+    case SymbolKind_File: {
+      char path[PATH_MAX];
+      strncpy(path, entry.name, sizeof(path) - 1);
+      path[sizeof(path) - 1] = 0;
+      SetActiveSourceFile(context, path);
+      gui_goto_line(context, 1);
+    } break;
+  }
+}
+
+//NOTE(Torin) While the search is open it takes all keyboard input
+static bool
+ProcessSymbolSearchEvent(GUIContext *context, const SDL_Event& event)
+{
+  SymbolSearch *search = &context->symbolSearch;
+  if (event.type == SDL_TEXTINPUT) {
+    AppendSymbolSearchQuery(search, event.text.text);
+    return true;
+  }
+
+  if (event.type != SDL_KEYDOWN) return false;
+  switch (event.key.keysym.sym) {
+    case SDLK_ESCAPE: {
+      SetSymbolSearchVisible(search, false);
+      SDL_StopTextInput();
+    } break;
+    case SDLK_RETURN: {
+      SelectSymbolSearchResult(context);
+      SetSymbolSearchVisible(search, false);
+      SDL_StopTextInput();
+    } break;
+    case SDLK_BACKSPACE: {
+      PopSymbolSearchQuery(search);
+    } break;
+    case SDLK_UP: {
+      if (search->selectedResult > 0) search->selectedResult--;
+    } break;
+    case SDLK_DOWN: {
+      if (search->selectedResult + 1 < search->resultCount) search->selectedResult++;
+    } break;
+  }
+  return true;
+}
+
+static void
+GUIShowFuzzySearch(GUIContext *context)
+{
+  SymbolSearch& search = context->symbolSearch;
+  StepSymbolSearch(&search, SYMBOL_SEARCH_FRAME_BUDGET_MS);
+
+  const PanelStyle& style = context->mouseOverPanelStyle;
+  int lineHeight = (int)(context->line_spacing + context->font_size);
+  Panel panel = {};
+  panel.w = context->screen_width / 2;
+  panel.h = ((search.resultCount + 2) * lineHeight) + style.pad_top + 
+    style.pad_bottom + (style.border_size * 2);
+  panel.x = (context->screen_width - panel.w) / 2;
+  panel.y = context->screen_height / 8;
+  gui_draw_panel(context, &panel, style);
+
+  RGBA8 textColor = { 236, 236, 236, 255 };
+  RGBA8 dimColor = { 140, 140, 140, 255 };
+  int x = (int)(panel.x + style.border_size + style.pad_left);
+  int y = (int)(panel.y + style.border_size + style.pad_top);
+
+  char text[256];
+  int length = snprintf(text, sizeof(text), "> %s_", search.query);
+  DrawTextRun(context, context->font, text, length, x, y, textColor);
+  y += lineHeight;
+
+  if (search.isScanning) {
+    length = snprintf(text, sizeof(text), "%u matches, searching %u/%u",
+      search.matchCount, search.scannedCount, search.scanCount);
+  } else {
+    length = snprintf(text, sizeof(text), "%u matches of %u symbols in %.2f ms",
+      search.matchCount, search.entryCount, search.queryMilliseconds);
+  }
+  DrawTextRun(context, context->font, text, length, x, y, dimColor);
+  y += lineHeight;
+
+  for (uint32_t i = 0; i < search.resultCount; i++) {
+    const SymbolEntry& entry = search.entries[search.results[i].entryIndex];
+    if (i == search.selectedResult) {
+      FlushTextBatch(&context->textBatch);
+      SDL_Rect rect = { (int)panel.x + (int)style.border_size, y, 
+        (int)panel.w - (int)(style.border_size * 2), lineHeight };
+      SDL_SetRenderDrawColor(context->renderer, 80, 80, 120, 255);
+      SDL_RenderFillRect(context->renderer, &rect);
     }
+    int kindWidth = DrawTextRun(context, context->font, SYMBOL_KIND_NAMES[entry.kind], 
+      strlen(SYMBOL_KIND_NAMES[entry.kind]), x, y, dimColor);
+    DrawTextRun(context, context->font, entry.name, entry.nameLength, 
+      x + max(kindWidth, 56) + 8, y, textColor);
+    y += lineHeight;
   }
 }
 
@@ -838,6 +983,9 @@ void gui_update_input(GUIContext *context)
   while (SDL_PollEvent(&event))
   {
     ImGui_ImplSdl_ProcessEvent(&event);
+    if (context->symbolSearch.isVisible && ProcessSymbolSearchEvent(context, event))
+      continue;
+
     switch(event.type)
     {
         case SDL_QUIT:
@@ -847,6 +995,7 @@ void gui_update_input(GUIContext *context)
 
         case SDL_KEYDOWN:
         {
+            context->hadInputEvent = true;
 
             if (event.key.keysym.sym == SDLK_a) {
               context->controls.stepOver = true;
@@ -858,6 +1007,12 @@ void gui_update_input(GUIContext *context)
               context->linesToScroll -= 1;
             } else if (event.key.keysym.sym == SDLK_c) {
               context->controls.continueExecution = true;
+            } else if (event.key.keysym.sym == SDLK_f) {
+              context->controls.toggleChangedOnly = true;
+            } else if (event.key.keysym.sym == SDLK_F1) {
+              context->controls.toggleDebugOverlay = true;
+            } else if (event.key.keysym.sym == SDLK_F2) {
+              context->controls.cycleConsoleFilter = true;
             } else if (event.key.keysym.sym == SDLK_p) {
               if (event.key.keysym.mod & (KMOD_CTRL)) {
                 context->controls.showFuzzySearch = true;
@@ -870,6 +1025,7 @@ void gui_update_input(GUIContext *context)
         } break;
 
         case SDL_KEYUP: {
+          context->hadInputEvent = true;
           if (event.key.keysym.sym == SDLK_LCTRL){
             context->controls.isRemoveDown = false;
           }
@@ -887,10 +1043,12 @@ void gui_update_input(GUIContext *context)
 
         case SDL_MOUSEWHEEL: 
         {
+          context->hadInputEvent = true;
           context->linesToScroll -= (event.wheel.y * 2);
         } break;
 
         case SDL_MOUSEBUTTONDOWN: {
+          context->hadInputEvent = true;
           context->controls.isActionDown = true;
           uint32_t keymod = SDL_GetModState(); 
           if (keymod & KMOD_CTRL) {
@@ -909,7 +1067,8 @@ void gui_goto_line(GUIContext *context, uint32_t line_number)
 {
   int realitiveCenterLineNumber = (int)context->max_lines_in_panel / 2;
   int requested_top_line = (int)line_number - realitiveCenterLineNumber;
-  int max_top_line_possible = context->line_count - context->max_lines_in_panel;
+  int max_top_line_possible = (int)GetActiveSourceLineCount(context) + 1 - 
+    (int)context->max_lines_in_panel;
   if (max_top_line_possible < 1) 
     max_top_line_possible = 1;
 
@@ -925,27 +1084,68 @@ void gui_goto_line(GUIContext *context, uint32_t line_number)
 
 static inline
 void gui_set_top_line(GUIContext *context, int line_number) {
+  int max_top_line_possible = (int)GetActiveSourceLineCount(context) + 1 - 
+    (int)context->max_lines_in_panel;
+  if (line_number > max_top_line_possible) {
+    line_number = max_top_line_possible;
+  }
   if (line_number < 1) {
     line_number = 1;
-  } else {
-    line_number = min(line_number, 
-      context->line_count - context->max_lines_in_panel);    
   }
   context->top_line_in_panel = line_number;
 }
 
+//NOTE(Torin) The first row of the console panel is its header
+static inline
+uint32_t GetConsoleVisibleRowCount(const Panel& panel, const PanelStyle& style) {
+  int lineHeight = (int)(style.lineSpacing + style.fontSize);
+  int textHeight = (int)panel.h - (int)((style.border_size * 2) + style.pad_top + style.pad_bottom);
+  int result = (textHeight / lineHeight) - 1;
+  return result > 0 ? (uint32_t)result : 0;
+}
+
 static inline
 void gui_process_input(GUIContext *context) 
 {
 
   const InputState& input = context->input;
   if (context->linesToScroll) {
-    //GetPanelUnderPoint(input.mouse_x, input.mouse_y);
-
-    gui_set_top_line(context, context->top_line_in_panel + context->linesToScroll);
+    uint32_t panelIndex = GetPanelIndexFromPoint(context, input.mouse_x, input.mouse_y);
+    if (panelIndex == PanelType_ExpressionList) {
+      ScrollExpressionList(&context->expressionList, context->linesToScroll);
+    } else if (panelIndex == PanelType_Output) {
+      ScrollConsole(&GetConsole(), context->linesToScroll, 
+        GetConsoleVisibleRowCount(context->output_panel, context->output_style));
+    } else {
+      gui_set_top_line(context, context->top_line_in_panel + context->linesToScroll);
+    }
     context->linesToScroll = 0;
   }
   
+  if (context->controls.toggleChangedOnly) {
+    ExpressionList *list = &context->expressionList;
+    list->showChangedOnly = !list->showChangedOnly;
+    list->topRow = 0;
+  }
+
+  if (context->controls.toggleDebugOverlay) {
+    context->showDebugOverlay = !context->showDebugOverlay;
+  }
+
+  if (context->controls.cycleConsoleFilter) {
+    CycleConsoleFilter(&GetConsole());
+  }
+
+  if (context->controls.showFuzzySearch) {
+    SetSymbolSearchVisible(&context->symbolSearch, true);
+    SDL_StartTextInput();
+  }
+
+  if (context->controls.stepOver || context->controls.stepInto ||
+      context->controls.continueExecution) {
+    ResetMemoryArena(&context->stopArena);
+  }
+
   if (context->controls.stepOver) {
     // write_literal(context->gdb.output_pipe, "next\n");
     lldb_step_over(&context->debug_context);
@@ -968,34 +1168,83 @@ void gui_process_input(GUIContext *context)
 }
 
 static inline
-void InitStringBuffer(StringBuffer *buffer, size_t size) {
+void InitStringBuffer(StringBuffer *buffer, size_t size, MemoryArena *arena) {
   buffer->used = 0;
   buffer->size = size;
-  buffer->memory = (char *)malloc(size);
+  buffer->memory = (char *)PushSize(arena, size);
 }
 
 #define FONT_FILE "/usr/share/fonts/TTF/DejaVuSans.ttf"
 
 
-static inline
-const char** CreateTypeNameList(uint32_t mask, size_t *outCount, lldb::SBTarget target) {
-  const char** result = 0;
-  lldb::SBModule module = target.GetModuleAtIndex(0);
-  assert(module.GetNumCompileUnits() >= 1);
-  for(size_t i = 0; i < module.GetNumCompileUnits(); i++){
-    auto compileUnit = module.GetCompileUnitAtIndex(i);
-    auto typeList = compileUnit.GetTypes(mask);//MASK functions
-    result = (const char **)malloc(sizeof(char*) * typeList.GetSize()); 
-    for(size_t i = 0; i < typeList.GetSize(); i++){
-      auto type = typeList.GetTypeAtIndex(i);
-      result[i] = type.GetName();
+//NOTE(Torin) Functions and globals come from the symbol tables of the executable
+//and every shared library the target knows about, their locations are only
+//looked up when one is picked
+static void
+BuildSymbolSearchIndex(SymbolSearch *search, lldb::SBTarget target, MemoryArena *arena) 
+{
+  const uint32_t typeMask = lldb::eTypeClassClass | lldb::eTypeClassStruct | 
+    lldb::eTypeClassUnion | lldb::eTypeClassEnumeration | lldb::eTypeClassTypedef;
+
+  uint32_t moduleCount = target.GetNumModules();
+  assert(moduleCount >= 1 && target.GetModuleAtIndex(0).GetNumCompileUnits() >= 1);
+  size_t totalCount = 0;
+  for (uint32_t m = 0; m < moduleCount; m++) {
+    lldb::SBModule module = target.GetModuleAtIndex(m);
+    totalCount += module.GetNumSymbols();
+    for (size_t i = 0; i < module.GetNumCompileUnits(); i++) {
+      lldb::SBCompileUnit compileUnit = module.GetCompileUnitAtIndex(i);
+      totalCount += compileUnit.GetTypes(typeMask).GetSize();
+      totalCount += compileUnit.GetNumSupportFiles() + 1;
     }
   }
-  return result;
+
+  double beginMilliseconds = GetSymbolSearchMilliseconds();
+  InitSymbolSearch(search, totalCount, arena);
+  SymbolNameSet nameSet = {};
+  InitSymbolNameSet(&nameSet, totalCount, arena);
+
+  char path[PATH_MAX];
+  for (uint32_t m = 0; m < moduleCount; m++) {
+    lldb::SBModule module = target.GetModuleAtIndex(m);
+    size_t symbolCount = module.GetNumSymbols();
+    for (size_t i = 0; i < symbolCount; i++) {
+      lldb::SBSymbol symbol = module.GetSymbolAtIndex(i);
+      const char *name = symbol.GetName();
+      if (name == NULL || name[0] == 0) continue;
+      lldb::SymbolType symbolType = symbol.GetType();
+      if (symbolType == lldb::eSymbolTypeCode) {
+        AddSymbolEntry(search, name, SymbolKind_Function, m, i, arena);
+      } else if (symbolType == lldb::eSymbolTypeData) {
+        AddUniqueSymbolEntry(search, &nameSet, name, SymbolKind_Global, m, i, arena);
+      }
+    }
+
+    for (size_t i = 0; i < module.GetNumCompileUnits(); i++) {
+      lldb::SBCompileUnit compileUnit = module.GetCompileUnitAtIndex(i);
+      lldb::SBTypeList typeList = compileUnit.GetTypes(typeMask);
+      for (size_t j = 0; j < typeList.GetSize(); j++) {
+        lldb::SBType type = typeList.GetTypeAtIndex(j);
+        const char *name = type.GetName();
+        if (name != NULL && name[0] != 0)
+          AddUniqueSymbolEntry(search, &nameSet, name, SymbolKind_Type, m, 0, arena);
+      }
+
+      if (compileUnit.GetFileSpec().GetPath(path, sizeof(path)) < sizeof(path))
+        AddUniqueSymbolEntry(search, &nameSet, path, SymbolKind_File, m, 0, arena);
+      for (uint32_t j = 0; j < compileUnit.GetNumSupportFiles(); j++) {
+        if (compileUnit.GetSupportFileAtIndex(j).GetPath(path, sizeof(path)) < sizeof(path))
+          AddUniqueSymbolEntry(search, &nameSet, path, SymbolKind_File, m, 0, arena);
+      }
+    }
+  }
+
+  log_debug("symbol-index: %u entries from %u modules in %.2f ms", search->entryCount,
+    moduleCount, GetSymbolSearchMilliseconds() - beginMilliseconds);
 }
 
 static inline
-void gui_initalize(GUIContext *context)
+void gui_initalize(GUIContext *context, size_t consoleByteCapacity)
 {
   memset(context, 0, sizeof(GUIContext));
   context->screen_width = DEFAULT_WINDOW_WIDTH;
@@ -1037,9 +1286,23 @@ void gui_initalize(GUIContext *context)
   SDL_GLContext glContext = SDL_GL_CreateContext(context->window);
   ImGui_ImplSdl_Init(context->window);
 
+  InitMemoryArena(&context->sessionArena, "session", MEMORY_ARENA_DEFAULT_BLOCK_SIZE * 8);
+  InitMemoryArena(&context->stopArena, "stop", MEMORY_ARENA_DEFAULT_BLOCK_SIZE);
+  InitMemoryArena(&context->hoverArena, "hover", MEMORY_ARENA_DEFAULT_BLOCK_SIZE);
+  InitMemoryArena(&context->frameArena, "frame", MEMORY_ARENA_DEFAULT_BLOCK_SIZE);
+
   //TODO(Torin) Revert mouseOver size back to somthing sane
-  InitStringBuffer(&context->mouseOverStringBuffer, 1024*1024*4);
-  InitStringBuffer(&GetConsole().buffer, 1024*1024);
+  InitStringBuffer(&context->mouseOverStringBuffer, 1024*1024*4, &context->sessionArena);
+  InitConsole(&GetConsole(), consoleByteCapacity, &context->sessionArena);
+
+  InitTextBatch(&context->textBatch, context->renderer, &context->sessionArena);
+
+  InitMemoryPool(&context->expressionList.rootPool, &context->sessionArena,
+    sizeof(Expression) + EXPRESSION_NAME_CAPACITY);
+  InitMemoryPool(&context->expressionList.pagePool, &context->sessionArena,
+    sizeof(Expression) * EXPRESSION_PAGE_SIZE);
+  InitMemoryPool(&context->expressionList.valuePool, &context->sessionArena,
+    EXPRESSION_VALUE_CAPACITY);
   
   context->font_size = 16;
   context->line_spacing = 4;
@@ -1063,6 +1326,12 @@ void gui_initalize(GUIContext *context)
     style.typeColor  = RGBA8 { 139, 191, 239, 255 };
     style.identColor = RGBA8 { 236, 236, 236, 255 };
     style.valueColor = RGBA8 { 217, 206, 132, 255 }; 
+    style.changedValueColor = RGBA8 { 239, 110, 90, 255 };
+    style.keywordColor = RGBA8 { 204, 153, 204, 255 };
+    style.stringColor = RGBA8 { 153, 199, 148, 255 };
+    style.commentColor = RGBA8 { 128, 128, 128, 255 };
+    style.numberColor = RGBA8 { 249, 174, 88, 255 };
+    style.preprocessorColor = RGBA8 { 95, 180, 180, 255 };
   }
 
   PanelStyle commonStyle = {};
@@ -1091,6 +1360,9 @@ void gui_initalize(GUIContext *context)
   context->text_style.border_size = 0;
 
   context->max_lines_in_panel = panel->h / (context->font_size + context->line_spacing);
+  context->expressionList.visibleRowCount = context->expressionPanel.h / 
+    (context->expressionPanelStyle.fontSize + context->expressionPanelStyle.lineSpacing);
+  context->expressionList.currentStopID = 1;
   context->is_running = true;
 
 
@@ -1118,10 +1390,11 @@ internal_lldb_process_events(GUIContext *context) {
 
         static auto updateStopInfo = [](GUIContext *context, const lldb::SBLineEntry lineEntry, const lldb::SBFileSpec fileSpec) {
           uint32_t line_number = lineEntry.GetLine();
-          char temp[1024];
-          uint32_t bytesRequired = fileSpec.GetPath(temp, ARRAYCOUNT(context->active_filename));
-          if (bytesRequired > ARRAYCOUNT(context->active_filename)) {
-            assert(false);
+          char temp[PATH_MAX];
+          uint32_t bytesRequired = fileSpec.GetPath(temp, sizeof(temp));
+          if (bytesRequired >= sizeof(temp)) {
+            log_error("path is too long to display");
+            return;
           }
 
           if (temp[0] != 0) {
@@ -1242,46 +1515,259 @@ bool isNewline(const char *str) {
   return false;
 }
 
+//NOTE(Torin) Only the rows that fit in the panel are copied out of the ring
+//and drawn, clipped to the panel width, so the cost of drawing the console
+//does not depend on how much output it holds
 static void
 DrawConsole(GUIContext *context, const Panel& panel, const PanelStyle& style) {
-  const Console& console = GetConsole();
-  uint32_t verticalDisplacementPerLine = style.lineSpacing + style.fontSize; 
-  uint32_t estimatedMaxCharsPerLine = (panel.w / style.fontSize) + 10;
-  char bufferToDraw[estimatedMaxCharsPerLine];
-  for (uint32_t i = 0; i < console.entryCount; i++) {
-    const ConsoleEntry& entry = console.entries[i];
-    char *write = bufferToDraw;
-    memset(bufferToDraw, 0, estimatedMaxCharsPerLine);
-    if (entry.type == ConsoleEntryType_DEBUGGER) {
+  uint64_t beginCounter = SDL_GetPerformanceCounter();
+  Console& console = GetConsole();
+  const GlyphAtlas *atlas = GetGlyphAtlas(context, style.font);
+  if (atlas == NULL) return;
+  int lineHeight = (int)(style.lineSpacing + style.fontSize);
+  int x = (int)(style.border_size + style.pad_left + panel.x);
+  int y = (int)(style.border_size + style.pad_top + panel.y);
+  int maxWidth = (int)panel.w - (int)((style.border_size * 2) + style.pad_left + style.pad_right);
+
+  uint32_t visibleRowCount = GetConsoleVisibleRowCount(panel, style);
+  uint64_t rowCount = GetConsoleRowCount(&console);
+  uint64_t maxScrollOffset = rowCount > visibleRowCount ? rowCount - visibleRowCount : 0;
+  if (console.scrollOffset > maxScrollOffset) console.scrollOffset = maxScrollOffset;
+  uint64_t endRow = rowCount - console.scrollOffset;
+  uint64_t beginRow = endRow > visibleRowCount ? endRow - visibleRowCount : 0;
+
+  char header[128];
+  const char *filterName = "all";
+  if (console.filterMask == (1 << ConsoleEntryType_APPLICATION)) filterName = "app";
+  else if (console.filterMask == (1 << ConsoleEntryType_DEBUGGER)) filterName = "udb";
+  int headerLength = snprintf(header, sizeof(header), "[F2 %s] %lu lines%s", 
+    filterName, (unsigned long)rowCount, console.scrollOffset ? ", scrolled back" : "");
+  RGBA8 headerColor = { 140, 140, 140, 255 };
+  DrawTextRun(context, style.font, header, headerLength, x, y, headerColor);
+  y += lineHeight;
+
+  static const size_t ROW_CAPACITY = 512;
+  char *row = PushArray(&context->frameArena, char, ROW_CAPACITY);
+  for (uint64_t i = beginRow; i < endRow; i++) {
+    const ConsoleLine *line = GetConsoleRow(&console, i);
+    char *write = row;
+    if (line->type == ConsoleEntryType_DEBUGGER) {
       memcpy_literal_and_increment_dest(write, "[UDB] ");
-    } else if (entry.type == ConsoleEntryType_APPLICATION) {
+    } else if (line->type == ConsoleEntryType_APPLICATION) {
       memcpy_literal_and_increment_dest(write, "[App] ");
     }
+    size_t rowLength = (write - row) + CopyConsoleLine(&console, line, write, 
+      ROW_CAPACITY - (write - row));
+
+    int width = 0;
+    size_t visibleLength = 0;
+    while (visibleLength < rowLength) {
+      width += atlas->glyphRects[GetGlyphIndex(row[visibleLength])].w;
+      if (width > maxWidth) break;
+      visibleLength++;
+    }
+    DrawTextRun(context, style.font, row, visibleLength, x, y, style.fontColor);
+    y += lineHeight;
+  }
 
-    //TODO(Torin) Add filtering of console entry types
-    //Draw each line of the current entry
-    //TODO(Torin) Consider newlines inside of the entry 
-    const char *entryText = console.entries[i].text;
-    uint32_t entryLength = console.entries[i].length;
-    memcpy_and_increment_dest(write, entryText, entryLength);
-    
-    SDL_Color sdlColor = { style.fontColor.r, style.fontColor.g, style.fontColor.b, style.fontColor.a };
-    SDL_Surface *text_surface = TTF_RenderText_Blended(style.font, bufferToDraw, sdlColor); 
-    
-    SDL_Rect text_rect = {
-      (int)(style.border_size + style.pad_left + panel.x),
-      (int)((i * verticalDisplacementPerLine) + 
-          style.border_size + (int)style.pad_top + panel.y),
-      text_surface->w,
-      text_surface->h
-    };
+  console.drawMicroseconds = (float)((SDL_GetPerformanceCounter() - beginCounter) * 1000000.0 / 
+    SDL_GetPerformanceFrequency());
+}
+
+//NOTE(Torin) The output pipe is drained in large reads every frame. Output
+//that does not fit under the per frame limit stays in the pipe and the
+//inferior blocks on it until the next frame, nothing is dropped
+#define PROCESS_OUTPUT_CHUNK_SIZE (256 * 1024)
+#define PROCESS_OUTPUT_FRAME_LIMIT (2 * 1024 * 1024)
 
-    SDL_Texture *text_texture = 
-      SDL_CreateTextureFromSurface(context->renderer, text_surface);
-    SDL_RenderCopy(context->renderer, text_texture, NULL, &text_rect);
-    SDL_DestroyTexture(text_texture);
-    SDL_FreeSurface(text_surface);
+static void
+DrainProcessOutput(GUIContext *context)
+{
+  char *chunk = PushArray(&context->frameArena, char, PROCESS_OUTPUT_CHUNK_SIZE);
+  size_t bytesThisFrame = 0;
+  while (bytesThisFrame < PROCESS_OUTPUT_FRAME_LIMIT) {
+    size_t bytesRead = lldb_read_process_output(&context->debug_context, 
+      chunk, PROCESS_OUTPUT_CHUNK_SIZE);
+    if (bytesRead == 0) break;
+    AppendConsoleText(&GetConsole(), ConsoleEntryType_APPLICATION, chunk, bytesRead);
+    bytesThisFrame += bytesRead;
+  }
+  context->processOutputBytes += bytesThisFrame;
+  context->processOutputWindowBytes += bytesThisFrame;
+
+  uint64_t counter = SDL_GetPerformanceCounter();
+  uint64_t frequency = SDL_GetPerformanceFrequency();
+  if (counter - context->processOutputWindowBegin >= frequency) {
+    double seconds = (double)(counter - context->processOutputWindowBegin) / frequency;
+    context->processOutputMegabytesPerSecond = (float)(context->processOutputWindowBytes / 
+      (1024.0 * 1024.0) / seconds);
+    context->processOutputWindowBytes = 0;
+    context->processOutputWindowBegin = counter;
+  }
+}
+
+//NOTE(Torin) @Damage Rather than every place that changes what a panel
+//shows having to remember to mark it dirty, each panel hashes the state its
+//drawing depends on and is redrawn when the hash changes
+#define IDLE_WAIT_RUNNING_MS 8
+#define IDLE_WAIT_STOPPED_MS 250
+
+static inline
+uint64_t MixPanelSignature(uint64_t hash, uint64_t value) {
+  hash ^= value;
+  hash *= 1099511628211ULL;
+  return hash;
+}
+
+static uint64_t
+ComputePanelSignature(GUIContext *context, uint32_t panelType)
+{
+  uint64_t result = 14695981039346656037ULL;
+  switch (panelType) {
+    case PanelType_TextBuffer: {
+      const SourceFile *source = context->activeSource;
+      result = MixPanelSignature(result, (uintptr_t)source);
+      if (source != NULL) {
+        result = MixPanelSignature(result, (uintptr_t)source->buffer.data);
+        result = MixPanelSignature(result, source->buffer.lineCount);
+      }
+      result = MixPanelSignature(result, context->top_line_in_panel);
+      result = MixPanelSignature(result, context->line_execution_stopped);
+      result = MixPanelSignature(result, context->breakpointList.breakpointCount);
+      result = MixPanelSignature(result, context->is_debugger_executing);
+      result = MixPanelSignature(result, context->breakpointWasJustHit);
+    } break;
+
+    case PanelType_ExpressionList: {
+      const ExpressionList& list = context->expressionList;
+      result = MixPanelSignature(result, list.currentStopID);
+      result = MixPanelSignature(result, list.count);
+      result = MixPanelSignature(result, list.topRow);
+      result = MixPanelSignature(result, list.showChangedOnly);
+      result = MixPanelSignature(result, list.rootPool.blocksInUse);
+      result = MixPanelSignature(result, list.pagePool.blocksInUse);
+    } break;
+
+    case PanelType_Mouseover: {
+      result = MixPanelSignature(result, (uint64_t)context->input.mouse_x);
+      result = MixPanelSignature(result, (uint64_t)context->input.mouse_y);
+      result = MixPanelSignature(result, context->mouseOverStringBuffer.used);
+      for (const char *c = context->identUnderCursor; *c != 0; c++)
+        result = MixPanelSignature(result, (uint8_t)*c);
+    } break;
+
+    case PanelType_Output: {
+      const Console& console = GetConsole();
+      result = MixPanelSignature(result, console.firstLine);
+      result = MixPanelSignature(result, console.endLine);
+      if (console.endLine > console.firstLine) {
+        result = MixPanelSignature(result, 
+          console.lines[(console.endLine - 1) & console.lineMask].length);
+      }
+      result = MixPanelSignature(result, console.scrollOffset);
+      result = MixPanelSignature(result, console.filterMask);
+    } break;
+  }
+  return result;
+}
+
+static void
+UpdatePanelDamage(GUIContext *context)
+{
+  //NOTE(Torin) Clicks and keys can change state no signature covers (expanding
+  //a watch, selecting a row) and are rare enough to just redraw everything
+  bool redrawAll = context->hadInputEvent || context->requires_refresh ||
+    context->panelCache == NULL;
+  for (uint32_t i = 0; i < PanelType_Count; i++) {
+    uint64_t signature = ComputePanelSignature(context, i);
+    if (signature != context->panelSignatures[i] || redrawAll)
+      context->isPanelDirty[i] = true;
+    context->panelSignatures[i] = signature;
   }
+  context->hadInputEvent = false;
+}
+
+static void
+RedrawPanelIfDirty(GUIContext *context, uint32_t panelType)
+{
+  if (!context->isPanelDirty[panelType]) return;
+  context->isPanelDirty[panelType] = false;
+  context->panelsRedrawnLastFrame++;
+
+  const Panel& panel = context->panels[panelType];
+  SDL_Rect rect = { (int)panel.x, (int)panel.y, (int)panel.w, (int)panel.h };
+  SDL_RenderSetClipRect(context->renderer, &rect);
+  SDL_SetRenderDrawColor(context->renderer, 0, 0, 0, 255);
+  SDL_RenderFillRect(context->renderer, &rect);
+
+  switch (panelType) {
+    case PanelType_TextBuffer: {
+      if (context->activeSource != NULL)
+        gui_render_buffer(context);
+    } break;
+    case PanelType_Output: {
+      gui_draw_panel(context, &context->output_panel, context->output_style);
+      DrawConsole(context, context->output_panel, context->output_style);
+    } break;
+    case PanelType_ExpressionList: {
+      gui_draw_panel(context, &context->expressionPanel, context->expressionPanelStyle);
+      DrawExpressionList(context, &context->expressionList, context->expressionPanel, 
+        context->expressionPanelStyle, context->syntaxStyle);
+    } break;
+  }
+
+  FlushTextBatch(&context->textBatch);
+  SDL_RenderSetClipRect(context->renderer, NULL);
+}
+
+static inline
+void EndFrameInput(GUIContext *context) {
+  bool isRemoveDown = context->controls.isRemoveDown;
+  memset(&context->controls, 0, sizeof(Controls));
+  context->controls.isRemoveDown = isRemoveDown;
+  context->requires_refresh = false;
+}
+
+//NOTE(Torin) Returns false when nothing on screen changed and the frame does
+//not need to be presented
+static bool
+RedrawDirtyPanels(GUIContext *context)
+{
+  if (context->panelCache == NULL) {
+    context->panelCache = SDL_CreateTexture(context->renderer, SDL_PIXELFORMAT_RGBA8888,
+      SDL_TEXTUREACCESS_TARGET, (int)context->screen_width, (int)context->screen_height);
+    if (context->panelCache == NULL) {
+      log_error("failed to create panel cache: %s", SDL_GetError());
+      return false;
+    }
+    SDL_SetRenderTarget(context->renderer, context->panelCache);
+    SDL_SetRenderDrawColor(context->renderer, 0, 0, 0, 255);
+    SDL_RenderClear(context->renderer);
+    SDL_SetRenderTarget(context->renderer, NULL);
+  }
+
+  context->panelsRedrawnLastFrame = 0;
+  bool isAnyPanelDirty = context->isPanelDirty[PanelType_TextBuffer] ||
+    context->isPanelDirty[PanelType_Output] || context->isPanelDirty[PanelType_ExpressionList];
+  if (isAnyPanelDirty) {
+    SDL_SetRenderTarget(context->renderer, context->panelCache);
+    RedrawPanelIfDirty(context, PanelType_TextBuffer);
+    RedrawPanelIfDirty(context, PanelType_Output);
+    RedrawPanelIfDirty(context, PanelType_ExpressionList);
+    SDL_SetRenderTarget(context->renderer, NULL);
+  }
+
+  //NOTE(Torin) Overlays that are open redraw every frame since they either
+  //show live stats or are still searching, and once more after closing
+  bool isOverlayVisible = context->showDebugOverlay || context->symbolSearch.isVisible;
+  bool result = isAnyPanelDirty || context->isPanelDirty[PanelType_Mouseover] ||
+    isOverlayVisible || context->wasOverlayVisible;
+  context->isPanelDirty[PanelType_Mouseover] = false;
+  context->wasOverlayVisible = isOverlayVisible;
+  if (result) {
+    SDL_RenderCopy(context->renderer, context->panelCache, NULL, NULL);
+  }
+  return result;
 }
 
 int main(int argc, char **argv) {
@@ -1303,6 +1789,9 @@ int main(int argc, char **argv) {
   Command commands[argc];
   uint32_t commandCount = 0;
   uint32_t executableNameIndex = 0;
+  size_t consoleByteCapacity = CONSOLE_DEFAULT_BYTE_CAPACITY;
+  bool isHeadless = false;
+  const char *scriptPath = NULL;
   for (int i = 1; i < argc; i++) {
     const char *current = argv[i];
     if (*current == '-') {
@@ -1315,6 +1804,26 @@ int main(int argc, char **argv) {
         commands[commandCount].arg = current;
         commands[commandCount].type = CommandType_SET_BREAKPOINT;
         commandCount++;
+      } else if (*current == 'n') {
+        isHeadless = true;
+      } else if (*current == 'x') {
+        //NOTE(Torin) Run headless reading commands from a script file
+        current++;
+        while(isspace(*current)) {
+          current++;
+        }
+        scriptPath = current;
+        isHeadless = true;
+      } else if (*current == 'c') {
+        //NOTE(Torin) Console size in bytes, accepts a K or M suffix
+        current++;
+        while(isspace(*current)) {
+          current++;
+        }
+        char *suffix = NULL;
+        consoleByteCapacity = strtoul(current, &suffix, 10);
+        if (*suffix == 'K' || *suffix == 'k') consoleByteCapacity *= 1024;
+        if (*suffix == 'M' || *suffix == 'm') consoleByteCapacity *= 1024 * 1024;
       } else {
         log_error("Invalid command line paramater");
         return 1;
@@ -1338,13 +1847,23 @@ int main(int argc, char **argv) {
     executable_arguments = argv[executableNameIndex + 1];
   }
 
+  if (isHeadless) {
+    const char *breakpoints[argc];
+    uint32_t breakpointCount = 0;
+    for (uint32_t i = 0; i < commandCount; i++) {
+      if (commands[i].type == CommandType_SET_BREAKPOINT)
+        breakpoints[breakpointCount++] = commands[i].arg;
+    }
+    return RunHeadless(executable_path, executable_arguments, scriptPath,
+      breakpoints, breakpointCount);
+  }
+
   GUIContext* ctx = (GUIContext *)malloc(sizeof(GUIContext));
   GUIContext& context = *ctx;
 
-  gui_initalize(&context);
+  gui_initalize(&context, consoleByteCapacity);
   lldb_initialize(&context.debug_context, executable_path);
-  ctx->functionNameList = CreateTypeNameList(lldb::eTypeClassFunction, 
-    &ctx->functionNameListCount, ctx->debug_context.target);
+  BuildSymbolSearchIndex(&ctx->symbolSearch, ctx->debug_context.target, &ctx->sessionArena);
 
   bool wasBreakpointSet = false;
   for (uint32_t i = 0; i < commandCount; i++) {
@@ -1362,6 +1881,16 @@ int main(int argc, char **argv) {
   lldb_run_executable(&context.debug_context, &executable_arguments);
   
   while (context.is_running) {
+    //NOTE(Torin) Sleep until there is input or something to poll instead of
+    //spinning on vsync when the last frame had nothing to draw
+    if (context.wasLastFrameIdle) {
+      SDL_WaitEventTimeout(NULL, context.is_debugger_executing ? 
+        IDLE_WAIT_RUNNING_MS : IDLE_WAIT_STOPPED_MS);
+    }
+
+    uint64_t frameBeginCounter = SDL_GetPerformanceCounter();
+    BeginMemoryFrame();
+    ResetMemoryArena(&context.frameArena);
     gui_update_input(&context);
     internal_lldb_process_events(&context);
     gui_process_input(&context);
@@ -1369,49 +1898,32 @@ int main(int argc, char **argv) {
     ProcessPanelBasedInput(&context);
 
     if (context.requires_refresh) {
-      ExpressionList* list = &context.expressionList;
-      for (uint32_t i = 0; i < list->count; i++) {
-        Expression* expr = list->expressions[i];
-        UpdateRootExpression(expr, &context.debug_context, true);
-      }
+      context.expressionList.currentStopID++;
     }
-
-#if 0
-    static char test[1024];
-    size_t bytesWritten = context.debug_context.process.GetSTDOUT(test, 1024);
-    if (bytesWritten) {
-      printf("bytesWritten %lu\n", bytesWritten);
+    if (context.is_debugger_executing == false) {
+      UpdateWatchExpressions(&context.expressionList, &context.debug_context);
     }
-    
-    if (test[0]) {
-      Console& console = GetConsole();
-      const char *textWritten = AppendToStringBuffer(test, bytesWritten, &console.buffer);
-      const char *current = textWritten;
-      while ((current - textWritten) < bytesWritten) {
-        const char *entryText = current;
-        while (*current != 0) {
-          current++;
-        }
-        size_t entryLength = current - entryText;
-        ConsoleEntry& entry = console.entries[console.entryCount];
-        entry.text = entryText;
-        entry.length = entryLength;
-        console.entryCount++;
-        current++;
-      }
-    }
-#endif
+
+    DrainProcessOutput(&context);
 
             
         InputState *input = &context.input;
         char temp[1024];
         memcpy(temp, context.identUnderCursor, 1024);
 
-        if (gui_get_ident_under_point(&context, input->mouse_x, input->mouse_y,
-              context.identUnderCursor, ARRAYCOUNT(context.identUnderCursor))) {
+        uint64_t hoverBeginCounter = SDL_GetPerformanceCounter();
+        int isIdentUnderCursor = gui_get_ident_under_point(&context, input->mouse_x, 
+          input->mouse_y, context.identUnderCursor, ARRAYCOUNT(context.identUnderCursor));
+        context.hoverMicroseconds = (float)((double)(SDL_GetPerformanceCounter() - hoverBeginCounter) *
+          1000000.0 / (double)SDL_GetPerformanceFrequency());
+        if (isIdentUnderCursor) {
           if (strcmp(temp, context.identUnderCursor) || context.requires_refresh) {
+            //NOTE(Torin) The values are copied into mouseOverStringBuffer below
+            //so the last identifier's are done with once it changes
             ClearStringBuffer(&context.mouseOverStringBuffer);
-            PrintInfo info = lldb_print_identifier(&context.debug_context, context.identUnderCursor);
+            ResetMemoryArena(&context.hoverArena);
+            PrintInfo info = lldb_print_identifier(&context.debug_context, 
+              context.identUnderCursor, &context.hoverArena);
             context.tooltip_is_compound = info.value_count > 1;
             for (uint32_t i = 0; i < info.value_count; i++) {
               PrintValue& value = info.values[i];
@@ -1430,25 +1942,19 @@ int main(int argc, char **argv) {
           ClearStringBuffer(&context.mouseOverStringBuffer);
         }
 
-        { //Draw the main buffer
-          SDL_Rect screen_rect = { 0, 0, (int)context.screen_width, (int)context.screen_height };
-          SDL_RenderSetViewport(context.renderer, &screen_rect);
-          SDL_SetRenderDrawColor(context.renderer, 0, 0, 0, 0);
-          SDL_RenderClear(context.renderer);
-          if (context.active_filedata)
-            gui_render_buffer(&context);
+        UpdatePanelDamage(&context);
+        if (!RedrawDirtyPanels(&context)) {
+          context.framesSkipped++;
+          context.wasLastFrameIdle = true;
+          EndFrameInput(&context);
+          continue;
         }
-
-            gui_draw_panel(&context, &context.output_panel, context.output_style);
-            DrawConsole(&context, context.output_panel, context.output_style);
-
-            gui_draw_panel(&context, &context.expressionPanel, 
-                context.expressionPanelStyle);
-            DrawExpressionList(&context, &context.expressionList, context.expressionPanel, 
-                context.expressionPanelStyle, context.syntaxStyle);
+        context.wasLastFrameIdle = false;
+        context.framesPresented++;
 
             //@Draw the @mouseOver buffer
-            if (context.mouseOverStringBuffer.memory[0] != 0) {
+            const GlyphAtlas *tooltipAtlas = GetGlyphAtlas(&context, context.font);
+            if (tooltipAtlas != NULL && context.mouseOverStringBuffer.memory[0] != 0) {
 
               //Determine the required size of the panel
               uint32_t totalHeight = 0;
@@ -1460,8 +1966,7 @@ int main(int argc, char **argv) {
                   while (*read_pos != 0) { 
                     read_pos++;
                   }
-                  int width, height;
-                  TTF_SizeText(context.font, text, &width, &height);
+                  uint32_t width = MeasureTextWidth(tooltipAtlas, text, read_pos - text);
                   maxWidth = max(width, maxWidth);
                   totalHeight += context.line_spacing + context.font_size; 
                   read_pos++;
@@ -1487,13 +1992,9 @@ int main(int argc, char **argv) {
                   read_pos++;
                 size_t text_length = read_pos - text;
                 
-                SDL_Color color = { 255, 255, 255, 255 };
-                SDL_Surface *text_surface = TTF_RenderText_Blended(context.font, text, color);
-                SDL_Texture *text_texture = SDL_CreateTextureFromSurface(context.renderer, text_surface);
-                SDL_Rect dest_rect = { (int)(panel->x + style.border_size + style.pad_left) + xoffset, ypos, text_surface->w, text_surface->h }; 
-                SDL_RenderCopy(context.renderer, text_texture, NULL, &dest_rect);
-                SDL_DestroyTexture(text_texture);
-                SDL_FreeSurface(text_surface);
+                RGBA8 color = { 255, 255, 255, 255 };
+                DrawTextRun(&context, context.font, text, text_length,
+                  (int)(panel->x + style.border_size + style.pad_left) + xoffset, ypos, color);
                 ypos += context.line_spacing + context.font_size;
                 read_pos++;
               }
@@ -1501,26 +2002,20 @@ int main(int argc, char **argv) {
 
 #if 1 
             if (context.identUnderCursor[0] != 0) {
-              SDL_Color color = { 255, 255, 255, 255 };
-              SDL_Surface *text_surface = TTF_RenderText_Blended(context.font, context.identUnderCursor, color);
-              SDL_Texture *text_texture = SDL_CreateTextureFromSurface(context.renderer, text_surface);
-              SDL_Rect dest_rect = { 640, 360, text_surface->w, text_surface->h }; 
-              SDL_RenderCopy(context.renderer, text_texture, NULL, &dest_rect);
-              SDL_DestroyTexture(text_texture);
-              SDL_FreeSurface(text_surface);
+              RGBA8 color = { 255, 255, 255, 255 };
+              DrawTextRun(&context, context.font, context.identUnderCursor, 
+                strlen(context.identUnderCursor), 640, 360, color);
             }
 #endif
 
 
 
-            static bool isSearchVisible = false;
-            if (context.controls.showFuzzySearch) {
-              isSearchVisible = true;
+            if (context.showDebugOverlay) {
+              DrawDebugOverlay(&context);
             }
 
-            if (isSearchVisible) {
-              //GUIShowFuzzySearch(&context);
-              isSearchVisible = false;
+            if (context.symbolSearch.isVisible) {
+              GUIShowFuzzySearch(&context);
             }
             
             //glViewport(0, 0, (int)ImGui::GetIO().DisplaySize.x, (int)ImGui::GetIO().DisplaySize.y);
@@ -1533,20 +2028,19 @@ int main(int argc, char **argv) {
             //ImGui_ImplSdl_NewFrame(ctx->window);
             //ImGui::ShowTestWindow();
             //ImGui::Render();
+            EndTextBatchFrame(&context.textBatch);
+            context.frameMilliseconds = (float)((double)(SDL_GetPerformanceCounter() - frameBeginCounter) *
+              1000.0 / (double)SDL_GetPerformanceFrequency());
             SDL_RenderPresent(context.renderer);
             
 
 
-            bool isRemoveDown = context.controls.isRemoveDown;
-            memset(&context.controls, 0, sizeof(Controls));
-            context.controls.isRemoveDown = isRemoveDown;
-
-            
-            
-
-            context.requires_refresh = false;
+            EndFrameInput(&context);
       }
 
+      FreeSourceCache(&context.sourceCache);
+      if (context.panelCache != NULL)
+        SDL_DestroyTexture(context.panelCache);
       TTF_Quit();
       SDL_Quit();
       return 0;
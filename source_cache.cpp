@@ -0,0 +1,133 @@
+#include <limits.h>
+
+//NOTE(Torin) Source files that execution has stopped in are kept open along
+//with everything derived from them so stepping back and forth between files
+//does not reread and reindex them. Entries are keyed by canonical path and
+//reloaded when the file on disk changes. Per file state that is built lazily
+//(line advances, syntax states) lives in the entry's arena and is thrown away
+//with it.
+
+#define SOURCE_CACHE_CAPACITY 8
+#define SOURCE_FILE_ARENA_BLOCK_SIZE (256 * 1024)
+
+struct SourceFile {
+  char path[PATH_MAX];
+  TextBuffer buffer;
+  LineAdvanceCache lineAdvanceCache;
+  SyntaxCache syntaxCache;
+  MemoryArena arena;
+
+  timespec modifiedTime;
+  size_t fileSize;
+  uint64_t lastUseTick;
+};
+
+struct SourceCache {
+  SourceFile files[SOURCE_CACHE_CAPACITY];
+  uint32_t fileCount;
+  uint64_t useTick;
+
+  uint64_t hitCount;
+  uint64_t missCount;
+  uint64_t reloadCount;
+  uint64_t evictionCount;
+};
+
+static bool
+LoadSourceFile(SourceFile *file, const struct stat& fileStat)
+{
+  ResetMemoryArena(&file->arena);
+  file->modifiedTime = fileStat.st_mtim;
+  file->fileSize = (size_t)fileStat.st_size;
+  bool result = LoadTextBuffer(&file->buffer, file->path);
+  InitLineAdvanceCache(&file->lineAdvanceCache, file->buffer.lineCount, &file->arena);
+  InitSyntaxCache(&file->syntaxCache, file->buffer.lineCount, &file->arena);
+  return result;
+}
+
+//NOTE(Torin) A file that failed to load is not kept, so the next time it is
+//needed it is tried again instead of handing back an empty buffer. The slot
+//is reused before any other.
+static void
+ReleaseSourceFile(SourceFile *file)
+{
+  UnloadTextBuffer(&file->buffer);
+  ResetMemoryArena(&file->arena);
+  file->path[0] = 0;
+  file->lastUseTick = 0;
+}
+
+static SourceFile *
+AcquireSourceFile(SourceCache *cache, const char *filename)
+{
+  char canonicalPath[PATH_MAX];
+  if (realpath(filename, canonicalPath) == NULL) {
+    log_error("could not resolve path %s: %s", filename, strerror(errno));
+    return NULL;
+  }
+
+  struct stat fileStat;
+  if (stat(canonicalPath, &fileStat) != 0) {
+    log_error("could not stat %s: %s", canonicalPath, strerror(errno));
+    return NULL;
+  }
+
+  cache->useTick++;
+  for (uint32_t i = 0; i < cache->fileCount; i++) {
+    SourceFile *file = &cache->files[i];
+    if (strcmp(file->path, canonicalPath) != 0) continue;
+    file->lastUseTick = cache->useTick;
+    if (file->modifiedTime.tv_sec == fileStat.st_mtim.tv_sec &&
+        file->modifiedTime.tv_nsec == fileStat.st_mtim.tv_nsec &&
+        file->fileSize == (size_t)fileStat.st_size) {
+      cache->hitCount++;
+      return file;
+    }
+
+    log_debug("source-cache: %s changed on disk, reloading", canonicalPath);
+    cache->reloadCount++;
+    cache->missCount++;
+    if (!LoadSourceFile(file, fileStat)) {
+      ReleaseSourceFile(file);
+      return NULL;
+    }
+    return file;
+  }
+
+  cache->missCount++;
+  SourceFile *file = NULL;
+  for (uint32_t i = 0; i < cache->fileCount && file == NULL; i++) {
+    if (cache->files[i].path[0] == 0) file = &cache->files[i];
+  }
+  if (file == NULL && cache->fileCount < SOURCE_CACHE_CAPACITY) {
+    file = &cache->files[cache->fileCount++];
+    InitMemoryArena(&file->arena, "source", SOURCE_FILE_ARENA_BLOCK_SIZE);
+  } else if (file == NULL) {
+    file = &cache->files[0];
+    for (uint32_t i = 1; i < cache->fileCount; i++) {
+      if (cache->files[i].lastUseTick < file->lastUseTick)
+        file = &cache->files[i];
+    }
+    log_debug("source-cache: evicting %s", file->path);
+    cache->evictionCount++;
+  }
+
+  size_t pathLength = strlen(canonicalPath);
+  memcpy(file->path, canonicalPath, pathLength + 1);
+  file->lastUseTick = cache->useTick;
+  if (!LoadSourceFile(file, fileStat)) {
+    ReleaseSourceFile(file);
+    return NULL;
+  }
+  return file;
+}
+
+static void
+FreeSourceCache(SourceCache *cache)
+{
+  for (uint32_t i = 0; i < cache->fileCount; i++) {
+    FreeTextBuffer(&cache->files[i].buffer);
+    FreeMemoryArena(&cache->files[i].arena);
+  }
+  cache->fileCount = 0;
+}
@@ -0,0 +1,380 @@
+//NOTE(Torin) C/C++ lexer for the source panel. Lines are only lexed when they
+//are drawn, the only thing carried from one line to the next is the lexer
+//mode at the end of the line (inside a block comment or a raw string) which is
+//cached per line. Scrolling to a line lexes forward from the last line whose
+//start state is known, redrawing a line only relexes that line.
+
+enum SyntaxKind : uint8_t {
+  SyntaxKind_Default,
+  SyntaxKind_Keyword,
+  SyntaxKind_Type,
+  SyntaxKind_Number,
+  SyntaxKind_String,
+  SyntaxKind_Comment,
+  SyntaxKind_Preprocessor,
+  SyntaxKind_Count,
+};
+
+enum SyntaxMode : uint8_t {
+  SyntaxMode_Normal,
+  SyntaxMode_BlockComment,
+  SyntaxMode_RawString,
+};
+
+#define SYNTAX_RAW_DELIMITER_MAX 16
+
+//NOTE(Torin) A raw string's delimiter is not copied, the state points back
+//at it in the file data
+struct SyntaxLineState {
+  uint8_t mode;
+  uint8_t rawDelimiterLength;
+  uint32_t rawDelimiterOffset;
+};
+
+struct SyntaxRun {
+  uint32_t begin;
+  uint32_t length;
+  uint8_t kind;
+};
+
+struct SyntaxCache {
+  SyntaxLineState *lineStates;
+  uint32_t lineCount;
+  uint32_t knownStateCount;
+
+  uint64_t linesLexed;
+  double secondsLexing;
+};
+
+struct SyntaxWord {
+  const char *text;
+  uint32_t length;
+  uint8_t kind;
+};
+
+#define SYNTAX_WORD_TABLE_SIZE 512
+static SyntaxWord _syntaxWordTable[SYNTAX_WORD_TABLE_SIZE];
+static bool _syntaxWordTableIsBuilt;
+
+static const char *_syntaxKeywords[] = {
+  "alignas", "alignof", "asm", "break", "case", "catch", "class", "concept",
+  "const", "consteval", "constexpr", "constinit", "const_cast", "continue",
+  "co_await", "co_return", "co_yield", "decltype", "default", "delete", "do",
+  "dynamic_cast", "else", "enum", "explicit", "export", "extern", "false",
+  "final", "for", "friend", "goto", "if", "inline", "mutable", "namespace",
+  "new", "noexcept", "nullptr", "NULL", "operator", "override", "private",
+  "protected", "public", "register", "reinterpret_cast", "requires", "restrict",
+  "return", "sizeof", "static", "static_assert", "static_cast", "struct",
+  "switch", "template", "this", "thread_local", "throw", "true", "try",
+  "typedef", "typeid", "typename", "union", "using", "virtual", "volatile",
+  "while",
+};
+
+static const char *_syntaxTypes[] = {
+  "auto", "bool", "char", "char8_t", "char16_t", "char32_t", "double", "float",
+  "int", "long", "short", "signed", "unsigned", "void", "wchar_t",
+};
+
+static inline
+uint32_t HashSyntaxWord(const char *text, uint32_t length) {
+  uint32_t hash = 2166136261u;
+  for (uint32_t i = 0; i < length; i++) {
+    hash ^= (uint8_t)text[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+static void
+AddSyntaxWords(const char **words, uint32_t wordCount, uint8_t kind)
+{
+  for (uint32_t i = 0; i < wordCount; i++) {
+    uint32_t length = strlen(words[i]);
+    uint32_t slot = HashSyntaxWord(words[i], length) & (SYNTAX_WORD_TABLE_SIZE - 1);
+    while (_syntaxWordTable[slot].text != NULL)
+      slot = (slot + 1) & (SYNTAX_WORD_TABLE_SIZE - 1);
+    _syntaxWordTable[slot] = SyntaxWord { words[i], length, kind };
+  }
+}
+
+static inline
+uint8_t ClassifySyntaxWord(const char *text, uint32_t length) {
+  if (_syntaxWordTableIsBuilt == false) {
+    AddSyntaxWords(_syntaxKeywords, ARRAYCOUNT(_syntaxKeywords), SyntaxKind_Keyword);
+    AddSyntaxWords(_syntaxTypes, ARRAYCOUNT(_syntaxTypes), SyntaxKind_Type);
+    _syntaxWordTableIsBuilt = true;
+  }
+
+  uint32_t slot = HashSyntaxWord(text, length) & (SYNTAX_WORD_TABLE_SIZE - 1);
+  while (_syntaxWordTable[slot].text != NULL) {
+    const SyntaxWord& word = _syntaxWordTable[slot];
+    if (word.length == length && memcmp(word.text, text, length) == 0)
+      return word.kind;
+    slot = (slot + 1) & (SYNTAX_WORD_TABLE_SIZE - 1);
+  }
+
+  //NOTE(Torin) size_t, uint32_t, pthread_t...
+  if (length > 2 && text[length - 2] == '_' && text[length - 1] == 't')
+    return SyntaxKind_Type;
+  return SyntaxKind_Default;
+}
+
+static inline
+bool IsSyntaxIdentChar(char c) {
+  bool result = isalnum((uint8_t)c) || c == '_';
+  return result;
+}
+
+static inline
+void EmitSyntaxRun(SyntaxRun *runs, uint32_t *runCount, uint8_t kind,
+uint32_t begin, uint32_t end) {
+  if (runs == NULL || end <= begin) return;
+  if (*runCount > 0) {
+    SyntaxRun& last = runs[*runCount - 1];
+    if (last.kind == kind && last.begin + last.length == begin) {
+      last.length += end - begin;
+      return;
+    }
+  }
+  runs[(*runCount)++] = SyntaxRun { begin, end - begin, kind };
+}
+
+//NOTE(Torin) Finds the raw string terminator )delimiter" and writes the index
+//one past it to outEnd, or length if it is not on this line
+static inline
+bool FindRawStringEnd(const char *line, uint32_t begin, uint32_t length,
+const char *delimiter, uint32_t delimiterLength, uint32_t *outEnd) {
+  for (uint32_t i = begin; i + delimiterLength + 1 < length; i++) {
+    if (line[i] == ')' && memcmp(&line[i + 1], delimiter, delimiterLength) == 0 &&
+        line[i + 1 + delimiterLength] == '"') {
+      *outEnd = i + delimiterLength + 2;
+      return true;
+    }
+  }
+  *outEnd = length;
+  return false;
+}
+
+//NOTE(Torin) Lexes one line starting in state and returns the state at the
+//start of the next line. runs may be NULL when only the state is needed,
+//otherwise it must have room for length runs.
+static SyntaxLineState
+LexSyntaxLine(const char *fileData, uint32_t lineOffset, uint32_t length,
+SyntaxLineState state, SyntaxRun *runs, uint32_t *runCount)
+{
+  const char *line = fileData + lineOffset;
+  uint32_t i = 0;
+  bool isLineStart = true;
+
+  while (i < length) {
+    if (state.mode == SyntaxMode_BlockComment) {
+      uint32_t end = length;
+      for (uint32_t j = i; j + 1 < length; j++) {
+        if (line[j] == '*' && line[j + 1] == '/') {
+          end = j + 2;
+          state.mode = SyntaxMode_Normal;
+          break;
+        }
+      }
+      EmitSyntaxRun(runs, runCount, SyntaxKind_Comment, i, end);
+      i = end;
+      continue;
+    }
+
+    if (state.mode == SyntaxMode_RawString) {
+      const char *delimiter = fileData + state.rawDelimiterOffset;
+      uint32_t end = 0;
+      if (FindRawStringEnd(line, i, length, delimiter, state.rawDelimiterLength, &end))
+        state.mode = SyntaxMode_Normal;
+      EmitSyntaxRun(runs, runCount, SyntaxKind_String, i, end);
+      i = end;
+      continue;
+    }
+
+    char c = line[i];
+    if (c == ' ' || c == '\t' || c == '\r') {
+      uint32_t begin = i;
+      while (i < length && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r')) i++;
+      EmitSyntaxRun(runs, runCount, SyntaxKind_Default, begin, i);
+      continue;
+    }
+
+    if (c == '#' && isLineStart) {
+      uint32_t begin = i++;
+      while (i < length && (line[i] == ' ' || line[i] == '\t')) i++;
+      uint32_t directiveBegin = i;
+      while (i < length && IsSyntaxIdentChar(line[i])) i++;
+      EmitSyntaxRun(runs, runCount, SyntaxKind_Preprocessor, begin, i);
+      isLineStart = false;
+
+      if (i - directiveBegin == 7 && memcmp(&line[directiveBegin], "include", 7) == 0) {
+        uint32_t spaceBegin = i;
+        while (i < length && (line[i] == ' ' || line[i] == '\t')) i++;
+        EmitSyntaxRun(runs, runCount, SyntaxKind_Default, spaceBegin, i);
+        if (i < length && line[i] == '<') {
+          uint32_t pathBegin = i;
+          while (i < length && line[i] != '>') i++;
+          if (i < length) i++;
+          EmitSyntaxRun(runs, runCount, SyntaxKind_String, pathBegin, i);
+        }
+      }
+      continue;
+    }
+    isLineStart = false;
+
+    if (c == '/' && i + 1 < length && line[i + 1] == '/') {
+      EmitSyntaxRun(runs, runCount, SyntaxKind_Comment, i, length);
+      i = length;
+      continue;
+    }
+
+    if (c == '/' && i + 1 < length && line[i + 1] == '*') {
+      EmitSyntaxRun(runs, runCount, SyntaxKind_Comment, i, i + 2);
+      state.mode = SyntaxMode_BlockComment;
+      i += 2;
+      continue;
+    }
+
+    if (c == '"' || c == '\'') {
+      uint32_t begin = i++;
+      while (i < length && line[i] != c) {
+        if (line[i] == '\\') i++;
+        i++;
+      }
+      if (i < length) i++;
+      if (i > length) i = length;
+      EmitSyntaxRun(runs, runCount, SyntaxKind_String, begin, i);
+      continue;
+    }
+
+    if (isalpha((uint8_t)c) || c == '_') {
+      uint32_t begin = i;
+      while (i < length && IsSyntaxIdentChar(line[i])) i++;
+      uint32_t wordLength = i - begin;
+      const char *word = &line[begin];
+
+      //NOTE(Torin) Encoding prefixes (L u U u8) and raw strings (R"delim(...)delim")
+      if (i < length && (line[i] == '"' || line[i] == '\'') && wordLength <= 3) {
+        bool isRaw = word[wordLength - 1] == 'R';
+        uint32_t prefixLength = isRaw ? wordLength - 1 : wordLength;
+        bool isPrefix = prefixLength == 0 ||
+          (prefixLength == 1 && (word[0] == 'L' || word[0] == 'u' || word[0] == 'U')) ||
+          (prefixLength == 2 && word[0] == 'u' && word[1] == '8');
+        if (isPrefix && isRaw && line[i] == '"') {
+          uint32_t delimiterBegin = i + 1;
+          uint32_t j = delimiterBegin;
+          while (j < length && line[j] != '(' && j - delimiterBegin < SYNTAX_RAW_DELIMITER_MAX &&
+              line[j] != ' ' && line[j] != ')' && line[j] != '\\') j++;
+          if (j < length && line[j] == '(') {
+            uint32_t delimiterLength = j - delimiterBegin;
+            uint32_t end = 0;
+            if (!FindRawStringEnd(line, j + 1, length, &line[delimiterBegin], delimiterLength, &end)) {
+              state.mode = SyntaxMode_RawString;
+              state.rawDelimiterLength = (uint8_t)delimiterLength;
+              state.rawDelimiterOffset = lineOffset + delimiterBegin;
+            }
+            EmitSyntaxRun(runs, runCount, SyntaxKind_String, begin, end);
+            i = end;
+            continue;
+          }
+        } else if (isPrefix && isRaw == false) {
+          char quote = line[i++];
+          while (i < length && line[i] != quote) {
+            if (line[i] == '\\') i++;
+            i++;
+          }
+          if (i < length) i++;
+          if (i > length) i = length;
+          EmitSyntaxRun(runs, runCount, SyntaxKind_String, begin, i);
+          continue;
+        }
+      }
+
+      uint8_t kind = runs ? ClassifySyntaxWord(word, wordLength) : (uint8_t)SyntaxKind_Default;
+      EmitSyntaxRun(runs, runCount, kind, begin, i);
+      continue;
+    }
+
+    if (isdigit((uint8_t)c) || (c == '.' && i + 1 < length && isdigit((uint8_t)line[i + 1]))) {
+      uint32_t begin = i++;
+      while (i < length) {
+        char n = line[i];
+        char p = line[i - 1];
+        bool isExponentSign = (n == '+' || n == '-') &&
+          (p == 'e' || p == 'E' || p == 'p' || p == 'P');
+        if (IsSyntaxIdentChar(n) || n == '.' || n == '\'' || isExponentSign) i++;
+        else break;
+      }
+      EmitSyntaxRun(runs, runCount, SyntaxKind_Number, begin, i);
+      continue;
+    }
+
+    EmitSyntaxRun(runs, runCount, SyntaxKind_Default, i, i + 1);
+    i++;
+  }
+
+  return state;
+}
+
+static inline
+double GetMonotonicSeconds() {
+  timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  double result = (double)time.tv_sec + ((double)time.tv_nsec / 1000000000.0);
+  return result;
+}
+
+static inline
+void InitSyntaxCache(SyntaxCache *cache, uint32_t lineCount, MemoryArena *arena) {
+  memset(cache, 0, sizeof(SyntaxCache));
+  cache->lineCount = lineCount;
+  cache->lineStates = PushArray(arena, SyntaxLineState, lineCount + 1);
+  cache->knownStateCount = 1;
+}
+
+//NOTE(Torin) Lexes forward without producing runs until the state at the
+//start of lineIndex is known
+static SyntaxLineState
+GetSyntaxLineState(SyntaxCache *cache, const TextBuffer *buffer, uint32_t lineIndex)
+{
+  assert(lineIndex < cache->lineCount);
+  if (lineIndex >= cache->knownStateCount) {
+    double beginSeconds = GetMonotonicSeconds();
+    uint32_t firstUnknownIndex = cache->knownStateCount;
+    while (cache->knownStateCount <= lineIndex) {
+      uint32_t previousIndex = cache->knownStateCount - 1;
+      uint32_t length = 0;
+      const char *line = GetTextBufferLine(buffer, previousIndex, &length);
+      cache->lineStates[previousIndex + 1] = LexSyntaxLine(buffer->data,
+        (uint32_t)(line - buffer->data), length, cache->lineStates[previousIndex], NULL, NULL);
+      cache->knownStateCount++;
+    }
+    cache->linesLexed += cache->knownStateCount - firstUnknownIndex;
+    cache->secondsLexing += GetMonotonicSeconds() - beginSeconds;
+  }
+  return cache->lineStates[lineIndex];
+}
+
+//NOTE(Torin) Runs are pushed onto arena which is expected to be the frame arena
+static SyntaxRun *
+HighlightSourceLine(SyntaxCache *cache, const TextBuffer *buffer, uint32_t lineIndex,
+MemoryArena *arena, uint32_t *outRunCount)
+{
+  SyntaxLineState state = GetSyntaxLineState(cache, buffer, lineIndex);
+  double beginSeconds = GetMonotonicSeconds();
+
+  uint32_t length = 0;
+  const char *line = GetTextBufferLine(buffer, lineIndex, &length);
+  SyntaxRun *runs = PushArray(arena, SyntaxRun, length + 1);
+  *outRunCount = 0;
+  SyntaxLineState nextState = LexSyntaxLine(buffer->data, (uint32_t)(line - buffer->data),
+    length, state, runs, outRunCount);
+  if (cache->knownStateCount == lineIndex + 1 && lineIndex + 1 < cache->lineCount) {
+    cache->lineStates[lineIndex + 1] = nextState;
+    cache->knownStateCount++;
+  }
+
+  cache->linesLexed++;
+  cache->secondsLexing += GetMonotonicSeconds() - beginSeconds;
+  return runs;
+}
@@ -83,6 +83,7 @@ void test_function()
 
 static int flatGlobal;
 static NestedStructs deepGlobal; 
+static float largeGlobalArray[1000000];
 
 static inline
 int BigFunctionWithLongNameAndLargeNumberOfArguments(
@@ -115,6 +116,7 @@ int main()
 
   flatGlobal = 20;
   deepGlobal.scale.y = 2.0f;
+  largeGlobalArray[999999] = 1.0f;
 
   LargeStruct large_struct = {};
   const char *stringLiteral = "foobar";
@@ -0,0 +1,39 @@
+#!/bin/sh
+#Runs a program twice in one headless session with an argument and checks
+#both runs stop at main and exit with the status the argument gives.
+#Expects the debugger to have been built to ./a.out with build.sh, run it
+#with: sh test_headless.sh
+WORK_DIR=$(mktemp -d)
+
+cat > $WORK_DIR/args.c <<'ARGS'
+#include <string.h>
+int main(int argc, char **argv) {
+  if (argc == 2 && strcmp(argv[1], "hello") == 0) return 7;
+  return 1;
+}
+ARGS
+clang -O0 -g $WORK_DIR/args.c -o $WORK_DIR/args || exit 1
+
+cat > $WORK_DIR/script.txt <<'SCRIPT'
+break main
+run
+continue
+run
+continue
+quit
+SCRIPT
+
+./a.out -x$WORK_DIR/script.txt $WORK_DIR/args hello 2>/dev/null > $WORK_DIR/results.txt
+STOPPED=$(grep -c '"command":"run","ok":true,"state":"stopped"' $WORK_DIR/results.txt)
+EXITED=$(grep -c '"command":"continue","ok":true,"state":"exited","status":7' $WORK_DIR/results.txt)
+ERRORS=$(grep -c '"ok":false' $WORK_DIR/results.txt)
+if [ "$STOPPED" -eq 2 ] && [ "$EXITED" -eq 2 ] && [ "$ERRORS" -eq 0 ]; then
+  echo "PASS headless run twice"
+  RESULT=0
+else
+  echo "FAIL headless run twice"
+  cat $WORK_DIR/results.txt
+  RESULT=1
+fi
+rm -rf $WORK_DIR
+exit $RESULT
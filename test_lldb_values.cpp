@@ -5,6 +5,7 @@
 #define log_error(...)  printf(__VA_ARGS__); printf("\n")
 #define log_info(...)   printf(__VA_ARGS__); printf("\n")
 
+#include "arena.cpp"
 #include "lldb_backend.cpp"
 
 int main() {
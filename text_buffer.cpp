@@ -0,0 +1,194 @@
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+//NOTE(Torin) Source files are mapped rather than read and the line index is
+//a growable array of line start offsets so there is no limit on the number of
+//lines. lineOffsets[lineCount] is always the size of the file so the end of
+//any line is the start of the next one minus its line ending (\n or \r\n)
+
+struct TextBuffer {
+  char *data;
+  size_t size;
+  bool isMapped;
+
+  uint32_t *lineOffsets;
+  uint32_t lineCount;
+  uint32_t lineCapacity;
+
+  float indexMilliseconds;
+};
+
+static inline
+void ReserveLineOffsets(TextBuffer *buffer, uint32_t requiredCount) {
+  if (requiredCount <= buffer->lineCapacity) return;
+  uint32_t newCapacity = buffer->lineCapacity ? buffer->lineCapacity : 1024;
+  while (newCapacity < requiredCount) newCapacity *= 2;
+  buffer->lineOffsets = (uint32_t *)realloc(buffer->lineOffsets, sizeof(uint32_t) * newCapacity);
+  assert(buffer->lineOffsets != NULL);
+  buffer->lineCapacity = newCapacity;
+}
+
+static inline
+void PushLineBreaks(TextBuffer *buffer, uint32_t baseOffset, uint32_t newlineMask) {
+  while (newlineMask != 0) {
+    uint32_t bitIndex = __builtin_ctz(newlineMask);
+    buffer->lineOffsets[buffer->lineCount++] = baseOffset + bitIndex + 1;
+    newlineMask &= newlineMask - 1;
+  }
+}
+
+#if defined(__SSE2__)
+static size_t
+IndexNewlinesSSE2(TextBuffer *buffer, size_t offset)
+{
+  const __m128i newline = _mm_set1_epi8('\n');
+  for (; offset + 16 <= buffer->size; offset += 16) {
+    ReserveLineOffsets(buffer, buffer->lineCount + 16);
+    __m128i chunk = _mm_loadu_si128((const __m128i *)(buffer->data + offset));
+    uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline));
+    PushLineBreaks(buffer, (uint32_t)offset, mask);
+  }
+  return offset;
+}
+
+__attribute__((target("avx2"))) static size_t
+IndexNewlinesAVX2(TextBuffer *buffer, size_t offset)
+{
+  const __m256i newline = _mm256_set1_epi8('\n');
+  for (; offset + 32 <= buffer->size; offset += 32) {
+    ReserveLineOffsets(buffer, buffer->lineCount + 32);
+    __m256i chunk = _mm256_loadu_si256((const __m256i *)(buffer->data + offset));
+    uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline));
+    PushLineBreaks(buffer, (uint32_t)offset, mask);
+  }
+  return offset;
+}
+#endif
+
+static void
+BuildTextBufferLineIndex(TextBuffer *buffer)
+{
+  timespec beginTime;
+  clock_gettime(CLOCK_MONOTONIC, &beginTime);
+
+  buffer->lineCount = 0;
+  ReserveLineOffsets(buffer, (uint32_t)(buffer->size / 32) + 2);
+  if (buffer->size > 0)
+    buffer->lineOffsets[buffer->lineCount++] = 0;
+
+  size_t offset = 0;
+#if defined(__SSE2__)
+  static int hasAVX2 = -1;
+  if (hasAVX2 == -1) hasAVX2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+  if (hasAVX2) offset = IndexNewlinesAVX2(buffer, offset);
+  offset = IndexNewlinesSSE2(buffer, offset);
+#endif
+  for (; offset < buffer->size; offset++) {
+    if (buffer->data[offset] == '\n') {
+      ReserveLineOffsets(buffer, buffer->lineCount + 1);
+      buffer->lineOffsets[buffer->lineCount++] = (uint32_t)(offset + 1);
+    }
+  }
+
+  //NOTE(Torin) A trailing newline ends the last line rather than starting an empty one
+  if (buffer->lineCount > 0 && buffer->lineOffsets[buffer->lineCount - 1] == buffer->size)
+    buffer->lineCount--;
+  ReserveLineOffsets(buffer, buffer->lineCount + 1);
+  buffer->lineOffsets[buffer->lineCount] = (uint32_t)buffer->size;
+
+  timespec endTime;
+  clock_gettime(CLOCK_MONOTONIC, &endTime);
+  buffer->indexMilliseconds = (float)((endTime.tv_sec - beginTime.tv_sec) * 1000.0 +
+    (endTime.tv_nsec - beginTime.tv_nsec) / 1000000.0);
+}
+
+static void
+UnloadTextBuffer(TextBuffer *buffer)
+{
+  if (buffer->isMapped) {
+    munmap(buffer->data, buffer->size);
+  } else {
+    free(buffer->data);
+  }
+  buffer->data = NULL;
+  buffer->size = 0;
+  buffer->isMapped = false;
+  buffer->lineCount = 0;
+}
+
+static inline
+void FreeTextBuffer(TextBuffer *buffer) {
+  UnloadTextBuffer(buffer);
+  free(buffer->lineOffsets);
+  buffer->lineOffsets = NULL;
+  buffer->lineCapacity = 0;
+}
+
+//NOTE(Torin) The line offset array is kept between loads so reopening files
+//only reallocates it when a bigger file comes along
+static bool
+LoadTextBuffer(TextBuffer *buffer, const char *filename)
+{
+  UnloadTextBuffer(buffer);
+
+  int fd = open(filename, O_RDONLY);
+  if (fd == -1) {
+    log_error("could not open %s: %s", filename, strerror(errno));
+    return false;
+  }
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0) {
+    log_error("could not stat %s: %s", filename, strerror(errno));
+    close(fd);
+    return false;
+  }
+
+  if ((uint64_t)fileStat.st_size >= (uint64_t)UINT32_MAX) {
+    log_error("%s is too large to display (%lu bytes)", filename, (size_t)fileStat.st_size);
+    close(fd);
+    return false;
+  }
+
+  buffer->size = (size_t)fileStat.st_size;
+  if (buffer->size > 0) {
+    void *mapping = mmap(NULL, buffer->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping != MAP_FAILED) {
+      madvise(mapping, buffer->size, MADV_SEQUENTIAL);
+      buffer->data = (char *)mapping;
+      buffer->isMapped = true;
+    } else {
+      //NOTE(Torin) Some filesystems cannot be mapped, fall back to reading it
+      buffer->data = (char *)malloc(buffer->size);
+      assert(buffer->data != NULL);
+      size_t bytesRead = 0;
+      while (bytesRead < buffer->size) {
+        ssize_t result = read(fd, buffer->data + bytesRead, buffer->size - bytesRead);
+        if (result <= 0) break;
+        bytesRead += result;
+      }
+      buffer->size = bytesRead;
+    }
+  }
+  close(fd);
+
+  BuildTextBufferLineIndex(buffer);
+  return true;
+}
+
+//NOTE(Torin) Returns the start of the line and its length without the line ending
+static inline
+const char *GetTextBufferLine(const TextBuffer *buffer, uint32_t lineIndex, uint32_t *outLength) {
+  assert(lineIndex < buffer->lineCount);
+  uint32_t begin = buffer->lineOffsets[lineIndex];
+  uint32_t end = buffer->lineOffsets[lineIndex + 1];
+  if (end > begin && buffer->data[end - 1] == '\n') end--;
+  if (end > begin && buffer->data[end - 1] == '\r') end--;
+  *outLength = end - begin;
+  return buffer->data + begin;
+}